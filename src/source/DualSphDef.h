@@ -110,6 +110,8 @@
 
 #define BSIZE_FORCES 128  ///<Blocksize for particle interaction (default=128).
 
+#define INTERCHECK_TOL 1e-4 ///<Tolerance of maximum relative difference of SIMD or PosCell interaction against scalar path (-cpusimd:2 or -cpuposcell:2).
+
 //#define CODE_SIZE4  //-Enables or disables the use of unsigned type (32 bits) for code (allows valid 65530 MKs). | Activa o desactiva el uso de unsigned (32 bits) para code (permite 65530 MKs validos).
 #ifdef CODE_SIZE4
   #define CODE_MKRANGEMAX 65530        //-Maximum valid MK value. | Valor maximo de MK valido.
@@ -298,6 +300,7 @@ typedef enum{
   SDAT_Vtk=2,        ///<VTK format .vtk
   SDAT_Csv=4,        ///<CSV format .csv
   SDAT_Info=8,
+  SDAT_Vtu=16,       ///<VTK XML format .vtu (built-in writer)
   SDAT_None=0 
 }TpSaveDat; 
 
@@ -422,6 +425,23 @@ inline const char* GetNameCellMode(TpCellMode cellmode){
   return("???");
 }
 
+///Order of the rows of cells (Y,Z) in memory on CPU. Cells of a row in X are always consecutive.
+typedef enum{ 
+   CELLORDER_Row=0      ///<Row-major order (rows by Y and then by Z).
+  ,CELLORDER_Morton=1   ///<Rows follow a Morton (Z-order) curve in (Y,Z).
+  ,CELLORDER_Hilbert=2  ///<Rows follow a Hilbert curve in (Y,Z). Not bit-identical to row order (summation order changes).
+}TpCellOrder; 
+
+///Returns the name of the CellOrder in text format.
+inline const char* GetNameCellOrder(TpCellOrder cellorder){
+  switch(cellorder){
+    case CELLORDER_Row:      return("Row");
+    case CELLORDER_Morton:   return("Morton");
+    case CELLORDER_Hilbert:  return("Hilbert");
+  }
+  return("???");
+}
+
 ///Domain division mode.
 typedef enum{ 
   MGDIV_None=0,      ///<Not specified. 
@@ -21,7 +21,12 @@
 #include "JArraysCpu.h"
 #include "Functions.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#ifdef _WIN32
+  #include <malloc.h>
+#endif
 
 using namespace std;
 
@@ -35,7 +40,11 @@ JArraysCpuSize::JArraysCpuSize(unsigned elementsize):ElementSize(elementsize){
   ClassName="JArraysCpuSize";
   for(unsigned c=0;c<MAXPOINTERS;c++)Pointers[c]=NULL;
   Count=0;
+  CountUsedMark=0;
   CountMax=CountUsedMax=0;
+  TouchBlock=NULL;
+  TouchBytes=NULL;
+  TouchTime=NULL;
   Reset();
 }
 
@@ -53,6 +62,7 @@ JArraysCpuSize::~JArraysCpuSize(){
 void JArraysCpuSize::Reset(){
   FreeMemory();
   ArraySize=0;
+  CountUsedMark=0;
 }
 
 //==============================================================================
@@ -65,27 +75,23 @@ void JArraysCpuSize::FreeMemory(){
 }
 
 //==============================================================================
-/// Reserva memoria y devuelve puntero con memoria asignada.
-/// Allocates memory and returns pointers with allocated memory.
+/// Reserva memoria alineada a ALIGNMENT bytes y devuelve puntero con memoria 
+/// asignada e inicializada.
+/// Allocates memory aligned to ALIGNMENT bytes and returns pointers with 
+/// allocated and initialised memory.
 //==============================================================================
 void* JArraysCpuSize::AllocPointer(unsigned size)const{
+  if(ElementSize!=1 && ElementSize!=2 && ElementSize!=4 && ElementSize!=8 && ElementSize!=12 
+    && ElementSize!=16 && ElementSize!=24 && ElementSize!=32)Run_Exceptioon("The elementsize value is invalid.");
+  const size_t nbytes=size_t(ElementSize)*size;
   void* pointer=NULL;
-  try{
-    switch(ElementSize){
-      case 1:   pointer=new char[size];      break;
-      case 2:   pointer=new word[size];      break;
-      case 4:   pointer=new int[size];       break;
-      case 8:   pointer=new double[size];    break;
-      case 12:  pointer=new int[size*3];     break;
-      case 16:  pointer=new int[size*4];     break;
-      case 24:  pointer=new double[size*3];  break;
-      case 32:  pointer=new double[size*4];  break;
-    }
-  }
-  catch(const std::bad_alloc){
-    Run_Exceptioon("Cannot allocate the requested memory.");
-  }
-  if(!pointer)Run_Exceptioon("The elementsize value is invalid.");
+ #ifdef _WIN32
+  pointer=_aligned_malloc(nbytes,ALIGNMENT);
+ #else
+  if(posix_memalign(&pointer,ALIGNMENT,nbytes))pointer=NULL;
+ #endif
+  if(!pointer)Run_Exceptioon("Cannot allocate the requested memory.");
+  FirstTouch(pointer,nbytes);
   return(pointer);
 }
 
@@ -94,17 +100,52 @@ void* JArraysCpuSize::AllocPointer(unsigned size)const{
 /// Frees memory allocated to pointers.
 //==============================================================================
 void JArraysCpuSize::FreePointer(void* pointer)const{
-  switch(ElementSize){
-    case 1:   delete[] ((char*)pointer);    pointer=NULL;   break;
-    case 2:   delete[] ((word*)pointer);    pointer=NULL;   break;
-    case 4:   delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 8:   delete[] ((double*)pointer);  pointer=NULL;   break;
-    case 12:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 16:  delete[] ((int*)pointer);     pointer=NULL;   break;
-    case 24:  delete[] ((double*)pointer);  pointer=NULL;   break;
-    case 32:  delete[] ((double*)pointer);  pointer=NULL;   break;
+ #ifdef _WIN32
+  _aligned_free(pointer);
+ #else
+  free(pointer);
+ #endif
+}
+
+//==============================================================================
+/// Inicializa la memoria con ceros en paralelo en bloques de igual tamanho, uno
+/// por hilo, de forma que no hay fallos de pagina durante los pasos. El reparto
+/// no coincide con el de los bucles de particulas: los bloques dividen la 
+/// capacidad del array (no las np particulas actuales) y la interaccion reparte
+/// fragmentos guided de forma dinamica (JSphSchedCpu), asi que solo es 
+/// aproximado que las paginas esten en el nodo NUMA del hilo que las usa (con 
+/// franjas por socket cada socket inicializa su parte de la capacidad).
+/// Con TouchBlock cada hilo inicializa el bloque indicado en lugar del bloque th.
+/// Initialises memory with zeros in parallel in blocks of equal size, one per
+/// thread, so there are no page faults during the simulation steps. This split
+/// does not match the particle loops: blocks split the capacity of the array
+/// (not the current np particles) and the interaction hands out guided chunks
+/// dynamically (JSphSchedCpu), so pages are only approximately on the NUMA node
+/// of the thread that uses them (with slabs by socket each socket initialises
+/// its part of the capacity).
+/// With TouchBlock each thread initialises the given block instead of block th.
+/// With TouchBytes the bytes and the time of each thread are accumulated.
+//==============================================================================
+void JArraysCpuSize::FirstTouch(void *pointer,size_t nbytes)const{
+  byte *ptr=(byte*)pointer;
+ #ifdef OMP_USE
+  const int nth=omp_get_max_threads();
+  #pragma omp parallel for schedule (static,1)
+  for(int th=0;th<nth;th++){
+    const double tini=(TouchBytes? omp_get_wtime(): 0);
+    const size_t b=size_t(TouchBlock? TouchBlock[th]: th);
+    const size_t ini=nbytes/nth*b+min(nbytes%nth,b);
+    const size_t fin=nbytes/nth*(b+1)+min(nbytes%nth,b+1);
+    memset(ptr+ini,0,fin-ini);
+    if(TouchBytes){
+      TouchBytes[th]+=fin-ini;
+      TouchTime[th]+=omp_get_wtime()-tini;
+    }
   }
-  if(pointer)Run_Exceptioon("The elementsize value is invalid.");
+ #else
+  memset(ptr,0,nbytes);
+  if(TouchBytes)TouchBytes[0]+=nbytes;
+ #endif
 }
 
 //==============================================================================
@@ -130,6 +171,31 @@ void JArraysCpuSize::SetArrayCount(unsigned count){
   CountMax=max(CountMax,Count);
 }
 
+//==============================================================================
+/// Establece el bloque de memoria que inicializa cada hilo al reservar arrays.
+/// Sets the block of memory initialised by each thread when arrays are allocated.
+//==============================================================================
+void JArraysCpu::SetTouchOrder(int nth,const int *thblock){
+  if(nth>OMP_MAXTHREADS)Run_Exceptioon("Number of threads is invalid.");
+  for(int th=0;th<nth;th++)TouchBlock[th]=thblock[th];
+  Arrays1b->SetTouchBlock(TouchBlock);
+  Arrays2b->SetTouchBlock(TouchBlock);
+  Arrays4b->SetTouchBlock(TouchBlock);
+  Arrays8b->SetTouchBlock(TouchBlock);
+  Arrays12b->SetTouchBlock(TouchBlock);
+  Arrays16b->SetTouchBlock(TouchBlock);
+  Arrays24b->SetTouchBlock(TouchBlock);
+  Arrays32b->SetTouchBlock(TouchBlock);
+}
+
+//==============================================================================
+/// Reinicia los bytes y el tiempo de inicializacion de memoria de cada hilo.
+/// Resets the bytes and the time of memory initialisation of each thread.
+//==============================================================================
+void JArraysCpu::ResetTouchStats(){
+  for(int th=0;th<OMP_MAXTHREADS;th++){ TouchBytes[th]=0; TouchTime[th]=0; }
+}
+
 //==============================================================================
 /// Cambia el numero de elementos de los arrays.
 /// Si hay algun array en uso lanza una excepcion.
@@ -182,6 +248,14 @@ void JArraysCpuSize::Free(void *pointer){
   }
 }  
 
+//==============================================================================
+/// Comprueba que los arrays reservados durante el paso fueron liberados.
+/// Checks that the arrays reserved during the step were freed.
+//==============================================================================
+void JArraysCpuSize::CheckStep()const{
+  if(CountUsed!=CountUsedMark)Run_Exceptioon(fun::PrintStr("Arrays with %u bytes in use changed during the step (%u -> %u).",ElementSize,CountUsedMark,CountUsed));
+}
+
 
 //##############################################################################
 //# JArraysCpu
@@ -199,6 +273,16 @@ JArraysCpu::JArraysCpu(){
   Arrays16b=new JArraysCpuSize(16);
   Arrays24b=new JArraysCpuSize(24);
   Arrays32b=new JArraysCpuSize(32);
+  for(int th=0;th<OMP_MAXTHREADS;th++)TouchBlock[th]=th;
+  ResetTouchStats();
+  Arrays1b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays2b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays4b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays8b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays12b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays16b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays24b->SetTouchStats(TouchBytes,TouchTime);
+  Arrays32b->SetTouchStats(TouchBytes,TouchTime);
 }
 
 //==============================================================================
@@ -273,4 +357,46 @@ void JArraysCpu::SetArraySize(unsigned size){
   Arrays32b->SetArraySize(size);
 }
 
+//==============================================================================
+/// Guarda el numero de arrays en uso al comienzo del paso.
+/// Stores the number of arrays in use at the start of the step.
+//==============================================================================
+void JArraysCpu::MarkStep(){
+  Arrays1b->MarkStep(); 
+  Arrays2b->MarkStep(); 
+  Arrays4b->MarkStep(); 
+  Arrays8b->MarkStep(); 
+  Arrays12b->MarkStep();
+  Arrays16b->MarkStep();
+  Arrays24b->MarkStep();
+  Arrays32b->MarkStep();
+}
 
+//==============================================================================
+/// Comprueba que los arrays reservados durante el paso fueron liberados.
+/// Checks that the arrays reserved during the step were freed.
+//==============================================================================
+void JArraysCpu::CheckStep()const{
+  Arrays1b->CheckStep(); 
+  Arrays2b->CheckStep(); 
+  Arrays4b->CheckStep(); 
+  Arrays8b->CheckStep(); 
+  Arrays12b->CheckStep();
+  Arrays16b->CheckStep();
+  Arrays24b->CheckStep();
+  Arrays32b->CheckStep();
+}
+
+//==============================================================================
+/// Devuelve maximo de arrays en uso y arrays reservados de cada tamano.
+/// Returns maximum number of arrays in use and allocated arrays of each size.
+//==============================================================================
+std::string JArraysCpu::GetUsageInfo()const{
+  const JArraysCpuSize* arrays[8]={Arrays1b,Arrays2b,Arrays4b,Arrays8b,Arrays12b,Arrays16b,Arrays24b,Arrays32b};
+  const unsigned sizes[8]={1,2,4,8,12,16,24,32};
+  std::string tx;
+  for(unsigned c=0;c<8;c++)if(arrays[c]->GetArrayCountMax()){
+    tx=tx+(tx.empty()? "": "  ")+fun::PrintStr("%uB:%u/%u",sizes[c],arrays[c]->GetArrayCountUsedMax(),arrays[c]->GetArrayCount());
+  }
+  return(tx);
+}
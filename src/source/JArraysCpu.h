@@ -22,6 +22,10 @@
 //:# - Codigo creado a partir de JArraysGpu para usar con memoria CPU. (10-03-2014)
 //:# - Remplaza long long por llong. (01-10-2015)
 //:# - Mejora la gestion de excepciones. (06-05-2020)
+//:# - Arrays alineados a 64 bytes e inicializados en paralelo (first-touch). (17-10-2026)
+//:# - Control de arrays reservados en cada paso con MarkStep() y CheckStep(). (17-10-2026)
+//:# - Nuevo metodo GetUsageInfo() con el maximo de arrays en uso. (17-10-2026)
+//:# - Orden configurable de los bloques inicializados por cada hilo. (17-10-2026)
 //:#############################################################################
 
 /// \file JArraysCpu.h \brief Declares the class \ref JArraysCpu.
@@ -31,6 +35,7 @@
 
 #include "JObject.h"
 #include "DualSphDef.h"
+#include <string>
 
 //##############################################################################
 //# JArraysCpuSize
@@ -44,14 +49,21 @@ protected:
   unsigned ArraySize;
 
   static const unsigned MAXPOINTERS=30;
+  static const unsigned ALIGNMENT=64;  ///<Alignment in bytes of the arrays (cache line). | Alineamiento en bytes de los arrays (linea de cache).
   void* Pointers[MAXPOINTERS];
   unsigned Count;
   unsigned CountUsed;
+  unsigned CountUsedMark;  ///<Number of arrays in use at the start of the step. | Numero de arrays en uso al comienzo del paso.
 
   unsigned CountMax,CountUsedMax;
+
+  const int *TouchBlock;  ///<Block of memory initialised by each thread (NULL: block th). | Bloque de memoria inicializado por cada hilo (NULL: bloque th).
+  ullong *TouchBytes;     ///<Bytes initialised by each thread (NULL: not measured). | Bytes inicializados por cada hilo (NULL: no se mide).
+  double *TouchTime;      ///<Time of initialisation of each thread [s]. | Tiempo de inicializacion de cada hilo [s].
   
   void* AllocPointer(unsigned size)const;
   void FreePointer(void* pointer)const;
+  void FirstTouch(void *pointer,size_t nbytes)const;
 
   void FreeMemory();
   unsigned FindPointerUsed(void *pointer)const;
@@ -71,10 +83,16 @@ public:
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(ArraySize); }
 
+  void SetTouchBlock(const int *thblock){ TouchBlock=thblock; }
+  void SetTouchStats(ullong *thbytes,double *thtime){ TouchBytes=thbytes; TouchTime=thtime; }
+
   llong GetAllocMemoryCpu()const{ return((llong)(Count)*ElementSize*ArraySize); };
 
   void* Reserve();
   void Free(void *pointer);
+
+  void MarkStep(){ CountUsedMark=CountUsed; }
+  void CheckStep()const;
 };
 
 
@@ -97,6 +115,10 @@ protected:
   JArraysCpuSize *Arrays16b;
   JArraysCpuSize *Arrays24b;
   JArraysCpuSize *Arrays32b;
+
+  int TouchBlock[OMP_MAXTHREADS];  ///<Block of memory initialised by each thread. | Bloque de memoria inicializado por cada hilo.
+  ullong TouchBytes[OMP_MAXTHREADS]; ///<Bytes initialised by each thread since ResetTouchStats(). | Bytes inicializados por cada hilo desde ResetTouchStats().
+  double TouchTime[OMP_MAXTHREADS];  ///<Time of initialisation of each thread since ResetTouchStats() [s]. | Tiempo de inicializacion de cada hilo desde ResetTouchStats() [s].
   
   JArraysCpuSize* GetArrays(TpArraySize tsize)const{ return(tsize==SIZE_32B? Arrays32b: (tsize==SIZE_24B? Arrays24b: (tsize==SIZE_16B? Arrays16b: (tsize==SIZE_12B? Arrays12b: (tsize==SIZE_8B? Arrays8b: (tsize==SIZE_4B? Arrays4b: (tsize==SIZE_2B? Arrays2b: Arrays1b))))))); }
 
@@ -113,6 +135,14 @@ public:
 
   void SetArraySize(unsigned size);
   unsigned GetArraySize()const{ return(Arrays1b->GetArraySize()); }
+  void SetTouchOrder(int nth,const int *thblock);
+  void ResetTouchStats();
+  ullong GetTouchBytes(int th)const{ return(TouchBytes[th]); }
+  double GetTouchTime(int th)const{ return(TouchTime[th]); }
+
+  void MarkStep();
+  void CheckStep()const;
+  std::string GetUsageInfo()const;
 
   byte*        ReserveByte(){       return((byte*)Arrays1b->Reserve());         }
   word*        ReserveWord(){       return((word*)Arrays2b->Reserve());         }
@@ -19,6 +19,7 @@
 /// \file JBinaryData.cpp \brief Implements the class \ref JBinaryData.
 
 #include "JBinaryData.h"
+#include "JBinaryDataComp.h"
 #include "Functions.h"
 
 #include <fstream>
@@ -28,6 +29,12 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#ifndef WIN32
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
 
 using namespace std;
 
@@ -138,6 +145,10 @@ JBinaryDataArray::JBinaryDataArray(JBinaryData* parent,const std::string &name,J
   ExternalPointer=false;
   Count=Size=0;
   ClearFileData();
+  CompMode=0;
+  CompQuantMin=TDouble3(0);
+  CompQuantStep=0;
+  CompReady=false;
 }
 
 //==============================================================================
@@ -153,7 +164,7 @@ JBinaryDataArray::~JBinaryDataArray(){
 /// Returns the amount of memory reserved.
 //==============================================================================
 llong JBinaryDataArray::GetAllocMemory()const{
-  return(Pointer&&!ExternalPointer? Size*JBinaryDataDef::SizeOfType(Type): 0);
+  return((Pointer&&!ExternalPointer? Size*JBinaryDataDef::SizeOfType(Type): 0)+CompData.capacity());
 }
 
 //==============================================================================
@@ -282,6 +293,7 @@ std::string JBinaryDataArray::OutStr(unsigned &count,unsigned size,const byte *p
 /// Frees allocated memory.
 //==============================================================================
 void JBinaryDataArray::FreeMemory(){
+  CompDataClear();
   if(Pointer&&!ExternalPointer)FreePointer(Pointer);
   Pointer=NULL;
   ExternalPointer=false;
@@ -332,9 +344,9 @@ void JBinaryDataArray::ConfigExternalMemory(unsigned size,void* pointer){
 /// Configura acceso a datos en fichero.
 /// Set file data access.
 //==============================================================================
-void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize){
+void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,bool datacomp){
   FreeMemory();
-  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize;
+  FileDataPos=filepos; FileDataCount=datacount; FileDataSize=datasize; FileDataComp=datacomp;
 }
 
 //==============================================================================
@@ -342,7 +354,7 @@ void JBinaryDataArray::ConfigFileData(llong filepos,unsigned datacount,unsigned
 /// Delete data file data access.
 //==============================================================================
 void JBinaryDataArray::ClearFileData(){
-  FileDataPos=-1; FileDataCount=FileDataSize=0;
+  FileDataPos=-1; FileDataCount=FileDataSize=0; FileDataComp=false;
 }
 
 //==============================================================================
@@ -358,7 +370,7 @@ void JBinaryDataArray::ReadFileData(bool resize){
   //printf("ReadFileData[%s]> fpos:%llu count:%u size:%u\n",Name.c_str(),FileDataPos,FileDataCount,FileDataSize);
   if(FileDataPos<0)Run_Exceptioon("The access information to data file is not available.");
   pf->seekg(FileDataPos,ios::beg);
-  ReadData(FileDataCount,FileDataSize,pf,resize);
+  ReadData(FileDataCount,FileDataSize,pf,resize,FileDataComp);
 }
 
 //==============================================================================
@@ -367,8 +379,15 @@ void JBinaryDataArray::ReadFileData(bool resize){
 /// Add elements to the array of a file. 
 /// If ExternalPointer will not allow to resize the allocated memory.
 //==============================================================================
-void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize){
-  if(count){
+void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,bool comp){
+  if(count && comp){//-Compressed data.
+    byte *buf=new byte[size];
+    pf->read((char*)buf,size);
+    AddDataComp(count,size,buf,resize);
+    delete[] buf;
+  }
+  else if(count){
+    CompDataClear();
     //-Reserva memoria si fuese necesario.
     CheckMemory(count,resize);
     //-Carga datos de fichero.
@@ -397,6 +416,7 @@ void JBinaryDataArray::ReadData(unsigned count,unsigned size,std::ifstream *pf,b
 //==============================================================================
 void JBinaryDataArray::AddData(unsigned count,const void* data,bool resize){
   if(count){
+    CompDataClear();
     //-Reserva memoria si fuese necesario.
     //-Allocates memory if necessary.
     CheckMemory(count,resize);
@@ -417,6 +437,27 @@ void JBinaryDataArray::AddData(unsigned count,const void* data,bool resize){
   }
 }
 
+//==============================================================================
+/// Anhade elementos al array a partir de size bytes de datos comprimidos.
+/// Si es ExternalPointer no permite redimensionar la memoria asignada.
+/// Add elements to the array from size bytes of compressed data.
+/// If ExternalPointer will not allow to resize the allocated memory.
+//==============================================================================
+void JBinaryDataArray::AddDataComp(unsigned count,unsigned size,const byte* data,bool resize){
+  if(count){
+    CompDataClear();
+    //-Reserva memoria si fuese necesario.
+    //-Allocates memory if necessary.
+    CheckMemory(count,resize);
+    //-Descomprime datos en el puntero.
+    //-Decompresses data in the pointer.
+    const size_t stype=JBinaryDataDef::SizeOfType(Type);
+    JBinaryDataComp comp;
+    comp.Decode(Type,count,size,data,((byte*)Pointer)+stype*Count);
+    Count+=count;
+  }
+}
+
 //==============================================================================
 /// Guarda datos como contenido del array.
 /// Save data as contents of the array.
@@ -442,6 +483,7 @@ void JBinaryDataArray::AddText(const std::string &str,bool resize){
   if(Type!=JBinaryDataDef::DatText)Run_Exceptioon("Type of array is not Text.");
   unsigned count=1;
   if(count){
+    CompDataClear();
     //-Reserva memoria si fuese necesario.
     //-Allocates memory if necessary.
     CheckMemory(count,resize);
@@ -488,6 +530,10 @@ unsigned JBinaryDataArray::GetDataCopy(unsigned size,void* pointer)const{
     count=GetCount();
     if(size>=count)memcpy(pointer,Pointer,stype*count);
   }
+  else if(GetFileDataMapped()){
+    count=FileDataCount;
+    if(size>=count)memcpy(pointer,GetFileDataMapped(),stype*count);
+  }
   else{
     count=FileDataCount;
     if(size>=count){
@@ -495,13 +541,74 @@ unsigned JBinaryDataArray::GetDataCopy(unsigned size,void* pointer)const{
       if(!pf||!pf->is_open())Run_Exceptioon("The file with data is not available.");
       pf->seekg(FileDataPos,ios::beg);
       count=FileDataCount;
-      pf->read((char*)pointer,stype*count);
+      if(FileDataComp){//-Compressed data.
+        byte *buf=new byte[FileDataSize];
+        pf->read((char*)buf,FileDataSize);
+        JBinaryDataComp comp;
+        comp.Decode(Type,count,FileDataSize,buf,pointer);
+        delete[] buf;
+      }
+      else pf->read((char*)pointer,stype*count);
     }
   }
   if(size<count)Run_Exceptioon("Size of array is not enough to store all data.");
   return(count);
 }
 
+//==============================================================================
+/// Devuelve puntero a los datos del array en el fichero proyectado en memoria
+/// o NULL cuando no estan disponibles (fichero no proyectado, datos ya cargados,
+/// comprimidos o de tipo text). Los datos no estan alineados en general por lo
+/// que deben leerse con memcpy().
+/// Returns pointer to array data in the file mapped in memory or NULL when it
+/// is not available (file not mapped, data already loaded, compressed or text).
+/// In general the data is not aligned so it must be read using memcpy().
+//==============================================================================
+const void* JBinaryDataArray::GetFileDataMapped()const{
+  const void *ptr=NULL;
+  if(!DataInPointer() && DataInFile() && !FileDataComp && Type!=JBinaryDataDef::DatText){
+    llong fsize=0;
+    const byte *fptr=Parent->GetItemRoot()->GetFileMapped(fsize);
+    const llong sdata=llong(JBinaryDataDef::SizeOfType(Type))*FileDataCount;
+    if(fptr && FileDataPos+sdata<=fsize)ptr=fptr+FileDataPos;
+  }
+  return(ptr);
+}
+
+//==============================================================================
+/// Configura compresion de los datos del array al grabar. Los tipos que no
+/// admiten compresion (text y bool) se graban sin comprimir.
+/// Configures compression of array data for writing. Types that do not support
+/// compression (text and bool) are written without compression.
+//==============================================================================
+void JBinaryDataArray::SetCompression(byte mode,tdouble3 quantmin,double quantstep){
+  CompDataClear();
+  CompMode=(JBinaryDataComp::TypeAllowed(Type)? mode: 0);
+  CompQuantMin=quantmin;
+  CompQuantStep=quantstep;
+}
+
+//==============================================================================
+/// Comprime datos del array cuando hay compresion configurada.
+/// Compresses array data when compression is configured.
+//==============================================================================
+void JBinaryDataArray::CompDataPrepare(){
+  if(CompMode && !CompReady){
+    JBinaryDataComp comp;
+    comp.Encode(Type,Count,Pointer,CompMode,CompQuantMin,CompQuantStep,CompData);
+    CompReady=true;
+  }
+}
+
+//==============================================================================
+/// Libera datos comprimidos.
+/// Frees compressed data.
+//==============================================================================
+void JBinaryDataArray::CompDataClear(){
+  CompReady=false;
+  std::vector<byte>().swap(CompData);
+}
+
 
 //##############################################################################
 //# JBinaryData
@@ -513,6 +620,7 @@ JBinaryData::JBinaryData(std::string name):Name(name){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMapPtr=NULL; FileMapSize=0;
   ValuesData=NULL;
   ValuesCacheReset();
   HideAll=HideValues=false;
@@ -528,6 +636,7 @@ JBinaryData::JBinaryData(const JBinaryData &src){
   ClassName="JBinaryData";
   Parent=NULL;
   FileStructure=NULL;
+  FileMapPtr=NULL; FileMapSize=0;
   ValuesData=NULL;
   ValuesCacheReset();
   *this=src;
@@ -791,7 +900,7 @@ void JBinaryData::InArrayBase(unsigned &count,unsigned size,byte *ptr,const JBin
   InStr(count,size,ptr,CodeArrayDef);
   InStr(count,size,ptr,ar->GetName());
   InBool(count,size,ptr,ar->GetHide());
-  InInt(count,size,ptr,int(ar->GetType()));
+  InInt(count,size,ptr,int(ar->GetType())|(ar->GetCompReady()? TypeCompressed: 0));
   InUint(count,size,ptr,ar->GetCount());
   //-Calcula e introduce size de los datos del array.
   unsigned sizearraydata=0;
@@ -807,7 +916,10 @@ void JBinaryData::InArrayData(unsigned &count,unsigned size,byte *ptr,const JBin
   const unsigned num=ar->GetCount();
   const void* pointer=ar->GetPointer();
   if(num&&!pointer)Run_Exceptioon("Pointer of array with data is invalid.");
-  if(type==JBinaryDataDef::DatText){//-Array de strings.
+  if(ar->GetCompReady()){//-Datos comprimidos. Compressed data.
+    InData(count,size,ptr,ar->GetCompData(),ar->GetCompSize());
+  }
+  else if(type==JBinaryDataDef::DatText){//-Array de strings.
     const string *list=(string*)pointer;
     for(unsigned c=0;c<num;c++)InStr(count,size,ptr,list[c]);
   }
@@ -875,14 +987,16 @@ void JBinaryData::InItem(unsigned &count,unsigned size,byte *ptr,bool all)const{
 /// Extrae datos basicos del Array de ptr.
 /// Extract basic data from ptr Array 
 //==============================================================================
-JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata){
+JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,bool &comp){
   if(OutStr(count,size,ptr)!=CodeArrayDef)Run_Exceptioon("Validation code is invalid.");
   string name=OutStr(count,size,ptr);
   bool hide=OutBool(count,size,ptr);
-  JBinaryDataDef::TpData type=(JBinaryDataDef::TpData)OutInt(count,size,ptr);
+  const int typecomp=OutInt(count,size,ptr);
+  JBinaryDataDef::TpData type=(JBinaryDataDef::TpData)(typecomp&(~TypeCompressed));
+  comp=((typecomp&TypeCompressed)!=0);
   countdata=OutUint(count,size,ptr);
   sizedata=OutUint(count,size,ptr);
-  if(type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)Run_Exceptioon("Size of data is invalid.");
+  if(!comp&&type!=JBinaryDataDef::DatText&&sizedata!=JBinaryDataDef::SizeOfType(type)*countdata)Run_Exceptioon("Size of data is invalid.");
   //-Crea array.
   JBinaryDataArray *ar=CreateArray(name,type);
   ar->SetHide(hide);
@@ -893,8 +1007,14 @@ JBinaryDataArray* JBinaryData::OutArrayBase(unsigned &count,unsigned size,const
 /// Extrae contenido de Array de ptr.
 /// Extract the contents of the ptr Array
 //==============================================================================
-void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata){
-  if(ar->GetType()==JBinaryDataDef::DatText){//-Array de strings.
+void JBinaryData::OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp){
+  if(comp){//-Datos comprimidos. Compressed data.
+    unsigned count2=count+sizedata;
+    if(count2>size)Run_Exceptioon("Overflow in reading data.");
+    ar->AddDataComp(countdata,sizedata,ptr+count,true);
+    count=count2;
+  }
+  else if(ar->GetType()==JBinaryDataDef::DatText){//-Array de strings.
     ar->AllocMemory(countdata);
     for(unsigned c=0;c<countdata;c++)ar->AddText(OutStr(count,size,ptr),false);
   }
@@ -919,10 +1039,11 @@ void JBinaryData::OutArray(unsigned &count,unsigned size,const byte *ptr){
   //-Creates and configures array from ptr 
   const unsigned sizearraydef=OutUint(count,size,ptr);
   unsigned countdata,sizedata;
-  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata);
+  bool comp;
+  JBinaryDataArray *ar=OutArrayBase(count,size,ptr,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  OutArrayData(count,size,ptr,ar,countdata,sizedata);
+  OutArrayData(count,size,ptr,ar,countdata,sizedata,comp);
 }
 
 //==============================================================================
@@ -990,6 +1111,26 @@ void JBinaryData::SaveValues(unsigned &count,unsigned size,byte *ptr)const{
   for(unsigned c=0;c<num;c++)InValue(count,size,ptr,Values[c]);
 }
 
+//==============================================================================
+/// Comprime los datos de los arrays con compresion configurada en el item y
+/// descendientes. Con all activado se incluyen tambien los elementos ocultos.
+/// Compresses data of arrays with configured compression in the item and
+/// descendants. With bool "all" true the hidden elements are also included.
+//==============================================================================
+void JBinaryData::CompCachePrepare(bool all){
+  for(unsigned c=0;c<Arrays.size();c++)if(all||!Arrays[c]->GetHide())Arrays[c]->CompDataPrepare();
+  for(unsigned c=0;c<Items.size();c++)if(all||!Items[c]->GetHide())Items[c]->CompCachePrepare(all);
+}
+
+//==============================================================================
+/// Libera los datos comprimidos del item y descendientes.
+/// Frees compressed data of the item and descendants.
+//==============================================================================
+void JBinaryData::CompCacheClear(){
+  for(unsigned c=0;c<Arrays.size();c++)Arrays[c]->CompDataClear();
+  for(unsigned c=0;c<Items.size();c++)Items[c]->CompCacheClear();
+}
+
 
 
 //==============================================================================
@@ -1001,7 +1142,10 @@ void JBinaryData::WriteArrayData(std::fstream *pf,const JBinaryDataArray *ar)con
   const unsigned countdata=ar->GetCount();
   const void* pointer=ar->GetPointer();
   if(countdata&&!pointer)Run_Exceptioon("Pointer of array with data is invalid.");
-  if(type==JBinaryDataDef::DatText){//-Array de strings. Stings Array
+  if(ar->GetCompReady()){//-Datos comprimidos. Compressed data.
+    pf->write((const char*)ar->GetCompData(),ar->GetCompSize());
+  }
+  else if(type==JBinaryDataDef::DatText){//-Array de strings. Stings Array
     const string *list=(string*)pointer;
     unsigned sbuf=0;
     for(unsigned c=0;c<countdata;c++)InStr(sbuf,0,NULL,list[c]);//-Calcula size de buffer. Calculate buffer size.
@@ -1077,11 +1221,11 @@ unsigned JBinaryData::ReadUint(std::ifstream *pf)const{
 /// Carga datos de array de fichero.
 /// Loads data to array from the file.
 //==============================================================================
-void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata){
+void JBinaryData::ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool loadarraysdata){
   const JBinaryDataDef::TpData type=ar->GetType();
-  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true);
+  if(loadarraysdata)ar->ReadData(countdata,sizedata,pf,true,comp);
   else{
-    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata);  
+    ar->ConfigFileData((llong)pf->tellg(),countdata,sizedata,comp);  
     pf->seekg(sizedata,ios::cur);
   }
 }
@@ -1096,11 +1240,12 @@ void JBinaryData::ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loada
   const unsigned sizearraydef=ReadUint(pf);
   pf->read((char*)buf,sizearraydef);
   unsigned countdata,sizedata;
+  bool comp;
   unsigned cbuf=0;
-  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata);
+  JBinaryDataArray *ar=OutArrayBase(cbuf,sizearraydef,buf,countdata,sizedata,comp);
   //-Extrae contenido del array.
   //-Extract contents of the array.
-  ReadArrayData(pf,ar,countdata,sizedata,loadarraysdata);
+  ReadArrayData(pf,ar,countdata,sizedata,comp,loadarraysdata);
 }
 
 //==============================================================================
@@ -1403,6 +1548,7 @@ unsigned JBinaryData::SaveDataConst(unsigned size,byte* ptr,bool all)const{
 //==============================================================================
 unsigned JBinaryData::GetSizeData(bool all){
   ValuesCachePrepare(true);
+  CompCachePrepare(all);
   unsigned count=0;
   InItem(count,0,NULL,all);
   return(count);
@@ -1420,8 +1566,10 @@ unsigned JBinaryData::GetSizeData(bool all){
 unsigned JBinaryData::SaveData(unsigned size,byte* ptr,bool all){
   if(!ptr)Run_Exceptioon("The pointer is invalid.");
   ValuesCachePrepare(true);
+  CompCachePrepare(all);
   unsigned count=0;
   InItem(count,size,ptr,all);
+  CompCacheClear();
   return(count);
 }
 
@@ -1481,6 +1629,7 @@ void JBinaryData::SaveFileData(std::fstream *pf,bool head,const std::string &fil
 //==============================================================================
 void JBinaryData::SaveFile(const std::string &file,bool memory,bool all){
   ValuesCachePrepare(true);
+  CompCachePrepare(all);
   fstream pf;
   pf.open(file.c_str(),ios::binary|ios::out);
   if(pf){
@@ -1489,6 +1638,7 @@ void JBinaryData::SaveFile(const std::string &file,bool memory,bool all){
     pf.close();
   }
   else Run_ExceptioonFile("Cannot open the file.",file);
+  CompCacheClear();
 }
 
 //==============================================================================
@@ -1537,6 +1687,7 @@ void JBinaryData::LoadFile(const std::string &file,const std::string &filecode,b
 //==============================================================================
 void JBinaryData::SaveFileListApp(const std::string &file,const std::string &filecode,bool memory,bool all){
   ValuesCachePrepare(true);
+  CompCachePrepare(all);
   fstream pf;
   if(fun::FileExists(file))pf.open(file.c_str(),ios::binary|ios::out|ios::in|ios::app);
   else pf.open(file.c_str(),ios::binary|ios::out);
@@ -1551,6 +1702,7 @@ void JBinaryData::SaveFileListApp(const std::string &file,const std::string &fil
     pf.close();
   }
   else Run_ExceptioonFile("Cannot open the file.",file);
+  CompCacheClear();
 }
 
 //==============================================================================
@@ -1607,8 +1759,11 @@ void JBinaryData::LoadFileListApp(const std::string &file,const std::string &fil
 /// arrays.
 /// Open file and load data structure but without loading the contents of the
 /// arrays.
+/// With mapped the file is also mapped in memory (read only) so the data of 
+/// arrays can be accessed in place and pages are loaded on demand. When the
+/// mapping is not available the file is accessed as usual.
 //==============================================================================
-void JBinaryData::OpenFileStructure(const std::string &file,const std::string &filecode){
+void JBinaryData::OpenFileStructure(const std::string &file,const std::string &filecode,bool mapped){
   if(Parent)Run_Exceptioon("Item is not root.");
   Clear(); //-Limpia contenido de objeto. Clean object content.
   FileStructure=new ifstream;
@@ -1618,6 +1773,22 @@ void JBinaryData::OpenFileStructure(const std::string &file,const std::string &f
     const unsigned sbuf=1024;
     byte buf[sbuf];
     ReadItem(FileStructure,sbuf,buf,false,false);
+  #ifndef WIN32
+    //-Proyecta fichero en memoria. Maps file in memory.
+    if(mapped){
+      const int fd=open(file.c_str(),O_RDONLY);
+      struct stat st;
+      if(fd>=0 && !fstat(fd,&st) && st.st_size>0){
+        void *ptr=mmap(NULL,size_t(st.st_size),PROT_READ,MAP_PRIVATE,fd,0);
+        if(ptr!=MAP_FAILED){
+          madvise(ptr,size_t(st.st_size),MADV_SEQUENTIAL);
+          FileMapPtr=(byte*)ptr;
+          FileMapSize=llong(st.st_size);
+        }
+      }
+      if(fd>=0)close(fd);
+    }
+  #endif
   }
   else{
     CloseFileStructure();
@@ -1630,10 +1801,22 @@ void JBinaryData::OpenFileStructure(const std::string &file,const std::string &f
 /// Close open file using OpenFileStructure ().
 //==============================================================================
 void JBinaryData::CloseFileStructure(){
+  FileMapFree();
   if(FileStructure&&FileStructure->is_open())FileStructure->close();
   delete FileStructure; FileStructure=NULL;
 }
 
+//==============================================================================
+/// Libera proyeccion en memoria del fichero abierto con OpenFileStructure().
+/// Frees mapping in memory of file opened with OpenFileStructure().
+//==============================================================================
+void JBinaryData::FileMapFree(){
+#ifndef WIN32
+  if(FileMapPtr)munmap(FileMapPtr,size_t(FileMapSize));
+#endif
+  FileMapPtr=NULL; FileMapSize=0;
+}
+
 //==============================================================================
 /// Devuelve puntero al fichero abierto con OpenFileStructure().
 /// Returns pointer to open file with OpenFileStructure ().
@@ -1643,6 +1826,18 @@ std::ifstream* JBinaryData::GetFileStructure()const{
   return(FileStructure);
 }
 
+//==============================================================================
+/// Devuelve puntero al fichero proyectado en memoria por OpenFileStructure() o
+/// NULL cuando no esta proyectado.
+/// Returns pointer to file mapped in memory by OpenFileStructure() or NULL when
+/// it is not mapped.
+//==============================================================================
+const byte* JBinaryData::GetFileMapped(llong &size)const{
+  if(Parent)Run_Exceptioon("Item is not root.");
+  size=FileMapSize;
+  return(FileMapPtr);
+}
+
 //==============================================================================
 /// Graba contenido en fichero XML.
 /// Record XML file content.
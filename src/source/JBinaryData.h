@@ -43,6 +43,9 @@
 //:# - Opcion en SaveFileXml() para grabar datos de arrays. (04-12-2014)
 //:# - Nuevos metodos CheckCopyArrayData() y CopyArrayData(). (13-04-2020)
 //:# - Mejora la gestion de excepciones. (06-05-2020)
+//:# - Codificacion comprimida opcional de arrays con JBinaryDataComp. (17-10-2026)
+//:# - OpenFileStructure() permite proyectar el fichero en memoria (mmap) para
+//:#   acceder a los datos de arrays sin copias. (17-10-2026)
 //:#############################################################################
 
 /// \file JBinaryData.h \brief Declares the class \ref JBinaryData.
@@ -100,6 +103,14 @@ class JBinaryDataArray : protected JObject
   llong FileDataPos;      ///<Valor mayor o igual a cero indica la posicion de lectura en el fichero abierto en el ItemHead. Value greater than or equal to zero indicates the position of reading in the file opened in the ItemHead.
   unsigned FileDataCount; ///<Numero de elemetos del array en fichero. Number of elements in the array in a file.
   unsigned FileDataSize;  ///<Size de datos del array en fichero. Size of array data in file.
+  bool FileDataComp;      ///<Los datos del array en fichero estan comprimidos. Array data in file is compressed.
+
+  //-Variables para compresion de datos. Variables for data compression.
+  byte CompMode;              ///<Modo de compresion para grabar (0:sin compresion). Compression mode to write (combination of JBinaryDataComp::TpCompress, 0:none).
+  tdouble3 CompQuantMin;      ///<Origen de la rejilla de cuantizacion. Origin of quantisation grid.
+  double CompQuantStep;       ///<Paso de la rejilla de cuantizacion. Step of quantisation grid.
+  std::vector<byte> CompData; ///<Datos comprimidos listos para grabar. Compressed data ready to be written.
+  bool CompReady;             ///<CompData contiene los datos actuales. CompData contains the current data.
 
   void FreePointer(void* ptr)const;
   void* AllocPointer(unsigned size)const;
@@ -133,8 +144,9 @@ class JBinaryDataArray : protected JObject
   void AllocMemory(unsigned size,bool savedata=false);
   void ConfigExternalMemory(unsigned size,void* pointer);
 
-  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize);
+  void ReadData(unsigned count,unsigned size,std::ifstream *pf,bool resize,bool comp=false);
   void AddData(unsigned count,const void* data,bool resize);
+  void AddDataComp(unsigned count,unsigned size,const byte* data,bool resize);
   void SetData(unsigned count,const void* data,bool externalpointer);
 
   const void* GetDataPointer()const;
@@ -143,11 +155,21 @@ class JBinaryDataArray : protected JObject
   void AddText(const std::string &str,bool resize);
   void AddTexts(unsigned count,const std::string *strs,bool resize);
 
-  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize);
+  void ConfigFileData(llong filepos,unsigned datacount,unsigned datasize,bool datacomp=false);
   void ClearFileData();
   unsigned GetFileDataCount()const{ return(FileDataCount); }
   unsigned GetFileDataSize()const{ return(FileDataSize); }
   void ReadFileData(bool resize);
+
+  void SetCompression(byte mode,tdouble3 quantmin=TDouble3(0),double quantstep=0);
+  byte GetCompression()const{ return(CompMode); }
+  void CompDataPrepare();
+  void CompDataClear();
+  bool GetCompReady()const{ return(CompReady); }
+  unsigned GetCompSize()const{ return(unsigned(CompData.size())); }
+  const byte* GetCompData()const{ return(CompReady && !CompData.empty()? &CompData[0]: NULL); }
+
+  const void* GetFileDataMapped()const;
 };
 
 //##############################################################################
@@ -171,6 +193,7 @@ class JBinaryData : protected JObject
   static const std::string CodeItemDef;
   static const std::string CodeValuesDef;
   static const std::string CodeArrayDef;
+  static const int TypeCompressed=0x100;  ///<Marca en el tipo de arrays con datos comprimidos. Flag in type of arrays with compressed data.
 
  public:
 
@@ -210,6 +233,10 @@ class JBinaryData : protected JObject
   std::vector<StValue> Values;
 
   std::ifstream *FileStructure;
+  byte *FileMapPtr;      ///<Fichero proyectado en memoria por OpenFileStructure(). File mapped in memory by OpenFileStructure().
+  llong FileMapSize;     ///<Tamanho del fichero proyectado. Size of mapped file.
+
+  void FileMapFree();
 
   //-Variables para cache de values. Variables to cache values.
   bool ValuesModif;
@@ -268,8 +295,8 @@ class JBinaryData : protected JObject
   void InItemBase(unsigned &count,unsigned size,byte *ptr,bool all)const;
   void InItem(unsigned &count,unsigned size,byte *ptr,bool all)const;
 
-  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata);
-  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata);
+  JBinaryDataArray* OutArrayBase(unsigned &count,unsigned size,const byte *ptr,unsigned &countdata,unsigned &sizedata,bool &comp);
+  void OutArrayData(unsigned &count,unsigned size,const byte *ptr,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp);
   void OutArray(unsigned &count,unsigned size,const byte *ptr);
   JBinaryData* OutItemBase(unsigned &count,unsigned size,const byte *ptr,bool create,unsigned &narrays,unsigned &nitems,unsigned &sizevalues);
   void OutItem(unsigned &count,unsigned size,const byte *ptr,bool create);
@@ -277,13 +304,15 @@ class JBinaryData : protected JObject
   unsigned GetSizeValues()const;
   void SaveValues(unsigned &count,unsigned size,byte *ptr)const;
   void ValuesCachePrepare(bool down);
+  void CompCachePrepare(bool all);
+  void CompCacheClear();
 
   void WriteArrayData(std::fstream *pf,const JBinaryDataArray *ar)const;
   void WriteArray(std::fstream *pf,unsigned sbuf,byte *buf,const JBinaryDataArray *ar)const;
   void WriteItem(std::fstream *pf,unsigned sbuf,byte *buf,bool all)const;
 
   unsigned ReadUint(std::ifstream *pf)const;
-  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool loadarraysdata);
+  void ReadArrayData(std::ifstream *pf,JBinaryDataArray *ar,unsigned countdata,unsigned sizedata,bool comp,bool loadarraysdata);
   void ReadArray(std::ifstream *pf,unsigned sbuf,byte *buf,bool loadarraysdata);
   void ReadItem(std::ifstream *pf,unsigned sbuf,byte *buf,bool create,bool loadarraysdata);
 
@@ -334,9 +363,10 @@ class JBinaryData : protected JObject
   void SaveFileListApp(const std::string &file,const std::string &filecode,bool memory=false,bool all=true);
   void LoadFileListApp(const std::string &file,const std::string &filecode,bool memory=false);
   
-  void OpenFileStructure(const std::string &file,const std::string &filecode="");
+  void OpenFileStructure(const std::string &file,const std::string &filecode="",bool mapped=false);
   void CloseFileStructure();
   std::ifstream* GetFileStructure()const;
+  const byte* GetFileMapped(llong &size)const;
 
   void SaveFileXml(std::string file,bool svarrays=false,const std::string &head=" fmt=\"JBinaryData\"")const;
 
@@ -447,7 +477,7 @@ uint size_array_def [n]
 - "ARRAY"
 - str name
 - bool hide
-- int type
+- int type  (type|0x100 con datos comprimidos, ver JBinaryDataComp)
 - uint count
 - uint size_contenido
   - [contenido de array]
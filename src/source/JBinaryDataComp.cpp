@@ -0,0 +1,445 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+/// \file JBinaryDataComp.cpp \brief Implements the class \ref JBinaryDataComp.
+
+#include "JBinaryDataComp.h"
+#include "Functions.h"
+#include "OmpDefs.h"
+
+#include <cmath>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+using namespace std;
+
+//##############################################################################
+//# JBinaryDataComp
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JBinaryDataComp::JBinaryDataComp(){
+  ClassName="JBinaryDataComp";
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JBinaryDataComp::~JBinaryDataComp(){
+  DestructorActive=true;
+}
+
+//==============================================================================
+/// Returns components of data type and false when the type is not supported.
+/// Devuelve componentes del tipo de dato y false si el tipo no es soportado.
+//==============================================================================
+bool JBinaryDataComp::TypeInfo(JBinaryDataDef::TpData type,unsigned &ncomp,unsigned &csize,bool &cfloat){
+  ncomp=1; csize=0; cfloat=false;
+  switch(type){
+    case JBinaryDataDef::DatChar:     
+    case JBinaryDataDef::DatUchar:    csize=1;              break;
+    case JBinaryDataDef::DatShort:    
+    case JBinaryDataDef::DatUshort:   csize=2;              break;
+    case JBinaryDataDef::DatInt:      
+    case JBinaryDataDef::DatUint:     csize=4;              break;
+    case JBinaryDataDef::DatLlong:    
+    case JBinaryDataDef::DatUllong:   csize=8;              break;
+    case JBinaryDataDef::DatFloat:    csize=4; cfloat=true; break;
+    case JBinaryDataDef::DatDouble:   csize=8; cfloat=true; break;
+    case JBinaryDataDef::DatInt3:     
+    case JBinaryDataDef::DatUint3:    ncomp=3; csize=4;              break;
+    case JBinaryDataDef::DatFloat3:   ncomp=3; csize=4; cfloat=true; break;
+    case JBinaryDataDef::DatDouble3:  ncomp=3; csize=8; cfloat=true; break;
+    default:                          ncomp=0; csize=0;              break; //-Type not supported.
+  }
+  return(csize!=0);
+}
+
+//==============================================================================
+/// Returns true when the data type can be compressed.
+/// Devuelve true cuando el tipo de dato puede comprimirse.
+//==============================================================================
+bool JBinaryDataComp::TypeAllowed(JBinaryDataDef::TpData type){
+  unsigned ncomp,csize;
+  bool cfloat;
+  return(TypeInfo(type,ncomp,csize,cfloat));
+}
+
+//==============================================================================
+/// Delta encoding of each component (in reverse order to work in place).
+/// Codificacion delta de cada componente.
+//==============================================================================
+template<typename T> void JBinaryDataComp::DeltaEncode(unsigned n,unsigned ncomp,T *w){
+  const unsigned nw=n*ncomp;
+  for(unsigned c=nw;c>ncomp;c--)w[c-1]=T(w[c-1]-w[c-1-ncomp]);
+}
+//==============================================================================
+/// Delta decoding of each component.
+/// Decodificacion delta de cada componente.
+//==============================================================================
+template<typename T> void JBinaryDataComp::DeltaDecode(unsigned n,unsigned ncomp,T *w){
+  const unsigned nw=n*ncomp;
+  for(unsigned c=ncomp;c<nw;c++)w[c]=T(w[c]+w[c-ncomp]);
+}
+//==============================================================================
+/// Delta encoding according to size of words.
+/// Codificacion delta segun tamanho de palabras.
+//==============================================================================
+void JBinaryDataComp::DeltaEncode(unsigned n,unsigned ncomp,unsigned wsize,byte *w){
+  switch(wsize){
+    case 1:  DeltaEncode<byte>    (n,ncomp,w);            break;
+    case 2:  DeltaEncode<word>    (n,ncomp,(word*)w);     break;
+    case 4:  DeltaEncode<unsigned>(n,ncomp,(unsigned*)w); break;
+    case 8:  DeltaEncode<ullong>  (n,ncomp,(ullong*)w);   break;
+    default: fun::Run_ExceptioonFun(fun::PrintStr("Size of word %u is invalid for delta encoding.",wsize));
+  }
+}
+//==============================================================================
+/// Delta decoding according to size of words.
+/// Decodificacion delta segun tamanho de palabras.
+//==============================================================================
+void JBinaryDataComp::DeltaDecode(unsigned n,unsigned ncomp,unsigned wsize,byte *w){
+  switch(wsize){
+    case 1:  DeltaDecode<byte>    (n,ncomp,w);            break;
+    case 2:  DeltaDecode<word>    (n,ncomp,(word*)w);     break;
+    case 4:  DeltaDecode<unsigned>(n,ncomp,(unsigned*)w); break;
+    case 8:  DeltaDecode<ullong>  (n,ncomp,(ullong*)w);   break;
+    default: fun::Run_ExceptioonFun(fun::PrintStr("Size of word %u is invalid for delta decoding.",wsize));
+  }
+}
+
+//==============================================================================
+/// Groups the bytes of nw words in wsize planes (byte 0 of all words, byte 1...).
+/// Agrupa los bytes de nw palabras en wsize planos.
+//==============================================================================
+void JBinaryDataComp::Shuffle(unsigned nw,unsigned wsize,const byte *src,byte *dst){
+  for(unsigned b=0;b<wsize;b++){
+    byte *d=dst+size_t(nw)*b;
+    const byte *s=src+b;
+    for(unsigned c=0;c<nw;c++)d[c]=s[size_t(c)*wsize];
+  }
+}
+
+//==============================================================================
+/// Restores the words grouped by Shuffle().
+/// Restaura las palabras agrupadas por Shuffle().
+//==============================================================================
+void JBinaryDataComp::Unshuffle(unsigned nw,unsigned wsize,const byte *src,byte *dst){
+  for(unsigned b=0;b<wsize;b++){
+    const byte *s=src+size_t(nw)*b;
+    byte *d=dst+b;
+    for(unsigned c=0;c<nw;c++)d[size_t(c)*wsize]=s[c];
+  }
+}
+
+//==============================================================================
+/// Reads 4 bytes without alignment.
+//==============================================================================
+inline unsigned LzRead32(const byte *p){ unsigned v; memcpy(&v,p,4); return(v); }
+
+//==============================================================================
+/// Writes length of literals or match (values>=15 use extra bytes).
+//==============================================================================
+inline void LzWriteLength(unsigned len,byte *dst,unsigned &op){
+  len-=15;
+  while(len>=255){ dst[op++]=255; len-=255; }
+  dst[op++]=byte(len);
+}
+
+//==============================================================================
+/// Compresses n bytes of src in dst (LZ4 style sequences with 64 KB window).
+/// Returns compressed size or 0 when dstsize is not enough.
+///
+/// Comprime n bytes de src en dst. Devuelve el tamanho comprimido o 0 cuando
+/// dstsize no es suficiente.
+//==============================================================================
+unsigned JBinaryDataComp::LzCompress(unsigned n,const byte *src,unsigned dstsize,byte *dst)const{
+  const unsigned hbits=14;
+  std::vector<unsigned> htab(1<<hbits,UINT_MAX);
+  const unsigned mflimit=(n>12? n-12: 0);    //-Last position to start a match.
+  const unsigned matchlimit=(n>5? n-5: 0);   //-Last 5 bytes are always literals.
+  unsigned ip=0,anchor=0,op=0;
+  while(ip<mflimit){
+    const unsigned seq=LzRead32(src+ip);
+    const unsigned h=(seq*2654435761u)>>(32-hbits);
+    const unsigned ref=htab[h];
+    htab[h]=ip;
+    if(ref!=UINT_MAX && ip-ref<=65535 && LzRead32(src+ref)==seq){
+      unsigned ml=4;
+      while(ip+ml<matchlimit && src[ref+ml]==src[ip+ml])ml++;
+      const unsigned ll=ip-anchor;
+      if(op+ll+(ll+ml)/255+5>dstsize)return(0);
+      //-Writes sequence: token, literals, offset and match length.
+      const unsigned optoken=op++;
+      byte token=byte(min(ll,15u)<<4);
+      if(ll>=15)LzWriteLength(ll,dst,op);
+      memcpy(dst+op,src+anchor,ll); op+=ll;
+      const unsigned off=ip-ref;
+      dst[op++]=byte(off&0xFF);
+      dst[op++]=byte(off>>8);
+      const unsigned mc=ml-4;
+      token|=byte(min(mc,15u));
+      if(mc>=15)LzWriteLength(mc,dst,op);
+      dst[optoken]=token;
+      ip+=ml;
+      anchor=ip;
+    }
+    else ip+=1+((ip-anchor)>>7); //-Faster skip in data without matches.
+  }
+  //-Writes last literals.
+  const unsigned ll=n-anchor;
+  if(op+ll+ll/255+2>dstsize)return(0);
+  dst[op++]=byte(min(ll,15u)<<4);
+  if(ll>=15)LzWriteLength(ll,dst,op);
+  memcpy(dst+op,src+anchor,ll); op+=ll;
+  return(op);
+}
+
+//==============================================================================
+/// Decompresses n bytes of src in dst with dstsize bytes.
+/// Descomprime n bytes de src en dst con dstsize bytes.
+//==============================================================================
+void JBinaryDataComp::LzDecompress(unsigned n,const byte *src,unsigned dstsize,byte *dst)const{
+  const char* errtex="Compressed data is corrupted.";
+  unsigned ip=0,op=0;
+  while(true){
+    if(ip>=n)Run_Exceptioon(errtex);
+    const byte token=src[ip++];
+    //-Copies literals.
+    unsigned ll=token>>4;
+    if(ll==15){
+      byte b;
+      do{ if(ip>=n)Run_Exceptioon(errtex); b=src[ip++]; ll+=b; }while(b==255);
+    }
+    if(ip+ll>n || op+ll>dstsize)Run_Exceptioon(errtex);
+    memcpy(dst+op,src+ip,ll); ip+=ll; op+=ll;
+    if(ip==n)break; //-Last sequence.
+    //-Copies match.
+    if(ip+2>n)Run_Exceptioon(errtex);
+    const unsigned off=unsigned(src[ip])|(unsigned(src[ip+1])<<8);
+    ip+=2;
+    unsigned ml=token&15;
+    if(ml==15){
+      byte b;
+      do{ if(ip>=n)Run_Exceptioon(errtex); b=src[ip++]; ml+=b; }while(b==255);
+    }
+    ml+=4;
+    if(!off || off>op || op+ml>dstsize)Run_Exceptioon(errtex);
+    byte *d=dst+op;
+    const byte *s=d-off;
+    if(off>=ml)memcpy(d,s,ml);
+    else for(unsigned c=0;c<ml;c++)d[c]=s[c];
+    op+=ml;
+  }
+  if(op!=dstsize)Run_Exceptioon(errtex);
+}
+
+//==============================================================================
+/// Encodes ne elements of one block.
+/// Codifica ne elementos de un bloque.
+//==============================================================================
+void JBinaryDataComp::EncodeBlock(const StHead &hd,const tdouble3 &qmin
+  ,double qstep,unsigned ne,const byte *data,std::vector<byte> &out)const
+{
+  const unsigned nw=ne*hd.ncomp;
+  const unsigned rsize=nw*hd.wsize;
+  std::vector<byte> w(rsize),sh(rsize);
+  if(hd.mode&COMP_Quant){
+    const double qm[3]={qmin.x,qmin.y,qmin.z};
+    ullong *q=(ullong*)&w[0];
+    for(unsigned c=0;c<nw;c++){
+      const double v=(hd.csize==4? double(((const float*)data)[c]): ((const double*)data)[c]);
+      q[c]=ullong(llong(floor((v-qm[c%hd.ncomp])/qstep+0.5)));
+    }
+  }
+  else memcpy(&w[0],data,rsize);
+  if(hd.mode&COMP_Delta)DeltaEncode(ne,hd.ncomp,hd.wsize,&w[0]);
+  Shuffle(nw,hd.wsize,&w[0],&sh[0]);
+  out.resize(rsize);
+  unsigned size=LzCompress(rsize,&sh[0],rsize,&out[0]);
+  if(!size || size>=rsize){//-Stores block without LZ.
+    memcpy(&out[0],&sh[0],rsize);
+    size=rsize;
+  }
+  out.resize(size);
+}
+
+//==============================================================================
+/// Decodes ne elements of one block.
+/// Decodifica ne elementos de un bloque.
+//==============================================================================
+void JBinaryDataComp::DecodeBlock(const StHead &hd,const tdouble3 &qmin
+  ,double qstep,unsigned ne,const byte *data,unsigned size,byte *out)const
+{
+  const unsigned nw=ne*hd.ncomp;
+  const unsigned rsize=nw*hd.wsize;
+  std::vector<byte> sh(rsize);
+  if(size==rsize)memcpy(&sh[0],data,rsize);
+  else LzDecompress(size,data,rsize,&sh[0]);
+  if(hd.mode&COMP_Quant){
+    std::vector<byte> w(rsize);
+    Unshuffle(nw,hd.wsize,&sh[0],&w[0]);
+    if(hd.mode&COMP_Delta)DeltaDecode(ne,hd.ncomp,hd.wsize,&w[0]);
+    const double qm[3]={qmin.x,qmin.y,qmin.z};
+    const ullong *q=(const ullong*)&w[0];
+    for(unsigned c=0;c<nw;c++){
+      const double v=qm[c%hd.ncomp]+double(llong(q[c]))*qstep;
+      if(hd.csize==4)((float*)out)[c]=float(v);
+      else ((double*)out)[c]=v;
+    }
+  }
+  else{
+    Unshuffle(nw,hd.wsize,&sh[0],out);
+    if(hd.mode&COMP_Delta)DeltaDecode(ne,hd.ncomp,hd.wsize,out);
+  }
+}
+
+//==============================================================================
+/// Encodes count elements of data in out. With COMP_Quant the float values are
+/// stored as integers qmin+i*qstep (maximum error qstep/2), when some value can
+/// not be quantised the data is encoded without loss.
+///
+/// Codifica count elementos de data en out. Con COMP_Quant los valores float se
+/// guardan como enteros qmin+i*qstep (error maximo qstep/2), cuando algun valor
+/// no puede cuantizarse los datos se codifican sin perdida.
+//==============================================================================
+void JBinaryDataComp::Encode(JBinaryDataDef::TpData type,unsigned count,const void *data
+  ,byte mode,const tdouble3 &qmin,double qstep,std::vector<byte> &out)const
+{
+  unsigned ncomp,csize;
+  bool cfloat;
+  if(!TypeInfo(type,ncomp,csize,cfloat))Run_Exceptioon("Type of array is invalid for compression.");
+  if(count && !data)Run_Exceptioon("Pointer of array with data is invalid.");
+  //-Checks quantisation.
+  if(!cfloat)mode&=~byte(COMP_Quant);
+  if(mode&COMP_Quant){
+    if(!(qstep>0))Run_Exceptioon("Quantisation step is invalid.");
+    const double qm[3]={qmin.x,qmin.y,qmin.z};
+    const double qmax=4.e18;
+    const int nv=int(count*ncomp);
+    int nerr=0;
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule(static) reduction(+:nerr)
+    #endif
+    for(int c=0;c<nv;c++){
+      const double v=(csize==4? double(((const float*)data)[c]): ((const double*)data)[c]);
+      if(!(fabs((v-qm[c%ncomp])/qstep)<qmax))nerr++; //-Also NaN values.
+    }
+    if(nerr)mode&=~byte(COMP_Quant);
+  }
+  if(cfloat && !(mode&COMP_Quant))mode&=~byte(COMP_Delta);
+  //-Configures head.
+  StHead hd;
+  memset(&hd,0,sizeof(StHead));
+  hd.mode=byte(mode|COMP_Shuffle);
+  hd.ncomp=byte(ncomp);
+  hd.csize=byte(csize);
+  hd.wsize=byte(mode&COMP_Quant? sizeof(ullong): csize);
+  hd.blocksize=BlockSize;
+  hd.nblocks=(count+BlockSize-1)/BlockSize;
+  //-Encodes blocks.
+  const size_t selem=size_t(ncomp)*csize;
+  std::vector< std::vector<byte> > blocks(hd.nblocks);
+  const int nb=int(hd.nblocks);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic)
+  #endif
+  for(int cb=0;cb<nb;cb++){
+    const unsigned e0=unsigned(cb)*BlockSize;
+    const unsigned ne=min(BlockSize,count-e0);
+    EncodeBlock(hd,qmin,qstep,ne,(const byte*)data+selem*e0,blocks[cb]);
+  }
+  //-Stores head, sizes and blocks.
+  size_t size=sizeof(StHead)+(hd.mode&COMP_Quant? sizeof(tdouble3)+sizeof(double): 0)+sizeof(unsigned)*hd.nblocks;
+  for(unsigned cb=0;cb<hd.nblocks;cb++)size+=blocks[cb].size();
+  if(size>=UINT_MAX)Run_Exceptioon("Size of compressed data is too large.");
+  out.resize(size);
+  byte *ptr=&out[0];
+  memcpy(ptr,&hd,sizeof(StHead));  ptr+=sizeof(StHead);
+  if(hd.mode&COMP_Quant){
+    memcpy(ptr,&qmin,sizeof(tdouble3));  ptr+=sizeof(tdouble3);
+    memcpy(ptr,&qstep,sizeof(double));   ptr+=sizeof(double);
+  }
+  for(unsigned cb=0;cb<hd.nblocks;cb++){
+    const unsigned sb=unsigned(blocks[cb].size());
+    memcpy(ptr,&sb,sizeof(unsigned));  ptr+=sizeof(unsigned);
+  }
+  for(unsigned cb=0;cb<hd.nblocks;cb++)if(!blocks[cb].empty()){
+    memcpy(ptr,&(blocks[cb][0]),blocks[cb].size());  ptr+=blocks[cb].size();
+  }
+}
+
+//==============================================================================
+/// Decodes count elements from size bytes of data in out.
+/// Decodifica count elementos a partir de size bytes de data en out.
+//==============================================================================
+void JBinaryDataComp::Decode(JBinaryDataDef::TpData type,unsigned count,unsigned size
+  ,const byte *data,void *out)const
+{
+  const char* errtex="Compressed data is corrupted.";
+  unsigned ncomp,csize;
+  bool cfloat;
+  if(!TypeInfo(type,ncomp,csize,cfloat))Run_Exceptioon("Type of array is invalid for compression.");
+  //-Loads and checks head.
+  StHead hd;
+  if(size<sizeof(StHead))Run_Exceptioon(errtex);
+  memcpy(&hd,data,sizeof(StHead));
+  size_t pos=sizeof(StHead);
+  if(hd.mode&(~byte(COMP_Shuffle|COMP_Delta|COMP_Quant)))Run_Exceptioon(fun::PrintStr("Compression mode %u is unknown.",unsigned(hd.mode)));
+  const bool quant=(hd.mode&COMP_Quant)!=0;
+  if(!(hd.mode&COMP_Shuffle) || hd.ncomp!=ncomp || hd.csize!=csize || !hd.blocksize
+    || hd.wsize!=(quant? sizeof(ullong): csize) || (quant && !cfloat)
+    || hd.nblocks!=(count+hd.blocksize-1)/hd.blocksize)Run_Exceptioon(errtex);
+  tdouble3 qmin=TDouble3(0);
+  double qstep=0;
+  if(quant){
+    if(pos+sizeof(tdouble3)+sizeof(double)>size)Run_Exceptioon(errtex);
+    memcpy(&qmin,data+pos,sizeof(tdouble3));  pos+=sizeof(tdouble3);
+    memcpy(&qstep,data+pos,sizeof(double));   pos+=sizeof(double);
+  }
+  //-Computes position of blocks.
+  if(pos+sizeof(unsigned)*hd.nblocks>size)Run_Exceptioon(errtex);
+  std::vector<size_t> bpos(hd.nblocks+1);
+  std::vector<unsigned> bsize(hd.nblocks);
+  memcpy(bsize.data(),data+pos,sizeof(unsigned)*hd.nblocks);
+  pos+=sizeof(unsigned)*hd.nblocks;
+  for(unsigned cb=0;cb<hd.nblocks;cb++){
+    bpos[cb]=pos;
+    pos+=bsize[cb];
+  }
+  if(pos!=size)Run_Exceptioon(errtex);
+  //-Decodes blocks.
+  const size_t selem=size_t(ncomp)*csize;
+  const int nb=int(hd.nblocks);
+  int nerr=0;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic) reduction(+:nerr)
+  #endif
+  for(int cb=0;cb<nb;cb++){
+    const unsigned e0=unsigned(cb)*hd.blocksize;
+    const unsigned ne=min(hd.blocksize,count-e0);
+    try{
+      DecodeBlock(hd,qmin,qstep,ne,data+bpos[cb],bsize[cb],(byte*)out+selem*e0);
+    }
+    catch(...){ nerr++; }
+  }
+  if(nerr)Run_Exceptioon(errtex);
+}
+
@@ -0,0 +1,121 @@
+//HEAD_DSCODES
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/). 
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics. 
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License 
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+ 
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details. 
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+//:#############################################################################
+//:# Descripcion:
+//:# =============
+//:# Codificacion comprimida de arrays de JBinaryData:
+//:# - Cuantizacion de valores float/double sobre una rejilla uniforme (opcional
+//:#   y con perdida).
+//:# - Codificacion delta de valores enteros.
+//:# - Reordenacion de bytes por planos (byte shuffling).
+//:# - Compresion LZ rapida por bloques, los bloques se procesan en paralelo.
+//:#
+//:# Cambios:
+//:# =========
+//:# - Implementacion. (17-10-2026)
+//:#############################################################################
+
+/// \file JBinaryDataComp.h \brief Declares the class \ref JBinaryDataComp.
+
+#ifndef _JBinaryDataComp_
+#define _JBinaryDataComp_
+
+#include "JObject.h"
+#include "TypesDef.h"
+#include "JBinaryData.h"
+#include <vector>
+
+//##############################################################################
+//# JBinaryDataComp
+//##############################################################################
+/// \brief Encodes and decodes compressed data of arrays in \ref JBinaryData.
+///
+/// Data is split in blocks of BlockSize elements which are encoded and decoded
+/// in parallel. Each block applies quantisation (optional), delta encoding,
+/// byte-plane shuffling and a LZ codec (LZ4 style with 64 KB window). Blocks
+/// that are not reduced by LZ are stored without compression.
+// Codifica y decodifica datos comprimidos de arrays de JBinaryData.
+
+class JBinaryDataComp : protected JObject
+{
+ public:
+  ///Transformations applied to data. | Transformaciones aplicadas a los datos.
+  typedef enum{ 
+    COMP_None=0,
+    COMP_Shuffle=1,   ///<Byte-plane shuffling and LZ compression (lossless).
+    COMP_Delta=2,     ///<Delta encoding of integer values (or quantised values).
+    COMP_Quant=4      ///<Quantisation of float/double values on a uniform grid (lossy).
+  }TpCompress;
+
+  static const unsigned BlockSize=32768;  ///<Number of elements per block.
+
+ private:
+  ///Header of encoded data. | Cabecera de datos codificados.
+  typedef struct{
+    byte mode;          ///<Combination of TpCompress.
+    byte ncomp;         ///<Number of components of each element.
+    byte wsize;         ///<Size of encoded words (size of components or 8 with quantisation).
+    byte csize;         ///<Size of components.
+    unsigned blocksize; ///<Number of elements per block.
+    unsigned nblocks;   ///<Number of blocks.
+    unsigned void1;     ///<Not used.
+  }StHead; //-sizeof(16)
+
+  static bool TypeInfo(JBinaryDataDef::TpData type,unsigned &ncomp,unsigned &csize,bool &cfloat);
+
+  template<typename T> static void DeltaEncode(unsigned n,unsigned ncomp,T *w);
+  template<typename T> static void DeltaDecode(unsigned n,unsigned ncomp,T *w);
+  static void DeltaEncode(unsigned n,unsigned ncomp,unsigned wsize,byte *w);
+  static void DeltaDecode(unsigned n,unsigned ncomp,unsigned wsize,byte *w);
+  static void Shuffle(unsigned nw,unsigned wsize,const byte *src,byte *dst);
+  static void Unshuffle(unsigned nw,unsigned wsize,const byte *src,byte *dst);
+
+  void EncodeBlock(const StHead &hd,const tdouble3 &qmin,double qstep
+    ,unsigned ne,const byte *data,std::vector<byte> &out)const;
+  void DecodeBlock(const StHead &hd,const tdouble3 &qmin,double qstep
+    ,unsigned ne,const byte *data,unsigned size,byte *out)const;
+
+ public:
+  JBinaryDataComp();
+  ~JBinaryDataComp();
+
+  static bool TypeAllowed(JBinaryDataDef::TpData type);
+
+  unsigned LzCompress(unsigned n,const byte *src,unsigned dstsize,byte *dst)const;
+  void LzDecompress(unsigned n,const byte *src,unsigned dstsize,byte *dst)const;
+
+  void Encode(JBinaryDataDef::TpData type,unsigned count,const void *data
+    ,byte mode,const tdouble3 &qmin,double qstep,std::vector<byte> &out)const;
+  void Decode(JBinaryDataDef::TpData type,unsigned count,unsigned size,const byte *data,void *out)const;
+};
+
+/*
+Structure of encoded data:
+==========================
+- StHead head (16 bytes)
+- [COMP_Quant] double3 qmin + double qstep
+- uint size_block[nblocks]  (size_block==raw_size -> block without LZ)
+- [block_0]
+  ...
+- [block_n]
+*/
+
+#endif
+
+
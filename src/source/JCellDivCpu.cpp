@@ -22,6 +22,8 @@
 #include "Functions.h"
 #include <cfloat>
 #include <climits>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -41,7 +43,11 @@ JCellDivCpu::JCellDivCpu(bool stable,bool floating,byte periactive
   ClassName="JCellDivCpu";
   CellPart=NULL;    SortPart=NULL;
   PartsInCell=NULL; BeginCell=NULL;
+  SortHist=NULL;
   VSort=NULL;
+  CellOrder=CELLORDER_Row;
+  CellRow=NULL; RowCell=NULL;
+  IncMaxFraction=0;
   Reset();
 }
 
@@ -75,6 +81,15 @@ void JCellDivCpu::Reset(){
   BoundLimitCellMin=BoundLimitCellMax=TUint3(0);
   BoundDivideCellMin=BoundDivideCellMax=TUint3(0);
   DivideFull=false;
+  FreeMemoryRows();
+  IncOk=false;
+  IncNp=IncNpb=0;
+  DivideInc=false;
+  SortIni=SortFin=0;
+  NdivInc=NdivIncSame=0;
+  IncMoved=0;
+  IncList.clear(); IncOldBox.clear();
+  IncBeginCell.clear(); IncListIni.clear();
 }
 
 //==============================================================================
@@ -84,8 +99,12 @@ void JCellDivCpu::Reset(){
 void JCellDivCpu::FreeMemoryNct(){
   delete[] PartsInCell;   PartsInCell=NULL;
   delete[] BeginCell;     BeginCell=NULL; 
+  delete[] SortHist;      SortHist=NULL;
+  SizeSortHist=0;
+  SortBlocks=1;
   MemAllocNct=0;
   BoundDivideOk=false;
+  IncOk=false;
 }
 
 //==============================================================================
@@ -98,6 +117,7 @@ void JCellDivCpu::FreeMemoryNp(){
   delete[] VSort;       SetMemoryVSort(NULL);
   MemAllocNp=0;
   BoundDivideOk=false;
+  IncOk=false;
 }
 
 //==============================================================================
@@ -207,6 +227,159 @@ void JCellDivCpu::CheckMemoryNct(unsigned nctmin){
   else if(!BeginCell)AllocMemoryNct(SizeNct);  
 }
 
+//==============================================================================
+/// Free memory reserved for order of rows of cells.
+/// Libera memoria reservada para el orden de filas de celdas.
+//==============================================================================
+void JCellDivCpu::FreeMemoryRows(){
+  delete[] CellRow;  CellRow=NULL;
+  delete[] RowCell;  RowCell=NULL;
+  SizeRows=0;
+  RowsNcy=RowsNcz=0;
+}
+
+//==============================================================================
+/// Configures the order of rows of cells. Only with CELLORDER_Row the index of
+/// a cell is cx+cy*Ncx+cz*Nsheet, in general it is cx+CellRow[cy+cz*Ncy]*Ncx.
+/// The order of particles within each cell depends on their previous position
+/// in memory, and Morton and Hilbert curves change the relative order of rows
+/// (e.g. rows (cy=2,cz=0) and (cy=1,cz=1)), so particles arriving in a cell from
+/// both rows may be sorted differently. Thus the summation order of the 
+/// interaction changes and results are not guaranteed bit-identical to row 
+/// order (last digits differ).
+/// Configura el orden de filas de celdas. Solo con CELLORDER_Row el indice de
+/// una celda es cx+cy*Ncx+cz*Nsheet, en general es cx+CellRow[cy+cz*Ncy]*Ncx.
+/// El orden de las particulas dentro de cada celda depende de su posicion 
+/// previa en memoria, y las curvas Morton y Hilbert cambian el orden relativo
+/// de las filas, asi que el orden de suma de la interaccion cambia y los 
+/// resultados no son necesariamente identicos bit a bit al orden por filas.
+//==============================================================================
+void JCellDivCpu::SetCellOrder(TpCellOrder cellorder){
+  if(Ndiv)Run_Exceptioon("The order of cells can not be changed after the first divide.");
+  CellOrder=cellorder;
+  FreeMemoryRows();
+}
+
+//==============================================================================
+/// Returns key of position (y,z) on Morton curve (interleaved bits).
+/// Devuelve clave de la posicion (y,z) en la curva de Morton (bits intercalados).
+//==============================================================================
+ullong JCellDivCpu::MortonKey(unsigned y,unsigned z){
+  ullong key=0;
+  for(unsigned b=0;b<32;b++){
+    key|=(ullong((y>>b)&1)<<(2*b)) | (ullong((z>>b)&1)<<(2*b+1));
+  }
+  return(key);
+}
+
+//==============================================================================
+/// Returns key of position (y,z) on Hilbert curve of size n (power of 2).
+/// Devuelve clave de la posicion (y,z) en la curva de Hilbert de tamano n (potencia de 2).
+//==============================================================================
+ullong JCellDivCpu::HilbertKey(unsigned n,unsigned y,unsigned z){
+  ullong key=0;
+  for(unsigned s=n/2;s>0;s/=2){
+    const unsigned ry=((y&s)>0? 1: 0);
+    const unsigned rz=((z&s)>0? 1: 0);
+    key+=ullong(s)*ullong(s)*((3*ry)^rz);
+    //-Rotates quadrant. | Rota cuadrante.
+    if(rz==0){
+      if(ry==1){ y=s-1-y; z=s-1-z; }
+      const unsigned t=y; y=z; z=t;
+    }
+  }
+  return(key);
+}
+
+//==============================================================================
+/// Computes order of rows of cells (CellRow[] and RowCell[]) for current 
+/// number of cells. Only when the number of cells in Y or Z changes (so the 
+/// boundary particles are also sorted again by DivideFull).
+/// Calcula el orden de filas de celdas (CellRow[] y RowCell[]) para el numero
+/// actual de celdas. Solo cuando cambia el numero de celdas en Y o Z (por lo 
+/// que el contorno tambien se reordena con DivideFull).
+//==============================================================================
+void JCellDivCpu::PrepareRows(){
+  if(CellRow && RowsNcy==Ncy && RowsNcz==Ncz)return;
+  const unsigned nrows=Ncy*Ncz;
+  if(nrows>SizeRows || !CellRow){
+    FreeMemoryRows();
+    try{
+      CellRow=new unsigned[nrows];
+      RowCell=new unsigned[nrows];
+    }
+    catch(const std::bad_alloc&){
+      Run_Exceptioon(fun::PrintStr("Failed CPU memory allocation for order of %u rows of cells.",nrows));
+    }
+    SizeRows=nrows;
+  }
+  if(CellOrder!=CELLORDER_Row && nrows>1){
+    //-Computes key of each row and sorts rows by key. | Calcula clave de cada fila y ordena filas por clave.
+    std::vector< std::pair<ullong,unsigned> > keys(nrows);
+    unsigned n=1;
+    while(n<Ncy || n<Ncz)n*=2;
+    for(unsigned cz=0;cz<Ncz;cz++)for(unsigned cy=0;cy<Ncy;cy++){
+      const unsigned r=cy+cz*Ncy;
+      keys[r].first=(CellOrder==CELLORDER_Hilbert? HilbertKey(n,cy,cz): MortonKey(cy,cz));
+      keys[r].second=r;
+    }
+    std::sort(keys.begin(),keys.end());
+    for(unsigned r=0;r<nrows;r++)RowCell[r]=keys[r].second;
+  }
+  else for(unsigned r=0;r<nrows;r++)RowCell[r]=r;
+  for(unsigned r=0;r<nrows;r++)CellRow[RowCell[r]]=r;
+  RowsNcy=Ncy; RowsNcz=Ncz;
+}
+
+//==============================================================================
+/// Returns the number of blocks of particles for the parallel counting sort.
+/// The histograms of blocks are limited to SortHistMaxFactor values per particle,
+/// so cell-heavy domains use fewer blocks. Returns 1 for serial sort.
+///
+/// Devuelve el numero de bloques de particulas para la ordenacion por conteo
+/// en paralelo. Los histogramas de los bloques se limitan a SortHistMaxFactor
+/// valores por particula. Devuelve 1 para ordenacion en serie.
+//==============================================================================
+unsigned JCellDivCpu::GetSortBlocks(unsigned np,ullong nbox)const{
+  unsigned nblk=1;
+#ifdef OMP_USE
+  const unsigned SortHistMaxFactor=4;
+  if(np>OMP_LIMIT_COMPUTEMEDIUM && nbox){
+    nblk=unsigned(min(omp_get_max_threads(),OMP_MAXTHREADS));
+    const ullong maxblk=(ullong(np)*SortHistMaxFactor)/nbox;
+    if(nblk>maxblk)nblk=unsigned(maxblk);
+    if(nblk<1)nblk=1;
+  }
+#endif
+  return(nblk);
+}
+
+//==============================================================================
+/// Returns memory for the histograms of the parallel counting sort with nblk
+/// blocks of nbox values. The memory is only increased and is counted as cell memory.
+///
+/// Devuelve memoria para los histogramas de la ordenacion por conteo en paralelo
+/// con nblk bloques de nbox valores. La memoria solo se incrementa y se contabiliza
+/// como memoria de celdas.
+//==============================================================================
+unsigned* JCellDivCpu::CheckMemorySortHist(unsigned nblk,ullong nbox){
+  const ullong size=nbox*nblk;
+  if(SizeSortHist<size){
+    MemAllocNct-=sizeof(unsigned)*SizeSortHist;
+    delete[] SortHist; SortHist=NULL;
+    SizeSortHist=0;
+    try{
+      SortHist=new unsigned[size];
+    }
+    catch(const std::bad_alloc&){
+      Run_Exceptioon(fun::PrintStr("Failed CPU memory allocation of %.1f MB for parallel sort of cells.",double(sizeof(unsigned)*size)/(1024*1024)));
+    }
+    SizeSortHist=size;
+    MemAllocNct+=sizeof(unsigned)*SizeSortHist;
+  }
+  return(SortHist);
+}
+
 //==============================================================================
 /// Define simulation domain to use.
 /// Define el dominio de simulacion a usar.
@@ -350,10 +523,10 @@ void JCellDivCpu::CalcCellDomainFluid(unsigned n,unsigned pini,unsigned n2,unsig
 /// Reordena datos de todas las particulas (para tipo word).
 //==============================================================================
 void JCellDivCpu::SortArray(word *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortWord[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortWord+ini,sizeof(word)*(n-ini));
@@ -364,10 +537,10 @@ void JCellDivCpu::SortArray(word *vec){
 /// Reordena datos de todas las particulas (para tipo unsigned).
 //==============================================================================
 void JCellDivCpu::SortArray(unsigned *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortInt[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortInt+ini,sizeof(unsigned)*(n-ini));
@@ -378,10 +551,10 @@ void JCellDivCpu::SortArray(unsigned *vec){
 /// Reordena datos de todas las particulas (para tipo float).
 //==============================================================================
 void JCellDivCpu::SortArray(float *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortFloat[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortFloat+ini,sizeof(float)*(n-ini));
@@ -392,10 +565,10 @@ void JCellDivCpu::SortArray(float *vec){
 /// Reordena datos de todas las particulas (para tipo tdouble3).
 //==============================================================================
 void JCellDivCpu::SortArray(tdouble3 *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortDouble3[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortDouble3+ini,sizeof(tdouble3)*(n-ini));
@@ -406,10 +579,10 @@ void JCellDivCpu::SortArray(tdouble3 *vec){
 /// Reordena datos de todas las particulas (para tipo tfloat3).
 //==============================================================================
 void JCellDivCpu::SortArray(tfloat3 *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortFloat3[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortFloat3+ini,sizeof(tfloat3)*(n-ini));
@@ -420,10 +593,10 @@ void JCellDivCpu::SortArray(tfloat3 *vec){
 /// Reordena datos de todas las particulas (para tipo tfloat4).
 //==============================================================================
 void JCellDivCpu::SortArray(tfloat4 *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortFloat4[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortFloat4+ini,sizeof(tfloat4)*(n-ini));
@@ -434,15 +607,132 @@ void JCellDivCpu::SortArray(tfloat4 *vec){
 /// Reordena datos de todas las particulas (para tipo tsymatrix3f).
 //==============================================================================
 void JCellDivCpu::SortArray(tsymatrix3f *vec){
-  const int n=int(Nptot);
-  const int ini=(DivideFull? 0: int(NpbFinal));
+  const int n=int(SortArrayFin());
+  const int ini=int(SortArrayIni());
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(n-ini>OMP_LIMIT_COMPUTELIGHT)
   #endif
   for(int p=ini;p<n;p++)VSortSymmatrix3f[p]=vec[SortPart[p]];
   memcpy(vec+ini,VSortSymmatrix3f+ini,sizeof(tsymatrix3f)*(n-ini));
 }
 
+//==============================================================================
+/// Completes the reorder of array a after writing the particles SortArrayIni()
+/// ...SortArrayFin()-1 in a2. With GetSortSwap() the particles that were not 
+/// reordered are copied to a2 (the caller swaps pointers), otherwise the 
+/// reordered particles are copied back to a. So the smallest part is copied.
+///
+/// Completa la reordenacion del array a tras escribir las particulas 
+/// SortArrayIni()...SortArrayFin()-1 en a2. Con GetSortSwap() las particulas
+/// no reordenadas se copian a a2 (el llamador intercambia los punteros), si no
+/// las particulas reordenadas se copian de vuelta a a. Asi se copia la parte
+/// menor.
+//==============================================================================
+template<class T> void JCellDivCpu::SortCopy(T *a,T *a2)const{
+  const unsigned ini=SortArrayIni(),fin=SortArrayFin();
+  if(GetSortSwap()){
+    if(ini)memcpy(a2,a,sizeof(T)*ini);
+    if(fin<Nptot)memcpy(a2+fin,a+fin,sizeof(T)*(Nptot-fin));
+  }
+  else if(fin>ini)memcpy(a+ini,a2+ini,sizeof(T)*(fin-ini));
+}
+
+//==============================================================================
+/// Reorders basic arrays according to SortPart[] in a single pass over the 
+/// particles reordered by the divide (all, only fluid or the range of the 
+/// incremental divide). Sorted data is left in the second arrays when 
+/// GetSortSwap() is true (the caller swaps pointers) or in the first arrays.
+///
+/// Reordena arrays basicos segun SortPart[] en una sola pasada sobre las 
+/// particulas reordenadas por el divide (todas, solo fluido o el rango del 
+/// divide incremental). Los datos ordenados quedan en los segundos arrays 
+/// cuando GetSortSwap() es true (el llamador intercambia los punteros) o en 
+/// los primeros arrays.
+//==============================================================================
+void JCellDivCpu::SortBasicArrays(unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop
+  ,unsigned *idp2,typecode *code2,unsigned *dcell2,tdouble3 *pos2,tfloat4 *velrhop2)const
+{
+  const int ini=int(SortArrayIni());
+  const int fin=int(SortArrayFin());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++){
+    const unsigned oldpos=SortPart[p];
+    idp2[p]    =idp[oldpos];
+    code2[p]   =code[oldpos];
+    dcell2[p]  =dcell[oldpos];
+    pos2[p]    =pos[oldpos];
+    velrhop2[p]=velrhop[oldpos];
+  }
+  SortCopy(idp,idp2);
+  SortCopy(code,code2);
+  SortCopy(dcell,dcell2);
+  SortCopy(pos,pos2);
+  SortCopy(velrhop,velrhop2);
+}
+
+//==============================================================================
+/// Reorders data arrays according to SortPart (for type tfloat4).
+/// Ordena arrays de datos segun SortPart (para tipo tfloat4).
+//==============================================================================
+void JCellDivCpu::SortDataArrays(tfloat4 *a,tfloat4 *a2)const{
+  const int ini=int(SortArrayIni());
+  const int fin=int(SortArrayFin());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++)a2[p]=a[SortPart[p]];
+  SortCopy(a,a2);
+}
+
+//==============================================================================
+/// Reorders data arrays according to SortPart (for tdouble3 and tfloat4 values).
+/// Ordena arrays de datos segun SortPart (para valores tdouble3 y tfloat4).
+//==============================================================================
+void JCellDivCpu::SortDataArrays(tdouble3 *a,tfloat4 *b,tdouble3 *a2,tfloat4 *b2)const{
+  const int ini=int(SortArrayIni());
+  const int fin=int(SortArrayFin());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++){
+    const unsigned oldpos=SortPart[p];
+    a2[p]=a[oldpos];
+    b2[p]=b[oldpos];
+  }
+  SortCopy(a,a2);
+  SortCopy(b,b2);
+}
+
+//==============================================================================
+/// Reorders data arrays according to SortPart (for type tsymatrix3f).
+/// Ordena arrays de datos segun SortPart (para tipo tsymatrix3f).
+//==============================================================================
+void JCellDivCpu::SortDataArrays(tsymatrix3f *a,tsymatrix3f *a2)const{
+  const int ini=int(SortArrayIni());
+  const int fin=int(SortArrayFin());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++)a2[p]=a[SortPart[p]];
+  SortCopy(a,a2);
+}
+
+//==============================================================================
+/// Reorders data arrays according to SortPart (for type tfloat3).
+/// Ordena arrays de datos segun SortPart (para tipo tfloat3).
+//==============================================================================
+void JCellDivCpu::SortDataArrays(tfloat3 *a,tfloat3 *a2)const{
+  const int ini=int(SortArrayIni());
+  const int fin=int(SortArrayFin());
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++)a2[p]=a[SortPart[p]];
+  SortCopy(a,a2);
+}
+
 //==============================================================================
 /// Return current limites of domain.
 /// Devuelve limites actuales del dominio.
@@ -30,6 +30,7 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 //#define DBG_JCellDivCpu 1 //:DEL:
 
@@ -78,6 +79,11 @@ protected:
   unsigned *BeginCell;   ///<Get first value of each cell. | Contiene el principio de cada celda. 
   // BeginCell=[BoundOk(nct),BoundIgnore(1),Fluid(nct),BoundOut(1),FluidOut(1),BoundOutIgnore(1),FluidOutIgnore(1),END)]
 
+  //-Variables for parallel counting sort. | Variables para ordenacion por conteo en paralelo.
+  unsigned SortBlocks;    ///<Number of blocks of particles used in the last sort (1:serial sort). | Numero de bloques de particulas usados en la ultima ordenacion (1:serie).
+  ullong SizeSortHist;    ///<Number of values allocated in SortHist[]. | Numero de valores reservados en SortHist[].
+  unsigned *SortHist;     ///<Particles per box and block, and then destination of each box per block [SortBlocks*(Nctt-1)]. | Particulas por caja y bloque, y despues destino de cada caja por bloque.
+
   //-Variables to reorder particles. | Variables para reordenar particulas.
   byte        *VSort;            ///<Memory to reorder particles. | Memoria para reordenar particulas. [sizeof(tdouble3)*Np]
   word        *VSortWord;        ///<To order word vectors (write to VSort). | Para ordenar vectores word (apunta a VSort).
@@ -120,6 +126,29 @@ protected:
 
   bool DivideFull;      ///<Indicate that divie is applied to fluid & boundary (not only to fluid). | Indica que el divide se aplico a fluido y contorno (no solo al fluido).
 
+  //-Order of rows of cells (cells of a row in X are always consecutive). | Orden de filas de celdas (las celdas de una fila en X siempre son consecutivas).
+  TpCellOrder CellOrder;  ///<Order of rows of cells in (Y,Z). | Orden de filas de celdas en (Y,Z).
+  unsigned RowsNcy;       ///<Number of cells in Y used to compute CellRow[]. | Numero de celdas en Y usado para calcular CellRow[].
+  unsigned RowsNcz;       ///<Number of cells in Z used to compute CellRow[]. | Numero de celdas en Z usado para calcular CellRow[].
+  unsigned SizeRows;      ///<Number of rows with allocated memory. | Numero de filas con memoria reservada.
+  unsigned *CellRow;      ///<Position in memory of each row (cy+cz*Ncy) [SizeRows]. | Posicion en memoria de cada fila.
+  unsigned *RowCell;      ///<Row (cy+cz*Ncy) in each position of memory [SizeRows]. | Fila en cada posicion de memoria.
+
+  //-Variables for incremental divide of fluid. | Variables para divide incremental del fluido.
+  float IncMaxFraction;   ///<Maximum fraction of fluid particles that change box for an incremental divide (0:disabled). | Fraccion maxima de particulas de fluido que cambian de caja para un divide incremental (0:desactivado).
+  bool IncOk;             ///<Order of particles of the last divide can be used in an incremental divide. | El orden de particulas del ultimo divide puede usarse en un divide incremental.
+  unsigned IncNp,IncNpb;  ///<Number of particles and boundary particles after the last divide. | Numero de particulas y particulas de contorno tras el ultimo divide.
+  bool DivideInc;         ///<Indicates that the divide was incremental and only SortIni...SortFin-1 was reordered. | Indica que el divide fue incremental y solo se reordeno SortIni...SortFin-1.
+  unsigned SortIni;       ///<First particle reordered by an incremental divide. | Primera particula reordenada por un divide incremental.
+  unsigned SortFin;       ///<Last particle (+1) reordered by an incremental divide. | Ultima particula (+1) reordenada por un divide incremental.
+  unsigned NdivInc;       ///<Number of incremental divides. | Numero de divides incrementales.
+  unsigned NdivIncSame;   ///<Number of incremental divides where no particle changed box. | Numero de divides incrementales donde ninguna particula cambio de caja.
+  ullong IncMoved;        ///<Total number of particles that changed box in incremental divides. | Numero total de particulas que cambiaron de caja en divides incrementales.
+  std::vector<ullong> IncList;         ///<Particles that changed box as (newbox<<32|p) sorted by box and particle. | Particulas que cambiaron de caja como (newbox<<32|p) ordenadas por caja y particula.
+  std::vector<unsigned> IncOldBox;     ///<Previous box of particles that changed box (sorted). | Caja previa de las particulas que cambiaron de caja (ordenadas).
+  std::vector<unsigned> IncBeginCell; ///<BeginCell[] of fluid boxes in the previous divide. | BeginCell[] de las cajas de fluido en el divide previo.
+  std::vector<unsigned> IncListIni;    ///<First entry of IncList[] for each fluid box. | Primera entrada de IncList[] para cada caja de fluido.
+
   void Reset();
 
   //-Management of allocated dynamic memory.
@@ -132,6 +161,14 @@ protected:
   void AllocMemoryNct(ullong nct);
   void CheckMemoryNp(unsigned npmin);
   void CheckMemoryNct(unsigned nctmin);
+  void FreeMemoryRows();
+  void PrepareRows();
+  static ullong MortonKey(unsigned y,unsigned z);
+  static ullong HilbertKey(unsigned n,unsigned y,unsigned z);
+  unsigned* CheckMemorySortHist(unsigned nblk,ullong nbox);
+
+  unsigned GetSortBlocks(unsigned np,ullong nbox)const;
+  static unsigned SortBlockIni(unsigned np,unsigned pini,unsigned nblk,unsigned b){ return(pini+unsigned((ullong(np)*b)/nblk)); }
 
   ullong SizeBeginCell(ullong nct)const{ return((nct*2)+5+1); } //-[BoundOk(nct),BoundIgnore(1),Fluid(nct),BoundOut(1),FluidOut(1),BoundOutIgnore(1),FluidOutIgnore(1),END(1)]
 
@@ -147,6 +184,10 @@ protected:
 
   unsigned CellSize(unsigned box)const{ return(BeginCell[box+1]-BeginCell[box]); }
 
+  unsigned SortArrayIni()const{ return(DivideInc? SortIni: (DivideFull? 0: NpbFinal)); }
+  unsigned SortArrayFin()const{ return(DivideInc? SortFin: Nptot); }
+  template<class T> void SortCopy(T *a,T *a2)const;
+
 public:
   JCellDivCpu(bool stable,bool floating,byte periactive
     ,TpCellMode cellmode,float scell,tdouble3 mapposmin,tdouble3 mapposmax,tuint3 mapcells
@@ -164,6 +205,15 @@ public:
   void SortArray(tfloat4 *vec);
   void SortArray(tsymatrix3f *vec);
 
+  /// Returns true when sorted data is left in the second arrays (the caller swaps pointers).
+  bool GetSortSwap()const{ const unsigned n=SortArrayFin()-SortArrayIni(); return(n>Nptot-n); }
+  void SortBasicArrays(unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop
+    ,unsigned *idp2,typecode *code2,unsigned *dcell2,tdouble3 *pos2,tfloat4 *velrhop2)const;
+  void SortDataArrays(tfloat4 *a,tfloat4 *a2)const;
+  void SortDataArrays(tdouble3 *a,tfloat4 *b,tdouble3 *a2,tfloat4 *b2)const;
+  void SortDataArrays(tsymatrix3f *a,tsymatrix3f *a2)const;
+  void SortDataArrays(tfloat3 *a,tfloat3 *a2)const;
+
   TpCellMode GetCellMode()const{ return(CellMode); }
   unsigned GetHdiv()const{ return(Hdiv); }
   float GetScell()const{ return(Scell); }
@@ -175,6 +225,11 @@ public:
   tuint3 GetNcells()const{ return(TUint3(Ncx,Ncy,Ncz)); }
   unsigned GetBoxFluid()const{ return(BoxFluid); }
 
+  void SetCellOrder(TpCellOrder cellorder);
+  TpCellOrder GetCellOrder()const{ return(CellOrder); }
+  const unsigned* GetCellRow()const{ return(CellRow); }
+  const unsigned* GetRowCell()const{ return(RowCell); }
+
   tuint3 GetCellDomainMin()const{ return(CellDomainMin); }
   tuint3 GetCellDomainMax()const{ return(CellDomainMax); }
   tdouble3 GetDomainLimits(bool limitmin,unsigned slicecellmin=0)const;
@@ -189,9 +244,22 @@ public:
 
   //:const unsigned* GetCellPart()const{ return(CellPart); }
   const unsigned* GetBeginCell(){ return(BeginCell); }
+  const unsigned* GetSortPart()const{ return(SortPart); }
+  unsigned GetSortPartIni()const{ return(DivideFull? 0: NpbFinal); } ///<Particles before this position were not reordered.
 
   void SetIncreaseNp(unsigned increasenp){ IncreaseNp=increasenp; }
 
+  void SetIncDivide(float maxfraction){ IncMaxFraction=maxfraction; }
+  float GetIncDivide()const{ return(IncMaxFraction); }
+  bool GetDivideInc()const{ return(DivideInc); }
+  unsigned GetSortIni()const{ return(SortIni); }  ///<First particle reordered by an incremental divide.
+  unsigned GetSortFin()const{ return(SortFin); }  ///<Last particle (+1) reordered by an incremental divide.
+  unsigned GetNdiv()const{ return(Ndiv); }
+  unsigned GetNdivFull()const{ return(NdivFull); }
+  unsigned GetNdivInc()const{ return(NdivInc); }
+  unsigned GetNdivIncSame()const{ return(NdivIncSame); }
+  ullong GetIncMoved()const{ return(IncMoved); }
+
   //:bool CellNoEmpty(unsigned box,byte kind)const;
   //:unsigned CellBegin(unsigned box,byte kind)const;
   //:unsigned CellSize(unsigned box,byte kind)const;
@@ -21,6 +21,7 @@
 #include "JCellDivCpuSingle.h"
 #include "Functions.h"
 #include <climits>
+#include <algorithm>
 
 using namespace std;
 
@@ -100,6 +101,8 @@ void JCellDivCpuSingle::PrepareNct(){
   BoxFluidOut=BoxBoundOut+1; 
   BoxBoundOutIgnore=BoxFluidOut+1;
   BoxFluidOutIgnore=BoxBoundOutIgnore+1;
+  //-Computes order of rows of cells. | Calcula orden de filas de celdas.
+  PrepareRows();
   //:Log->Printf("--->PrepareNct> BoxIgnore:%u BoxFluid:%u BoxBoundOut:%u BoxFluidOut:%u",BoxIgnore,BoxFluid,BoxBoundOut,BoxFluidOut);
   //:Log->Printf("--->PrepareNct> BoxBoundOutIgnore:%u BoxFluidOutIgnore:%u",BoxBoundOutIgnore,BoxFluidOutIgnore);
 }
@@ -108,38 +111,47 @@ void JCellDivCpuSingle::PrepareNct(){
 /// Computes cell of each boundary and fluid particle (cellpart[]) starting from its cell in 
 /// the map. all the excluded particles were already marked in code[].
 /// Excluded particles bound (fixed and moving) and floating are moved to BoxBoundOut.
-/// Account for particles for cell (partsincell[]).
+/// Account for particles for cell of each block of particles (partsblk[nblk*(Nctt-1)]).
 ///
 /// Calcula celda de cada particula bound y fluid (cellpart[]) a partir de su celda en
 /// mapa. Todas las particulas excluidas ya fueron marcadas en code[].
 /// Las particulas excluidas de tipo bound (fixed and moving) and floating se mueven a BoxBoundOut.
-/// Contabiliza particulas por celda (partsincell[]).
+/// Contabiliza particulas por celda de cada bloque de particulas (partsblk[nblk*(Nctt-1)]).
 //==============================================================================
 void JCellDivCpuSingle::PreSortFull(unsigned np,const unsigned *dcellc,const typecode *codec
-  ,unsigned* cellpart,unsigned* partsincell)const
+  ,unsigned* cellpart,unsigned nblk,unsigned* partsblk)const
 {
-  memset(partsincell,0,sizeof(unsigned)*(Nctt-1));
-  for(unsigned p=0;p<np;p++){
-    //-Computes cell according position.
-    const unsigned rcell=dcellc[p];
-    const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
-    const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
-    const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
-    const unsigned cellsort=cx+cy*Ncx+cz*Nsheet;
-    //-Checks particle code.
-    const typecode rcode=codec[p];
-    const typecode codetype=CODE_GetType(rcode);
-    const typecode codeout=CODE_GetSpecialValue(rcode);
-    //-Assigns box.
-    unsigned box;
-    if(codetype<CODE_TYPE_FLOATING){//-Bound particles (except floating) | Particulas bound (excepto floating).
-      box=(codeout<CODE_OUTIGNORE?   ((cx<Ncx && cy<Ncy && cz<Ncz)? cellsort: BoxBoundIgnore):   (codeout==CODE_OUTIGNORE? BoxBoundOutIgnore: BoxBoundOut));
+  const ullong nbox=Nctt-1;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static,1) if(nblk>1)
+  #endif
+  for(int b=0;b<int(nblk);b++){
+    unsigned *partsincell=partsblk+nbox*b;
+    memset(partsincell,0,sizeof(unsigned)*nbox);
+    const unsigned pini=SortBlockIni(np,0,nblk,b);
+    const unsigned pfin=SortBlockIni(np,0,nblk,b+1);
+    for(unsigned p=pini;p<pfin;p++){
+      //-Computes cell according position.
+      const unsigned rcell=dcellc[p];
+      const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
+      const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
+      const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
+      const unsigned cellsort=(cx<Ncx && cy<Ncy && cz<Ncz? cx+CellRow[cy+cz*Ncy]*Ncx: 0);
+      //-Checks particle code.
+      const typecode rcode=codec[p];
+      const typecode codetype=CODE_GetType(rcode);
+      const typecode codeout=CODE_GetSpecialValue(rcode);
+      //-Assigns box.
+      unsigned box;
+      if(codetype<CODE_TYPE_FLOATING){//-Bound particles (except floating) | Particulas bound (excepto floating).
+        box=(codeout<CODE_OUTIGNORE?   ((cx<Ncx && cy<Ncy && cz<Ncz)? cellsort: BoxBoundIgnore):   (codeout==CODE_OUTIGNORE? BoxBoundOutIgnore: BoxBoundOut));
+      }
+      else{//-Fluid and floating particles | Particulas fluid y floating.
+        box=(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? BoxFluid+cellsort: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
+      }
+      cellpart[p]=box;
+      partsincell[box]++;
     }
-    else{//-Fluid and floating particles | Particulas fluid y floating.
-      box=(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? BoxFluid+cellsort: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
-    }
-    cellpart[p]=box;
-    partsincell[box]++;
   }
 }
 
@@ -147,74 +159,214 @@ void JCellDivCpuSingle::PreSortFull(unsigned np,const unsigned *dcellc,const typ
 /// Computes cell of each fluid particle (cellpart[]) starting from its cell in 
 /// the map. all the excluded particles were already marked in code[].
 /// Excluded particles floating are moved to BoxBoundOut.
-/// Account for particles for cell (partsincell[]).
+/// Account for particles for cell of each block of particles (partsblk[nblk*(Nctt-1)]).
 ///
 /// Calcula celda de cada particula fluid (cellpart[]) a partir de su celda en
 /// mapa. Todas las particulas excluidas ya fueron marcadas en code[].
 /// Las particulas excluidas de tipo floating se mueven a BoxBoundOut.
-/// Contabiliza particulas por celda (partsincell[]).
+/// Contabiliza particulas por celda de cada bloque de particulas (partsblk[nblk*(Nctt-1)]).
 //==============================================================================
 void JCellDivCpuSingle::PreSortFluid(unsigned np,unsigned pini,const unsigned *dcellc
-  ,const typecode *codec,unsigned* cellpart,unsigned* partsincell)const
+  ,const typecode *codec,unsigned* cellpart,unsigned nblk,unsigned* partsblk)const
 {
-  memset(partsincell+BoxFluid,0,sizeof(unsigned)*(Nctt-1-BoxFluid));
-  const unsigned pfin=pini+np;
-  for(unsigned p=pini;p<pfin;p++){
-    //-Computes cell according position.
-    const unsigned rcell=dcellc[p];
-    const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
-    const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
-    const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
-    const unsigned cellsortfluid=BoxFluid+cx+cy*Ncx+cz*Nsheet;
-    //-Checks particle code.
-    const typecode rcode=codec[p];
-    const typecode codetype=CODE_GetType(rcode);
-    const typecode codeout=CODE_GetSpecialValue(rcode);
-    //-Assigns box.
-    const unsigned box=(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? cellsortfluid: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
-    cellpart[p]=box;
-    partsincell[box]++;
+  const ullong nbox=Nctt-1;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static,1) if(nblk>1)
+  #endif
+  for(int b=0;b<int(nblk);b++){
+    unsigned *partsincell=partsblk+nbox*b;
+    memset(partsincell+BoxFluid,0,sizeof(unsigned)*(nbox-BoxFluid));
+    const unsigned pbini=SortBlockIni(np,pini,nblk,b);
+    const unsigned pbfin=SortBlockIni(np,pini,nblk,b+1);
+    for(unsigned p=pbini;p<pbfin;p++){
+      const unsigned box=FluidBox(dcellc[p],codec[p]);
+      cellpart[p]=box;
+      partsincell[box]++;
+    }
   }
 }
 
 //==============================================================================
-/// Calculate SortPart[] (where the particle is that must go in stated position).
+/// Calculate SortPart[] (where the particle is that must go in stated position)
+/// for particles pini...pini+np-1 and boxes boxini...Nctt-2, begincell[boxini] 
+/// must be already defined. 
+/// The sort is a counting sort in parallel by blocks of particles: exclusive scan
+/// of partsblk[] (box-major, block-minor) to obtain the destination of each box 
+/// in each block and stable scatter of each block in particle order. So the 
+/// result is identical to the serial sort for any number of blocks.
 /// If there are no excluded boundary particles, no problem exists.
 ///
-/// Calcula SortPart[] (donde esta la particula que deberia ir en dicha posicion).
+/// Calcula SortPart[] (donde esta la particula que deberia ir en dicha posicion)
+/// para las particulas pini...pini+np-1 y cajas boxini...Nctt-2, begincell[boxini]
+/// debe estar ya definido.
+/// La ordenacion es por conteo en paralelo por bloques de particulas: suma 
+/// prefija exclusiva de partsblk[] (por caja y despues por bloque) para obtener
+/// el destino de cada caja en cada bloque y reparto estable de cada bloque en el
+/// orden de las particulas. Asi el resultado es identico a la ordenacion en serie
+/// para cualquier numero de bloques.
 /// Si hay particulas de contorno excluidas no hay ningun problema.
 //==============================================================================
-void JCellDivCpuSingle::MakeSortFull(const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const{
-  //-Adjust initial position of cells | Ajusta posiciones iniciales de celdas.
-  begincell[0]=0;
-  for(unsigned box=0;box<Nctt-1;box++)begincell[box+1]=begincell[box]+partsincell[box];
+void JCellDivCpuSingle::MakeSort(unsigned np,unsigned pini,unsigned boxini,const unsigned* cellpart
+  ,unsigned* begincell,unsigned nblk,unsigned* partsblk,unsigned* sortpart)const
+{
+  const ullong nbox=Nctt-1;
+  const unsigned nrange=nblk;
+  const unsigned nboxrange=unsigned(nbox-boxini);
+  //-Number of particles in each range of boxes | Numero de particulas en cada rango de cajas.
+  unsigned rangeini[OMP_MAXTHREADS+1];
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static,1) if(nrange>1)
+  #endif
+  for(int r=0;r<int(nrange);r++){
+    const unsigned bxini=SortBlockIni(nboxrange,boxini,nrange,r);
+    const unsigned bxfin=SortBlockIni(nboxrange,boxini,nrange,r+1);
+    unsigned sum=0;
+    for(unsigned box=bxini;box<bxfin;box++)for(unsigned b=0;b<nblk;b++)sum+=partsblk[nbox*b+box];
+    rangeini[r+1]=sum;
+  }
+  //-Adjust initial position of each range | Ajusta posicion inicial de cada rango.
+  rangeini[0]=begincell[boxini];
+  for(unsigned r=0;r<nrange;r++)rangeini[r+1]+=rangeini[r];
+  //-Adjust initial position of cells and of each block in cells.
+  //-Ajusta posiciones iniciales de celdas y de cada bloque en las celdas.
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static,1) if(nrange>1)
+  #endif
+  for(int r=0;r<int(nrange);r++){
+    const unsigned bxini=SortBlockIni(nboxrange,boxini,nrange,r);
+    const unsigned bxfin=SortBlockIni(nboxrange,boxini,nrange,r+1);
+    unsigned pos=rangeini[r];
+    for(unsigned box=bxini;box<bxfin;box++){
+      for(unsigned b=0;b<nblk;b++){
+        const unsigned n=partsblk[nbox*b+box];
+        partsblk[nbox*b+box]=pos;
+        pos+=n;
+      }
+      begincell[box+1]=pos;
+    }
+  }
   //-Put particles in their boxes | Coloca las particulas en sus cajas.
-  memset(partsincell,0,sizeof(unsigned)*(Nctt-1));
-  for(unsigned p=0;p<Nptot;p++){
-    unsigned box=cellpart[p];
-    sortpart[begincell[box]+partsincell[box]]=p;
-    partsincell[box]++;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static,1) if(nblk>1)
+  #endif
+  for(int b=0;b<int(nblk);b++){
+    unsigned *posincell=partsblk+nbox*b;
+    const unsigned pbini=SortBlockIni(np,pini,nblk,b);
+    const unsigned pbfin=SortBlockIni(np,pini,nblk,b+1);
+    for(unsigned p=pbini;p<pbfin;p++){
+      const unsigned box=cellpart[p];
+      sortpart[posincell[box]]=p;
+      posincell[box]++;
+    }
   }
 }
 
 //==============================================================================
-/// Calculate SortPart[] (where the particle is that must go in stated position).
-/// In this case, there are mp excluded boundary particles because an exception is generated.
+/// Incremental divide of fluid: computes SortPart[] and BeginCell[] starting 
+/// from the order of the previous divide when only a few fluid particles changed
+/// box. CellPart[] is only updated for the particles that changed box, and the 
+/// boxes between the first and last affected box merge the particles that 
+/// remain with the particles that arrive (both in order of p), so the result is
+/// identical to PreSortFluid()+MakeSort(). Only SortIni...SortFin-1 is 
+/// reordered and it is empty when no particle changed box.
+/// Returns false when the particles that changed box exceed IncMaxFraction.
 ///
-/// Calcula SortPart[] (donde esta la particula que deberia ir en dicha posicion).
-/// En este caso nunca hay particulas bound excluidas pq se genera excepcion.
+/// Divide incremental del fluido: calcula SortPart[] y BeginCell[] a partir del
+/// orden del divide previo cuando solo unas pocas particulas de fluido cambiaron
+/// de caja. CellPart[] solo se actualiza para las particulas que cambiaron de 
+/// caja, y las cajas entre la primera y la ultima afectada mezclan las 
+/// particulas que permanecen con las que llegan (ambas en orden de p), asi que
+/// el resultado es identico a PreSortFluid()+MakeSort(). Solo se reordena 
+/// SortIni...SortFin-1 y esta vacio cuando ninguna particula cambio de caja.
+/// Devuelve false cuando las particulas que cambiaron de caja superan IncMaxFraction.
 //==============================================================================
-void JCellDivCpuSingle::MakeSortFluid(unsigned np,unsigned pini,const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const{
-  //-Adjust initial position of cells | Ajusta posiciones iniciales de celdas.
-  for(unsigned box=BoxFluid;box<Nctt-1;box++)begincell[box+1]=begincell[box]+partsincell[box];
-  //-Put particles in their boxes | Coloca las particulas en sus cajas.
-  memset(partsincell+BoxFluid,0,sizeof(unsigned)*(Nctt-1-BoxFluid));
-  const unsigned pfin=pini+np;
-  for(unsigned p=pini;p<pfin;p++){
-    unsigned box=cellpart[p];
-    sortpart[begincell[box]+partsincell[box]]=p;
-    partsincell[box]++;
+bool JCellDivCpuSingle::PreSortIncremental(const unsigned *dcellc,const typecode *codec){
+  const int pini=int(Npb1),pfin=int(Npb1+Npf1);
+  //-Computes box of fluid particles and collects particles that changed box.
+  //-Calcula caja de las particulas de fluido y recopila las que cambiaron de caja.
+  IncList.clear();
+  #ifdef OMP_USE
+    #pragma omp parallel if(Npf1>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  {
+    std::vector<ullong> moved;
+    #ifdef OMP_USE
+      #pragma omp for schedule (static)
+    #endif
+    for(int p=pini;p<pfin;p++){
+      const unsigned box=FluidBox(dcellc[p],codec[p]);
+      if(box!=CellPart[p]){
+        moved.push_back((ullong(box)<<32)|unsigned(p));
+        CellPart[p]=box;
+      }
+    }
+    if(!moved.empty()){
+      #ifdef OMP_USE
+        #pragma omp critical
+      #endif
+      {
+        IncList.insert(IncList.end(),moved.begin(),moved.end());
+      }
+    }
+  }
+  const unsigned m=unsigned(IncList.size());
+  if(m>unsigned(IncMaxFraction*Npf1))return(false);
+  DivideInc=true;
+  IncMoved+=m;
+  if(!m){//-The order of particles does not change. | El orden de particulas no cambia.
+    SortIni=SortFin=0;
+    NdivIncSame++;
+    return(true);
+  }
+  sort(IncList.begin(),IncList.end());
+  //-Previous box of particles that changed box. | Caja previa de las particulas que cambiaron de caja.
+  const unsigned *begfluid=BeginCell+BoxFluid;
+  const unsigned *begend=BeginCell+Nctt;
+  IncOldBox.resize(m);
+  for(unsigned c=0;c<m;c++){
+    const unsigned p=unsigned(IncList[c]&0xffffffffu);
+    IncOldBox[c]=BoxFluid+unsigned(upper_bound(begfluid,begend,p)-begfluid)-1;
   }
+  sort(IncOldBox.begin(),IncOldBox.end());
+  //-Computes new first particle of the affected boxes. | Calcula nueva primera particula de las cajas afectadas.
+  const unsigned boxmin=min(unsigned(IncList[0]>>32),IncOldBox[0]);
+  const unsigned boxmax=max(unsigned(IncList[m-1]>>32),IncOldBox[m-1]);
+  const unsigned nbox=boxmax-boxmin+1;
+  IncBeginCell.assign(BeginCell+boxmin,BeginCell+boxmax+2);
+  IncListIni.resize(nbox+1);
+  unsigned cin=0,cout=0;
+  for(unsigned cb=0;cb<=nbox;cb++){
+    const unsigned box=boxmin+cb;
+    BeginCell[box]=IncBeginCell[cb]+cin-cout;
+    IncListIni[cb]=cin;
+    while(cin<m && unsigned(IncList[cin]>>32)==box)cin++;
+    while(cout<m && IncOldBox[cout]==box)cout++;
+  }
+  SortIni=BeginCell[boxmin];
+  SortFin=BeginCell[boxmax+1];
+  //-Merges particles that remain in each box with particles that arrive.
+  //-Mezcla las particulas que permanecen en cada caja con las que llegan.
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided) if(SortFin-SortIni>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int cb=0;cb<int(nbox);cb++){
+    const unsigned box=boxmin+cb;
+    unsigned pos=BeginCell[box];
+    unsigned i=IncBeginCell[cb];
+    const unsigned ifin=IncBeginCell[cb+1];
+    unsigned c=IncListIni[cb];
+    const unsigned cfin=IncListIni[cb+1];
+    while(i<ifin || c<cfin){
+      if(i<ifin && CellPart[i]!=box)i++; //-Particle left the box. | La particula salio de la caja.
+      else{
+        const unsigned pc=(c<cfin? unsigned(IncList[c]&0xffffffffu): UINT_MAX);
+        if(i<ifin && i<pc){ SortPart[pos++]=i; i++; }
+        else{ SortPart[pos++]=pc; c++; }
+      }
+    }
+  }
+  SortArray(CellPart); //-Order values of CellPart[] | Ordena valores de CellPart[].
+  return(true);
 }
 
 //==============================================================================
@@ -231,13 +383,23 @@ void JCellDivCpuSingle::PreSort(const unsigned* dcellc,const typecode *codec){
   //-Load BeginCell[] with first particle of each cell.
   //-Carga SortPart[] con la p actual en los vectores de datos donde esta la particula que deberia ir en dicha posicion.
   //-Carga BeginCell[] con primera particula de cada celda.
+  //-Only particles that changed box are updated when the previous order can be used.
+  //-Solo se actualizan las particulas que cambiaron de caja cuando se puede usar el orden previo.
+  DivideInc=false;
+  if(IncOk && !DivideFull && !Npb2 && !Npf2 && Nptot==IncNp && Npb1==IncNpb && PreSortIncremental(dcellc,codec))return;
+  //-Uses several blocks of particles for parallel counting sort when it is worthwhile.
+  //-Usa varios bloques de particulas para ordenacion por conteo en paralelo cuando compensa.
+  const unsigned np=(DivideFull? Nptot: Npf1);
+  SortBlocks=GetSortBlocks(np,Nctt-1);
+  unsigned *partsblk=(SortBlocks>1? CheckMemorySortHist(SortBlocks,Nctt-1): PartsInCell);
   if(DivideFull){
-    PreSortFull(Nptot,dcellc,codec,CellPart,PartsInCell);
-    MakeSortFull(CellPart,BeginCell,PartsInCell,SortPart);
+    PreSortFull(Nptot,dcellc,codec,CellPart,SortBlocks,partsblk);
+    BeginCell[0]=0;
+    MakeSort(Nptot,0,0,CellPart,BeginCell,SortBlocks,partsblk,SortPart);
   }
   else{
-    PreSortFluid(Npf1,Npb1,dcellc,codec,CellPart,PartsInCell);
-    MakeSortFluid(Npf1,Npb1,CellPart,BeginCell,PartsInCell,SortPart);
+    PreSortFluid(Npf1,Npb1,dcellc,codec,CellPart,SortBlocks,partsblk);
+    MakeSort(Npf1,Npb1,BoxFluid,CellPart,BeginCell,SortBlocks,partsblk,SortPart);
   }
   SortArray(CellPart); //-Order values of CellPart[] | Ordena valores de CellPart[].
 }
@@ -322,6 +484,11 @@ void JCellDivCpuSingle::Divide(unsigned npb1,unsigned npf1,unsigned npb2,unsigne
 
   Ndiv++;
   if(DivideFull)NdivFull++;
+  if(DivideInc)NdivInc++;
+  //-The order of particles can be used by the next incremental divide.
+  //-El orden de particulas puede usarse en el siguiente divide incremental.
+  IncOk=(IncMaxFraction>0 && NpbFinal!=UINT_MAX);
+  IncNp=NpFinal; IncNpb=NpbFinal;
   TmcStop(timers,TMC_NlMakeSort);
 }
 
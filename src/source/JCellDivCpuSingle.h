@@ -35,12 +35,29 @@ protected:
   void MergeMapCellBoundFluid(const tuint3 &celbmin,const tuint3 &celbmax,const tuint3 &celfmin,const tuint3 &celfmax,tuint3 &celmin,tuint3 &celmax)const;
   void PrepareNct();
 
-  void PreSortFull(unsigned np,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned* partsincell)const;
-  void PreSortFluid(unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned* partsincell)const;
-  void MakeSortFull(const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const;
-  void MakeSortFluid(unsigned np,unsigned pini,const unsigned* cellpart,unsigned* begincell,unsigned* partsincell,unsigned* sortpart)const;
+  void PreSortFull(unsigned np,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned nblk,unsigned* partsblk)const;
+  void PreSortFluid(unsigned np,unsigned pini,const unsigned *dcellc,const typecode *codec,unsigned* cellpart,unsigned nblk,unsigned* partsblk)const;
+  void MakeSort(unsigned np,unsigned pini,unsigned boxini,const unsigned* cellpart,unsigned* begincell,unsigned nblk,unsigned* partsblk,unsigned* sortpart)const;
+  bool PreSortIncremental(const unsigned *dcellc,const typecode *codec);
   void PreSort(const unsigned* dcellc,const typecode *codec);
 
+  //==============================================================================
+  /// Returns box of fluid or floating particle for the divide of fluid.
+  /// Devuelve caja de particula fluid o floating para el divide del fluido.
+  //==============================================================================
+  inline unsigned FluidBox(unsigned rcell,typecode rcode)const{
+    //-Computes cell according position.
+    const unsigned cx=PC__Cellx(DomCellCode,rcell)-CellDomainMin.x;
+    const unsigned cy=PC__Celly(DomCellCode,rcell)-CellDomainMin.y;
+    const unsigned cz=PC__Cellz(DomCellCode,rcell)-CellDomainMin.z;
+    const unsigned cellsortfluid=BoxFluid+(cx<Ncx && cy<Ncy && cz<Ncz? cx+CellRow[cy+cz*Ncy]*Ncx: 0);
+    //-Checks particle code.
+    const typecode codetype=CODE_GetType(rcode);
+    const typecode codeout=CODE_GetSpecialValue(rcode);
+    //-Assigns box.
+    return(codeout<=CODE_OUTIGNORE?   (codeout<CODE_OUTIGNORE? cellsortfluid: BoxFluidOutIgnore):   (codetype==CODE_TYPE_FLOATING? BoxBoundOut: BoxFluidOut));
+  }
+
 public:
   JCellDivCpuSingle(bool stable,bool floating,byte periactive
     ,TpCellMode cellmode,float scell,tdouble3 mapposmin,tdouble3 mapposmax,tuint3 mapcells
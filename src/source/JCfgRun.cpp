@@ -44,8 +44,22 @@ void JCfgRun::Reset(){
   Stable=false;
   SvPosDouble=-1;
   OmpThreads=0;
+  OmpBind=0;
+  OmpSlabs=0;
+  CpuSymmetric=false;
+  CpuSimd=0;
+  CpuPosCell=0;
+  CpuNgList=0;
+  CpuSchedCost=false;
   SvTimers=true;
+  SvPerf=false;
+  SvPerfSkip=0;
+  SvAsync=0;
+  SvComp=-1;
+  SvCheckpoint=-1;
   CellMode=CELLMODE_2H;
+  CellOrder=CELLORDER_Row;
+  IncDivide=0;
   TBoundary=0; SlipMode=0; MdbcThreshold=-1;
   DomainMode=0;
   DomainFixedMin=DomainFixedMax=TDouble3(0);
@@ -56,9 +70,11 @@ void JCfgRun::Reset(){
   DDTValue=-1;
   Shifting=-1;
   SvRes=true; SvDomainVtk=false;
-  Sv_Binx=false; Sv_Info=false; Sv_Vtk=false; Sv_Csv=false;
+  Sv_Binx=false; Sv_Info=false; Sv_Vtk=false; Sv_Csv=false; Sv_Vtu=false;
+  SvVtuComp=false; SvVtuPieces=-1;
   CaseName=""; RunName=""; DirOut=""; DirDataOut=""; 
   PartBegin=0; PartBeginFirst=0; PartBeginDir="";
+  CheckpointFile="";
   TimeMax=-1; TimePart=-1;
   RhopOutModif=false; RhopOutMin=700; RhopOutMax=1300;
   FtPause=-1;
@@ -101,11 +117,59 @@ void JCfgRun::VisuInfo()const{
   printf("    -ompthreads:<int>  Only for CPU execution, indicates the number of threads\n");
   printf("                   by host for parallel execution, this takes the number of \n");
   printf("                   cores of the device by default (or using zero value)\n");
+  printf("    -ompbind:<mode>  Only for CPU execution on Linux, binds OpenMP threads\n");
+  printf("                   to cores before particle memory is initialised by them\n");
+  printf("        0          Disabled (by default)\n");
+  printf("        1          Close, threads fill the cores in order\n");
+  printf("        2          Spread, consecutive threads alternate between sockets\n");
+  printf("    -ompslabs:<int>  Only for CPU execution, splits the particles of the\n");
+  printf("                   interaction in slabs computed by groups of threads that\n");
+  printf("                   also initialise their memory, limits of slabs are moved\n");
+  printf("                   according to the measured time (number of sockets by\n");
+  printf("                   default when -ompbind is used). 0:Disabled (by default)\n");
   printf("\n");
 #endif
+  printf("    -cpusymmetric:<0/1>  Only for CPU execution, computes each fluid-fluid pair\n");
+  printf("                   once and applies the opposite contribution to the neighbour\n");
+  printf("                   (not available with floating bodies or symmetry)\n");
+  printf("    -cpusimd:<mode>  Only for CPU execution, particle interaction uses SoA\n");
+  printf("                   arrays and vectorised evaluation of neighbours\n");
+  printf("        0          Disabled (by default)\n");
+  printf("        1          Enabled\n");
+  printf("        2          Enabled and checked against scalar interaction (warning\n");
+  printf("                   when relative difference is over 1e-4)\n");
+  printf("    -cpuposcell:<mode>  Only for CPU execution, the scalar interaction uses\n");
+  printf("                   float positions relative to the origin of the cells instead\n");
+  printf("                   of double positions (not available with symmetry, -cpusimd,\n");
+  printf("                   -cpusymmetric or -cpunglist)\n");
+  printf("        0          Disabled (by default)\n");
+  printf("        1          Enabled\n");
+  printf("        2          Enabled and checked against interaction with double positions\n");
+  printf("    -cpunglist:<skin>  Only for CPU execution, particle interaction uses Verlet\n");
+  printf("                   neighbour lists with a skin distance (fraction of 2h) that\n");
+  printf("                   are built again when a particle moves more than skin/2\n");
+  printf("                   (0.2 by default, 0 disables, not available with periodic\n");
+  printf("                   conditions or inlet/outlet)\n");
+  printf("    -cpuschedcost:<0/1>  Only for CPU execution, particles of the interaction\n");
+  printf("                   are distributed among threads in chunks with equal work\n");
+  printf("                   estimated from the candidate neighbours of each cell\n");
+  printf("                   instead of equal number of particles (default=0)\n");
+  printf("\n");
   printf("    -cellmode:<mode>  Specifies the cell division mode\n");
   printf("        2h        Lowest and the least expensive in memory (by default)\n");
   printf("        h         Fastest and the most expensive in memory\n");
+  printf("    -cellorder:<order>  Only for CPU execution, order in memory of the rows\n");
+  printf("                   of cells along X according to their (Y,Z) position\n");
+  printf("        row       Row-major order (by default)\n");
+  printf("        morton    Morton (Z-order) curve\n");
+  printf("        hilbert   Hilbert curve\n");
+  printf("                   Morton and Hilbert change the order of particles\n");
+  printf("                   within cells and so the summation order, so results\n");
+  printf("                   are not guaranteed bit-identical to row order.\n");
+  printf("    -incdivide:<fraction>  Only for CPU execution, the divide of fluid\n");
+  printf("                   particles only updates the particles that change cell\n");
+  printf("                   when they are less than fraction of fluid particles\n");
+  printf("                   (0.02 when fraction is omitted). Disabled by default\n");
   printf("\n");
   printf("    -dbc           Dynamic Boundary Condition DBC (by default)\n");
   printf("    -mdbc          Modified Dynamic Boundary Condition mDBC (mode: vel=0)\n");
@@ -141,12 +205,31 @@ void JCfgRun::VisuInfo()const{
   printf("        info    Information about execution in .ibi4 format\n");
   printf("        vtk     VTK files\n");
   printf("        csv     CSV files\n");
+  printf("        vtu     VTK XML files (.vtu) saved by the built-in writer\n");
+  printf("    -svvtucomp:<0/1>  Compresses arrays of VTU files with LZ4 (default=0)\n");
+  printf("    -svvtupieces:<n>  Saves VTU files in n pieces saved in parallel with a .pvtu\n");
+  printf("                      file (-1=one .vtu file, 0=one piece per thread, default=-1)\n");
   printf("    -createdirs:<0/1> Creates full path for output files\n");
   printf("                      (value by default is read from DsphConfig.xml or 1)\n");
   printf("    -csvsep:<0/1>     Separator character in CSV files (0=semicolon, 1=coma)\n");
   printf("                      (value by default is read from DsphConfig.xml or 0)\n");
   printf("    -svres:<0/1>     Generates file that summarises the execution process\n");
   printf("    -svtimers:<0/1>  Obtains timing for each individual process\n");
+  printf("    -svperf:<0/1>    Only for CPU execution, saves performance counters of each\n");
+  printf("                     step in RunPerf.csv (timers, thread imbalance, pairs and\n");
+  printf("                     bytes moved)\n");
+  printf("    -svperfskip:<n>  Number of first steps (warm-up) not included in the totals\n");
+  printf("                     of performance counters (0 by default)\n");
+  printf("    -svasync[:n]     Saves PART data in a background thread with n buffered\n");
+  printf("                     PARTs, the simulation waits when all are pending (n=2 by\n");
+  printf("                     default, 0 disabled)\n");
+  printf("    -svcomp[:bits]   Saves compressed arrays in PART files sorted by Id. Without\n");
+  printf("                     bits it is lossless, with bits positions are quantised\n");
+  printf("                     with a step of Scell/2^bits (1-30)\n");
+  printf("    -svcheckpoint[:sec] Only for CPU execution, saves Checkpoint.cbi4 in the\n");
+  printf("                     output directory with the complete state of the simulation\n");
+  printf("                     every sec seconds of runtime and when the signal SIGUSR1\n");
+  printf("                     is received (without sec only on signal)\n");
   printf("    -svdomainvtk:<0/1>  Generates VTK file with domain limits\n");
   printf("    -name <string>      Specifies path and name of the case \n");
   printf("    -runname <string>   Specifies name for case execution\n");
@@ -156,6 +239,8 @@ void JCfgRun::VisuInfo()const{
   printf("     Specifies the beginning of the simulation starting from a given PART\n");
   printf("     (begin) and located in the directory (dir), (first) indicates the\n");
   printf("     number of the first PART to be generated\n\n");
+  printf("    -checkpoint <file>  Resumes the simulation from a checkpoint file saved with\n");
+  printf("     -svcheckpoint, the results are identical to the original execution\n\n");
   printf("    -rhopout:min:max Excludes fluid particles out of these density limits\n\n");
   printf("    -ftpause:<float> Time to start floating bodies movement. By default 0\n");
   printf("    -tmax:<float>   Maximum time of simulation\n");
@@ -182,13 +267,23 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  PartBegin",PartBegin,ln);
   PrintVar("  PartBeginFirst",PartBeginFirst,ln);
   PrintVar("  PartBeginDir",PartBeginDir,ln);
+  PrintVar("  CheckpointFile",CheckpointFile,ln);
   PrintVar("  Cpu",Cpu,ln);
   printf("  %s  %s\n",VarStr("Gpu",Gpu).c_str(),VarStr("GpuId",GpuId).c_str());
   PrintVar("  GpuFree",GpuFree,ln);
   PrintVar("  Stable",Stable,ln);
   PrintVar("  SvPosDouble",SvPosDouble,ln);
   PrintVar("  OmpThreads",OmpThreads,ln);
+  PrintVar("  OmpBind",OmpBind,ln);
+  PrintVar("  OmpSlabs",OmpSlabs,ln);
+  PrintVar("  CpuSymmetric",CpuSymmetric,ln);
+  PrintVar("  CpuSimd",CpuSimd,ln);
+  PrintVar("  CpuPosCell",CpuPosCell,ln);
+  PrintVar("  CpuNgList",CpuNgList,ln);
+  PrintVar("  CpuSchedCost",CpuSchedCost,ln);
   PrintVar("  CellMode",GetNameCellMode(CellMode),ln);
+  PrintVar("  CellOrder",GetNameCellOrder(CellOrder),ln);
+  PrintVar("  IncDivide",IncDivide,ln);
   PrintVar("  TStep",TStep,ln);
   PrintVar("  VerletSteps",VerletSteps,ln);
   PrintVar("  TKernel",TKernel,ln);
@@ -200,11 +295,19 @@ void JCfgRun::VisuConfig()const{
   PrintVar("  Shifting",Shifting,ln);
   PrintVar("  SvRes",SvRes,ln);
   PrintVar("  SvTimers",SvTimers,ln);
+  PrintVar("  SvPerf",SvPerf,ln);
+  PrintVar("  SvPerfSkip",SvPerfSkip,ln);
+  PrintVar("  SvAsync",SvAsync,ln);
+  PrintVar("  SvComp",SvComp,ln);
+  PrintVar("  SvCheckpoint",SvCheckpoint,ln);
   PrintVar("  SvDomainVtk",SvDomainVtk,ln);
   PrintVar("  Sv_Binx",Sv_Binx,ln);
   PrintVar("  Sv_Info",Sv_Info,ln);
   PrintVar("  Sv_Vtk",Sv_Vtk,ln);
   PrintVar("  Sv_Csv",Sv_Csv,ln);
+  PrintVar("  Sv_Vtu",Sv_Vtu,ln);
+  PrintVar("  SvVtuComp",SvVtuComp,ln);
+  PrintVar("  SvVtuPieces",SvVtuPieces,ln);
   PrintVar("  RhopOutModif",RhopOutModif,ln);
   if(RhopOutModif){
     PrintVar("  RhopOutMin",RhopOutMin,ln);
@@ -325,7 +428,29 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
       else if(txword=="OMPTHREADS"){ 
         OmpThreads=atoi(txoptfull.c_str()); if(OmpThreads<0)OmpThreads=0;
       } 
+      else if(txword=="OMPBIND"){ 
+        OmpBind=(txoptfull!=""? atoi(txoptfull.c_str()): 2);
+        if(OmpBind<0 || OmpBind>2)ErrorParm(opt,c,lv,file);
+      } 
+      else if(txword=="OMPSLABS"){ 
+        OmpSlabs=(txoptfull!=""? atoi(txoptfull.c_str()): -1);
+        if(OmpSlabs<-1 || OmpSlabs>OMP_MAXTHREADS)ErrorParm(opt,c,lv,file);
+      } 
 #endif
+      else if(txword=="CPUSYMMETRIC")CpuSymmetric=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="CPUSIMD"){
+        CpuSimd=(txoptfull!=""? atoi(txoptfull.c_str()): 1);
+        if(CpuSimd<0 || CpuSimd>2)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="CPUPOSCELL"){
+        CpuPosCell=(txoptfull!=""? atoi(txoptfull.c_str()): 1);
+        if(CpuPosCell<0 || CpuPosCell>2)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="CPUNGLIST"){
+        CpuNgList=(txoptfull!=""? float(atof(txoptfull.c_str())): 0.2f);
+        if(CpuNgList<0)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="CPUSCHEDCOST")CpuSchedCost=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="CELLMODE"){
         bool ok=true;
         if(!txoptfull.empty()){
@@ -337,6 +462,22 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
         else ok=false;
         if(!ok)ErrorParm(opt,c,lv,file);
       }
+      else if(txword=="CELLORDER"){
+        bool ok=true;
+        if(!txoptfull.empty()){
+          txoptfull=StrUpper(txoptfull);
+          if(txoptfull=="ROW")CellOrder=CELLORDER_Row;
+          else if(txoptfull=="MORTON")CellOrder=CELLORDER_Morton;
+          else if(txoptfull=="HILBERT")CellOrder=CELLORDER_Hilbert;
+          else ok=false;
+        }
+        else ok=false;
+        if(!ok)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="INCDIVIDE"){
+        IncDivide=(txoptfull!=""? float(atof(txoptfull.c_str())): 0.02f);
+        if(IncDivide<0 || IncDivide>1)ErrorParm(opt,c,lv,file);
+      }
       else if(txword=="DBC")          { TBoundary=1; SlipMode=0; }
       else if(txword=="MDBC")         { TBoundary=2; SlipMode=1; }
       else if(txword=="MDBC_NOSLIP")  { TBoundary=2; SlipMode=2; }
@@ -384,6 +525,30 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
       }
       else if(txword=="SVRES")SvRes=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SVTIMERS")SvTimers=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="SVPERF")SvPerf=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="SVPERFSKIP"){
+        const int v=atoi(txoptfull.c_str());
+        if(v<0)ErrorParm(opt,c,lv,file);
+        SvPerfSkip=unsigned(v);
+      }
+      else if(txword=="SVASYNC"){
+        const int v=(txoptfull!=""? atoi(txoptfull.c_str()): 2);
+        if(v<0)ErrorParm(opt,c,lv,file);
+        SvAsync=unsigned(v);
+      }
+      else if(txword=="SVCOMP"){
+        SvComp=(txoptfull!=""? atoi(txoptfull.c_str()): 0);
+        if(SvComp<0 || SvComp>30)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="SVVTUCOMP")SvVtuComp=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+      else if(txword=="SVVTUPIECES"){
+        SvVtuPieces=(txoptfull!=""? atoi(txoptfull.c_str()): 0);
+        if(SvVtuPieces<-1)ErrorParm(opt,c,lv,file);
+      }
+      else if(txword=="SVCHECKPOINT"){
+        SvCheckpoint=(txoptfull!=""? atof(txoptfull.c_str()): 0);
+        if(SvCheckpoint<0)ErrorParm(opt,c,lv,file);
+      }
       else if(txword=="SVDOMAINVTK")SvDomainVtk=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
       else if(txword=="SV"){
         string txop=StrUpper(txoptfull);
@@ -391,12 +556,13 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
           string op=fun::StrSplit(",",txop);
           if(op=="NONE"){ 
             SvDef=true; Sv_Binx=false; Sv_Info=false; 
-            Sv_Csv=false; Sv_Vtk=false;
+            Sv_Csv=false; Sv_Vtk=false; Sv_Vtu=false;
           }
           else if(op=="BINX"){    SvDef=true; Sv_Binx=true; }
           else if(op=="INFO"){    SvDef=true; Sv_Info=true; }
           else if(op=="VTK"){     SvDef=true; Sv_Vtk=true; }
           else if(op=="CSV"){     SvDef=true; Sv_Csv=true; }
+          else if(op=="VTU"){     SvDef=true; Sv_Vtu=true; }
           else ErrorParm(opt,c,lv,file);
         }
       }
@@ -416,6 +582,7 @@ void JCfgRun::LoadOpts(string *optlis,int optn,int lv,string file){
         }
         PartBeginDir=optlis[c+1]; c++; 
       }
+      else if(txword=="CHECKPOINT"&&c+1<optn){ CheckpointFile=optlis[c+1]; c++; }
       else if(txword=="RHOPOUT"){ 
         RhopOutMin=float(atof(txopt1.c_str())); 
         RhopOutMax=float(atof(txopt2.c_str())); 
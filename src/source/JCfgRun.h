@@ -70,8 +70,17 @@ public:
   int SvPosDouble;  ///<Saves particle position using double precision (default=0)
 
   int OmpThreads;
+  int OmpBind;        ///<Binding of OpenMP threads to cores 0:None, 1:Close, 2:Spread over sockets (default=0).
+  int OmpSlabs;       ///<Number of slabs of particles for the interaction on CPU, -1:Number of sockets, 0:Disabled (default=0).
+  bool CpuSymmetric;  ///<Fluid-Fluid interaction on CPU computes each pair once (default=0).
+  int CpuSimd;        ///<Interaction on CPU with SoA arrays and SIMD 0:No, 1:Yes, 2:Yes and checked against scalar path (default=0).
+  int CpuPosCell;     ///<Interaction on CPU with float positions relative to cells 0:No, 1:Yes, 2:Yes and checked against double path (default=0).
+  float CpuNgList;    ///<Skin distance (as a fraction of 2h) of Verlet neighbour lists on CPU, 0:Disabled (default=0).
+  bool CpuSchedCost;  ///<Chunks of particles of the interaction on CPU with equal estimated work from the occupancy of cells (default=0).
 
   TpCellMode  CellMode;
+  TpCellOrder CellOrder; ///<Order of the rows of cells in memory on CPU (default=CELLORDER_Row).
+  float IncDivide;       ///<Maximum fraction of fluid particles that change cell for an incremental divide on CPU, 0:Disabled (default=0).
   int TBoundary;        ///<Boundary method: 0:None, 1:DBC (by default), 2:mDBC (SlipMode: 1:DBC vel=0)
   int SlipMode;         ///<Slip mode for mDBC: 0:None, 1:DBC vel=0, 2:No-slip, 3:Free slip (default=1).
   float MdbcThreshold;  ///<Kernel support limit to apply mDBC correction (default=0).
@@ -86,10 +95,18 @@ public:
   float DDTValue; ///<Value used with Density Diffusion Term (default=0.1)
   int Shifting;   ///<Shifting mode -1:no defined, 0:none, 1:nobound, 2:nofixed, 3:full
   bool SvRes,SvTimers,SvDomainVtk;
-  bool Sv_Binx,Sv_Info,Sv_Csv,Sv_Vtk;
+  bool SvPerf;    ///<Saves performance counters of each step in RunPerf.csv (only CPU, default=0).
+  unsigned SvPerfSkip; ///<Number of first steps not included in the totals of performance counters (default=0).
+  unsigned SvAsync; ///<Number of PARTs buffered to be saved in background (0=disabled, default=0).
+  int SvComp;       ///<Compression of PART arrays (-1=disabled, 0=lossless, n=positions quantised with Scell/2^n, default=-1).
+  double SvCheckpoint; ///<Runtime between checkpoints in seconds (-1=disabled, 0=only on signal, default=-1).
+  bool Sv_Binx,Sv_Info,Sv_Csv,Sv_Vtk,Sv_Vtu;
+  bool SvVtuComp;   ///<Compresses arrays of VTU files with LZ4 (default=0).
+  int SvVtuPieces;  ///<Number of pieces of VTU files (-1=one .vtu file, 0=one piece per thread, default=-1).
   std::string CaseName,RunName,DirOut,DirDataOut;
   std::string PartBeginDir;
   unsigned PartBegin,PartBeginFirst;
+  std::string CheckpointFile;     ///<Checkpoint file to resume the simulation.
   float FtPause;
   bool RhopOutModif;              ///<Indicates whether \ref RhopOutMin or RhopOutMax is changed.
   float RhopOutMin,RhopOutMax;    ///<Limits for \ref RhopOut density correction.
@@ -146,6 +146,7 @@ std::string JGaugeItem::GetNameType(TpGauge type){
     case GAUGE_Swl:   return("SWL");
     case GAUGE_MaxZ:  return("MaxZ");
     case GAUGE_Force: return("Force");
+    case GAUGE_VelGrid: return("VelGrid");
   }
   return("???");
 }
@@ -180,6 +181,15 @@ void JGaugeItem::GetConfig(std::vector<std::string> &lines)const{
     lines.push_back(fun::PrintStr("MkBound.....: %u (%s particles)",gau->GetMkBound(),TpPartGetStrCode(gau->GetTypeParts())));
     lines.push_back(fun::PrintStr("Particles id: %u - %u",gau->GetIdBegin(),gau->GetIdBegin()+gau->GetCount()-1));
   }
+  else if(Type==GAUGE_VelGrid){
+    const JGaugeVelGrid* gau=(JGaugeVelGrid*)this;
+    const tuint3 n=gau->GetCountPoints();
+    lines.push_back(fun::PrintStr("Point0.....: (%g,%g,%g)",gau->GetPoint0().x,gau->GetPoint0().y,gau->GetPoint0().z));
+    lines.push_back(fun::PrintStr("Vec1.......: (%g,%g,%g)   Count:%u",gau->GetVec1().x,gau->GetVec1().y,gau->GetVec1().z,n.x));
+    if(n.y>1)lines.push_back(fun::PrintStr("Vec2.......: (%g,%g,%g)   Count:%u",gau->GetVec2().x,gau->GetVec2().y,gau->GetVec2().z,n.y));
+    if(n.z>1)lines.push_back(fun::PrintStr("Vec3.......: (%g,%g,%g)   Count:%u",gau->GetVec3().x,gau->GetVec3().y,gau->GetVec3().z,n.z));
+    lines.push_back(fun::PrintStr("Points.....: %u",gau->GetNpt()));
+  }
   else Run_Exceptioon("Type unknown.");
 }
 
@@ -245,6 +255,105 @@ float JGaugeItem::ComputePress(float rhop,float rhop0,float b,float gamma)const{
   return(b*(pow(rhop/rhop0,gamma)-1.0f));
 }
 
+//==============================================================================
+/// Computes the kernel sums of velocity and mass at one point with the same 
+/// loop and expressions as JGaugeVelocity::CalculeCpu() and 
+/// JGaugeSwl::CalculeMassCpu(), so the results are identical.
+/// The sums are added to sumvel and summass.
+///
+/// Calcula las sumas del kernel de velocidad y masa en un punto con el mismo 
+/// bucle y expresiones que JGaugeVelocity::CalculeCpu() y 
+/// JGaugeSwl::CalculeMassCpu(), asi los resultados son identicos.
+/// Las sumas se anhaden a sumvel y summass.
+//==============================================================================
+void JGaugeItem::CalculeSumsPointCpu(const tdouble3 &ptpos,const tint4 &nc,const tint3 &cellzero
+  ,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
+  ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop
+  ,tdouble3 &sumvel,double &summass)const
+{
+  const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
+  //-Obtain limits of interaction. | Obtiene limites de interaccion.
+  int cxini,cxfin,yini,yfin,zini,zfin;
+  GetInteractionCells(ptpos,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+
+  //-Auxiliary variables.
+  tdouble3 svel=TDouble3(0);
+  double smass=0;
+
+  //-Search for neighbors in adjacent cells.
+  //-Busqueda de vecinos en celdas adyacentes.
+  if(cxini<cxfin)for(int z=zini;z<zfin;z++){
+    const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
+    for(int y=yini;y<yfin;y++){
+      int ymod=cellfluid+nc.x*int(cellrow[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const unsigned pini=begincell[cxini+ymod];
+      const unsigned pfin=begincell[cxfin+ymod];
+
+      //-Interaction with Fluid/Floating | Interaccion con varias Fluid/Floating.
+      //--------------------------------------------------------------------------
+      bool rsym=false; //<vs_syymmetry>
+      for(unsigned p2=pini;p2<pfin;p2++){
+        const float drx=float(ptpos.x-pos[p2].x);
+              float dry=float(ptpos.y-pos[p2].y);
+        if(rsym)    dry=float(ptpos.y+pos[p2].y); //<vs_syymmetry>
+        const float drz=float(ptpos.z-pos[p2].z);
+        const float rr2=(drx*drx+dry*dry+drz*drz);
+        //-Interaction with real neighboring particles.
+        //-Interaccion con particulas vecinas reales.
+        if(rr2<=Fourh2 && rr2>=ALMOSTZERO && CODE_IsFluid(code[p2])){
+          float wab;
+          {//-Wendland kernel.
+            const float qq=sqrt(rr2)/H;
+            const float wqq=2.f*qq+1.f;
+            const float wqq1=1.f-0.5f*qq;
+            const float wqq2=wqq1*wqq1;
+            wab=Awen*wqq*wqq2*wqq2; //-Kernel.
+          }
+          tfloat4 velrhop2=velrhop[p2];
+          if(rsym)velrhop2.y=-velrhop2.y; //<vs_syymmetry>
+          wab*=MassFluid/velrhop2.w;
+          svel.x+=wab*velrhop2.x;
+          svel.y+=wab*velrhop2.y;
+          svel.z+=wab*velrhop2.z;
+          smass+=wab*MassFluid;
+          rsym=(rsymp1 && !rsym && float(ptpos.y-dry)<=H+H); //<vs_syymmetry>
+          if(rsym)p2--;                                       //<vs_syymmetry>
+        }
+        else rsym=false;                                      //<vs_syymmetry>
+      }
+    }
+  }
+  sumvel=sumvel+svel;
+  summass+=smass;
+}
+
+//==============================================================================
+/// Computes the kernel sums of velocity and mass at the indicated points. All
+/// points must belong to the same cell, so the neighbouring particles are 
+/// reused from cache. Each point uses CalculeSumsPointCpu() and the results are
+/// identical to JGaugeVelocity::CalculeCpu() and JGaugeSwl::CalculeMassCpu().
+/// A single sweep for all points was discarded since the compiler groups the
+/// products in a different way (-ffast-math) and the last digit changes.
+/// The sums are added to sumvel[] and summass[].
+///
+/// Calcula las sumas del kernel de velocidad y masa en los puntos indicados.
+/// Todos los puntos deben pertenecer a la misma celda, asi las particulas 
+/// vecinas se reutilizan de la cache. Cada punto usa CalculeSumsPointCpu() y 
+/// los resultados son identicos a JGaugeVelocity::CalculeCpu() y 
+/// JGaugeSwl::CalculeMassCpu(). Se descarto un solo recorrido para todos los 
+/// puntos porque el compilador agrupa los productos de otra forma (-ffast-math)
+/// y cambia la ultima cifra. Las sumas se anhaden a sumvel[] y summass[].
+//==============================================================================
+void JGaugeItem::CalculeSumsCpu(unsigned npt,const tdouble3 *ptpos,const tint4 &nc,const tint3 &cellzero
+  ,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
+  ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop
+  ,tdouble3 *sumvel,double *summass)const
+{
+  for(unsigned cp=0;cp<npt;cp++){
+    CalculeSumsPointCpu(ptpos[cp],nc,cellzero,cellfluid,begincell,cellrow,pos,code,velrhop,sumvel[cp],summass[cp]);
+  }
+}
+
 
 //##############################################################################
 //# JGaugeVelocity
@@ -350,8 +459,8 @@ unsigned JGaugeVelocity::GetPointDef(std::vector<tfloat3> &points)const{
 /// Calculates velocity at indicated points (on CPU).
 //==============================================================================
 void JGaugeVelocity::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const unsigned *begincell,const unsigned *cellrow,unsigned,unsigned,unsigned
+  ,const tdouble3 *pos,const typecode *code,const unsigned*,const tfloat4 *velrhop)
 {
   SetTimeStep(timestep);
   //-Start measure.
@@ -373,9 +482,9 @@ void JGaugeVelocity::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
     //-Search for neighbors in adjacent cells.
     //-Busqueda de vecinos en celdas adyacentes.
     if(cxini<cxfin)for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
+        int ymod=cellfluid+nc.x*int(cellrow[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
         const unsigned pini=begincell[cxini+ymod];
         const unsigned pfin=begincell[cxfin+ymod];
 
@@ -430,6 +539,26 @@ void JGaugeVelocity::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   if(Output(timestep))StoreResult();
 }
 
+//==============================================================================
+/// Loads the point for batched calculation on CPU and returns number of points.
+/// The point out of domain is skipped.
+//==============================================================================
+unsigned JGaugeVelocity::GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const{
+  points.push_back(Point);
+  skip.push_back(PointIsOut(Point.x,Point.y,Point.z)? 1: 0);
+  return(1);
+}
+
+//==============================================================================
+/// Stores the result of batched calculation on CPU.
+//==============================================================================
+void JGaugeVelocity::SetBatchResult(double timestep,const tdouble3 *sumvel,const double*){
+  SetTimeStep(timestep);
+  //-Stores result. | Guarda resultado.
+  Result.Set(timestep,ToTFloat3(Point),ToTFloat3(sumvel[0]));
+  if(Output(timestep))StoreResult();
+}
+
 #ifdef _WITHGPU
 //==============================================================================
 /// Calculates velocity at indicated points (on GPU).
@@ -592,7 +721,7 @@ unsigned JGaugeSwl::GetPointDef(std::vector<tfloat3> &points)const{
 /// pertenecer al dominio de celdas.
 //==============================================================================
 float JGaugeSwl::CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
-  ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell
+  ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
   ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)const
 {
   const bool rsymp1=(Symmetry && (ptpos.y<=H+H)); //<vs_syymmetry>
@@ -607,9 +736,9 @@ float JGaugeSwl::CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
   //-Search for neighbors in adjacent cells.
   //-Busqueda de vecinos en celdas adyacentes.
   if(cxini<cxfin)for(int z=zini;z<zfin;z++){
-    const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+    const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
     for(int y=yini;y<yfin;y++){
-      int ymod=zmod+nc.x*y;
+      int ymod=cellfluid+nc.x*int(cellrow[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
       const unsigned pini=begincell[cxini+ymod];
       const unsigned pfin=begincell[cxfin+ymod];
 
@@ -653,8 +782,8 @@ float JGaugeSwl::CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
 /// Calculates surface water level at indicated points (on CPU).
 //==============================================================================
 void JGaugeSwl::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const unsigned *begincell,const unsigned *cellrow,unsigned,unsigned,unsigned
+  ,const tdouble3 *pos,const typecode *code,const unsigned*,const tfloat4 *velrhop)
 {
   SetTimeStep(timestep);
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
@@ -666,7 +795,7 @@ void JGaugeSwl::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   float mpre=0;
   tdouble3 ptpos=Point0;
   for(unsigned cp=0;cp<=PointNp;cp++){
-    const float mass=CalculeMassCpu(ptpos,nc,cellzero,cellfluid,begincell,pos,code,velrhop);
+    const float mass=CalculeMassCpu(ptpos,nc,cellzero,cellfluid,begincell,cellrow,pos,code,velrhop);
     if(mass>MassLimit)mpre=mass;
     if(mass<MassLimit && mpre){
       const float fxm1=(MassLimit-mpre)/(mass-mpre)-1;
@@ -682,6 +811,44 @@ void JGaugeSwl::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   if(Output(timestep))StoreResult();
 }
 
+//==============================================================================
+/// Loads the points for batched calculation on CPU and returns number of points.
+//==============================================================================
+unsigned JGaugeSwl::GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const{
+  tdouble3 ptpos=Point0;
+  for(unsigned cp=0;cp<=PointNp;cp++){
+    points.push_back(ptpos);
+    skip.push_back(0);
+    ptpos=ptpos+PointDir;
+  }
+  return(PointNp+1);
+}
+
+//==============================================================================
+/// Stores the result of batched calculation on CPU.
+//==============================================================================
+void JGaugeSwl::SetBatchResult(double timestep,const tdouble3*,const double *summass){
+  SetTimeStep(timestep);
+  //-Look for change of fluid to empty. | Busca paso de fluido a vacio.
+  tdouble3 ptsurf=TDouble3(DBL_MAX);
+  float mpre=0;
+  tdouble3 ptpos=Point0;
+  for(unsigned cp=0;cp<=PointNp;cp++){
+    const float mass=float(summass[cp]);
+    if(mass>MassLimit)mpre=mass;
+    if(mass<MassLimit && mpre){
+      const float fxm1=(MassLimit-mpre)/(mass-mpre)-1;
+      ptsurf=ptpos+(PointDir*double(fxm1));
+      cp=PointNp+1;
+    }
+    ptpos=ptpos+PointDir;
+  }
+  if(ptsurf.x==DBL_MAX)ptsurf=Point0+(PointDir*(mpre? PointNp: 0));
+  //-Stores result. | Guarda resultado.
+  Result.Set(timestep,ToTFloat3(Point0),ToTFloat3(Point2),ToTFloat3(ptsurf));
+  if(Output(timestep))StoreResult();
+}
+
 #ifdef _WITHGPU
 //==============================================================================
 /// Calculates surface water level at indicated points (on GPU).
@@ -848,8 +1015,8 @@ void JGaugeMaxZ::GetInteractionCellsMaxZ(const tdouble3 &pos,const tint4 &nc,con
 /// Calculates maximum z of fluid at distance of a vertical line (on CPU).
 //==============================================================================
 void JGaugeMaxZ::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
-  ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
+  ,const unsigned *begincell,const unsigned *cellrow,unsigned,unsigned,unsigned
+  ,const tdouble3 *pos,const typecode *code,const unsigned*,const tfloat4*)
 {
   //Log->Printf("JGaugeMaxZ----> timestep:%g  (%d)",timestep,(DG?1:0));
   SetTimeStep(timestep);
@@ -866,9 +1033,9 @@ void JGaugeMaxZ::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
   float zmax=-FLT_MAX;
   //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
   if(cxini<cxfin)for(int z=zfin-1;z>=zini && pmax==UINT_MAX;z--){
-    const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+    const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
     for(int y=yini;y<yfin;y++){
-      int ymod=zmod+nc.x*y;
+      int ymod=cellfluid+nc.x*int(cellrow[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
       const unsigned pini=begincell[cxini+ymod];
       const unsigned pfin=begincell[cxfin+ymod];
 
@@ -1057,7 +1224,7 @@ unsigned JGaugeForce::GetPointDef(std::vector<tfloat3> &points)const{
 /// Ignores periodic boundary particles to avoid race condition problems.
 //==============================================================================
 void JGaugeForce::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-  ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned,unsigned np
   ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
 {
   if(!Cpu)Run_Exceptioon("Method is not allowed for GPU executions.");
@@ -1085,9 +1252,9 @@ void JGaugeForce::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
 
     //-Search for neighbors in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
     if(cxini<cxfin)for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
+        int ymod=cellfluid+nc.x*int(cellrow[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
         const unsigned pini=begincell[cxini+ymod];
         const unsigned pfin=begincell[cxfin+ymod];
 
@@ -1197,3 +1364,226 @@ void JGaugeForce::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
 
 
 
+
+
+//##############################################################################
+//# JGaugeVelGrid
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JGaugeVelGrid::JGaugeVelGrid(unsigned idx,std::string name,tdouble3 point0
+  ,tdouble3 vec1,tdouble3 vec2,tdouble3 vec3,tuint3 count,bool cpu,JLog2* log)
+  :JGaugeItem(GAUGE_VelGrid,idx,name,cpu,log)
+{
+  ClassName="JGaugeVelGrid";
+  FileInfo=string("Saves velocity data measured from fluid particles on a grid of points (by ")+ClassName+").";
+  Reset();
+  SetPoints(point0,vec1,vec2,vec3,count);
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JGaugeVelGrid::~JGaugeVelGrid(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JGaugeVelGrid::Reset(){
+  SetPoints(TDouble3(0),TDouble3(0),TDouble3(0),TDouble3(0),TUint3(1));
+  OutTime.clear();
+  OutBuff.clear();
+  JGaugeItem::Reset();
+}
+
+//==============================================================================
+/// Changes points definition. The points are sorted by first direction, then
+/// second direction and then third direction.
+//==============================================================================
+void JGaugeVelGrid::SetPoints(const tdouble3 &point0,const tdouble3 &vec1
+  ,const tdouble3 &vec2,const tdouble3 &vec3,const tuint3 &count)
+{
+  if(!count.x || !count.y || !count.z)Run_Exceptioon(fun::PrintStr("The number of points of gauge \'%s\' is invalid.",Name.c_str()));
+  Point0=point0;
+  Vec1=vec1;
+  Vec2=vec2;
+  Vec3=vec3;
+  Count=count;
+  Npt=Count.x*Count.y*Count.z;
+  Points.resize(Npt);
+  unsigned cp=0;
+  for(unsigned k=0;k<Count.z;k++)for(unsigned j=0;j<Count.y;j++)for(unsigned i=0;i<Count.x;i++){
+    Points[cp]=Point0+(Vec1*double(i))+(Vec2*double(j))+(Vec3*double(k));
+    cp++;
+  }
+  //-Results in buffer are not valid for the new points.
+  OutTime.clear();
+  OutBuff.clear();
+  OutCount=0;
+  ClearResult();
+}
+
+//==============================================================================
+/// Clears the last measure result.
+//==============================================================================
+void JGaugeVelGrid::ClearResult(){
+  ResultTime=0;
+  ResultVel.assign(Npt,TFloat3(0));
+}
+
+//==============================================================================
+/// Record the last measure result.
+//==============================================================================
+void JGaugeVelGrid::StoreResult(){
+  if(OutputSave){
+    //-Allocates memory.
+    if(unsigned(OutTime.size())<OutSize){
+      OutTime.resize(OutSize);
+      OutBuff.resize(size_t(OutSize)*Npt);
+    }
+    //-Empty buffer.
+    if(OutCount+1>=OutSize)SaveResults();
+    //-Stores last results.
+    OutTime[OutCount]=ResultTime;
+    std::copy(ResultVel.begin(),ResultVel.end(),OutBuff.begin()+size_t(Npt)*OutCount);
+    OutCount++;
+    //-Updates OutputNext.
+    if(OutputDt){
+      const unsigned nt=unsigned(TimeStep/OutputDt);
+      OutputNext=OutputDt*nt;
+      if(OutputNext<=TimeStep)OutputNext=OutputDt*(nt+1);
+    }
+  }
+}
+
+//==============================================================================
+/// Saves stored results in CSV file. Each row contains the velocity of all
+/// points in the order of GetPointDef().
+//==============================================================================
+void JGaugeVelGrid::SaveResults(){
+  if(OutCount){
+    const bool first=OutFile.empty();
+    if(first){
+      OutFile=GetResultsFileCsv();
+      Log->AddFileInfo(OutFile,FileInfo);
+    }
+    jcsv::JSaveCsv2 scsv(OutFile,!first,AppInfo.GetCsvSepComa());
+    //-Saves head.
+    if(first){
+      scsv.SetHead();
+      scsv << "time [s]";
+      for(unsigned cp=0;cp<Npt;cp++)scsv << fun::PrintStr("velx_%u [m/s];vely_%u [m/s];velz_%u [m/s]",cp,cp,cp);
+      scsv << jcsv::Endl();
+    }
+    //-Saves data.
+    scsv.SetData();
+    scsv << jcsv::Fmt(jcsv::TpFloat1,"%g") << jcsv::Fmt(jcsv::TpFloat3,"%g;%g;%g");
+    for(unsigned c=0;c<OutCount;c++){
+      scsv << OutTime[c];
+      const tfloat3 *vel=OutBuff.data()+size_t(Npt)*c;
+      for(unsigned cp=0;cp<Npt;cp++)scsv << vel[cp];
+      scsv << jcsv::Endl();
+    }
+    OutCount=0;
+  }
+}
+
+//==============================================================================
+/// Saves last result in VTK file.
+//==============================================================================
+void JGaugeVelGrid::SaveVtkResult(unsigned cpart){
+  if(JVtkLib::Available()){
+    //-Prepares data.
+    std::vector<tfloat3> pos;
+    GetPointDef(pos);
+    JDataArrays arrays;
+    arrays.AddArray("Pos",Npt,pos.data(),false);
+    arrays.AddArray("Vel",Npt,ResultVel.data(),false);
+    Log->AddFileInfo(fun::FileNameSec(GetResultsFileVtk(),UINT_MAX),FileInfo);
+    JVtkLib::SaveVtkData(fun::FileNameSec(GetResultsFileVtk(),cpart),arrays,"Pos");
+  }
+}
+
+//==============================================================================
+/// Loads and returns number definition points.
+//==============================================================================
+unsigned JGaugeVelGrid::GetPointDef(std::vector<tfloat3> &points)const{
+  for(unsigned cp=0;cp<Npt;cp++)points.push_back(ToTFloat3(Points[cp]));
+  return(Npt);
+}
+
+//==============================================================================
+/// Loads the points for batched calculation on CPU and returns number of points.
+/// The points out of domain are skipped.
+//==============================================================================
+unsigned JGaugeVelGrid::GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const{
+  for(unsigned cp=0;cp<Npt;cp++){
+    const tdouble3 pt=Points[cp];
+    points.push_back(pt);
+    skip.push_back(PointIsOut(pt.x,pt.y,pt.z)? 1: 0);
+  }
+  return(Npt);
+}
+
+//==============================================================================
+/// Stores the result of batched calculation on CPU.
+//==============================================================================
+void JGaugeVelGrid::SetBatchResult(double timestep,const tdouble3 *sumvel,const double*){
+  SetTimeStep(timestep);
+  //-Stores result. | Guarda resultado.
+  ResultTime=timestep;
+  for(unsigned cp=0;cp<Npt;cp++)ResultVel[cp]=ToTFloat3(sumvel[cp]);
+  if(Output(timestep))StoreResult();
+}
+
+//==============================================================================
+/// Calculates velocity at the points of the grid (on CPU).
+//==============================================================================
+void JGaugeVelGrid::CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const unsigned *begincell,const unsigned *cellrow,unsigned,unsigned,unsigned
+  ,const tdouble3 *pos,const typecode *code,const unsigned*,const tfloat4 *velrhop)
+{
+  SetTimeStep(timestep);
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  for(unsigned cp=0;cp<Npt;cp++){
+    const tdouble3 pt=Points[cp];
+    tdouble3 sumvel=TDouble3(0);
+    double summass=0;
+    if(!PointIsOut(pt.x,pt.y,pt.z))CalculeSumsCpu(1,&pt,nc,cellzero,cellfluid,begincell,cellrow,pos,code,velrhop,&sumvel,&summass);
+    ResultVel[cp]=ToTFloat3(sumvel);
+  }
+  //-Stores result. | Guarda resultado.
+  ResultTime=timestep;
+  if(Output(timestep))StoreResult();
+}
+
+#ifdef _WITHGPU
+//==============================================================================
+/// Calculates velocity at the points of the grid (on GPU).
+//==============================================================================
+void JGaugeVelGrid::CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+  ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+  ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux)
+{
+  SetTimeStep(timestep);
+  for(unsigned cp=0;cp<Npt;cp++){
+    const tdouble3 pt=Points[cp];
+    tfloat3 ptvel=TFloat3(0);
+    if(!PointIsOut(pt.x,pt.y,pt.z)){
+      cugauge::Interaction_GaugeVel(Symmetry,pt,Awen,Hdiv,ncells,cellmin,beginendcell,posxy,posz,code,velrhop,aux,DomPosMin,Scell,Fourh2,H,MassFluid);
+      cudaMemcpy(&ptvel,aux,sizeof(float3),cudaMemcpyDeviceToHost);
+    }
+    ResultVel[cp]=ptvel;
+  }
+  Check_CudaErroor("Failed in velocity calculation.");
+  //-Stores result. | Guarda resultado.
+  ResultTime=timestep;
+  if(Output(timestep))StoreResult();
+}
+#endif
@@ -22,6 +22,10 @@
 //:# - Clase para medir magnitudes fisicas durante la simulacion. (12-02-2018)
 //:# - Se escriben las unidades en las cabeceras de los ficheros CSV. (26-04-2018)
 //:# - Gestion de excepciones mejorada.  (15-09-2019)
+//:# - Permite consultar y restaurar los instantes del siguiente calculo y salida. (17-10-2026)
+//:# - CalculeCpu() recibe la posicion en memoria de cada fila de celdas. (17-10-2026)
+//:# - Calculo por lotes en CPU de los puntos de Vel, SWL y VelGrid. (17-10-2026)
+//:# - Nuevo tipo de gauge VelGrid con una malla de puntos (linea, plano o volumen). (17-10-2026)
 //:#############################################################################
 
 /// \file JGaugeItem.h \brief Declares the class \ref JGaugeItem.
@@ -75,6 +79,7 @@ public:
     ,GAUGE_Swl
     ,GAUGE_MaxZ
     ,GAUGE_Force
+    ,GAUGE_VelGrid
   }TpGauge;
 
   ///Structure with default configuration for JGaugeItem objects.
@@ -178,13 +183,29 @@ public:
   double GetOutputStart()const{ return(OutputStart); }
   double GetOutputEnd()const{ return(OutputEnd); }
 
+  double GetComputeNext()const{ return(ComputeNext); }
+  double GetOutputNext()const{ return(OutputNext); }
+  void SetTimeNext(double timestep,double computenext,double outputnext){ TimeStep=timestep; ComputeNext=computenext; OutputNext=outputnext; }
+
   bool Update(double timestep)const{ return(timestep>=ComputeNext && ComputeStart<=timestep && timestep<=ComputeEnd); }
   bool Output(double timestep)const{ return(OutputSave && timestep>=OutputNext && OutputStart<=timestep && timestep<=OutputEnd); }
 
   virtual void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)=0;
 
+  //-Batched calculation on CPU (by JGaugeSystem). | Calculo por lotes en CPU (por JGaugeSystem).
+  virtual unsigned GetBatchPoints(std::vector<tdouble3>&,std::vector<byte>&)const{ return(0); }
+  virtual void SetBatchResult(double,const tdouble3*,const double*){}
+  void CalculeSumsPointCpu(const tdouble3 &ptpos,const tint4 &nc,const tint3 &cellzero
+    ,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
+    ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop
+    ,tdouble3 &sumvel,double &summass)const;
+  void CalculeSumsCpu(unsigned npt,const tdouble3 *ptpos,const tint4 &nc,const tint3 &cellzero
+    ,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
+    ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop
+    ,tdouble3 *sumvel,double *summass)const;
+
  #ifdef _WITHGPU
   virtual void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
     ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
@@ -241,8 +262,11 @@ public:
 
   void SetPoint(const tdouble3 &point){ ClearResult(); Point=point; }
 
+  unsigned GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const;
+  void SetBatchResult(double timestep,const tdouble3 *sumvel,const double *summass);
+
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
 
  #ifdef _WITHGPU
@@ -295,7 +319,7 @@ protected:
   void ClearResult(){ Result.Reset(); }
   void StoreResult();
   float CalculeMassCpu(const tdouble3 &ptpos,const tint4 &nc
-    ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell
+    ,const tint3 &cellzero,unsigned cellfluid,const unsigned *begincell,const unsigned *cellrow
     ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)const;
 
 public:
@@ -314,8 +338,11 @@ public:
 
   void SetPoints(const tdouble3 &point0,const tdouble3 &point2,double pointdp);
 
+  unsigned GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const;
+  void SetBatchResult(double timestep,const tdouble3 *sumvel,const double *summass);
+
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
 
  #ifdef _WITHGPU
@@ -383,7 +410,7 @@ public:
   void SetDistLimit(float distlimit){        ClearResult(); DistLimit=distlimit; }
 
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
 
  #ifdef _WITHGPU
@@ -459,7 +486,71 @@ public:
   const StGaugeForceRes& GetResult()const{ return(Result); }
 
   void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
+    ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
+
+ #ifdef _WITHGPU
+  void CalculeGpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const int2 *beginendcell,unsigned npbok,unsigned npb,unsigned np
+    ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop,float3 *aux);
+ #endif
+};
+
+
+//##############################################################################
+//# JGaugeVelGrid
+//##############################################################################
+/// \brief Calculates velocity in fluid domain at a grid of points (line, plane or volume).
+class JGaugeVelGrid : public JGaugeItem
+{
+protected:
+  //-Definition.
+  tdouble3 Point0;   ///<First point of the grid.
+  tdouble3 Vec1;     ///<Distance between points along first direction.
+  tdouble3 Vec2;     ///<Distance between points along second direction.
+  tdouble3 Vec3;     ///<Distance between points along third direction.
+  tuint3 Count;      ///<Number of points along each direction.
+  //-Auxiliary variables.
+  unsigned Npt;                  ///<Number of points (Count.x*Count.y*Count.z).
+  std::vector<tdouble3> Points;  ///<Points of the grid [Npt].
+
+  //-Result of the last measure.
+  double ResultTime;
+  std::vector<tfloat3> ResultVel;  ///<Velocity at each point [Npt].
+
+  std::vector<double> OutTime;   ///<Time of results in buffer [OutSize].
+  std::vector<tfloat3> OutBuff;  ///<Results in buffer [OutSize*Npt].
+
+  void Reset();
+  void ClearResult();
+  void StoreResult();
+
+public:
+  JGaugeVelGrid(unsigned idx,std::string name,tdouble3 point0
+    ,tdouble3 vec1,tdouble3 vec2,tdouble3 vec3,tuint3 count,bool cpu,JLog2* log);
+  ~JGaugeVelGrid();
+
+  void SaveResults();
+  void SaveVtkResult(unsigned cpart);
+  unsigned GetPointDef(std::vector<tfloat3> &points)const;
+
+  tdouble3 GetPoint0()const{ return(Point0); }
+  tdouble3 GetVec1()const{ return(Vec1); }
+  tdouble3 GetVec2()const{ return(Vec2); }
+  tdouble3 GetVec3()const{ return(Vec3); }
+  tuint3 GetCountPoints()const{ return(Count); }
+  unsigned GetNpt()const{ return(Npt); }
+  double GetResultTime()const{ return(ResultTime); }
+  const tfloat3* GetResultVel()const{ return(ResultVel.data()); }
+
+  void SetPoints(const tdouble3 &point0,const tdouble3 &vec1
+    ,const tdouble3 &vec2,const tdouble3 &vec3,const tuint3 &count);
+
+  unsigned GetBatchPoints(std::vector<tdouble3> &points,std::vector<byte> &skip)const;
+  void SetBatchResult(double timestep,const tdouble3 *sumvel,const double *summass);
+
+  void CalculeCpu(double timestep,tuint3 ncells,tuint3 cellmin
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
 
  #ifdef _WITHGPU
@@ -27,6 +27,7 @@
 #include "JSphMk.h"
 #include "JDataArrays.h"
 #include "JVtkLib.h"
+#include "OmpDefs.h"
 #include <cfloat>
 #include <climits>
 #include <algorithm>
@@ -74,6 +75,11 @@ void JGaugeSystem::Reset(){
   ResetCfgDefault();
   for(unsigned c=0;c<Gauges.size();c++)delete Gauges[c];
   Gauges.clear();
+  BatchGauges.clear();  BatchPtIni.clear();
+  BatchPos.clear();     BatchSkip.clear();   BatchCell.clear();
+  BatchSort.clear();    BatchGroup.clear();  BatchSortPos.clear();
+  BatchSortVel.clear(); BatchSortMass.clear();
+  BatchSumVel.clear();  BatchSumMass.clear();
  #ifdef _WITHGPU
   if(AuxMemoryg)cudaFree(AuxMemoryg); AuxMemoryg=NULL;
  #endif
@@ -271,6 +277,18 @@ void JGaugeSystem::ReadXml(const JXml *sxml,TiXmlElement* lis,const JSphMk* mkin
           const word mkbound=(word)sxml->ReadElementUnsigned(ele,"target","mkbound");
           gau=AddGaugeForce(name,cfg.computestart,cfg.computeend,cfg.computedt,mkinfo,mkbound);
         }
+        else if(cmd=="velgrid"){
+          //-Reads first point and step and number of points along each direction (vec2 and vec3 are optional).
+          const tdouble3 pt0=sxml->ReadElementDouble3(ele,"point0");
+          const tdouble3 vec1=sxml->ReadElementDouble3(ele,"vec1");
+          const tdouble3 vec2=sxml->ReadElementDouble3(ele,"vec2",true);
+          const tdouble3 vec3=sxml->ReadElementDouble3(ele,"vec3",true);
+          const tuint3 count=TUint3(sxml->ReadElementUnsigned(ele,"vec1","count")
+            ,sxml->ReadElementUnsigned(ele,"vec2","count",true,1)
+            ,sxml->ReadElementUnsigned(ele,"vec3","count",true,1));
+          if(!count.x || !count.y || !count.z)Run_ExceptioonFile("The number of points (count) must be greater than zero.",sxml->ErrGetFileRow(ele));
+          gau=AddGaugeVelGrid(name,cfg.computestart,cfg.computeend,cfg.computedt,pt0,vec1,vec2,vec3,count);
+        }
         else Run_ExceptioonFile(fun::PrintStr("Gauge type \'%s\' is invalid.",cmd.c_str()),sxml->ErrGetFileRow(ele));
         gau->SetSaveVtkPart(cfg.savevtkpart);
         //gau->ConfigComputeTiming(cfg.computestart,cfg.computeend,cfg.computedt);
@@ -366,6 +384,25 @@ JGaugeForce* JGaugeSystem::AddGaugeForce(std::string name,double computestart
   return(gau);
 }
 
+//==============================================================================
+/// Creates new gauge-VelGrid and returns pointer.
+//==============================================================================
+JGaugeVelGrid* JGaugeSystem::AddGaugeVelGrid(std::string name,double computestart
+  ,double computeend,double computedt,tdouble3 point0,tdouble3 vec1,tdouble3 vec2
+  ,tdouble3 vec3,tuint3 count)
+{
+  if(GetGaugeIdx(name)!=UINT_MAX)Run_Exceptioon(fun::PrintStr("The name \'%s\' already exists.",name.c_str()));
+  //-Creates object.
+  JGaugeVelGrid* gau=new JGaugeVelGrid(GetCount(),name,point0,vec1,vec2,vec3,count,Cpu,Log);
+  gau->Config(Simulate2D,Symmetry,DomPosMin,DomPosMax,Scell,Hdiv,H,MassFluid,MassBound,Cs0,CteB,Gamma,RhopZero);
+  gau->ConfigComputeTiming(computestart,computeend,computedt);
+  //-Uses common configuration.
+  gau->SetSaveVtkPart(CfgDefault.savevtkpart);
+  gau->ConfigOutputTiming(CfgDefault.output,CfgDefault.outputstart,CfgDefault.outputend,CfgDefault.outputdt);
+  Gauges.push_back(gau);
+  return(gau);
+}
+
 //==============================================================================
 /// Shows object configuration using Log.
 //==============================================================================
@@ -447,17 +484,124 @@ JGaugeItem* JGaugeSystem::GetGauge(unsigned c)const{
 }
 
 //==============================================================================
-/// Updates results on gauges (on CPU).
+/// Compares points of the batch by cell (z, y, x) and by index.
+/// Compara puntos del lote por celda (z, y, x) y por indice.
+//==============================================================================
+struct StGaugeBatchCellLess{
+  const tint3 *Cell;
+  StGaugeBatchCellLess(const tint3 *cell):Cell(cell){}
+  bool operator()(unsigned a,unsigned b)const{
+    const tint3 ca=Cell[a],cb=Cell[b];
+    if(ca.z!=cb.z)return(ca.z<cb.z);
+    if(ca.y!=cb.y)return(ca.y<cb.y);
+    if(ca.x!=cb.x)return(ca.x<cb.x);
+    return(a<b);
+  }
+};
+
+//==============================================================================
+/// Computes the kernel sums of all points of the batch (on CPU). The points are
+/// sorted by cell and the points of each group in the same cell are computed 
+/// one after another, so the neighbouring particles are reused from cache. The
+/// groups are computed in parallel and the results are stored in BatchSumVel[]
+/// and BatchSumMass[].
+///
+/// Calcula las sumas del kernel de todos los puntos del lote (en CPU). Los 
+/// puntos se ordenan por celda y los puntos de cada grupo en la misma celda se
+/// calculan uno tras otro, asi las particulas vecinas se reutilizan de la 
+/// cache. Los grupos se calculan en paralelo y los resultados se guardan en 
+/// BatchSumVel[] y BatchSumMass[].
+//==============================================================================
+void JGaugeSystem::CalculeBatchCpu(tuint3 ncells,tuint3 cellmin,const unsigned *begincell
+  ,const unsigned *cellrow,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop)
+{
+  const unsigned npt=unsigned(BatchPos.size());
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  //-Computes cell of points and sorts the points by cell.
+  //-Calcula celda de los puntos y ordena los puntos por celda.
+  BatchCell.resize(npt);
+  BatchSort.clear();
+  for(unsigned p=0;p<npt;p++)if(!BatchSkip[p]){
+    const tdouble3 ps=BatchPos[p];
+    BatchCell[p]=TInt3(int((ps.x-DomPosMin.x)/Scell)-cellzero.x,int((ps.y-DomPosMin.y)/Scell)-cellzero.y,int((ps.z-DomPosMin.z)/Scell)-cellzero.z);
+    BatchSort.push_back(p);
+  }
+  std::sort(BatchSort.begin(),BatchSort.end(),StGaugeBatchCellLess(BatchCell.data()));
+  //-Creates groups of sorted points in the same cell.
+  //-Crea grupos de puntos ordenados en la misma celda.
+  const unsigned nsort=unsigned(BatchSort.size());
+  BatchGroup.clear();
+  BatchSortPos.resize(nsort);
+  for(unsigned c=0;c<nsort;c++){
+    const unsigned p=BatchSort[c];
+    if(!c || BatchCell[p]!=BatchCell[BatchSort[c-1]] || c-BatchGroup.back()>=BATCHGROUPSIZE)BatchGroup.push_back(c);
+    BatchSortPos[c]=BatchPos[p];
+  }
+  BatchGroup.push_back(nsort);
+  //-Computes the kernel sums of each group.
+  //-Calcula las sumas del kernel de cada grupo.
+  BatchSortVel.assign(nsort,TDouble3(0));
+  BatchSortMass.assign(nsort,0);
+  const JGaugeItem* gau=Gauges[BatchGauges[0]];
+  const int ngroups=int(BatchGroup.size())-1;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (dynamic)
+  #endif
+  for(int cg=0;cg<ngroups;cg++){
+    const unsigned cini=BatchGroup[cg];
+    gau->CalculeSumsCpu(BatchGroup[cg+1]-cini,BatchSortPos.data()+cini,nc,cellzero,cellfluid
+      ,begincell,cellrow,pos,code,velrhop,BatchSortVel.data()+cini,BatchSortMass.data()+cini);
+  }
+  //-Stores results in the order of the gauge points.
+  //-Guarda resultados en el orden de los puntos de los gauges.
+  BatchSumVel.assign(npt,TDouble3(0));
+  BatchSumMass.assign(npt,0);
+  for(unsigned c=0;c<nsort;c++){
+    const unsigned p=BatchSort[c];
+    BatchSumVel[p]=BatchSortVel[c];
+    BatchSumMass[p]=BatchSortMass[c];
+  }
+}
+
+//==============================================================================
+/// Updates results on gauges (on CPU). The points of gauges Vel, SWL and 
+/// VelGrid are computed together in batch with CalculeBatchCpu().
+///
+/// Actualiza resultados de los gauges (en CPU). Los puntos de los gauges Vel,
+/// SWL y VelGrid se calculan juntos por lotes con CalculeBatchCpu().
 //==============================================================================
 void JGaugeSystem::CalculeCpu(double timestep,bool svpart,tuint3 ncells
-  ,tuint3 cellmin,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+  ,tuint3 cellmin,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
   ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop)
 {
+  //-Collects points of batched gauges and computes the other gauges.
+  //-Recoge los puntos de gauges por lotes y calcula los demas gauges.
+  BatchGauges.clear();
+  BatchPtIni.clear();
+  BatchPos.clear();
+  BatchSkip.clear();
   const unsigned ng=GetCount();
   for(unsigned cg=0;cg<ng;cg++){
     JGaugeItem* gau=Gauges[cg];
     if(gau->Update(timestep)){
-      gau->CalculeCpu(timestep,ncells,cellmin,begincell,npbok,npb,np,pos,code,idp,velrhop);
+      const unsigned ptini=unsigned(BatchPos.size());
+      if(gau->GetBatchPoints(BatchPos,BatchSkip)){
+        BatchGauges.push_back(cg);
+        BatchPtIni.push_back(ptini);
+      }
+      else gau->CalculeCpu(timestep,ncells,cellmin,begincell,cellrow,npbok,npb,np,pos,code,idp,velrhop);
+    }
+  }
+  //-Computes batched gauges. | Calcula gauges por lotes.
+  const unsigned nb=unsigned(BatchGauges.size());
+  if(nb){
+    BatchPtIni.push_back(unsigned(BatchPos.size()));
+    CalculeBatchCpu(ncells,cellmin,begincell,cellrow,pos,code,velrhop);
+    for(unsigned cb=0;cb<nb;cb++){
+      const unsigned ptini=BatchPtIni[cb];
+      Gauges[BatchGauges[cb]]->SetBatchResult(timestep,BatchSumVel.data()+ptini,BatchSumMass.data()+ptini);
     }
   }
 }
@@ -484,6 +628,14 @@ void JGaugeSystem::CalculeGpu(double timestep,bool svpart,tuint3 ncells
 }
 #endif
 
+//==============================================================================
+/// Saves results in buffer to CSV file (without VTK files).
+//==============================================================================
+void JGaugeSystem::SaveResults(){
+  const unsigned ng=GetCount();
+  for(unsigned cg=0;cg<ng;cg++)Gauges[cg]->SaveResults();
+}
+
 //==============================================================================
 /// Saves results in VTK and/or CSV file.
 //==============================================================================
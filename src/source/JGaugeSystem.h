@@ -26,6 +26,11 @@
 //:# - Gestion de excepciones mejorada.  (15-09-2019)
 //:# - Objeto JXml pasado como const para operaciones de lectura. (18-03-2020)  
 //:# - Comprueba opcion active en elementos de primer y segundo nivel. (18-03-2020)  
+//:# - Nuevo metodo SaveResults() para grabar los resultados pendientes. (17-10-2026)
+//:# - CalculeCpu() recibe la posicion en memoria de cada fila de celdas. (17-10-2026)
+//:# - Calculo en CPU por lotes de los puntos de los gauges Vel, SWL y VelGrid 
+//:#   agrupados por celdas y en paralelo con OpenMP. (17-10-2026)
+//:# - Nuevo tipo de gauge velgrid con una malla de puntos. (17-10-2026)
 //:#############################################################################
 
 /// \file JGaugeSystem.h \brief Declares the class \ref JGaugeSystem.
@@ -82,6 +87,21 @@ private:
 
   std::vector<JGaugeItem*> Gauges;
 
+  //-Variables for batched calculation on CPU. | Variables para calculo por lotes en CPU.
+  static const unsigned BATCHGROUPSIZE=32;  ///<Maximum number of points of a group. | Numero maximo de puntos de un grupo.
+  std::vector<unsigned> BatchGauges;   ///<Gauges of the current batch. | Gauges del lote actual.
+  std::vector<unsigned> BatchPtIni;    ///<First point of each gauge of the batch [ngauges+1]. | Primer punto de cada gauge del lote.
+  std::vector<tdouble3> BatchPos;      ///<Points of the batch [npt]. | Puntos del lote.
+  std::vector<byte> BatchSkip;         ///<Points that are not computed (out of domain) [npt]. | Puntos que no se calculan.
+  std::vector<tint3> BatchCell;        ///<Cell of each point [npt]. | Celda de cada punto.
+  std::vector<unsigned> BatchSort;     ///<Computed points sorted by cell [nsort]. | Puntos calculados ordenados por celda.
+  std::vector<unsigned> BatchGroup;    ///<First sorted point of each group of points in the same cell [ngroups+1]. | Primer punto de cada grupo de puntos en la misma celda.
+  std::vector<tdouble3> BatchSortPos;  ///<Sorted points [nsort]. | Puntos ordenados.
+  std::vector<tdouble3> BatchSortVel;  ///<Kernel sums of velocity of sorted points [nsort]. | Sumas del kernel de velocidad de los puntos ordenados.
+  std::vector<double> BatchSortMass;   ///<Kernel sums of mass of sorted points [nsort]. | Sumas del kernel de masa de los puntos ordenados.
+  std::vector<tdouble3> BatchSumVel;   ///<Kernel sums of velocity of the points [npt]. | Sumas del kernel de velocidad de los puntos.
+  std::vector<double> BatchSumMass;    ///<Kernel sums of mass of the points [npt]. | Sumas del kernel de masa de los puntos.
+
   //-Variables for GPU.
  #ifdef _WITHGPU
   float3* AuxMemoryg;  ///<Auxiliary allocated memory on GPU [1].
@@ -95,6 +115,8 @@ private:
   JGaugeItem::StDefault ReadXmlCommon(const JXml *sxml,TiXmlElement* ele)const;
   void ReadXml(const JXml *sxml,TiXmlElement* ele,const JSphMk* mkinfo);
   void SaveVtkInitPoints()const;
+  void CalculeBatchCpu(tuint3 ncells,tuint3 cellmin,const unsigned *begincell,const unsigned *cellrow
+    ,const tdouble3 *pos,const typecode *code,const tfloat4 *velrhop);
 
 public:
   JGaugeSystem(bool cpu,JLog2* log);
@@ -126,13 +148,14 @@ public:
   JGaugeSwl*      AddGaugeSwl  (std::string name,double computestart,double computeend,double computedt,tdouble3 point0,tdouble3 point2,double pointdp,float masslimit=0);
   JGaugeMaxZ*     AddGaugeMaxZ (std::string name,double computestart,double computeend,double computedt,tdouble3 point0,double height,float distlimit);
   JGaugeForce*    AddGaugeForce(std::string name,double computestart,double computeend,double computedt,const JSphMk* mkinfo,word mkbound);
+  JGaugeVelGrid*  AddGaugeVelGrid(std::string name,double computestart,double computeend,double computedt,tdouble3 point0,tdouble3 vec1,tdouble3 vec2,tdouble3 vec3,tuint3 count);
 
   unsigned GetCount()const{ return(unsigned(Gauges.size())); }
   unsigned GetGaugeIdx(const std::string &name)const;
   JGaugeItem* GetGauge(unsigned c)const;
 
   void CalculeCpu(double timestep,bool svpart,tuint3 ncells,tuint3 cellmin
-    ,const unsigned *begincell,unsigned npbok,unsigned npb,unsigned np
+    ,const unsigned *begincell,const unsigned *cellrow,unsigned npbok,unsigned npb,unsigned np
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp,const tfloat4 *velrhop);
 
  #ifdef _WITHGPU
@@ -141,6 +164,7 @@ public:
     ,const double2 *posxy,const double *posz,const typecode *code,const unsigned *idp,const float4 *velrhop);
  #endif
 
+  void SaveResults();
   void SaveResults(unsigned cpart);
 };
 
@@ -21,6 +21,7 @@
 #include "JOutputCsv.h"
 #include "JDataArrays.h"
 #include "Functions.h"
+#include "OmpDefs.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -55,6 +56,36 @@ JOutputCsv::~JOutputCsv(){
 //==============================================================================
 void JOutputCsv::Reset(){
   FileName="";
+  Threads=0;
+}
+
+//==============================================================================
+/// Formats rows [cvini,cvfin) of data at the end of buffer.
+/// Formatea las filas [cvini,cvfin) de datos al final del buffer.
+//==============================================================================
+void JOutputCsv::FormatRows(unsigned cvini,unsigned cvfin
+  ,const std::vector<StOutField> &fields,char csvsep,jcsv::JCsvBuffer &buf)const
+{
+  const unsigned nf=unsigned(fields.size());
+  for(unsigned cv=cvini;cv<cvfin;cv++){
+    for(unsigned cf=0;cf<nf;cf++){
+      const StOutField &fd=fields[cf];
+      const char *fmt=fd.fmt.c_str();
+      switch(fd.type){
+        case TypeUchar:  { const byte     *v=(const byte    *)fd.ptr;  buf.AddFmt(fmt,v[cv]); }break;
+        case TypeUshort: { const word     *v=(const word    *)fd.ptr;  buf.AddFmt(fmt,v[cv]); }break;
+        case TypeUint:   { const unsigned *v=(const unsigned*)fd.ptr;  buf.AddFmt(fmt,v[cv]); }break;
+        case TypeFloat:  { const float    *v=(const float   *)fd.ptr;  buf.AddFmt(fmt,v[cv]); }break;
+        case TypeDouble: { const double   *v=(const double  *)fd.ptr;  buf.AddFmt(fmt,v[cv]); }break;
+        case TypeUint3:  { const tuint3   *v=(const tuint3  *)fd.ptr;  buf.AddFmt(fmt,v[cv].x); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].y); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].z); }break;
+        case TypeFloat3: { const tfloat3  *v=(const tfloat3 *)fd.ptr;  buf.AddFmt(fmt,v[cv].x); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].y); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].z); }break;
+        case TypeDouble3:{ const tdouble3 *v=(const tdouble3*)fd.ptr;  buf.AddFmt(fmt,v[cv].x); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].y); buf.AddChar(csvsep); buf.AddFmt(fmt,v[cv].z); }break;
+        default: Run_Exceptioon(fun::PrintStr("Type of array \'%s\' is invalid.",TypeToStr(fd.type)));
+      }
+      buf.AddChar(csvsep);
+    }
+    buf.AddChar('\n');
+  }
 }
 
 //==============================================================================
@@ -82,37 +113,48 @@ void JOutputCsv::SaveCsv(std::string fname,const JDataArrays &arrays,std::string
       else Run_ExceptioonFile(fun::PrintStr("Dimension %d of array \'%s\' is invalid.",dim,keyname.c_str()),fname);
     }
     pf << endl;
-    //-Creates vector with output format of arrays.
-    std::vector<std::string> outfmt;
+    //-Creates vector with output configuration of arrays.
+    std::vector<StOutField> fields(nf);
     for(unsigned cf=0;cf<nf;cf++){
-      string fmt=arrays.GetArrayFmt(cf);
+      const JDataArrays::StDataArray& ar=arrays.GetArrayCte(cf);
       const int dim=arrays.GetArrayDim(cf);
-      if(dim==3)fmt=fmt+csvsep+fmt+csvsep+fmt;
-      else if(dim!=1)Run_ExceptioonFile(fun::PrintStr("Dimension %d of array \'%s\' is invalid.",dim,arrays.GetArrayCte(cf).keyname.c_str()),fname);
-      outfmt.push_back(fmt);
+      if(dim!=1 && dim!=3)Run_ExceptioonFile(fun::PrintStr("Dimension %d of array \'%s\' is invalid.",dim,ar.keyname.c_str()),fname);
+      switch(ar.type){
+        case TypeUchar: case TypeUshort: case TypeUint: case TypeFloat: case TypeDouble:
+        case TypeUint3: case TypeFloat3: case TypeDouble3: break;
+        default: Run_ExceptioonFile(fun::PrintStr("Type of array \'%s\' is invalid.",TypeToStr(ar.type)),fname);
+      }
+      fields[cf].type=ar.type;
+      fields[cf].ptr=ar.ptr;
+      fields[cf].fmt=arrays.GetArrayFmt(cf);
     }
-    //-Saves data.
-    for(unsigned cv=0;cv<nv;cv++){
-      for(unsigned cf=0;cf<nf;cf++){
-        const JDataArrays::StDataArray& ar=arrays.GetArrayCte(cf);
-        if(1){
-          string fmt=outfmt[cf];
-          string values;
-          switch(ar.type){
-            case TypeUchar:  { const byte     *v=(byte    *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv])+csvsep; }break;
-            case TypeUshort: { const word     *v=(word    *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv])+csvsep; }break;
-            case TypeUint:   { const unsigned *v=(unsigned*)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv])+csvsep; }break;
-            case TypeFloat:  { const float    *v=(float   *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv])+csvsep; }break;
-            case TypeDouble: { const double   *v=(double  *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv])+csvsep; }break;
-            case TypeUint3:  { const tuint3   *v=(tuint3  *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv].x,v[cv].y,v[cv].z)+csvsep; }break;
-            case TypeFloat3: { const tfloat3  *v=(tfloat3 *)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv].x,v[cv].y,v[cv].z)+csvsep; }break;
-            case TypeDouble3:{ const tdouble3 *v=(tdouble3*)ar.ptr;  values=fun::PrintStr(fmt.c_str(),v[cv].x,v[cv].y,v[cv].z)+csvsep; }break;
-            default: Run_ExceptioonFile(fun::PrintStr("Type of array \'%s\' is invalid.",TypeToStr(ar.type)),fname);
-          }
-          pf << values;
+    //-Saves data. Blocks of chunks of rows are formatted in parallel and each
+    // chunk is written in order with only one write. Exceptions can not leave
+    // the parallel region, so they are thrown after the loop.
+    //-Graba datos. Bloques de fragmentos de filas se formatean en paralelo y 
+    // cada fragmento se graba en orden de una sola vez. Las excepciones no 
+    // pueden salir de la region paralela, asi que se lanzan despues del bucle.
+    const unsigned nchunks=(nv+CHUNKROWS-1)/CHUNKROWS;
+    const int nth=(Threads>0? Threads: omp_get_max_threads());
+    const unsigned nblock=(nth>1? min(nchunks,unsigned(nth*2)): 1);
+    std::vector<jcsv::JCsvBuffer> buf(nblock);
+    std::vector<string> errors(nblock);
+    for(unsigned c0=0;c0<nchunks;c0+=nblock){
+      const int nb=int(min(nblock,nchunks-c0));
+      #ifdef OMP_USE
+        #pragma omp parallel for num_threads(nth) schedule (dynamic) if(nb>1)
+      #endif
+      for(int cb=0;cb<nb;cb++){
+        const unsigned cvini=(c0+cb)*CHUNKROWS;
+        try{
+          buf[cb].Clear();
+          FormatRows(cvini,min(cvini+CHUNKROWS,nv),fields,csvsep,buf[cb]);
         }
+        catch(const std::exception &e){ errors[cb]=e.what(); }
+        catch(...){ errors[cb]="Unknown exception."; }
       }
-      pf << endl;
+      for(int cb=0;cb<nb;cb++)if(!errors[cb].empty())Run_ExceptioonFile(string("Error formatting data: ")+errors[cb],fname);
+      for(int cb=0;cb<nb;cb++)pf.write(buf[cb].GetPtr(),buf[cb].GetSize());
     }
     if(pf.fail())Run_ExceptioonFile("File writing failure.",fname);
     pf.close();
@@ -23,6 +23,8 @@
 //:# - Codigo actualizado para trabajar con ultima version de JDataArrays. (10-12-2019)
 //:# - CsvSepComa se define en el constructor y por defecto es false. (27-12-2019)
 //:# - CreatPath se define en el constructor y por defecto es true. (27-12-2019)
+//:# - Los datos se formatean en paralelo por bloques de filas con JCsvBuffer y 
+//:#   cada bloque se graba de una vez en orden. (17-10-2026)
 //:#############################################################################
 
 /// \file JOutputCsv.h \brief Declares the class \ref JOutputCsv.
@@ -33,6 +35,7 @@
 #include "TypesDef.h"
 #include "JObject.h"
 #include "JDataArrays.h"
+#include "JSaveCsv2.h"
 #include <string>
 #include <cstring>
 #include <string>
@@ -51,7 +54,20 @@ public:
   bool CsvSepComa;  ///<Separator character in CSV files (0=semicolon, 1=coma).
 
 protected:
+  static const unsigned CHUNKROWS=8192; ///<Number of rows formatted together. | Numero de filas formateadas juntas.
+
+  ///Output configuration of one array. | Configuracion de salida de un array.
+  typedef struct{
+    TpTypeData type;   ///<Type of data.
+    const void *ptr;   ///<Pointer to data.
+    std::string fmt;   ///<Output format of each value.
+  }StOutField;
+
   std::string FileName; ///<Last file generated.
+  int Threads;          ///<Number of threads to format data (0: omp_get_max_threads()). | Numero de hilos para formatear datos.
+
+  void FormatRows(unsigned cvini,unsigned cvfin,const std::vector<StOutField> &fields
+    ,char csvsep,jcsv::JCsvBuffer &buf)const;
   template<typename T> void CalculateStatsArray1(unsigned ndata,T *data
     ,double &valmin,double &valmax,double &valmean)const;
   template<typename T> void CalculateStatsArray3(unsigned ndata,T *data
@@ -62,6 +78,9 @@ public:
   ~JOutputCsv();
   void Reset();
 
+  void SetThreads(int threads){ Threads=threads; }
+  int GetThreads()const{ return(Threads); }
+
   void SaveCsv(std::string fname,const JDataArrays &arrays,std::string head="");
   //void SaveStatsCsv(std::string fname,bool create,int part,double timestep,const JDataArrays &arrays,std::string head="");
 
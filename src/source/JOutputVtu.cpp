@@ -0,0 +1,330 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JOutputVtu.cpp \brief Implements the class \ref JOutputVtu.
+
+#include "JOutputVtu.h"
+#include "JDataArrays.h"
+#include "JBinaryDataComp.h"
+#include "Functions.h"
+#include "OmpDefs.h"
+#include <fstream>
+#include <cstring>
+#include <climits>
+
+using namespace std;
+
+//##############################################################################
+//# JOutputVtu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JOutputVtu::JOutputVtu(bool createpath):CreatPath(createpath)
+{
+  ClassName="JOutputVtu";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JOutputVtu::~JOutputVtu(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialization of variables.
+//==============================================================================
+void JOutputVtu::Reset(){
+  FileName="";
+  Threads=0;
+  Compress=false;
+}
+
+//==============================================================================
+/// Returns VTK name of the type of components (exception when it is not supported).
+/// Devuelve el nombre VTK del tipo de las componentes (excepcion cuando no es valido).
+//==============================================================================
+const char* JOutputVtu::VtkTypeName(TpTypeData type){
+  switch(type){
+    case TypeChar:    return("Int8");
+    case TypeUchar:   return("UInt8");
+    case TypeShort:   return("Int16");
+    case TypeUshort:  return("UInt16");
+    case TypeInt:   case TypeInt2:   case TypeInt3:   case TypeInt4:   return("Int32");
+    case TypeUint:  case TypeUint2:  case TypeUint3:  case TypeUint4:  return("UInt32");
+    case TypeLlong:   return("Int64");
+    case TypeUllong:  return("UInt64");
+    case TypeFloat: case TypeFloat2: case TypeFloat3: case TypeFloat4: case TypeSyMatrix3f: return("Float32");
+    case TypeDouble:case TypeDouble2:case TypeDouble3:case TypeDouble4: return("Float64");
+    default: fun::Run_ExceptioonFun(fun::PrintStr("Type \'%s\' is not supported in VTU files.",TypeToStr(type)));
+  }
+  return(NULL);
+}
+
+//==============================================================================
+/// Loads configuration of arrays for points [pini,pini+np).
+/// Carga configuracion de arrays para los puntos [pini,pini+np).
+//==============================================================================
+void JOutputVtu::LoadArrays(const std::string &fname,const JDataArrays &arrays
+  ,const std::string &posfield,unsigned pini,unsigned np,StVtuArray &pos
+  ,std::vector<StVtuArray> &vars)const
+{
+  const unsigned na=arrays.Count();
+  vars.clear();
+  bool posok=false;
+  for(unsigned ca=0;ca<na;ca++){
+    const JDataArrays::StDataArray& ar=arrays.GetArrayCte(ca);
+    const char* vtktype=VtkTypeName(ar.type);
+    const unsigned esize=SizeOfType(ar.type);
+    StVtuArray va;
+    va.name=ar.keyname;
+    va.vtktype=vtktype;
+    va.ncomp=unsigned(DimOfType(ar.type));
+    va.data=(const byte*)ar.ptr+size_t(esize)*pini;
+    va.size=ullong(esize)*np;
+    va.offset=0;
+    if(ar.keyname==posfield){
+      if(ar.type!=TypeFloat3 && ar.type!=TypeDouble3)Run_ExceptioonFile(fun::PrintStr("Type of position array \'%s\' is invalid.",ar.keyname.c_str()),fname);
+      va.name="Points";
+      pos=va;
+      posok=true;
+    }
+    else vars.push_back(va);
+  }
+  if(!posok)Run_ExceptioonFile(fun::PrintStr("Array \'%s\' with positions is missing.",posfield.c_str()),fname);
+}
+
+//==============================================================================
+/// Compresses arrays in blocks of COMPBLOCK bytes. The blocks of all arrays
+/// are compressed in parallel.
+/// Comprime arrays en bloques de COMPBLOCK bytes. Los bloques de todos los
+/// arrays se comprimen en paralelo.
+//==============================================================================
+void JOutputVtu::CompressArrays(unsigned na,StVtuArray **ars,int nth)const{
+  const unsigned bound=CompBound(COMPBLOCK);
+  std::vector<tuint2> jobs; //-Array and block of each job.
+  for(unsigned ca=0;ca<na;ca++){
+    StVtuArray &va=*(ars[ca]);
+    const unsigned nb=unsigned((va.size+COMPBLOCK-1)/COMPBLOCK);
+    va.chead.assign(3+nb,0);
+    va.chead[0]=nb;
+    va.chead[1]=COMPBLOCK;
+    va.chead[2]=va.size%COMPBLOCK;
+    va.cdata.resize(size_t(bound)*nb);
+    for(unsigned cb=0;cb<nb;cb++)jobs.push_back(TUint2(ca,cb));
+  }
+  const JBinaryDataComp comp;
+  const int njobs=int(jobs.size());
+  #ifdef OMP_USE
+    #pragma omp parallel for num_threads(nth) schedule (dynamic) if(njobs>1)
+  #endif
+  for(int cj=0;cj<njobs;cj++){
+    StVtuArray &va=*(ars[jobs[cj].x]);
+    const unsigned cb=jobs[cj].y;
+    const ullong ini=ullong(cb)*COMPBLOCK;
+    const unsigned n=unsigned(min(ullong(COMPBLOCK),va.size-ini));
+    //-The destination size is the LZ4 bound, so LzCompress() never fails.
+    va.chead[3+cb]=comp.LzCompress(n,va.data+ini,bound,&va.cdata[size_t(bound)*cb]);
+  }
+}
+
+//==============================================================================
+/// Saves np points of loaded arrays in a .vtu file. Returns error message.
+/// Graba np puntos de los arrays cargados en un fichero .vtu. Devuelve mensaje de error.
+//==============================================================================
+std::string JOutputVtu::WritePiece(const std::string &fname,unsigned np
+  ,StVtuArray &pos,std::vector<StVtuArray> &vars,int nth)const
+{
+  if(np>=unsigned(INT_MAX))return("The number of points is too high for Int32 cells.");
+  //-Generates one vertex cell per point.
+  //-Genera una celda vertex por punto.
+  std::vector<int> conn(np),offs(np);
+  std::vector<byte> types(np,1);
+  const int n=int(np);
+  #ifdef OMP_USE
+    #pragma omp parallel for num_threads(nth) schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=0;p<n;p++){ conn[p]=p; offs[p]=p+1; }
+  StVtuArray cells[3];
+  const char* cellname[3]={"connectivity","offsets","types"};
+  for(unsigned c=0;c<3;c++){
+    cells[c].name=cellname[c];
+    cells[c].vtktype=(c<2? "Int32": "UInt8");
+    cells[c].ncomp=1;
+    cells[c].size=(c<2? sizeof(int)*ullong(np): ullong(np));
+    cells[c].offset=0;
+  }
+  cells[0].data=(np? (const byte*)&conn[0]: NULL);
+  cells[1].data=(np? (const byte*)&offs[0]: NULL);
+  cells[2].data=(np? &types[0]: NULL);
+  //-List of appended arrays in order.
+  //-Lista de arrays anexados en orden.
+  const unsigned nv=unsigned(vars.size());
+  std::vector<StVtuArray*> ars;
+  for(unsigned cv=0;cv<nv;cv++)ars.push_back(&vars[cv]);
+  ars.push_back(&pos);
+  for(unsigned c=0;c<3;c++)ars.push_back(cells+c);
+  const unsigned na=unsigned(ars.size());
+  if(Compress)CompressArrays(na,&ars[0],nth);
+  //-Computes offsets in appended data.
+  //-Calcula offsets en datos anexados.
+  ullong offset=0;
+  for(unsigned ca=0;ca<na;ca++){
+    StVtuArray &va=*(ars[ca]);
+    va.offset=offset;
+    if(Compress){
+      offset+=sizeof(ullong)*va.chead.size();
+      for(unsigned cb=3;cb<unsigned(va.chead.size());cb++)offset+=va.chead[cb];
+    }
+    else offset+=sizeof(ullong)+va.size;
+  }
+  //-Generates XML head.
+  //-Genera cabecera XML.
+  string xml="<?xml version=\"1.0\"?>\n";
+  xml=xml+"<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\""+(Compress? " compressor=\"vtkLZ4DataCompressor\"": "")+">\n";
+  xml=xml+"  <UnstructuredGrid>\n";
+  xml=xml+fun::PrintStr("    <Piece NumberOfPoints=\"%u\" NumberOfCells=\"%u\">\n",np,np);
+  for(unsigned ca=0;ca<na;ca++){
+    const StVtuArray &va=*(ars[ca]);
+    if(ca==0 && nv)xml=xml+"      <PointData>\n";
+    if(ca==nv)xml=xml+"      <Points>\n";
+    if(ca==nv+1)xml=xml+"      <Cells>\n";
+    xml=xml+fun::PrintStr("        <DataArray type=\"%s\" Name=\"%s\" NumberOfComponents=\"%u\" format=\"appended\" offset=\"%s\"/>\n"
+      ,va.vtktype,va.name.c_str(),va.ncomp,fun::UlongStr(va.offset).c_str());
+    if(ca+1==nv)xml=xml+"      </PointData>\n";
+    if(ca==nv)xml=xml+"      </Points>\n";
+  }
+  xml=xml+"      </Cells>\n";
+  xml=xml+"    </Piece>\n";
+  xml=xml+"  </UnstructuredGrid>\n";
+  xml=xml+"  <AppendedData encoding=\"raw\">\n   _";
+  //-Saves file.
+  //-Graba fichero.
+  ofstream pf;
+  pf.open(fname.c_str(),ios::binary|ios::out);
+  if(!pf)return("Cannot open the file.");
+  pf.write(xml.c_str(),xml.size());
+  const unsigned bound=CompBound(COMPBLOCK);
+  for(unsigned ca=0;ca<na;ca++){
+    const StVtuArray &va=*(ars[ca]);
+    if(Compress){
+      pf.write((const char*)&va.chead[0],sizeof(ullong)*va.chead.size());
+      for(unsigned cb=3;cb<unsigned(va.chead.size());cb++){
+        pf.write((const char*)&va.cdata[size_t(bound)*(cb-3)],std::streamsize(va.chead[cb]));
+      }
+    }
+    else{
+      pf.write((const char*)&va.size,sizeof(ullong));
+      if(va.size)pf.write((const char*)va.data,std::streamsize(va.size));
+    }
+  }
+  pf << "\n  </AppendedData>\n</VTKFile>\n";
+  if(pf.fail())return("File writing failure.");
+  pf.close();
+  return("");
+}
+
+//==============================================================================
+/// Stores data in one .vtu file.
+/// Graba datos en un fichero .vtu.
+//==============================================================================
+void JOutputVtu::SaveVtu(std::string fname,const JDataArrays &arrays,std::string posfield){
+  if(fun::GetExtension(fname).empty())fname=fun::AddExtension(fname,".vtu");
+  FileName=fname;
+  const unsigned np=arrays.GetDataCount(true);
+  if(np!=arrays.GetDataCount(false))Run_ExceptioonFile("The number of values in arrays is not the same.",fname);
+  if(CreatPath)fun::MkdirPath(fun::GetDirParent(fname));
+  StVtuArray pos;
+  std::vector<StVtuArray> vars;
+  LoadArrays(fname,arrays,posfield,0,np,pos,vars);
+  const int nth=(Threads>0? Threads: omp_get_max_threads());
+  const string err=WritePiece(fname,np,pos,vars,nth);
+  if(!err.empty())Run_ExceptioonFile(err,fname);
+}
+
+//==============================================================================
+/// Stores data in npieces .vtu files saved in parallel and one .pvtu file
+/// with the list of pieces (npieces=0: one piece per thread).
+/// Graba datos en npieces ficheros .vtu grabados en paralelo y un fichero
+/// .pvtu con la lista de piezas (npieces=0: una pieza por hilo).
+//==============================================================================
+void JOutputVtu::SavePvtu(std::string fname,const JDataArrays &arrays
+  ,std::string posfield,unsigned npieces)
+{
+  if(fun::GetExtension(fname).empty())fname=fun::AddExtension(fname,".pvtu");
+  FileName=fname;
+  const unsigned np=arrays.GetDataCount(true);
+  if(np!=arrays.GetDataCount(false))Run_ExceptioonFile("The number of values in arrays is not the same.",fname);
+  if(CreatPath)fun::MkdirPath(fun::GetDirParent(fname));
+  const int nth=(Threads>0? Threads: omp_get_max_threads());
+  if(!npieces)npieces=unsigned(nth);
+  npieces=max(1u,min(npieces,np));
+  //-Loads configuration of pieces.
+  //-Carga configuracion de piezas.
+  const string fbase=fun::GetWithoutExtension(fname);
+  std::vector<string> fpieces(npieces);
+  std::vector<StVtuArray> pos(npieces);
+  std::vector< std::vector<StVtuArray> > vars(npieces);
+  std::vector<unsigned> pini(npieces+1);
+  for(unsigned cp=0;cp<=npieces;cp++)pini[cp]=unsigned(ullong(np)*cp/npieces);
+  for(unsigned cp=0;cp<npieces;cp++){
+    fpieces[cp]=fbase+fun::PrintStr("_p%u.vtu",cp);
+    LoadArrays(fname,arrays,posfield,pini[cp],pini[cp+1]-pini[cp],pos[cp],vars[cp]);
+  }
+  //-Saves pieces in parallel (one piece per thread).
+  //-Graba piezas en paralelo (una pieza por hilo).
+  std::vector<string> errs(npieces);
+  const int npc=int(npieces);
+  #ifdef OMP_USE
+    #pragma omp parallel for num_threads(min(nth,npc)) schedule (dynamic) if(npc>1)
+  #endif
+  for(int cp=0;cp<npc;cp++){
+    errs[cp]=WritePiece(fpieces[cp],pini[cp+1]-pini[cp],pos[cp],vars[cp],1);
+  }
+  for(unsigned cp=0;cp<npieces;cp++)if(!errs[cp].empty())Run_ExceptioonFile(errs[cp],fpieces[cp]);
+  //-Saves .pvtu file.
+  //-Graba fichero .pvtu.
+  ofstream pf;
+  pf.open(fname.c_str());
+  if(pf){
+    pf << "<?xml version=\"1.0\"?>\n";
+    pf << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+    pf << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
+    const std::vector<StVtuArray> &vars0=vars[0];
+    if(!vars0.empty()){
+      pf << "    <PPointData>\n";
+      for(unsigned cv=0;cv<unsigned(vars0.size());cv++){
+        pf << "      <PDataArray type=\"" << vars0[cv].vtktype << "\" Name=\"" << vars0[cv].name << "\" NumberOfComponents=\"" << vars0[cv].ncomp << "\"/>\n";
+      }
+      pf << "    </PPointData>\n";
+    }
+    pf << "    <PPoints>\n";
+    pf << "      <PDataArray type=\"" << pos[0].vtktype << "\" Name=\"Points\" NumberOfComponents=\"3\"/>\n";
+    pf << "    </PPoints>\n";
+    for(unsigned cp=0;cp<npieces;cp++)pf << "    <Piece Source=\"" << fun::GetFile(fpieces[cp]) << "\"/>\n";
+    pf << "  </PUnstructuredGrid>\n";
+    pf << "</VTKFile>\n";
+    if(pf.fail())Run_ExceptioonFile("File writing failure.",fname);
+    pf.close();
+  }
+  else Run_ExceptioonFile("Cannot open the file.",fname);
+}
+
@@ -0,0 +1,110 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para grabar arrays de datos en ficheros VTK XML (.vtu) con datos
+//:#   binarios anexados (appended raw), opcionalmente comprimidos con LZ4 en
+//:#   paralelo, y ficheros .pvtu con una pieza por hilo. No depende de
+//:#   JVtkLib. (17-10-2026)
+//:#############################################################################
+
+/// \file JOutputVtu.h \brief Declares the class \ref JOutputVtu.
+
+#ifndef _JOutputVtu_
+#define _JOutputVtu_
+
+#include "TypesDef.h"
+#include "JObject.h"
+#include "JDataArrays.h"
+#include <string>
+#include <vector>
+
+//##############################################################################
+//# JOutputVtu
+//##############################################################################
+/// \brief Saves data arrays as points in VTK XML files (.vtu and .pvtu).
+///
+/// Files are UnstructuredGrid with one vertex cell per point and all arrays
+/// stored as appended raw binary data, so the cost of writing is similar to
+/// the cost of a bi4 file. With compression the arrays are split in blocks of
+/// 64 KB that are compressed in parallel (vtkLZ4DataCompressor). SavePvtu()
+/// splits the points in contiguous pieces and saves one .vtu file per piece
+/// in parallel with a .pvtu file that groups them.
+///
+/// Graba arrays de datos como puntos en ficheros VTK XML (.vtu y .pvtu).
+/// Los ficheros son UnstructuredGrid con una celda vertex por punto y todos
+/// los arrays se graban como datos binarios anexados, de modo que el coste de
+/// grabacion es similar al de un fichero bi4. Con compresion los arrays se
+/// dividen en bloques de 64 KB que se comprimen en paralelo. SavePvtu() divide
+/// los puntos en piezas contiguas y graba un fichero .vtu por pieza en
+/// paralelo con un fichero .pvtu que las agrupa.
+
+class JOutputVtu : protected JObject
+{
+public:
+  //-Output configuration.
+  bool CreatPath;   ///<Creates full path for output files (true by default).
+
+protected:
+  static const unsigned COMPBLOCK=65536; ///<Uncompressed size of compressed blocks [bytes]. | Tamanho sin comprimir de los bloques comprimidos [bytes].
+
+  ///Appended array of a piece. | Array anexado de una pieza.
+  typedef struct{
+    std::string name;      ///<Name of array.
+    const char *vtktype;   ///<VTK type of components (Float32, UInt32...).
+    unsigned ncomp;        ///<Number of components.
+    const byte *data;      ///<Pointer to raw data.
+    ullong size;           ///<Size of raw data [bytes].
+    ullong offset;         ///<Offset in appended data [bytes].
+    std::vector<ullong> chead;  ///<Compression header (nblocks,blocksize,lastblocksize,csize...). | Cabecera de compresion.
+    std::vector<byte> cdata;    ///<Compressed blocks (each one in a slot of CompBound(COMPBLOCK) bytes). | Bloques comprimidos.
+  }StVtuArray;
+
+  std::string FileName; ///<Last file generated.
+  int Threads;          ///<Number of threads to encode data (0: omp_get_max_threads()). | Numero de hilos para codificar datos.
+  bool Compress;        ///<Arrays are compressed with LZ4 (false by default). | Los arrays se comprimen con LZ4.
+
+  static const char* VtkTypeName(TpTypeData type);
+  static unsigned CompBound(unsigned size){ return(size+size/255+16); }
+  void LoadArrays(const std::string &fname,const JDataArrays &arrays
+    ,const std::string &posfield,unsigned pini,unsigned np,StVtuArray &pos
+    ,std::vector<StVtuArray> &vars)const;
+  void CompressArrays(unsigned na,StVtuArray **ars,int nth)const;
+  std::string WritePiece(const std::string &fname,unsigned np,StVtuArray &pos
+    ,std::vector<StVtuArray> &vars,int nth)const;
+
+public:
+  JOutputVtu(bool createpath=true);
+  ~JOutputVtu();
+  void Reset();
+
+  void SetThreads(int threads){ Threads=threads; }
+  int GetThreads()const{ return(Threads); }
+  void SetCompress(bool comp){ Compress=comp; }
+  bool GetCompress()const{ return(Compress); }
+
+  void SaveVtu(std::string fname,const JDataArrays &arrays,std::string posfield="Pos");
+  void SavePvtu(std::string fname,const JDataArrays &arrays,std::string posfield="Pos",unsigned npieces=0);
+
+  std::string GetFileName()const{ return(FileName); }
+};
+
+#endif
+
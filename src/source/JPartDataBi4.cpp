@@ -21,6 +21,8 @@
 #include "JPartDataBi4.h"
 //#include "JBinaryData.h"
 #include "JPartDataHead.h"
+#include "JBinaryDataComp.h"
+#include "JRadixSort.h"
 #include "Functions.h"
 #include <fstream>
 #include <cmath>
@@ -59,6 +61,8 @@ void JPartDataBi4::Reset(){
   Dir="";
   Piece=0;
   Npiece=1;
+  Compress=false;
+  CompQuantStep=0;
 }
 
 //==============================================================================
@@ -270,6 +274,17 @@ void JPartDataBi4::ConfigSimDiv(TpAxisDiv axisdiv){
   Data->SetvInt("AxisDiv",int(axisdiv));
 }
 
+//==============================================================================
+/// Configura grabacion de arrays de particulas comprimidos. Con quantstep>0 las
+/// posiciones se cuantifican con ese paso (con perdida).
+/// Configures saving of compressed particle arrays. With quantstep>0 positions
+/// are quantised with that step (lossy).
+//==============================================================================
+void JPartDataBi4::ConfigCompression(bool compress,double quantstep){
+  Compress=compress;
+  CompQuantStep=(compress && quantstep>0? quantstep: 0);
+}
+
 //==============================================================================
 /// Configuracion de variables de simetria con respecto al plano y=0.
 /// Configuration of variables of symmetry according plane y=0.
@@ -384,6 +399,74 @@ void JPartDataBi4::AddPartDataSplitting(unsigned npok,const float *mass
   Part->CreateArray("Hvar",JBinaryDataDef::DatFloat,npok,hvar,externalpointer);
 }
 
+//==============================================================================
+/// Ordena los arrays de particulas segun Idp (o Idpd) cuando no lo estan. Los
+/// datos ordenados se copian en memoria propia sin modificar los punteros 
+/// externos.
+/// Sorts particle arrays by Idp (or Idpd) when they are not sorted. Sorted data
+/// is copied to own memory without modifying the external pointers.
+//==============================================================================
+void JPartDataBi4::SortPartData(){
+  const unsigned npok=Part->GetvUint("Npok",true,0);
+  JBinaryDataArray *arid=Part->GetArray("Idp");
+  JBinaryDataArray *arid64=(arid? NULL: Part->GetArray("Idpd"));
+  if(npok<2 || (!arid && !arid64))return;
+  const unsigned *idp=(arid? (const unsigned*)arid->GetDataPointer(): NULL);
+  const ullong *idpd=(arid64? (const ullong*)arid64->GetDataPointer(): NULL);
+  //-Comprueba si ya esta ordenado. Checks if it is already sorted.
+  bool sorted=true;
+  if(idp)for(unsigned p=1;p<npok && sorted;p++)sorted=(idp[p-1]<=idp[p]);
+  else   for(unsigned p=1;p<npok && sorted;p++)sorted=(idpd[p-1]<=idpd[p]);
+  if(sorted)return;
+  //-Calcula indice de ordenacion. Computes sort index.
+  JRadixSort rs(true);
+  if(idp)rs.MakeIndex(npok,idp);
+  else   rs.MakeIndex(npok,idpd);
+  //-Reordena arrays de particulas. Reorders particle arrays.
+  byte *aux=NULL;
+  const unsigned na=Part->GetArraysCount();
+  for(unsigned ca=0;ca<na;ca++){
+    JBinaryDataArray *ar=Part->GetArray(ca);
+    if(ar->GetCount()==npok && ar->GetType()!=JBinaryDataDef::DatText){
+      const size_t stype=JBinaryDataDef::SizeOfType(ar->GetType());
+      if(!aux)aux=new byte[sizeof(tdouble3)*npok];
+      const void *ptr=ar->GetDataPointer();
+      switch(stype){
+        case 1:  rs.SortData(npok,(const byte    *)ptr,(byte    *)aux);  break;
+        case 2:  rs.SortData(npok,(const word    *)ptr,(word    *)aux);  break;
+        case 4:  rs.SortData(npok,(const unsigned*)ptr,(unsigned*)aux);  break;
+        case 8:  rs.SortData(npok,(const tuint2  *)ptr,(tuint2  *)aux);  break;
+        case 12: rs.SortData(npok,(const tfloat3 *)ptr,(tfloat3 *)aux);  break;
+        case 24: rs.SortData(npok,(const tdouble3*)ptr,(tdouble3*)aux);  break;
+        default: Run_Exceptioon("Size of data type is invalid.");
+      }
+      ar->SetData(npok,aux,false);
+    }
+  }
+  delete[] aux; aux=NULL;
+}
+
+//==============================================================================
+/// Configura la compresion de los arrays de particulas. Los Id se codifican 
+/// como diferencias y las posiciones se cuantifican cuando CompQuantStep>0.
+/// Configures compression of particle arrays. Ids are coded as differences and
+/// positions are quantised when CompQuantStep>0.
+//==============================================================================
+void JPartDataBi4::ConfigPartCompression(){
+  const byte cshuffle=byte(JBinaryDataComp::COMP_Shuffle);
+  const byte cdelta=byte(JBinaryDataComp::COMP_Delta);
+  const byte cquant=byte(JBinaryDataComp::COMP_Quant);
+  const tdouble3 qmin=Data->GetvDouble3("MapPosMin",true,Part->GetvDouble3("DomainMin",true,TDouble3(0)));
+  const unsigned na=Part->GetArraysCount();
+  for(unsigned ca=0;ca<na;ca++){
+    JBinaryDataArray *ar=Part->GetArray(ca);
+    const string name=ar->GetName();
+    if(name=="Idp" || name=="Idpd")ar->SetCompression(cshuffle|cdelta);
+    else if((name=="Pos" || name=="Posd") && CompQuantStep>0)ar->SetCompression(cshuffle|cquant|cdelta,qmin,CompQuantStep);
+    else ar->SetCompression(cshuffle);
+  }
+}
+
 //==============================================================================
 /// Graba le fichero BI4 indicado.
 /// Writes indicated BI4 file.
@@ -391,6 +474,11 @@ void JPartDataBi4::AddPartDataSplitting(unsigned npok,const float *mass
 void JPartDataBi4::SaveFileData(std::string fname){
   //-Comprueba que Part tenga algun array de datos. Check that Part has array with data.
   if(!Part->GetArraysCount())Run_Exceptioon("There is not array of particles data.");
+  //-Prepara compresion de arrays. Prepares compression of arrays.
+  if(Compress){
+    SortPartData();
+    ConfigPartCompression();
+  }
   //-Graba fichero. Record file.
   Data->SaveFile(Dir+fname,false,true);
   Part->RemoveArrays();
@@ -464,10 +552,13 @@ unsigned JPartDataBi4::GetPiecesFilePart(std::string dir,unsigned cpart)const{
 /// Graba fichero BI4 con el nombre da caso indicado.
 /// Writes file BI4 with the case name indicated.
 //==============================================================================
-void JPartDataBi4::LoadFileData(std::string file,unsigned cpart,unsigned piece,unsigned npiece){
+void JPartDataBi4::LoadFileData(std::string file,unsigned cpart,unsigned piece,unsigned npiece,bool mapped){
   ResetData();
   Cpart=cpart; Piece=piece; Npiece=npiece;
-  Data->OpenFileStructure(file,ClassName);
+  Data->OpenFileStructure(file,ClassName,mapped);
+  //-The file name of piece 0 is the same for any number of pieces, so it uses the number of the file.
+  //-El nombre de fichero de la pieza 0 es el mismo para cualquier numero de piezas, asi que usa el del fichero.
+  if(!Piece && Npiece>1 && Data->GetvUint("Npiece")>1)Npiece=Data->GetvUint("Npiece");
   if(Piece!=Data->GetvUint("Piece")||Npiece!=Data->GetvUint("Npiece"))Run_Exceptioon("PART configuration is invalid.");
   Part=Data->GetItem(GetNamePart(Cpart));
   if(!Part)Run_Exceptioon("PART data is invalid.");
@@ -478,16 +569,16 @@ void JPartDataBi4::LoadFileData(std::string file,unsigned cpart,unsigned piece,u
 /// Carga fichero BI4 con el nombre da caso indicado.
 /// Load file BI4 with the case name indicated.
 //==============================================================================
-void JPartDataBi4::LoadFileCase(std::string dir,std::string casename,unsigned piece,unsigned npiece){
-  LoadFileData(fun::GetDirWithSlash(dir)+GetFileNameCase(casename,piece,npiece),0,piece,npiece);
+void JPartDataBi4::LoadFileCase(std::string dir,std::string casename,unsigned piece,unsigned npiece,bool mapped){
+  LoadFileData(fun::GetDirWithSlash(dir)+GetFileNameCase(casename,piece,npiece),0,piece,npiece,mapped);
 }
 
 //==============================================================================
 /// Carga fichero PART con datos de particulas.
 /// Load file PART with data of particles.
 //==============================================================================
-void JPartDataBi4::LoadFilePart(std::string dir,unsigned cpart,unsigned piece,unsigned npiece){
-  LoadFileData(fun::GetDirWithSlash(dir)+GetFileNamePart(cpart,piece,npiece),cpart,piece,npiece);
+void JPartDataBi4::LoadFilePart(std::string dir,unsigned cpart,unsigned piece,unsigned npiece,bool mapped){
+  LoadFileData(fun::GetDirWithSlash(dir)+GetFileNamePart(cpart,piece,npiece),cpart,piece,npiece,mapped);
 }
 
 //==============================================================================
@@ -50,6 +50,10 @@
 //:# - Incluye informacion de Symmetry. (13-05-2019)
 //:# - Nuevo AddPartData() para tipos TpTypeData. (23-08-2019)
 //:# - Mejora la gestion de excepciones. (06-05-2020)
+//:# - Grabacion opcional de arrays comprimidos ordenados por Idp. (17-10-2026)
+//:# - Carga opcional con el fichero proyectado en memoria (mmap). (17-10-2026)
+//:# - La pieza 0 se carga con el numero de piezas del fichero cuando hay mas de
+//:#   dos piezas. (17-10-2026)
 //:#############################################################################
 
 /// \file JPartDataBi4.h \brief Declares the class \ref JPartDataBi4.
@@ -91,13 +95,18 @@ class JPartDataBi4 : protected JObject
   unsigned Npiece;   ///<Numero total de partes. Number of total parts.
   unsigned Cpart;    ///<Numero de PART. PART number.
 
+  bool Compress;         ///<Graba arrays de particulas comprimidos. Saves compressed arrays of particles.
+  double CompQuantStep;  ///<Paso de cuantificacion de posiciones (0:sin perdida). Quantisation step of positions (0:lossless).
+
   static std::string GetNamePart(unsigned cpart);
   void AddPartData(unsigned npok,const unsigned *idp,const ullong *idpd,const tfloat3 *pos,const tdouble3 *posd,const tfloat3 *vel,const float *rhop,bool externalpointer=true);
   void AddPartDataVar(const std::string &name,JBinaryDataDef::TpData type,unsigned npok,const void *v,bool externalpointer=true);
 
+  void SortPartData();
+  void ConfigPartCompression();
   void SaveFileData(std::string fname);
   unsigned GetPiecesFile(std::string file)const;
-  void LoadFileData(std::string file,unsigned cpart,unsigned piece,unsigned npiece);
+  void LoadFileData(std::string file,unsigned cpart,unsigned piece,unsigned npiece,bool mapped);
 
  public:
   JPartDataBi4();
@@ -128,6 +137,7 @@ class JPartDataBi4 : protected JObject
   void ConfigSplitting(bool splitting);
 
   void ConfigSimDiv(TpAxisDiv axisdiv);
+  void ConfigCompression(bool compress,double quantstep);
 
   //-Configuracion de parts. Configuration of parts.
   JBinaryData* AddPartInfo(unsigned cpart,double timestep,unsigned npok,unsigned nout,unsigned step,double runtime,tdouble3 domainmin,tdouble3 domainmax,ullong nptotal=0,ullong idmax=0);
@@ -167,8 +177,8 @@ class JPartDataBi4 : protected JObject
   //-Carga de fichero. File loaded.
   unsigned GetPiecesFileCase(std::string dir,std::string casename)const;
   unsigned GetPiecesFilePart(std::string dir,unsigned cpart)const;
-  void LoadFileCase(std::string dir,std::string casename,unsigned piece=0,unsigned npiece=1);
-  void LoadFilePart(std::string dir,unsigned cpart,unsigned piece=0,unsigned npiece=1);
+  void LoadFileCase(std::string dir,std::string casename,unsigned piece=0,unsigned npiece=1,bool mapped=false);
+  void LoadFilePart(std::string dir,unsigned cpart,unsigned piece=0,unsigned npiece=1,bool mapped=false);
 
   //Obtencion de datos basicos:
   //Obtaining basic data:
@@ -249,6 +259,14 @@ class JPartDataBi4 : protected JObject
   unsigned Get_Mass (unsigned size,float    *data)const{ return(GetArray("Mass",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
   unsigned Get_Hvar (unsigned size,float    *data)const{ return(GetArray("Hvar",JBinaryDataDef::DatFloat  )->GetDataCopy(size,data)); }
 
+  //-Datos (sin alinear) en el fichero proyectado en memoria o NULL.
+  //-Data (unaligned) in the file mapped in memory or NULL.
+  const byte* GetMap_Idp ()const{ return((const byte*)GetArray("Idp" ,JBinaryDataDef::DatUint   )->GetFileDataMapped()); }
+  const byte* GetMap_Pos ()const{ return((const byte*)GetArray("Pos" ,JBinaryDataDef::DatFloat3 )->GetFileDataMapped()); }
+  const byte* GetMap_Posd()const{ return((const byte*)GetArray("Posd",JBinaryDataDef::DatDouble3)->GetFileDataMapped()); }
+  const byte* GetMap_Vel ()const{ return((const byte*)GetArray("Vel" ,JBinaryDataDef::DatFloat3 )->GetFileDataMapped()); }
+  const byte* GetMap_Rhop()const{ return((const byte*)GetArray("Rhop",JBinaryDataDef::DatFloat  )->GetFileDataMapped()); }
+
   double Get_Particles2dPosY()const;
 };
 
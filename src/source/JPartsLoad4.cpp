@@ -22,6 +22,7 @@
 #include "Functions.h"
 #include "JPartDataBi4.h"
 #include "JRadixSort.h"
+#include "OmpDefs.h"
 #include <climits>
 #include <cfloat>
 
@@ -36,6 +37,7 @@ using namespace std;
 JPartsLoad4::JPartsLoad4(bool useomp):UseOmp(useomp){
   ClassName="JPartsLoad4";
   Idp=NULL; Pos=NULL; VelRhop=NULL;
+  FileMap=NULL;
   Reset();
 }
 
@@ -45,6 +47,7 @@ JPartsLoad4::JPartsLoad4(bool useomp):UseOmp(useomp){
 JPartsLoad4::~JPartsLoad4(){
   DestructorActive=true;
   AllocMemory(0);
+  FreeFileMap();
 }
 
 //==============================================================================
@@ -63,6 +66,7 @@ void JPartsLoad4::Reset(){
   SymplecticDtPre=0;
   DemDtForce=0;
   AllocMemory(0);
+  FreeFileMap();
 }
 
 //==============================================================================
@@ -86,6 +90,95 @@ void JPartsLoad4::AllocMemory(unsigned count){
   } 
 }
 
+//==============================================================================
+/// Frees file mapped in memory.
+/// Libera fichero proyectado en memoria.
+//==============================================================================
+void JPartsLoad4::FreeFileMap(){
+  delete FileMap; FileMap=NULL;
+  MapIdp=NULL; MapPos=NULL; MapPosd=NULL; MapVel=NULL; MapRhop=NULL;
+}
+
+//==============================================================================
+/// Obtains pointers to particle data in the file mapped in memory and returns
+/// false when some data is not available in place.
+/// Obtiene punteros a datos de particulas en el fichero proyectado en memoria y
+/// devuelve false cuando algun dato no esta disponible.
+//==============================================================================
+bool JPartsLoad4::SetFileMap(){
+  const JPartDataBi4 &pd=*FileMap;
+  MapIdp=pd.GetMap_Idp();
+  if(pd.Get_PosSimple())MapPos=pd.GetMap_Pos();
+  else MapPosd=pd.GetMap_Posd();
+  MapVel=pd.GetMap_Vel();
+  MapRhop=pd.GetMap_Rhop();
+  return(MapIdp && (MapPos || MapPosd) && MapVel && MapRhop);
+}
+
+//==============================================================================
+/// Copies particle data from the file mapped in memory (multi-threaded).
+/// Copia datos de particulas del fichero proyectado en memoria (multi-hilo).
+//==============================================================================
+void JPartsLoad4::CopyFileMap(unsigned *idp,tdouble3 *pos,tfloat4 *velrhop)const{
+  const int n=int(Count);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(static) if(UseOmp && n>OMP_LIMIT_LIGHT)
+  #endif
+  for(int p=0;p<n;p++){
+    memcpy(idp+p,MapIdp+sizeof(unsigned)*p,sizeof(unsigned));
+    pos[p]=GetFileMapPos(unsigned(p));
+    tfloat3 v;
+    float rhop;
+    memcpy(&v,MapVel+sizeof(tfloat3)*p,sizeof(tfloat3));
+    memcpy(&rhop,MapRhop+sizeof(float)*p,sizeof(float));
+    velrhop[p]=TFloat4(v.x,v.y,v.z,rhop);
+  }
+}
+
+//==============================================================================
+/// Returns position of particle from the file mapped in memory.
+/// Devuelve posicion de particula del fichero proyectado en memoria.
+//==============================================================================
+tdouble3 JPartsLoad4::GetFileMapPos(unsigned p)const{
+  tdouble3 ps;
+  if(MapPosd)memcpy(&ps,MapPosd+sizeof(tdouble3)*p,sizeof(tdouble3));
+  else{
+    tfloat3 psf;
+    memcpy(&psf,MapPos+sizeof(tfloat3)*p,sizeof(tfloat3));
+    ps=ToTDouble3(psf);
+  }
+  return(ps);
+}
+
+//==============================================================================
+/// Loads particle arrays from the file mapped in memory and frees the file.
+/// Carga arrays de particulas del fichero proyectado en memoria y lo libera.
+//==============================================================================
+void JPartsLoad4::LoadFileMapArrays(){
+  if(FileMap){
+    const unsigned count=Count;
+    AllocMemory(count);
+    CopyFileMap(Idp,Pos,VelRhop);
+    FreeFileMap();
+  }
+}
+
+//==============================================================================
+/// Copies particle data to the indicated arrays. With the file mapped in memory
+/// the data is converted in place without intermediate copies.
+/// Copia datos de particulas en los arrays indicados. Con el fichero proyectado
+/// en memoria los datos se convierten sin copias intermedias.
+//==============================================================================
+void JPartsLoad4::GetParticles(unsigned np,unsigned *idp,tdouble3 *pos,tfloat4 *velrhop)const{
+  if(np!=Count)Run_Exceptioon("Number of particles is invalid.");
+  if(FileMap)CopyFileMap(idp,pos,velrhop);
+  else{
+    memcpy(idp,Idp,sizeof(unsigned)*Count);
+    memcpy(pos,Pos,sizeof(tdouble3)*Count);
+    memcpy(velrhop,VelRhop,sizeof(tfloat4)*Count);
+  }
+}
+
 //==============================================================================
 /// Returns the reserved memory in CPU.
 /// Devuelve la memoria reservada en CPU.
@@ -119,7 +212,12 @@ void JPartsLoad4::CheckSortParticles(){
   if(nbound){
     unsigned lastbound=0;
     //-Computes position of last boundary particle.
-    for(unsigned p=0;p<Count;p++)if(Idp[p]<nbound && p>lastbound)lastbound=p;
+    if(FileMap)for(unsigned p=0;p<Count;p++){
+      unsigned id;
+      memcpy(&id,MapIdp+sizeof(unsigned)*p,sizeof(unsigned));
+      if(id<nbound && p>lastbound)lastbound=p;
+    }
+    else for(unsigned p=0;p<Count;p++)if(Idp[p]<nbound && p>lastbound)lastbound=p;
     if(lastbound+1!=nbound)Run_Exceptioon("Order of boundary (fixed and moving) particles is invalid.");
   }
 }
@@ -129,6 +227,7 @@ void JPartsLoad4::CheckSortParticles(){
 /// Ordena particulas por Idp[].
 //==============================================================================
 void JPartsLoad4::SortParticles(){
+  LoadFileMapArrays();
   //-Checks order. | Comprueba orden.
   bool sorted=true;
   for(unsigned p=1;p<Count && sorted;p++)sorted=(Idp[p-1]<Idp[p]);
@@ -150,20 +249,23 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
 {
   Reset();
   PartBegin=partbegin;
-  JPartDataBi4 pd;
+  //-The first piece is loaded with the file mapped in memory to access to 
+  //-particle data in place when it is possible.
+  FileMap=new JPartDataBi4();
+  JPartDataBi4 &pd=*FileMap;
   //-Loads file piece_0 and obtains configuration.
   //-Carga fichero piece_0 y obtiene configuracion.
   const string dir=fun::GetDirWithSlash(!PartBegin? casedir: casedirbegin);
   if(!PartBegin){
     const string file1=dir+JPartDataBi4::GetFileNameCase(casename,0,1);
-    if(fun::FileExists(file1))pd.LoadFileCase(dir,casename,0,1);
-    else if(fun::FileExists(dir+JPartDataBi4::GetFileNameCase(casename,0,2)))pd.LoadFileCase(dir,casename,0,2);
+    if(fun::FileExists(file1))pd.LoadFileCase(dir,casename,0,1,true);
+    else if(fun::FileExists(dir+JPartDataBi4::GetFileNameCase(casename,0,2)))pd.LoadFileCase(dir,casename,0,2,true);
     else Run_ExceptioonFile("File of the particles was not found.",file1);
   }
   else{
     const string file1=dir+JPartDataBi4::GetFileNamePart(PartBegin,0,1);
-    if(fun::FileExists(file1))pd.LoadFilePart(dir,PartBegin,0,1);
-    else if(fun::FileExists(dir+JPartDataBi4::GetFileNamePart(PartBegin,0,2)))pd.LoadFilePart(dir,PartBegin,0,2);
+    if(fun::FileExists(file1))pd.LoadFilePart(dir,PartBegin,0,1,true);
+    else if(fun::FileExists(dir+JPartDataBi4::GetFileNamePart(PartBegin,0,2)))pd.LoadFilePart(dir,PartBegin,0,2,true);
     else Run_ExceptioonFile("File of the particles was not found.",file1);
   }
   //-Obtains configuration. | Obtiene configuracion.
@@ -200,25 +302,28 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
     JPartDataBi4 pd2;
     if(!PartBegin)pd2.LoadFileCase(dir,casename,piece,Npiece);
     else pd2.LoadFilePart(dir,PartBegin,piece,Npiece);
-    sizetot+=pd.Get_Npok();
+    sizetot+=pd2.Get_Npok();
   }
-  //-Allocates memory.
-  AllocMemory(sizetot);
-  //-Loads particles.
-  {
+  //-Uses particle data in the file mapped in memory (it is converted later).
+  //-Usa datos de particulas en el fichero proyectado en memoria.
+  if(Npiece==1 && sizetot && SetFileMap())Count=sizetot;
+  else{
+    //-Allocates memory.
+    AllocMemory(sizetot);
+    //-Loads particles.
     unsigned ntot=0;
     unsigned auxsize=0;
     tfloat3 *auxf3=NULL;
     float *auxf=NULL;
     for(unsigned piece=0;piece<Npiece;piece++){
       if(piece){
-        if(!PartBegin)pd.LoadFileCase(dir,casename,piece,Npiece);
-        else pd.LoadFilePart(dir,PartBegin,piece,Npiece);
+        if(!PartBegin)pd.LoadFileCase(dir,casename,piece,Npiece,true);
+        else pd.LoadFilePart(dir,PartBegin,piece,Npiece,true);
       }
-      const unsigned npok=pd.Get_Npok();
+      const int npok=int(pd.Get_Npok());
       if(npok){
-        if(auxsize<npok){
-          auxsize=npok;
+        if(auxsize<unsigned(npok)){
+          auxsize=unsigned(npok);
           delete[] auxf3; auxf3=NULL;
           delete[] auxf;  auxf=NULL;
           auxf3=new tfloat3[auxsize];
@@ -226,23 +331,32 @@ void JPartsLoad4::LoadParticles(const std::string &casedir,const std::string &ca
         }
         if(possingle){
           pd.Get_Pos(npok,auxf3);
-          for(unsigned p=0;p<npok;p++)Pos[ntot+p]=ToTDouble3(auxf3[p]);
+          tdouble3 *pos=Pos+ntot;
+          #ifdef OMP_USE
+            #pragma omp parallel for schedule(static) if(UseOmp && npok>OMP_LIMIT_LIGHT)
+          #endif
+          for(int p=0;p<npok;p++)pos[p]=ToTDouble3(auxf3[p]);
         }
         else pd.Get_Posd(npok,Pos+ntot);
         pd.Get_Idp(npok,Idp+ntot);  
         pd.Get_Vel(npok,auxf3);  
         pd.Get_Rhop(npok,auxf);  
-        for(unsigned p=0;p<npok;p++)VelRhop[ntot+p]=TFloat4(auxf3[p].x,auxf3[p].y,auxf3[p].z,auxf[p]);
+        tfloat4 *velrhop=VelRhop+ntot;
+        #ifdef OMP_USE
+          #pragma omp parallel for schedule(static) if(UseOmp && npok>OMP_LIMIT_LIGHT)
+        #endif
+        for(int p=0;p<npok;p++)velrhop[p]=TFloat4(auxf3[p].x,auxf3[p].y,auxf3[p].z,auxf[p]);
       }
-      ntot+=npok;
+      ntot+=unsigned(npok);
     }
     delete[] auxf3; auxf3=NULL;
     delete[] auxf;  auxf=NULL;
+    FreeFileMap();
   }
   //-In simulations 2D, if PosY is invalid then calculates starting from position of particles.
   if(Simulate2DPosY==DBL_MAX){
     if(!sizetot)Run_Exceptioon("Number of particles is invalid to calculates Y in 2D simulations.");
-    Simulate2DPosY=Pos[0].y;
+    Simulate2DPosY=(!FileMap? Pos[0].y: GetFileMapPos(0).y);
   }
   //-Checks order of boundary particles.
   CheckSortParticles();
@@ -279,6 +393,7 @@ void JPartsLoad4::CheckConfig(ullong casenp,ullong casenfixed,ullong casenmoving
 /// Elimina particulas de contorno.
 //==============================================================================
 void JPartsLoad4::RemoveBoundary(){
+  LoadFileMapArrays();
   const unsigned casenbound=unsigned(CaseNp-CaseNfluid);
   //-Calculate number of boundary particles. 
   unsigned nbound=0;
@@ -318,7 +433,7 @@ void JPartsLoad4::CalculateCasePos(){
   //-Calculates minimum and maximum position. 
   //-Calcula posicion minima y maxima. 
   for(unsigned p=0;p<Count;p++){
-    const tdouble3 ps=Pos[p];
+    const tdouble3 ps=(!FileMap? Pos[p]: GetFileMapPos(p));
     if(pmin.x>ps.x)pmin.x=ps.x;
     if(pmin.y>ps.y)pmin.y=ps.y;
     if(pmin.z>ps.z)pmin.z=ps.z;
@@ -34,6 +34,8 @@
 //:# - No reordena paraticulas para reducir diferencias usando restart. (23-04-2018)
 //:# - Improved definition of the periodic conditions. (27-04-2018)
 //:# - Mejora la gestion de excepciones. (06-05-2020)
+//:# - Carga con el fichero proyectado en memoria (mmap) sin copias intermedias
+//:#   y conversion paralela de datos. (17-10-2026)
 //:#############################################################################
 
 /// \file JPartsLoad4.h \brief Declares the class \ref JPartsLoad4.
@@ -46,6 +48,8 @@
 #include "JObject.h"
 #include <cstring>
 
+class JPartDataBi4;
+
 //##############################################################################
 //# JPartsLoad4
 //##############################################################################
@@ -91,7 +95,21 @@ protected:
   tdouble3 *Pos;
   tfloat4 *VelRhop;
 
+  //-Particle data in the file mapped in memory (one piece without compression).
+  //-Data is not aligned so it is read using memcpy().
+  JPartDataBi4 *FileMap;   ///<Object with file mapped in memory while particle data is used.
+  const byte *MapIdp;      ///<Idp data (unsigned) in file.
+  const byte *MapPos;      ///<Pos data (tfloat3) in file.
+  const byte *MapPosd;     ///<Posd data (tdouble3) in file.
+  const byte *MapVel;      ///<Vel data (tfloat3) in file.
+  const byte *MapRhop;     ///<Rhop data (float) in file.
+
   void AllocMemory(unsigned count);
+  void FreeFileMap();
+  bool SetFileMap();
+  void LoadFileMapArrays();
+  void CopyFileMap(unsigned *idp,tdouble3 *pos,tfloat4 *velrhop)const;
+  tdouble3 GetFileMapPos(unsigned p)const;
   template<typename T> T* SortParticles(const unsigned *vsort,unsigned count,T *v)const;
   void CheckSortParticles();
   void SortParticles();
@@ -118,9 +136,11 @@ public:
   double GetPartBeginTimeStep()const{ return(PartBeginTimeStep); }
   ullong GetPartBeginTotalNp()const{ return(PartBeginTotalNp); }
 
-  const unsigned* GetIdp(){ return(Idp); }
-  const tdouble3* GetPos(){ return(Pos); }
-  const tfloat4* GetVelRhop(){ return(VelRhop); }
+  const unsigned* GetIdp(){ LoadFileMapArrays(); return(Idp); }
+  const tdouble3* GetPos(){ LoadFileMapArrays(); return(Pos); }
+  const tfloat4* GetVelRhop(){ LoadFileMapArrays(); return(VelRhop); }
+  void GetParticles(unsigned np,unsigned *idp,tdouble3 *pos,tfloat4 *velrhop)const;
+  bool UseFileMap()const{ return(FileMap!=NULL); }
 
   tdouble3 GetCasePosMin()const{ return(CasePosMin); }
   tdouble3 GetCasePosMax()const{ return(CasePosMax); }
@@ -107,6 +107,27 @@ void JPartsOut::AddData(unsigned np,const typecode* code){
   //printf("\n=====> count:%d outpos:%d\n",Count,OutPosCount);
 }
 
+//==============================================================================
+/// Adds motive information (1:position, 2:rhop, 3:velocity) and updates numbers.
+//==============================================================================
+void JPartsOut::AddData(unsigned np,const byte* motive){
+  unsigned outpos=0,outrhop=0,outmove=0;
+  for(unsigned c=0;c<np;c++){
+    switch(motive[c]){
+      case 1:  outpos++;   break;
+      case 2:  outrhop++;  break;
+      case 3:  outmove++;  break;
+      default: Run_Exceptioon("Motive of excluded particle is invalid.");
+    }
+  }
+  memcpy(Motive+Count,motive,sizeof(byte)*np);
+  //-Updates numbers.
+  Count+=np;
+  OutPosCount+=outpos;
+  OutRhopCount+=outrhop;
+  OutMoveCount+=outmove;
+}
+
 //==============================================================================
 /// Adds out particles data.
 //==============================================================================
@@ -122,5 +143,20 @@ void JPartsOut::AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos
   AddData(np,code);
 }
 
+//==============================================================================
+/// Adds out particles data with the motive for exclusion (1:position, 2:rhop, 3:velocity).
+//==============================================================================
+void JPartsOut::AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos
+  ,const tfloat3* vel,const float* rhop,const byte* motive)
+{
+  if(Count+np>Size)AllocMemory(Count+np+SizeUnit,false);
+  memcpy(Idp +Count,idp ,sizeof(unsigned)*np);
+  memcpy(Pos +Count,pos ,sizeof(tdouble3)*np);
+  memcpy(Vel +Count,vel ,sizeof(tfloat3 )*np);
+  memcpy(Rhop+Count,rhop,sizeof(float   )*np);
+  //-Adds motive information and updates numbers.
+  AddData(np,motive);
+}
+
 
 
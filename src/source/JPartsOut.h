@@ -26,6 +26,7 @@
 //:# - Se incluye el motivo de exclusion. (20-03-2018)
 //:# - Mejoras para compatibilidad con Multi-GPU. (10-09-2019)
 //:# - Mejora la gestion de excepciones. (06-05-2020)
+//:# - Permite anhadir particulas con el motivo de exclusion. (17-10-2026)
 //:#############################################################################
 
 /// \file JPartsOut.h \brief Declares the class \ref JPartsOut.
@@ -64,6 +65,7 @@ protected:
 
   void AllocMemory(unsigned size,bool reset);
   void AddData(unsigned np,const typecode* code);
+  void AddData(unsigned np,const byte* motive);
 
 public:
   JPartsOut(unsigned sizeunit=1024);
@@ -75,6 +77,8 @@ public:
 
   void AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos
     ,const tfloat3* vel,const float* rhop,const typecode* code);
+  void AddParticles(unsigned np,const unsigned* idp,const tdouble3* pos
+    ,const tfloat3* vel,const float* rhop,const byte* motive);
 
   unsigned GetSize()const{ return(Size); }
   unsigned GetCount()const{ return(Count); }
@@ -22,6 +22,7 @@
 #include "Functions.h"
 
 #include <cstring>
+#include <cmath>
 #include <cstdlib>
 #include <stdarg.h>
 
@@ -29,6 +30,209 @@ using namespace std;
 
 namespace jcsv{
 
+//##############################################################################
+//# JCsvBuffer
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JCsvBuffer::JCsvBuffer(unsigned capacity):Buf(NULL),Size(0),Capacity(0){
+  ClassName="JCsvBuffer";
+  if(capacity)Resize(capacity);
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JCsvBuffer::~JCsvBuffer(){
+  DestructorActive=true;
+  delete[] Buf; Buf=NULL;
+}
+
+//==============================================================================
+/// Resizes buffer to store at least capacity characters keeping the text.
+/// Redimensiona buffer para almacenar al menos capacity caracteres manteniendo el texto.
+//==============================================================================
+void JCsvBuffer::Resize(unsigned capacity){
+  unsigned newcap=(Capacity? Capacity*2: 256);
+  while(newcap<capacity)newcap*=2;
+  char *buf=new char[newcap];
+  if(Size)memcpy(buf,Buf,Size);
+  delete[] Buf;
+  Buf=buf;
+  Capacity=newcap;
+}
+
+//==============================================================================
+/// Adds text of len characters.
+//==============================================================================
+void JCsvBuffer::AddStr(const char *tx,unsigned len){
+  if(Size+len>Capacity)Resize(Size+len);
+  memcpy(Buf+Size,tx,len);
+  Size+=len;
+}
+
+//==============================================================================
+/// Adds unsigned integer value (same text as "%llu").
+//==============================================================================
+void JCsvBuffer::AddUllong(ullong v){
+  char tx[24];
+  unsigned n=0;
+  do{ tx[n++]=char('0'+unsigned(v%10)); v/=10; }while(v);
+  if(Size+n>Capacity)Resize(Size+n);
+  for(unsigned c=0;c<n;c++)Buf[Size+c]=tx[n-1-c];
+  Size+=n;
+}
+
+//==============================================================================
+/// Adds real value v with format "%[width][.prec]f", "%[width][.prec]e" or 
+/// "%[width][.prec]E" (conv is f, e or E). The value is scaled by an exact power
+/// of ten and rounded to an integer whose digits are written directly. When the
+/// scaled value is too big or its rounding is not certain (it is close to a tie
+/// with the error of the scaling), the value is written with snprintf(), so the
+/// text is always the same as with printf().
+///
+/// Anhade valor real v con formato "%[width][.prec]f", "%[width][.prec]e" o 
+/// "%[width][.prec]E" (conv es f, e o E). El valor se escala por una potencia de
+/// diez exacta y se redondea a un entero cuyos digitos se escriben directamente.
+/// Cuando el valor escalado es demasiado grande o su redondeo no es seguro (esta
+/// cerca de un empate con el error del escalado), el valor se escribe con 
+/// snprintf(), asi el texto es siempre el mismo que con printf().
+//==============================================================================
+void JCsvBuffer::AddDoubleFmt(double v,char conv,unsigned width,unsigned prec,const char *format){
+  static const double pow10[23]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11
+    ,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+  const double maxscaled=9007199254740992.;  //-2^53.
+  //-Sign, denormal, infinite and NaN values are checked with the bits of v (-ffast-math).
+  ullong bits;
+  memcpy(&bits,&v,sizeof(double));
+  const bool neg=((bits>>63)!=0);
+  const unsigned bexp=unsigned((bits>>52)&0x7FF);
+  const double av=fabs(v);
+  bool ok=(prec<=17 && bexp!=0x7FF && (bexp!=0 || (bits<<1)==0));
+  ullong num=0;
+  int e10=0;
+  if(ok && av>0){
+    double s=0;
+    if(conv=='f'){
+      s=av*pow10[prec];
+      ok=(s<maxscaled);
+    }
+    else{
+      e10=int(floor(log10(av)));
+      for(int c=0;c<3 && ok;c++){
+        const int k=int(prec)-e10;
+        ok=(k>=-22 && k<=22);
+        if(ok){
+          s=(k>=0? av*pow10[k]: av/pow10[-k]);
+          if(s>=pow10[prec+1])e10++;
+          else if(s<pow10[prec])e10--;
+          else break;
+        }
+      }
+      ok=(ok && s>=pow10[prec] && s<pow10[prec+1]);
+    }
+    if(ok){
+      //-The scaled value has one rounding error (relative error up to 2^-53). 
+      const double fl=floor(s);
+      const double frac=s-fl;
+      ok=(fabs(frac-0.5)>s*2.3e-16);
+      num=ullong(fl)+(frac>0.5? 1: 0);
+      if(ok && conv!='f' && num>=ullong(pow10[prec+1])){ num/=10; e10++; }
+    }
+  }
+  if(!ok){
+    char tx[512];
+    const int n=snprintf(tx,sizeof(tx),format,v);
+    if(n<0 || unsigned(n)>=sizeof(tx))Run_Exceptioon("Error formatting text.");
+    AddStr(tx,unsigned(n));
+    return;
+  }
+  //-Digits of num (prec+1 digits at least). | Digitos de num.
+  char dg[24];
+  unsigned nd=0;
+  do{ dg[nd++]=char('0'+unsigned(num%10)); num/=10; }while(num);
+  while(nd<prec+1)dg[nd++]='0';
+  //-Text of value. | Texto del valor.
+  char tx[64];
+  unsigned n=0;
+  if(neg)tx[n++]='-';
+  if(conv=='f'){
+    for(unsigned c=nd;c>prec;c--)tx[n++]=dg[c-1];
+    if(prec)tx[n++]='.';
+    for(unsigned c=prec;c>0;c--)tx[n++]=dg[c-1];
+  }
+  else{
+    tx[n++]=dg[nd-1];
+    if(prec)tx[n++]='.';
+    for(unsigned c=nd-1;c>0;c--)tx[n++]=dg[c-1];
+    tx[n++]=conv;
+    tx[n++]=(e10<0? '-': '+');
+    const unsigned ae=unsigned(e10<0? -e10: e10);
+    if(ae>=100)tx[n++]=char('0'+ae/100);
+    tx[n++]=char('0'+(ae/10)%10);
+    tx[n++]=char('0'+ae%10);
+  }
+  if(n<width){
+    const unsigned sp=width-n;
+    if(Size+sp>Capacity)Resize(Size+sp);
+    memset(Buf+Size,' ',sp);
+    Size+=sp;
+  }
+  AddStr(tx,n);
+}
+
+//==============================================================================
+/// Adds text using the same parameters used in vprintf().
+/// Integer formats "%d", "%u", "%lld" and "%llu" and real formats 
+/// "%[width][.prec]f", "%[width][.prec]e" and "%[width][.prec]E" are converted
+/// directly (see AddDoubleFmt()), the rest use vsnprintf().
+//==============================================================================
+void JCsvBuffer::AddFmtV(const char *format,va_list args){
+  if(format[0]=='%'){
+    const char *f=format+1;
+    if(f[0]=='d' && !f[1]){ AddInt(va_arg(args,int)); return; }
+    if(f[0]=='u' && !f[1]){ AddUint(va_arg(args,unsigned)); return; }
+    if(f[0]=='l' && f[1]=='l'){
+      if(f[2]=='d' && !f[3]){ AddLlong(va_arg(args,llong)); return; }
+      if(f[2]=='u' && !f[3]){ AddUllong(va_arg(args,ullong)); return; }
+    }
+    //-Real formats with optional width and precision. | Formatos reales con ancho y precision opcionales.
+    unsigned width=0,prec=6;
+    while(*f>='0' && *f<='9' && width<100)width=width*10+unsigned(*f++-'0');
+    if(*f=='.'){
+      f++; prec=0;
+      while(*f>='0' && *f<='9' && prec<100)prec=prec*10+unsigned(*f++-'0');
+    }
+    if((*f=='f' || *f=='e' || *f=='E') && !f[1] && format[1]!='0'){
+      AddDoubleFmt(va_arg(args,double),*f,width,prec,format);
+      return;
+    }
+  }
+  if(Capacity-Size<64)Resize(Size+64);
+  va_list args2;
+  va_copy(args2,args);
+  const int n=vsnprintf(Buf+Size,Capacity-Size,format,args2);
+  va_end(args2);
+  if(n<0)Run_Exceptioon("Error formatting text.");
+  if(unsigned(n)>=Capacity-Size){
+    Resize(Size+unsigned(n)+1);
+    vsnprintf(Buf+Size,Capacity-Size,format,args);
+  }
+  Size+=unsigned(n);
+}
+
+//==============================================================================
+/// Adds text using the same parameters used in printf().
+//==============================================================================
+void JCsvBuffer::AddFmt(const char *format,...){
+  va_list args;
+  va_start(args,format);
+  AddFmtV(format,args);
+  va_end(args);
+}
+
+
 //##############################################################################
 //# JSaveCsv2
 //##############################################################################
@@ -131,6 +335,30 @@ void JSaveCsv2::AddStr(std::string tx){
   }
 }
  
+//==============================================================================
+/// Adds text of len characters to data or head (the text can be modified).
+//==============================================================================
+void JSaveCsv2::AddStr(char *tx,unsigned len){
+  if(AutoSepEnable)SetSeparators(tx,len);
+  const bool jump=(len && tx[0]=='\n');
+  std::string &dst=(DataSelected? Data: Head);
+  if(!(dst.empty() || dst[dst.size()-1]=='\n' || jump))dst.append(";");
+  dst.append(tx,len);
+}
+
+//==============================================================================
+/// Adds value to data or head using the same parameters used in printf().
+/// The value is formatted in FmtBuff without temporary strings.
+//==============================================================================
+void JSaveCsv2::AddFmt(const char *format,...){
+  FmtBuff.Clear();
+  va_list args;
+  va_start(args,format);
+  FmtBuff.AddFmtV(format,args);
+  va_end(args);
+  AddStr(FmtBuff.GetPtr(),FmtBuff.GetSize());
+}
+
 //==============================================================================
 /// Adds one or several field separators.
 //==============================================================================
@@ -235,6 +463,16 @@ void JSaveCsv2::SetSeparators(std::string &tx)const{
   for(unsigned c=0;c<size;c++)if(tx[c]==sep0)tx[c]=sep1;
 }
 
+//==============================================================================
+/// Sets separators of text with len characters according configuration.
+/// Cambia separadores del texto con len caracteres segun configuracion.
+//==============================================================================
+void JSaveCsv2::SetSeparators(char *tx,unsigned len)const{
+  const char sep0=(CsvSepComa? ';': ',');
+  const char sep1=(CsvSepComa? ',': ';');
+  for(unsigned c=0;c<len;c++)if(tx[c]==sep0)tx[c]=sep1;
+}
+
 //==============================================================================
 /// Writes data in file.
 /// Graba datos en fichero.
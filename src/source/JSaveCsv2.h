@@ -32,6 +32,9 @@
 //:# - Nuevo metodo GetAppendMode() para saber si se va ampliar un fichero existente. (06-07-2018)
 //:# - Error corregido en SaveData() por el que siempre se grababa el head. (13-08-2018)
 //:# - Gestion de excepciones mejorada.  (15-09-2019)
+//:# - Nueva clase JCsvBuffer para formatear valores sin reservar memoria, con 
+//:#   conversion directa de enteros. JSaveCsv2 la usa para formatear. (17-10-2026)
+//:# - JCsvBuffer convierte directamente los formatos reales %[w][.p]f/e/E. (17-10-2026)
 //:#############################################################################
 
 /// \file JSaveCsv2.h \brief Declares the class \ref JSaveCsv2.
@@ -46,6 +49,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <cstdarg>
 
 /// Implements a set of classes to create CSV files.
 namespace jcsv{
@@ -130,6 +134,60 @@ public:
 };
 
 
+//##############################################################################
+//# JCsvBuffer
+//##############################################################################
+/// \brief Text buffer to format values of CSV files without temporary strings.
+///
+/// The values are formatted at the end of the buffer, which only grows when it
+/// is full. The integer formats "%d", "%u", "%lld" and "%llu" and the real 
+/// formats "%[width][.prec]f/e/E" are converted directly. Real values are only
+/// written directly when the rounding is exact in double, otherwise (and for the
+/// other formats) vsnprintf() is used into the buffer, so the text is always the
+/// same as with printf().
+///
+/// Buffer de texto para formatear valores de ficheros CSV sin strings temporales.
+/// Los valores se formatean al final del buffer, que solo crece cuando esta 
+/// lleno. Los formatos enteros "%d", "%u", "%lld" y "%llu" y los reales 
+/// "%[width][.prec]f/e/E" se convierten directamente. Los reales solo se escriben
+/// directamente cuando el redondeo es exacto en double, si no (y para los demas
+/// formatos) se usa vsnprintf() sobre el buffer, asi el texto es igual que printf().
+
+class JCsvBuffer : protected JObject
+{
+protected:
+  char *Buf;           ///<Text buffer [Capacity].
+  unsigned Size;       ///<Size of text in buffer.
+  unsigned Capacity;   ///<Allocated size of buffer.
+
+  void Resize(unsigned capacity);
+  void AddDoubleFmt(double v,char conv,unsigned width,unsigned prec,const char *format);
+
+private:
+  JCsvBuffer(const JCsvBuffer&);
+  JCsvBuffer& operator=(const JCsvBuffer&);
+
+public:
+  JCsvBuffer(unsigned capacity=0);
+  ~JCsvBuffer();
+  void Clear(){ Size=0; }
+  void Reserve(unsigned capacity){ if(capacity>Capacity)Resize(capacity); }
+
+  unsigned GetSize()const{ return(Size); }
+  char* GetPtr(){ return(Buf); }
+  const char* GetPtr()const{ return(Buf); }
+
+  void AddChar(char c){ if(Size>=Capacity)Resize(Size+1); Buf[Size++]=c; }
+  void AddStr(const char *tx,unsigned len);
+  void AddUllong(ullong v);
+  void AddLlong(llong v){ if(v<0){ AddChar('-'); AddUllong(ullong(0)-ullong(v)); } else AddUllong(ullong(v)); }
+  void AddUint(unsigned v){ AddUllong(v); }
+  void AddInt(int v){ AddLlong(v); }
+  void AddFmtV(const char *format,va_list args);
+  void AddFmt(const char *format,...);
+};
+
+
 //##############################################################################
 //# JSaveCsv2
 //##############################################################################
@@ -159,12 +217,17 @@ private:
   std::string Data;
   bool DataLineEmpty;
 
+  JCsvBuffer FmtBuff; ///<Buffer to format values.
+
   void InitFmt();
   void AddStr(std::string tx);
+  void AddStr(char *tx,unsigned len);
+  void AddFmt(const char *format,...);
   void AddSeparator(unsigned count);
   void AddEndl();
   void Save(const std::string &tx);
   void SetSeparators(std::string &tx)const;
+  void SetSeparators(char *tx,unsigned len)const;
   void OpenFile();
   //void R unException(const std::string &method,const std::string &msg){
   //  ExceptionThrown=true; JObject::R unException(method,msg);
@@ -198,34 +261,34 @@ public:
 
   JSaveCsv2& operator <<(const std::string &v){ AddStr(v); return(*this); }
 
-  JSaveCsv2& operator <<(char     v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(short    v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(int      v){ AddStr(ToStr(FmtCurrent[TpSigned1  ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(byte     v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(word     v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(unsigned v){ AddStr(ToStr(FmtCurrent[TpUnsigned1].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(char     v){ AddFmt(FmtCurrent[TpSigned1  ].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(short    v){ AddFmt(FmtCurrent[TpSigned1  ].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(int      v){ AddFmt(FmtCurrent[TpSigned1  ].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(byte     v){ AddFmt(FmtCurrent[TpUnsigned1].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(word     v){ AddFmt(FmtCurrent[TpUnsigned1].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(unsigned v){ AddFmt(FmtCurrent[TpUnsigned1].c_str(),v); return(*this); }
 
-  JSaveCsv2& operator <<(llong    v){ AddStr(ToStr(FmtCurrent[TpLlong1   ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(ullong   v){ AddStr(ToStr(FmtCurrent[TpUllong1  ].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(llong    v){ AddFmt(FmtCurrent[TpLlong1   ].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(ullong   v){ AddFmt(FmtCurrent[TpUllong1  ].c_str(),v); return(*this); }
 
-  JSaveCsv2& operator <<(float    v){ AddStr(ToStr(FmtCurrent[TpFloat1   ].c_str(),v)); return(*this); }
-  JSaveCsv2& operator <<(double   v){ AddStr(ToStr(FmtCurrent[TpDouble1  ].c_str(),v)); return(*this); }
+  JSaveCsv2& operator <<(float    v){ AddFmt(FmtCurrent[TpFloat1   ].c_str(),v); return(*this); }
+  JSaveCsv2& operator <<(double   v){ AddFmt(FmtCurrent[TpDouble1  ].c_str(),v); return(*this); }
 
-  JSaveCsv2& operator <<(const tint2   &v){ AddStr(ToStr(FmtCurrent[TpSigned2  ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tint3   &v){ AddStr(ToStr(FmtCurrent[TpSigned3  ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tint4   &v){ AddStr(ToStr(FmtCurrent[TpSigned4  ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tint2   &v){ AddFmt(FmtCurrent[TpSigned2  ].c_str(),v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tint3   &v){ AddFmt(FmtCurrent[TpSigned3  ].c_str(),v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tint4   &v){ AddFmt(FmtCurrent[TpSigned4  ].c_str(),v.x,v.y,v.z,v.w); return(*this); }
 
-  JSaveCsv2& operator <<(const tuint2  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned2].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tuint3  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned3].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tuint4  &v){ AddStr(ToStr(FmtCurrent[TpUnsigned4].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tuint2  &v){ AddFmt(FmtCurrent[TpUnsigned2].c_str(),v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tuint3  &v){ AddFmt(FmtCurrent[TpUnsigned3].c_str(),v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tuint4  &v){ AddFmt(FmtCurrent[TpUnsigned4].c_str(),v.x,v.y,v.z,v.w); return(*this); }
 
-  JSaveCsv2& operator <<(const tfloat2  &v){ AddStr(ToStr(FmtCurrent[TpFloat2  ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tfloat3  &v){ AddStr(ToStr(FmtCurrent[TpFloat3  ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tfloat4  &v){ AddStr(ToStr(FmtCurrent[TpFloat4  ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tfloat2  &v){ AddFmt(FmtCurrent[TpFloat2  ].c_str(),v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tfloat3  &v){ AddFmt(FmtCurrent[TpFloat3  ].c_str(),v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tfloat4  &v){ AddFmt(FmtCurrent[TpFloat4  ].c_str(),v.x,v.y,v.z,v.w); return(*this); }
 
-  JSaveCsv2& operator <<(const tdouble2 &v){ AddStr(ToStr(FmtCurrent[TpDouble2 ].c_str(),v.x,v.y));         return(*this); }
-  JSaveCsv2& operator <<(const tdouble3 &v){ AddStr(ToStr(FmtCurrent[TpDouble3 ].c_str(),v.x,v.y,v.z));     return(*this); }
-  JSaveCsv2& operator <<(const tdouble4 &v){ AddStr(ToStr(FmtCurrent[TpDouble4 ].c_str(),v.x,v.y,v.z,v.w)); return(*this); }
+  JSaveCsv2& operator <<(const tdouble2 &v){ AddFmt(FmtCurrent[TpDouble2 ].c_str(),v.x,v.y);         return(*this); }
+  JSaveCsv2& operator <<(const tdouble3 &v){ AddFmt(FmtCurrent[TpDouble3 ].c_str(),v.x,v.y,v.z);     return(*this); }
+  JSaveCsv2& operator <<(const tdouble4 &v){ AddFmt(FmtCurrent[TpDouble4 ].c_str(),v.x,v.y,v.z,v.w); return(*this); }
 
   void SaveData(bool closefile=false);
 };
@@ -47,6 +47,8 @@
 #include "JPartOutBi4Save.h"
 #include "JPartFloatBi4.h"
 #include "JPartsOut.h"
+#include "JSphSaveAsync.h"
+#include "JSphCheckpoint.h"
 #include "JShifting.h"
 #include "JDamping.h"
 #include "JSphInitialize.h"
@@ -57,6 +59,7 @@
 #include "JNormalsMarrone.h" //<vs_mddbc>
 #include "JDataArrays.h"
 #include "JOutputCsv.h"
+#include "JOutputVtu.h"
 #include "JVtkLib.h"
 #include "JNumexLib.h"
 #include "JSpaceUserVars.h"
@@ -73,6 +76,8 @@ JSph::JSph(bool cpu,bool mgpu,bool withmpi):Cpu(cpu),Mgpu(mgpu),WithMpi(withmpi)
   DataBi4=NULL;
   DataOutBi4=NULL;
   DataFloatBi4=NULL;
+  SaveAsync=NULL;
+  Checkpoint=NULL;
   PartsOut=NULL;
   Log=NULL;
   ViscoTime=NULL;
@@ -108,6 +113,8 @@ JSph::JSph(bool cpu,bool mgpu,bool withmpi):Cpu(cpu),Mgpu(mgpu),WithMpi(withmpi)
 //==============================================================================
 JSph::~JSph(){
   DestructorActive=true;
+  delete SaveAsync;     SaveAsync=NULL; //-Waits for pending PARTs before deleting DataBi4...
+  delete Checkpoint;    Checkpoint=NULL;
   delete DataBi4;       DataBi4=NULL;
   delete DataOutBi4;    DataOutBi4=NULL;
   delete DataFloatBi4;  DataFloatBi4=NULL;
@@ -186,6 +193,12 @@ void JSph::InitVars(){
   SvData=byte(SDAT_Binx)|byte(SDAT_Info);
   SvRes=false;
   SvTimers=false;
+  SvAsync=0;
+  SvAsyncCores.clear();
+  SvComp=-1;
+  SvVtuComp=false;
+  SvVtuPieces=-1;
+  SvCheckpoint=-1;
   SvDomainVtk=false;
 
   H=CteB=Gamma=RhopZero=CFLnumber=0;
@@ -207,6 +220,7 @@ void JSph::InitVars(){
   PartBegin=PartBeginFirst=0;
   PartBeginTimeStep=0; 
   PartBeginTotalNp=0;
+  CheckpointFile="";
 
   WrnPartsOut=true;
 
@@ -459,6 +473,7 @@ void JSph::LoadConfig(const JCfgRun *cfg){
   RunName=(cfg->RunName.length()? cfg->RunName: CaseName);
   FileXml=DirCase+CaseName+".xml";
   PartBeginDir=cfg->PartBeginDir; PartBegin=cfg->PartBegin; PartBeginFirst=cfg->PartBeginFirst;
+  CheckpointFile=cfg->CheckpointFile;
   //-Output options:
   CsvSepComa=cfg->CsvSepComa;
   SvData=byte(SDAT_None); 
@@ -466,14 +481,24 @@ void JSph::LoadConfig(const JCfgRun *cfg){
   if(cfg->Sv_Binx)SvData|=byte(SDAT_Binx);
   if(cfg->Sv_Info)SvData|=byte(SDAT_Info);
   if(cfg->Sv_Vtk)SvData|=byte(SDAT_Vtk);
+  if(cfg->Sv_Vtu)SvData|=byte(SDAT_Vtu);
   SvRes=cfg->SvRes;
   SvTimers=cfg->SvTimers;
+  SvAsync=cfg->SvAsync;
+  SvComp=cfg->SvComp;
+  SvVtuComp=cfg->SvVtuComp;
+  SvVtuPieces=cfg->SvVtuPieces;
+  SvCheckpoint=cfg->SvCheckpoint;
   SvDomainVtk=cfg->SvDomainVtk;
 
   printf("\n");
   RunTimeDate=fun::GetDateTime();
   Log->Printf("[Initialising %s  %s]",ClassName.c_str(),RunTimeDate.c_str());
-  if(!JVtkLib::Available())Log->PrintWarning("Code for VTK format files is not included in the current compilation, so no output VTK files will be created.");
+  if(!JVtkLib::Available() && (SvData&SDAT_Vtk)){//-Particle data is saved with the built-in VTU writer.
+    SvData=byte((SvData&(~SDAT_Vtk))|SDAT_Vtu);
+    Log->PrintWarning("Code for VTK format files is not included in the current compilation, so particle data requested in VTK format will be saved in VTU format (-sv:vtu) and other VTK files will not be created.");
+  }
+  else if(!JVtkLib::Available())Log->PrintWarning("Code for VTK format files is not included in the current compilation, so no output VTK files will be created.");
   const string runpath=AppInfo.GetRunPath();
   Log->Printf("ProgramFile=\"%s\"",fun::GetPathLevels(fun::GetCanonicalPath(runpath,AppInfo.GetRunCommand()),3).c_str());
   Log->Printf("ExecutionDir=\"%s\"",fun::GetPathLevels(runpath,3).c_str());
@@ -492,9 +517,25 @@ void JSph::LoadConfig(const JCfgRun *cfg){
     Log->Print(fun::VarStr("PartBeginDir",PartBeginDir));
     Log->Print(fun::VarStr("PartBeginFirst",PartBeginFirst));
   }
+  if(!CheckpointFile.empty())Log->Print(fun::VarStr("CheckpointFile",CheckpointFile));
 
   //-Loads case configuration from XML and command line.
   LoadCaseConfig(cfg);
+
+  //-Checks compatibility of checkpoints with selected options.
+  if(SvCheckpoint>=0 || !CheckpointFile.empty()){
+    bool unsupported=(!Cpu);
+    if(InOut || BoundCorr)unsupported=true;      //<vs_innlet>
+    if(ChronoObjects)unsupported=true;           //<vs_chroono>
+    if(Moorings || ForcePoints)unsupported=true; //<vs_moordyyn>
+    if(!CheckpointFile.empty()){
+      if(unsupported || PartBegin)Run_Exceptioon("Restart from checkpoint is only available for CPU executions without -partbegin, inlet/outlet, BoundCorr, Chrono, moorings or FtForces.");
+    }
+    if(SvCheckpoint>=0 && unsupported){
+      Log->PrintWarning("Checkpoints (-svcheckpoint) are only available for CPU executions without inlet/outlet, BoundCorr, Chrono, moorings or FtForces, so they are disabled.");
+      SvCheckpoint=-1;
+    }
+  }
 }
 
 //==============================================================================
@@ -1395,6 +1436,13 @@ void JSph::VisuConfig()const{
   Log->Print(fun::VarStr("SavePosDouble",SvPosDouble));
   Log->Print(fun::VarStr("SaveFtAce",SaveFtAce));
   Log->Print(fun::VarStr("SvTimers",SvTimers));
+  Log->Print(fun::VarStr("SvAsync",SvAsync));
+  Log->Print(fun::VarStr("SvComp",SvComp));
+  if(SvData&SDAT_Vtu){
+    Log->Print(fun::VarStr("SvVtuComp",SvVtuComp));
+    Log->Print(fun::VarStr("SvVtuPieces",SvVtuPieces));
+  }
+  Log->Print(fun::VarStr("SvCheckpoint",SvCheckpoint));
   Log->Print(fun::VarStr("Boundary",GetBoundName(TBoundary)));
   if(TBoundary==BC_MDBC){ //<vs_mddbc_ini>
     Log->Print(fun::VarStr("  SlipMode",GetSlipName(SlipMode)));
@@ -1797,7 +1845,7 @@ void JSph::LoadCaseParticles(){
   PartsLoaded->LoadParticles(DirCase,CaseName,PartBegin,PartBeginDir);
   PartsLoaded->CheckConfig(CaseNp,CaseNfixed,CaseNmoving,CaseNfloat,CaseNfluid,Simulate2D,Simulate2DPosY,TpPeri(PeriActive));
   if(PartBegin)RestartCheckData();
-  Log->Printf("Loaded particles: %u",PartsLoaded->GetCount());
+  Log->Printf("Loaded particles: %u%s",PartsLoaded->GetCount(),(PartsLoaded->UseFileMap()? " (file mapped in memory)": ""));
 
   //-Collect information of loaded particles.
   //-Recupera informacion de las particulas cargadas.
@@ -2062,9 +2110,11 @@ void JSph::ConfigSaveData(unsigned piece,unsigned pieces,std::string div){
     else if(div=="Y")DataBi4->ConfigSimDiv(JPartDataBi4::DIV_Y);
     else if(div=="Z")DataBi4->ConfigSimDiv(JPartDataBi4::DIV_Z);
     else Run_Exceptioon("The division configuration is invalid.");
+    if(SvComp>=0)DataBi4->ConfigCompression(true,(SvComp? double(Scell)/double(1u<<SvComp): 0));
     if(SvData&SDAT_Binx)Log->AddFileInfo(DirDataOut+"Part_????.bi4","Binary file with particle data in different instants.");
     if(SvData&SDAT_Info)Log->AddFileInfo(DirDataOut+"PartInfo.ibi4","Binary file with execution information for each instant (input for PartInfo program).");
   }
+  if(SvData&SDAT_Vtu)Log->AddFileInfo(DirDataOut+(SvVtuPieces>=0? "PartVtu_????.pvtu": "PartVtu_????.vtu"),"VTK XML file with particle data in different instants.");
   //-Configures object to store excluded particles.  
   //-Configura objeto para grabacion de particulas excluidas.
   if(SvData&SDAT_Binx){
@@ -2090,6 +2140,15 @@ void JSph::ConfigSaveData(unsigned piece,unsigned pieces,std::string div){
   //-Creates object to store excluded particles until recordering. 
   //-Crea objeto para almacenar las particulas excluidas hasta su grabacion.
   PartsOut=new JPartsOut();
+  //-Creates object to store PART data in background.
+  //-Crea objeto para grabar datos de PART en segundo plano.
+  if(SvAsync)SaveAsync=new JSphSaveAsync(this,SvAsync);
+  //-Creates object to store checkpoints with the complete state.
+  //-Crea objeto para grabar checkpoints con el estado completo.
+  if(SvCheckpoint>=0){
+    Checkpoint=new JSphCheckpoint(Log,SvCheckpoint,JSphCheckpoint::GetFileDef(DirOut));
+    Checkpoint->VisuConfig("Checkpoint configuration:"," ");
+  }
 }
 
 //==============================================================================
@@ -2207,31 +2266,92 @@ void JSph::AddBasicArrays(JDataArrays &arrays,unsigned np,const tdouble3 *pos
 }
 
 //==============================================================================
-/// Stores files of particle data.
-/// Graba los ficheros de datos de particulas.
+/// Stores files of particle data. With SaveAsync the data is copied and the
+/// files are saved in background by SavePartJob().
+///
+/// Graba los ficheros de datos de particulas. Con SaveAsync los datos se copian
+/// y los ficheros se graban en segundo plano mediante SavePartJob().
 //==============================================================================
 void JSph::SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays
   ,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus)
 {
+  JSphPartJob jobsync;
+  JSphPartJob &job=(SaveAsync? *SaveAsync->GetFreeJob(): jobsync);
+  //-Values of the PART (computed in the main thread).
+  job.Part=Part;
+  job.TimeStep=TimeStep;
+  job.Nstep=Nstep;
+  job.TotalNp=TotalNp;
+  job.Npok=npok;
+  job.Nout=nout;
+  if(DataBi4){
+    TimerPart.Stop();
+    job.TimePart=TimerPart.GetElapsedTimeD()/1000.;
+  }
+  job.DomainMin=vdom[0];
+  job.DomainMax=vdom[1];
+  for(unsigned c=1;c<ndom;c++){
+    job.DomainMin=MinValues(job.DomainMin,vdom[c*2  ]);
+    job.DomainMax=MaxValues(job.DomainMax,vdom[c*2+1]);
+  }
+  if(ndom>1)job.VDom.assign(vdom,vdom+ndom*2);
+  job.SymplecticDtPre=SymplecticDtPre;
+  job.DemDtForce=DemDtForce;
+  job.WithInfo=(infoplus && SvData&SDAT_Info);
+  if(job.WithInfo){
+    job.InfoPlus=*infoplus;
+    job.DtMean=(!Nstep? 0: (TimeStep-TimeStepM1)/(Nstep-PartNstep));
+    job.DtMin=(!Nstep? 0: PartDtMin);
+    job.DtMax=(!Nstep? 0: PartDtMax);
+    job.WithDtError=(DtFixed!=NULL);
+    if(DtFixed)job.DtError=DtFixed->GetDtError(true);
+  }
+  //-Particle arrays and excluded particles.
+  const unsigned noutsv=(DataOutBi4? PartsOut->GetCount(): 0);
+  job.SetData(arrays,noutsv,PartsOut->GetIdpOut(),PartsOut->GetPosOut()
+    ,PartsOut->GetVelOut(),PartsOut->GetRhopOut(),PartsOut->GetMotiveOut(),SaveAsync!=NULL);
+  //-Data of floating bodies.
+  if(DataFloatBi4)for(unsigned cf=0;cf<FtCount;cf++){
+    job.FtCenter.push_back(FtObjs[cf].center);
+    job.FtFvel.push_back(FtObjs[cf].fvel);
+    job.FtFomega.push_back(FtObjs[cf].fomega);
+  }
+
+  //-Saves files of the PART.
+  //-Graba ficheros del PART.
+  if(SaveAsync)SaveAsync->Submit(&job);
+  else SavePartJob(job);
+
+  //-Empties stock of excluded particles.
+  //-Vacia almacen de particulas excluidas.
+  PartsOut->Clear();
+}
+
+//==============================================================================
+/// Stores files of particle data of one PART. It is called by the main thread
+/// or by the writer thread of SaveAsync, so it only uses the data of job and
+/// the constant configuration.
+///
+/// Graba los ficheros de datos de particulas de un PART. Se llama desde el hilo
+/// principal o desde el hilo de escritura de SaveAsync, por lo que solo usa los
+/// datos de job y la configuracion constante.
+//==============================================================================
+void JSph::SavePartJob(const JSphPartJob &job){
+  const unsigned npok=job.Npok;
+  const JDataArrays &arrays=job.Arrays;
   //-Stores particle data and/or information in bi4 format.
   //-Graba datos de particulas y/o informacion en formato bi4.
   if(DataBi4){
     tfloat3* posf3=NULL;
-    TimerPart.Stop();
-    tdouble3 domainmin=vdom[0];
-    tdouble3 domainmax=vdom[1];
-    for(unsigned c=1;c<ndom;c++){
-      domainmin=MinValues(domainmin,vdom[c*2  ]);
-      domainmax=MaxValues(domainmax,vdom[c*2+1]);
-    }
-    JBinaryData* bdpart=DataBi4->AddPartInfo(Part,TimeStep,npok,nout,Nstep,TimerPart.GetElapsedTimeD()/1000.,domainmin,domainmax,TotalNp);
-    if(TStep==STEP_Symplectic)bdpart->SetvDouble("SymplecticDtPre",SymplecticDtPre);
-    if(UseDEM)bdpart->SetvDouble("DemDtForce",DemDtForce); //(DEM)
-    if(infoplus && SvData&SDAT_Info){
-      bdpart->SetvDouble("dtmean",(!Nstep? 0: (TimeStep-TimeStepM1)/(Nstep-PartNstep)));
-      bdpart->SetvDouble("dtmin",(!Nstep? 0: PartDtMin));
-      bdpart->SetvDouble("dtmax",(!Nstep? 0: PartDtMax));
-      if(DtFixed)bdpart->SetvDouble("dterror",DtFixed->GetDtError(true));
+    JBinaryData* bdpart=DataBi4->AddPartInfo(job.Part,job.TimeStep,npok,job.Nout,job.Nstep,job.TimePart,job.DomainMin,job.DomainMax,job.TotalNp);
+    if(TStep==STEP_Symplectic)bdpart->SetvDouble("SymplecticDtPre",job.SymplecticDtPre);
+    if(UseDEM)bdpart->SetvDouble("DemDtForce",job.DemDtForce); //(DEM)
+    if(job.WithInfo){
+      const StInfoPartPlus *infoplus=&job.InfoPlus;
+      bdpart->SetvDouble("dtmean",job.DtMean);
+      bdpart->SetvDouble("dtmin",job.DtMin);
+      bdpart->SetvDouble("dtmax",job.DtMax);
+      if(job.WithDtError)bdpart->SetvDouble("dterror",job.DtError);
       bdpart->SetvDouble("timesim",infoplus->timesim);
       bdpart->SetvUint("nct",infoplus->nct);
       bdpart->SetvUint("npbin",infoplus->npbin);
@@ -2247,11 +2367,12 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays
         bdpart->SetvLlong("npalloc",infoplus->memorynpalloc);
         bdpart->SetvLlong("npused",infoplus->memorynpused);
       }
+      const unsigned ndom=unsigned(job.VDom.size()/2);
       if(ndom>1){
         bdpart->SetvUint("subdomain_count",ndom);
         for(unsigned c=0;c<ndom;c++){
-          bdpart->SetvDouble3(fun::PrintStr("subdomainmin_%02u",c),vdom[c*2  ]);
-          bdpart->SetvDouble3(fun::PrintStr("subdomainmax_%02u",c),vdom[c*2+1]);
+          bdpart->SetvDouble3(fun::PrintStr("subdomainmin_%02u",c),job.VDom[c*2  ]);
+          bdpart->SetvDouble3(fun::PrintStr("subdomainmax_%02u",c),job.VDom[c*2+1]);
         }
       }
     }
@@ -2287,7 +2408,7 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays
   }
 
   //-Stores VTK nd/or CSV files.
-  if((SvData&SDAT_Csv) || (SvData&SDAT_Vtk)){
+  if((SvData&SDAT_Csv) || (SvData&SDAT_Vtk) || (SvData&SDAT_Vtu)){
     JDataArrays arrays2;
     arrays2.CopyFrom(arrays);
 
@@ -2310,11 +2431,19 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays
     arrays2.MoveArray(arrays2.Count()-1,4);
     //-Defines fields to be stored.
     if(SvData&SDAT_Vtk){
-      JVtkLib::SaveVtkData(DirDataOut+fun::FileNameSec("PartVtk.vtk",Part),arrays2,"Pos");
+      JVtkLib::SaveVtkData(DirDataOut+fun::FileNameSec("PartVtk.vtk",job.Part),arrays2,"Pos");
+    }
+    if(SvData&SDAT_Vtu){
+      JOutputVtu ovtu;
+      ovtu.SetCompress(SvVtuComp);
+      if(SaveAsync)ovtu.SetThreads(1); //-The writer thread does not compete with the simulation threads.
+      if(SvVtuPieces<0)ovtu.SaveVtu(DirDataOut+fun::FileNameSec("PartVtu.vtu",job.Part),arrays2,"Pos");
+      else ovtu.SavePvtu(DirDataOut+fun::FileNameSec("PartVtu.pvtu",job.Part),arrays2,"Pos",unsigned(SvVtuPieces));
     }
     if(SvData&SDAT_Csv){ 
       JOutputCsv ocsv(AppInfo.GetCsvSepComa());
-      ocsv.SaveCsv(DirDataOut+fun::FileNameSec("PartCsv.csv",Part),arrays2);
+      if(SaveAsync)ocsv.SetThreads(1); //-The writer thread does not compete with the simulation threads.
+      ocsv.SaveCsv(DirDataOut+fun::FileNameSec("PartCsv.csv",job.Part),arrays2);
     }
     //-Deallocate of memory.
     delete[] posf3;
@@ -2322,19 +2451,27 @@ void JSph::SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays
   }
 
   //-Stores data of excluded particles.
-  if(DataOutBi4 && PartsOut->GetCount()){
-    DataOutBi4->SavePartOut(SvPosDouble,Part,TimeStep,PartsOut->GetCount(),PartsOut->GetIdpOut(),NULL,PartsOut->GetPosOut(),PartsOut->GetVelOut(),PartsOut->GetRhopOut(),PartsOut->GetMotiveOut());
+  if(DataOutBi4 && job.OutCount){
+    DataOutBi4->SavePartOut(SvPosDouble,job.Part,job.TimeStep,job.OutCount,job.OutIdp,NULL,job.OutPos,job.OutVel,job.OutRhop,job.OutMotive);
   }
 
   //-Stores data of floating bodies.
   if(DataFloatBi4){
-    for(unsigned cf=0;cf<FtCount;cf++)DataFloatBi4->AddPartData(cf,FtObjs[cf].center,FtObjs[cf].fvel,FtObjs[cf].fomega);
-    DataFloatBi4->SavePartFloat(Part,TimeStep,(UseDEM? DemDtForce: 0));
+    for(unsigned cf=0;cf<FtCount;cf++)DataFloatBi4->AddPartData(cf,job.FtCenter[cf],job.FtFvel[cf],job.FtFomega[cf]);
+    DataFloatBi4->SavePartFloat(job.Part,job.TimeStep,(UseDEM? job.DemDtForce: 0));
   }
+}
 
-  //-Empties stock of excluded particles.
-  //-Vacia almacen de particulas excluidas.
-  PartsOut->Clear();
+//==============================================================================
+/// Waits until the PART data submitted to SaveAsync is saved and shows stats.
+/// Espera hasta que los datos de PART enviados a SaveAsync esten grabados.
+//==============================================================================
+void JSph::FlushSaveAsync(){
+  if(SaveAsync){
+    SaveAsync->Flush();
+    Log->Printf("Saving in background: %u PARTs with %u buffers (%.2f MB), main thread waited %u times (%.3f s).",SaveAsync->GetSavedCount(),SaveAsync->GetJobsCount()
+      ,double(SaveAsync->GetAllocMemory())/(1024*1024),SaveAsync->GetWaitCount(),SaveAsync->GetWaitTime());
+  }
 }
 
 //==============================================================================
@@ -2413,6 +2550,150 @@ void JSph::SaveData(unsigned npok,const JDataArrays& arrays
   if(BoundCorr && BoundCorr->GetUseMotion())BoundCorr->SaveData(Part);  //<vs_innlet>
 }
 
+//==============================================================================
+/// Adds general state of the simulation to checkpoint data (times, counters, 
+/// floating bodies, excluded particles pending to be saved and gauges).
+/// Anhade el estado general de la simulacion a los datos de checkpoint.
+//==============================================================================
+void JSph::CheckpointSaveState(JBinaryData *bdat){
+  //-Previous PARTs and results of gauges are stored before the checkpoint.
+  if(SaveAsync)SaveAsync->Flush();
+  GaugeSystem->SaveResults();
+  //-Values to check the case.
+  bdat->SetvText("CaseName",CaseName);
+  bdat->SetvUint("CaseNp",CaseNp);
+  bdat->SetvUint("CaseNpb",CaseNpb);
+  bdat->SetvUint("FtCount",FtCount);
+  bdat->SetvInt("TStep",int(TStep));
+  bdat->SetvInt("TVisco",int(TVisco));
+  //-Simulation state.
+  bdat->SetvInt("Part",Part);
+  bdat->SetvInt("Nstep",Nstep);
+  bdat->SetvInt("PartNstep",PartNstep);
+  bdat->SetvUint("PartOut",PartOut);
+  bdat->SetvUint("OutPosCount",OutPosCount);
+  bdat->SetvUint("OutRhopCount",OutRhopCount);
+  bdat->SetvUint("OutMoveCount",OutMoveCount);
+  bdat->SetvDouble("TimeStep",TimeStep);
+  bdat->SetvDouble("TimeStepM1",TimeStepM1);
+  bdat->SetvDouble("TimePartNext",TimePartNext);
+  bdat->SetvDouble("LastDt",LastDt);
+  bdat->SetvInt("VerletStep",VerletStep);
+  bdat->SetvDouble("SymplecticDtPre",SymplecticDtPre);
+  bdat->SetvDouble("DemDtForce",DemDtForce);
+  bdat->SetvUint("DtModif",DtModif);
+  bdat->SetvDouble("PartDtMin",PartDtMin);
+  bdat->SetvDouble("PartDtMax",PartDtMax);
+  bdat->SetvUllong("TotalNp",TotalNp);
+  bdat->SetvUint("IdMax",IdMax);
+  //-Floating bodies (StFloatingData is stored as bytes).
+  if(FtCount)bdat->CreateArray("FtObjs",JBinaryDataDef::DatUchar,unsigned(sizeof(StFloatingData)*FtCount),FtObjs,true);
+  //-Excluded particles pending to be saved in next PART.
+  const unsigned nout=PartsOut->GetCount();
+  bdat->SetvUint("OutCount",nout);
+  if(nout){
+    bdat->CreateArray("OutIdp"   ,JBinaryDataDef::DatUint   ,nout,PartsOut->GetIdpOut()   ,true);
+    bdat->CreateArray("OutPos"   ,JBinaryDataDef::DatDouble3,nout,PartsOut->GetPosOut()   ,true);
+    bdat->CreateArray("OutVel"   ,JBinaryDataDef::DatFloat3 ,nout,PartsOut->GetVelOut()   ,true);
+    bdat->CreateArray("OutRhop"  ,JBinaryDataDef::DatFloat  ,nout,PartsOut->GetRhopOut()  ,true);
+    bdat->CreateArray("OutMotive",JBinaryDataDef::DatUchar  ,nout,PartsOut->GetMotiveOut(),true);
+  }
+  //-Instants of next computation and output of gauges.
+  const unsigned ng=GaugeSystem->GetCount();
+  if(ng){
+    std::vector<double> gnext;
+    for(unsigned cg=0;cg<ng;cg++){
+      const JGaugeItem *gau=GaugeSystem->GetGauge(cg);
+      gnext.push_back(gau->GetComputeNext());
+      gnext.push_back(gau->GetOutputNext());
+    }
+    bdat->CreateArray("GaugeNext",JBinaryDataDef::DatDouble,ng*2,gnext.data(),false);
+  }
+}
+
+//==============================================================================
+/// Returns true when a checkpoint was requested (runtime interval or signal).
+/// Devuelve true cuando se solicito un checkpoint (intervalo o senhal).
+//==============================================================================
+bool JSph::CheckpointRequested(){
+  return(Checkpoint && Checkpoint->CheckSave());
+}
+
+//==============================================================================
+/// Saves checkpoint data in the checkpoint file.
+/// Graba los datos de checkpoint en el fichero de checkpoint.
+//==============================================================================
+void JSph::CheckpointSaveFile(JBinaryData *bdat){
+  Checkpoint->SaveFile(bdat,TimeStep,unsigned(Nstep));
+}
+
+//==============================================================================
+/// Restores general state of the simulation from checkpoint data and adjusts 
+/// motion for the instant of the checkpoint (as in restart from PART).
+/// Restaura el estado general de la simulacion desde los datos de checkpoint.
+//==============================================================================
+void JSph::CheckpointLoadState(JBinaryData *bdat){
+  //-Checks the case.
+  if(bdat->GetvText("CaseName")!=CaseName || bdat->GetvUint("CaseNp")!=CaseNp 
+    || bdat->GetvUint("CaseNpb")!=CaseNpb || bdat->GetvUint("FtCount")!=FtCount)
+    Run_ExceptioonFile("The checkpoint does not belong to this case.",CheckpointFile);
+  if(bdat->GetvInt("TStep")!=int(TStep) || bdat->GetvInt("TVisco")!=int(TVisco))
+    Run_ExceptioonFile("The time integration scheme or viscosity of checkpoint does not match the configuration.",CheckpointFile);
+  //-Simulation state.
+  Part=bdat->GetvInt("Part");
+  Nstep=bdat->GetvInt("Nstep");
+  PartNstep=bdat->GetvInt("PartNstep");
+  PartOut=bdat->GetvUint("PartOut");
+  OutPosCount=bdat->GetvUint("OutPosCount");
+  OutRhopCount=bdat->GetvUint("OutRhopCount");
+  OutMoveCount=bdat->GetvUint("OutMoveCount");
+  TimeStep=bdat->GetvDouble("TimeStep");
+  TimeStepM1=bdat->GetvDouble("TimeStepM1");
+  TimePartNext=bdat->GetvDouble("TimePartNext");
+  LastDt=bdat->GetvDouble("LastDt");
+  VerletStep=bdat->GetvInt("VerletStep");
+  SymplecticDtPre=bdat->GetvDouble("SymplecticDtPre");
+  DemDtForce=bdat->GetvDouble("DemDtForce");
+  DtModif=bdat->GetvUint("DtModif");
+  PartDtMin=bdat->GetvDouble("PartDtMin");
+  PartDtMax=bdat->GetvDouble("PartDtMax");
+  TotalNp=bdat->GetvUllong("TotalNp");
+  IdMax=bdat->GetvUint("IdMax");
+  //-The resumed execution starts at the instant of the checkpoint.
+  PartIni=Part;
+  TimeStepIni=TimeStep;
+  //-Floating bodies.
+  if(FtCount)JSphCheckpoint::GetArrayData(bdat,"FtObjs",JBinaryDataDef::DatUchar,unsigned(sizeof(StFloatingData)*FtCount),FtObjs);
+  //-Excluded particles pending to be saved in next PART.
+  PartsOut->Clear();
+  const unsigned nout=bdat->GetvUint("OutCount");
+  if(nout){
+    unsigned *idp=new unsigned[nout];
+    tdouble3 *pos=new tdouble3[nout];
+    tfloat3  *vel=new tfloat3[nout];
+    float    *rhop=new float[nout];
+    byte     *motive=new byte[nout];
+    JSphCheckpoint::GetArrayData(bdat,"OutIdp"   ,JBinaryDataDef::DatUint   ,nout,idp);
+    JSphCheckpoint::GetArrayData(bdat,"OutPos"   ,JBinaryDataDef::DatDouble3,nout,pos);
+    JSphCheckpoint::GetArrayData(bdat,"OutVel"   ,JBinaryDataDef::DatFloat3 ,nout,vel);
+    JSphCheckpoint::GetArrayData(bdat,"OutRhop"  ,JBinaryDataDef::DatFloat  ,nout,rhop);
+    JSphCheckpoint::GetArrayData(bdat,"OutMotive",JBinaryDataDef::DatUchar  ,nout,motive);
+    PartsOut->AddParticles(nout,idp,pos,vel,rhop,motive);
+    delete[] idp;  delete[] pos;  delete[] vel;
+    delete[] rhop; delete[] motive;
+  }
+  //-Instants of next computation and output of gauges.
+  const unsigned ng=GaugeSystem->GetCount();
+  if(ng){
+    std::vector<double> gnext(ng*2);
+    JSphCheckpoint::GetArrayData(bdat,"GaugeNext",JBinaryDataDef::DatDouble,ng*2,gnext.data());
+    for(unsigned cg=0;cg<ng;cg++)GaugeSystem->GetGauge(cg)->SetTimeNext(TimeStep,gnext[cg*2],gnext[cg*2+1]);
+  }
+  //-Adjusts motion for the instant of the checkpoint.
+  if(SphMotion)SphMotion->ProcesTime(JSphMotion::MOMT_Simple,0,TimeStep);
+  if(DtFixed)DtIni=DtFixed->GetDt(TimeStep,DtIni);
+}
+
 //==============================================================================
 /// Generates VTK file with domain of the particles.
 /// Genera fichero VTK con el dominio de las particulas.
@@ -2597,6 +2878,7 @@ void JSph::ShowResume(bool stop,float tsim,float ttot,bool all,std::string infop
     Log->Printf("Steps per second.................: %f",nstepseg);
     Log->Printf("Steps of simulation..............: %d",Nstep);
     Log->Printf("PART files.......................: %d",Part-PartIni);
+    if(Checkpoint)Log->Printf("Checkpoint files.................: %u (%.3f sec.)",Checkpoint->GetCount(),Checkpoint->GetTimeSave());
     while(!infoplus.empty()){
       string lin=fun::StrSplit("#",infoplus);
       if(!lin.empty()){
@@ -58,6 +58,10 @@ class JPartDataBi4;
 class JPartOutBi4Save;
 class JPartFloatBi4Save;
 class JPartsOut;
+class JBinaryData;
+class JSphSaveAsync;
+class JSphCheckpoint;
+class JSphPartJob;
 class JShifting;
 class JDamping;
 class JXml;
@@ -87,6 +91,7 @@ class JNumexLib;
 
 class JSph : protected JObject
 {
+  friend class JSphSaveAsync;
 public:
 /// Structure with constants for the Cubic Spline kernel.
   typedef struct {
@@ -124,6 +129,8 @@ private:
   JPartDataBi4 *DataBi4;            ///<To store particles and info in bi4 format.      | Para grabar particulas e info en formato bi4.
   JPartOutBi4Save *DataOutBi4;      ///<To store excluded particles in bi4 format.      | Para grabar particulas excluidas en formato bi4.
   JPartFloatBi4Save *DataFloatBi4;  ///<To store floating data in bi4 format.           | Para grabar datos de floatings en formato bi4.
+  JSphSaveAsync *SaveAsync;         ///<To store PART data in background (only with SvAsync). | Para grabar datos de PART en segundo plano.
+  JSphCheckpoint *Checkpoint;       ///<To store checkpoints with the complete state (only with SvCheckpoint). | Para grabar checkpoints con el estado completo.
 
   //-Total number of excluded particles according to reason for exclusion.
   //-Numero acumulado de particulas excluidas segun motivo.
@@ -140,6 +147,7 @@ private:
   void ConfigDomainParticlesPrc(tdouble3 vmin,tdouble3 vmax);
   void ConfigDomainParticlesPrcValue(std::string key,double v);
   void ConfigDomainResize(std::string key,const JSpaceEParms *eparms);
+  void SavePartJob(const JSphPartJob &job);
 
 protected:
   const bool Cpu;
@@ -217,6 +225,12 @@ protected:
   byte SvData;               ///<Combination of the TpSaveDat values.                            | Combinacion de valores TpSaveDat.                                                      
   bool SvRes;                ///<Creates file with execution summary.                            | Graba fichero con resumen de ejecucion.
   bool SvTimers;             ///<Computes the time for each process.                             | Obtiene tiempo para cada proceso.
+  unsigned SvAsync;          ///<Number of PARTs buffered to be saved in background (0=disabled). | Numero de PARTs en buffer para grabar en segundo plano (0=desactivado).
+  std::vector<int> SvAsyncCores; ///<Cores for the writer thread of SvAsync (empty=inherited from main thread). | Cores para el hilo de escritura de SvAsync (vacio=heredados del hilo principal).
+  int SvComp;                ///<Compression of PART arrays (-1=disabled, 0=lossless, n=quantised positions with Scell/2^n). | Compresion de arrays de PART (-1=desactivada, 0=sin perdida, n=posiciones cuantificadas con Scell/2^n).
+  bool SvVtuComp;            ///<Compresses arrays of VTU files with LZ4.                         | Comprime arrays de ficheros VTU con LZ4.
+  int SvVtuPieces;           ///<Number of pieces of VTU files (-1=one .vtu file, 0=one piece per thread). | Numero de piezas de ficheros VTU (-1=un fichero .vtu, 0=una pieza por hilo).
+  double SvCheckpoint;       ///<Runtime between checkpoints in seconds (-1=disabled, 0=only on signal). | Tiempo de ejecucion entre checkpoints en segundos (-1=desactivado, 0=solo con senhal).
   bool SvDomainVtk;          ///<Stores VTK file with the domain of particles of each PART file. | Graba fichero vtk con el dominio de las particulas en cada Part. 
   //bool SvInterCount;       ///<Computes and saves number of interactions.                      | Calcula y graba el numero de interacciones.
 
@@ -267,6 +281,7 @@ protected:
   unsigned PartBeginFirst;    ///<Indicates the number of the first PART to be generated. | Indica el numero del primer PART a generar.                                    
   double PartBeginTimeStep;   ///<initial instant of the simulation                       | Instante de inicio de la simulación.                                          
   ullong PartBeginTotalNp;    ///<Total number of simulated particles.
+  std::string CheckpointFile; ///<Checkpoint file to resume the simulation (empty: no resumption). | Fichero de checkpoint para reanudar la simulacion.
 
   JPartsOut *PartsOut;        ///<Stores excluded particles until they are saved. | Almacena las particulas excluidas hasta su grabacion.
   bool WrnPartsOut;           ///<Active warning according to number of out particles (default=1).
@@ -449,8 +464,13 @@ protected:
   void AddBasicArrays(JDataArrays &arrays,unsigned np,const tdouble3 *pos
     ,const unsigned *idp,const tfloat3 *vel,const float *rhop)const;
   void SavePartData(unsigned npok,unsigned nout,const JDataArrays& arrays,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
+  void FlushSaveAsync();
   void SaveData(unsigned npok,const JDataArrays& arrays,unsigned ndom,const tdouble3 *vdom,const StInfoPartPlus *infoplus);
   void SaveDomainVtk(unsigned ndom,const tdouble3 *vdom)const;
+  bool CheckpointRequested();
+  void CheckpointSaveState(JBinaryData *bdat);
+  void CheckpointSaveFile(JBinaryData *bdat);
+  void CheckpointLoadState(JBinaryData *bdat);
   void SaveInitialDomainVtk()const;
   unsigned SaveMapCellsVtkSize()const;
   void SaveMapCellsVtk(float scell)const;
@@ -0,0 +1,431 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphBenchCpu.cpp \brief Implements the class \ref JSphBenchCpu.
+
+#include "JSphBenchCpu.h"
+#include "JSphCpuSingle.h"
+#include "JCfgRun.h"
+#include "JLog2.h"
+#include "JAppInfo.h"
+#include "Functions.h"
+#include "JRadixSort.h"
+#include "JTimer.h"
+#include "OmpDefs.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+//##############################################################################
+//# JSphBenchCpu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphBenchCpu::JSphBenchCpu(const std::string &appname):AppName(appname){
+  ClassName="JSphBenchCpu";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphBenchCpu::~JSphBenchCpu(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphBenchCpu::Reset(){
+  CaseType=JSphCaseGen::CGEN_Block;
+  NpCase=50000;
+  NpWeak=0;
+  CoefH=0;
+  Npieces=1;
+  Steps=20;
+  WarmupSteps=2;
+  Threads.clear();
+  Kernels.clear();
+  Viscos.clear();
+  Ddts.clear();
+  RunSolver=true;
+  RunRadix=true;
+  DirOut="BenchOut";
+  FileJson="";
+  CaseName="";
+  CaseNp=CaseNpb=0;
+  CaseDp=CaseH=0;
+  RunRes.clear();
+  RadixRes.clear();
+}
+
+//==============================================================================
+/// Shows the options of the program.
+//==============================================================================
+void JSphBenchCpu::PrintUsage()const{
+  printf("Micro-benchmark of CPU kernels (divide, sort, interaction and update)\n");
+  printf("on a generated case (block of fluid over a floor or dam break).\n\n");
+  printf("Options:\n");
+  printf("    -case:<type>      Geometry of the case: block or dam (block by default)\n");
+  printf("    -np:<n>           Number of particles of the case (50000 by default)\n");
+  printf("    -weak:<n>         Weak scaling with n particles per thread, a case is\n");
+  printf("                      generated for each number of threads (disabled by default)\n");
+  printf("    -coefh:<v>        Coefficient to compute h=coefh*sqrt(3*dp^2), it sets the\n");
+  printf("                      number of neighbours per particle (1 for block and\n");
+  printf("                      1.1547 for dam by default)\n");
+  printf("    -pieces:<n>       Number of pieces of the bi4 file of the case, pieces are\n");
+  printf("                      saved in parallel (1 by default)\n");
+  printf("    -steps:<n>        Number of measured steps (20 by default)\n");
+  printf("    -warmup:<n>       Number of steps before measurement (2 by default)\n");
+  printf("    -threads:<list>   Numbers of OpenMP threads (e.g. 1,2,4). By default powers\n");
+  printf("                      of 2 up to the number of cores and the number of cores\n");
+  printf("    -kernels:<list>   Kernels: wendland,cubic (wendland by default)\n");
+  printf("    -viscos:<list>    Viscosity treatments: art,sps (art by default)\n");
+  printf("    -ddts:<list>      Density Diffusion Terms: 0,1,2,3 (0 by default)\n");
+  printf("    -solver:<0/1>     Runs the solver on the case (1 by default)\n");
+  printf("    -radix:<0/1>      Runs JRadixSort alone with random keys (1 by default)\n");
+  printf("    -dirout:<dir>     Output directory (BenchOut by default)\n");
+  printf("    -json:<file>      Output JSON file (<dirout>/Bench.json by default)\n");
+  printf("\n");
+  printf("Examples:\n");
+  printf("  -np:200000 -coefh:1.2 -threads:1,2,4,8 -kernels:wendland,cubic -ddts:0,2\n");
+  printf("  -case:dam -weak:250000 -threads:1,2,4,8 -ddts:3\n");
+  printf("  -case:dam -np:13000000 -solver:0 -radix:0   (only generates the case)\n");
+}
+
+//==============================================================================
+/// Loads the options of the command line. Returns false when the program
+/// only shows the help.
+//==============================================================================
+bool JSphBenchCpu::LoadArgv(int argc,char** argv){
+  Reset();
+  bool help=false;
+  for(int c=1;c<argc;c++){
+    const string opt=fun::StrTrim(argv[c]);
+    if(opt.size()<2 || opt[0]!='-')Run_Exceptioon(string("Parameter \"")+opt+"\" unrecognised or invalid.");
+    const int pos=int(opt.find(":"));
+    const string txword=fun::StrUpper(pos>0? opt.substr(1,pos-1): opt.substr(1));
+    const string txoptfull=(pos>0? opt.substr(pos+1): "");
+    bool ok=true;
+    if(txword=="CASE")ok=JSphCaseGen::GetTypeByName(txoptfull,CaseType);
+    else if(txword=="NP"){ const double v=atof(txoptfull.c_str()); ok=(v>0 && v<UINT_MAX); NpCase=unsigned(v); }
+    else if(txword=="WEAK"){ const double v=atof(txoptfull.c_str()); ok=(v>0 && v<UINT_MAX); NpWeak=unsigned(v); }
+    else if(txword=="PIECES"){ const int v=atoi(txoptfull.c_str()); ok=(v>0); Npieces=unsigned(v); }
+    else if(txword=="COEFH"){ CoefH=atof(txoptfull.c_str()); ok=(CoefH>0); }
+    else if(txword=="STEPS"){ const int v=atoi(txoptfull.c_str()); ok=(v>0); Steps=unsigned(v); }
+    else if(txword=="WARMUP"){ const int v=atoi(txoptfull.c_str()); ok=(v>=0); WarmupSteps=unsigned(v); }
+    else if(txword=="THREADS"){
+      fun::VectorSplitInt(",",txoptfull,Threads);
+      for(unsigned i=0;i<unsigned(Threads.size()) && ok;i++)ok=(Threads[i]>0 && Threads[i]<=OMP_MAXTHREADS);
+      ok=(ok && !Threads.empty());
+    }
+    else if(txword=="KERNELS"){
+      fun::VectorSplitStr(",",fun::StrLower(txoptfull),Kernels);
+      for(unsigned i=0;i<unsigned(Kernels.size()) && ok;i++)ok=(Kernels[i]=="wendland" || Kernels[i]=="cubic");
+      ok=(ok && !Kernels.empty());
+    }
+    else if(txword=="VISCOS"){
+      fun::VectorSplitStr(",",fun::StrLower(txoptfull),Viscos);
+      for(unsigned i=0;i<unsigned(Viscos.size()) && ok;i++)ok=(Viscos[i]=="art" || Viscos[i]=="sps");
+      ok=(ok && !Viscos.empty());
+    }
+    else if(txword=="DDTS"){
+      fun::VectorSplitInt(",",txoptfull,Ddts);
+      for(unsigned i=0;i<unsigned(Ddts.size()) && ok;i++)ok=(Ddts[i]>=0 && Ddts[i]<=3);
+      ok=(ok && !Ddts.empty());
+    }
+    else if(txword=="SOLVER")RunSolver=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+    else if(txword=="RADIX")RunRadix=(txoptfull!=""? atoi(txoptfull.c_str()): 1)!=0;
+    else if(txword=="DIROUT"){ DirOut=txoptfull; ok=!DirOut.empty(); }
+    else if(txword=="JSON"){ FileJson=txoptfull; ok=!FileJson.empty(); }
+    else if(txword=="H" || txword=="HELP" || txword=="?")help=true;
+    else ok=false;
+    if(!ok)Run_Exceptioon(string("Parameter \"")+opt+"\" unrecognised or invalid.");
+  }
+  if(help || argc<2){
+    PrintUsage();
+    return(false);
+  }
+  //-Default values of lists. | Valores por defecto de las listas.
+  if(Threads.empty()){
+    #ifdef OMP_USE
+      const int ncores=min(omp_get_num_procs(),OMP_MAXTHREADS);
+    #else
+      const int ncores=1;
+    #endif
+    for(int n=1;n<ncores;n*=2)Threads.push_back(n);
+    Threads.push_back(ncores);
+  }
+  if(Kernels.empty())Kernels.push_back("wendland");
+  if(Viscos.empty())Viscos.push_back("art");
+  if(Ddts.empty())Ddts.push_back(0);
+  if(FileJson.empty())FileJson=fun::GetDirWithSlash(DirOut)+"Bench.json";
+  return(true);
+}
+
+//==============================================================================
+/// Generates the case files (XML and bi4) with np particles using JSphCaseGen.
+/// Genera los ficheros del caso (XML y bi4) con np particulas usando JSphCaseGen.
+//==============================================================================
+void JSphBenchCpu::SaveCase(unsigned np,const std::string &name){
+  CaseName=fun::GetDirWithSlash(DirOut)+"case/"+name;
+  JSphCaseGen gen(AppName);
+  gen.Config(CaseType,np,CoefH,Npieces);
+  gen.Generate();
+  gen.SaveCase(CaseName);
+  CaseNp=gen.GetNp();
+  CaseNpb=gen.GetNpb();
+  CaseDp=gen.GetDp();
+  CaseH=gen.GetH();
+  printf("Case: %s.xml  %s\n",CaseName.c_str(),gen.GetSummary().c_str());
+  printf("      generated in %.3f s and saved in %.3f s\n\n",gen.GetTimeGen(),gen.GetTimeSave());
+}
+
+//==============================================================================
+/// Runs the solver on the case with one configuration and stores the totals
+/// of the performance counters after the warm-up steps.
+///
+/// Ejecuta el solver sobre el caso con una configuracion y guarda los totales
+/// de los contadores de rendimiento tras los pasos de calentamiento.
+//==============================================================================
+void JSphBenchCpu::RunCase(int threads,const std::string &kernel
+  ,const std::string &visco,int ddt)
+{
+  const string runname=fun::PrintStr("run_t%d_%s_%s_ddt%d",threads,kernel.c_str(),visco.c_str(),ddt);
+  const string dirrun=fun::GetDirWithSlash(DirOut)+runname;
+  printf("Running %s...\n",runname.c_str());
+  fflush(stdout);
+  //-Options of execution. | Opciones de ejecucion.
+  vector<string> opts;
+  opts.push_back(AppName);
+  opts.push_back("-cpu");
+  opts.push_back("-name");
+  opts.push_back(CaseName);
+  opts.push_back("-dirout");
+  opts.push_back(dirrun);
+  opts.push_back("-symplectic");
+  opts.push_back(string("-")+kernel);
+  opts.push_back(visco=="sps"? "-viscolamsps:0.000001": "-viscoart:0.01");
+  opts.push_back(fun::PrintStr("-ddt:%d",ddt));
+  opts.push_back(fun::PrintStr("-ompthreads:%d",threads));
+  opts.push_back("-sv:none");
+  opts.push_back("-svres:0");
+  opts.push_back("-svperf");
+  opts.push_back(fun::PrintStr("-svperfskip:%u",WarmupSteps));
+  opts.push_back(fun::PrintStr("-nsteps:%u",WarmupSteps+Steps));
+  vector<char*> argv(opts.size());
+  for(unsigned c=0;c<unsigned(opts.size());c++)argv[c]=(char*)opts[c].c_str();
+  JCfgRun cfg;
+  cfg.LoadArgv(int(argv.size()),&argv[0]);
+  AppInfo.ConfigOutput(cfg.CreateDirs,cfg.CsvSepComa,cfg.DirOut,cfg.DirDataOut);
+  fun::MkdirPath(dirrun);
+  //-Runs the solver with the log only in file. | Ejecuta el solver con el log solo en fichero.
+  JLog2 log(JLog2::Out_File);
+  log.Init(fun::GetDirWithSlash(dirrun)+"Run.out");
+  StRunResult r;
+  r.threads=threads;
+  r.kernel=kernel;
+  r.visco=visco;
+  r.ddt=ddt;
+  {
+    JSphCpuSingle sph;
+    sph.Run(AppName,&cfg,&log);
+    if(!sph.GetPerf())Run_Exceptioon("Performance counters are not available.");
+    r.tot=sph.GetPerf()->GetTotals();
+  }
+  r.casename=fun::GetFile(CaseName);
+  r.np=(r.tot.nsteps? unsigned(r.tot.npsteps/r.tot.nsteps): CaseNp);
+  r.npb=CaseNpb;
+  r.dp=CaseDp;
+  r.h=CaseH;
+  printf("Finished %s: %u measured steps in %.3f s\n\n",runname.c_str(),r.tot.nsteps,r.tot.tstep);
+  RunRes.push_back(r);
+}
+
+//==============================================================================
+/// Measures JRadixSort (keys and index) with random keys of 32 bits.
+/// Mide JRadixSort (claves e indice) con claves aleatorias de 32 bits.
+//==============================================================================
+void JSphBenchCpu::RunRadixSort(int threads){
+  #ifdef OMP_USE
+    omp_set_num_threads(threads);
+  #endif
+  const unsigned n=CaseNp;
+  unsigned *keys0=new unsigned[n];
+  unsigned *keys=new unsigned[n];
+  //-Random keys with the range of cell codes. | Claves aleatorias con el rango de codigos de celda.
+  unsigned seed=12345;
+  for(unsigned p=0;p<n;p++){
+    seed=seed*1664525u+1013904223u;
+    keys0[p]=(seed>>8)%n;
+  }
+  StRadixResult r;
+  r.threads=threads;
+  r.nkeys=n;
+  r.nsorts=WarmupSteps+Steps;
+  r.nbits=0;
+  r.tsort=0;
+  JRadixSort rs(true);
+  for(unsigned cs=0;cs<r.nsorts;cs++){
+    memcpy(keys,keys0,sizeof(unsigned)*n);
+    JTimer tm;
+    tm.Start();
+    rs.Sort(true,n,keys);
+    tm.Stop();
+    if(cs>=WarmupSteps)r.tsort+=tm.GetElapsedTimeD()/1000.;
+    if(!cs)r.nbits=rs.CalcNbits(n,keys0);
+  }
+  r.nsorts=Steps;
+  delete[] keys0; keys0=NULL;
+  delete[] keys;  keys=NULL;
+  printf("RadixSort with %d threads: %u keys x %u  %.3f s\n",threads,n,r.nsorts,r.tsort);
+  RadixRes.push_back(r);
+}
+
+//==============================================================================
+/// Returns a/b or zero when b is zero (valid value for JSON).
+/// Devuelve a/b o cero cuando b es cero (valor valido para JSON).
+//==============================================================================
+static double SafeDiv(double a,double b){
+  return(b>0? a/b: 0);
+}
+
+//==============================================================================
+/// Returns the JSON object with the results of one execution of the solver.
+/// Devuelve el objeto JSON con los resultados de una ejecucion del solver.
+//==============================================================================
+std::string JSphBenchCpu::GetJsonRun(const StRunResult &r)const{
+  const JSphPerfCpu::StTotals &t=r.tot;
+  const double npsteps=double(t.npsteps);
+  const double tdiv=t.timers[TMC_NlLimits]+t.timers[TMC_NlMakeSort]+t.timers[TMC_NlNgList];
+  const double tsort=t.timers[TMC_NlSortData];
+  const double tforces=t.timers[TMC_CfForces];
+  const double tupdate=t.timers[TMC_SuComputeStep];
+  vector<string> div,sort,forces,update,props;
+  div.push_back(fun::JSONProperty("time",tdiv));
+  div.push_back(fun::JSONProperty("particle_steps_per_s",SafeDiv(npsteps,tdiv)));
+  sort.push_back(fun::JSONProperty("time",tsort));
+  sort.push_back(fun::JSONPropertyValue("bytes",fun::UlongStr(t.bytessort)));
+  sort.push_back(fun::JSONProperty("gb_per_s",SafeDiv(double(t.bytessort)/1e9,tsort)));
+  forces.push_back(fun::JSONProperty("time",tforces));
+  forces.push_back(fun::JSONProperty("particle_steps_per_s",SafeDiv(npsteps,tforces)));
+  forces.push_back(fun::JSONPropertyValue("pairs_eval",fun::UlongStr(t.pairseval)));
+  forces.push_back(fun::JSONPropertyValue("pairs_ok",fun::UlongStr(t.pairsok)));
+  forces.push_back(fun::JSONProperty("pairs_per_s",SafeDiv(double(t.pairseval),tforces)));
+  forces.push_back(fun::JSONProperty("pairs_ok_ratio",SafeDiv(double(t.pairsok),double(t.pairseval))));
+  forces.push_back(fun::JSONProperty("thread_imbalance",SafeDiv(t.thmax,t.thmean)));
+  update.push_back(fun::JSONProperty("time",tupdate));
+  update.push_back(fun::JSONPropertyValue("bytes",fun::UlongStr(t.bytesstep)));
+  update.push_back(fun::JSONProperty("gb_per_s",SafeDiv(double(t.bytesstep)/1e9,tupdate)));
+  props.push_back(fun::JSONProperty("threads",r.threads));
+  props.push_back(fun::JSONProperty("kernel",r.kernel));
+  props.push_back(fun::JSONProperty("visco",r.visco));
+  props.push_back(fun::JSONProperty("ddt",r.ddt));
+  props.push_back(fun::JSONProperty("case",r.casename));
+  props.push_back(fun::JSONProperty("np",r.np));
+  props.push_back(fun::JSONProperty("npb",r.npb));
+  props.push_back(fun::JSONProperty("dp",r.dp));
+  props.push_back(fun::JSONProperty("h",r.h));
+  props.push_back(fun::JSONProperty("steps",t.nsteps));
+  props.push_back(fun::JSONProperty("time",t.tstep));
+  props.push_back(fun::JSONProperty("particle_steps_per_s",SafeDiv(npsteps,t.tstep)));
+  props.push_back(fun::JSONPropertyValue("divide",fun::JSONObject(div)));
+  props.push_back(fun::JSONPropertyValue("sort",fun::JSONObject(sort)));
+  props.push_back(fun::JSONPropertyValue("forces",fun::JSONObject(forces)));
+  props.push_back(fun::JSONPropertyValue("update",fun::JSONObject(update)));
+  return(fun::JSONObject(props));
+}
+
+//==============================================================================
+/// Returns the JSON object with the results of one execution of JRadixSort.
+/// Devuelve el objeto JSON con los resultados de una ejecucion de JRadixSort.
+//==============================================================================
+std::string JSphBenchCpu::GetJsonRadix(const StRadixResult &r)const{
+  //-Keys and index are read and written once (effective bandwidth).
+  const double bytes=double(r.nkeys)*r.nsorts*(sizeof(unsigned)*4);
+  vector<string> props;
+  props.push_back(fun::JSONProperty("threads",r.threads));
+  props.push_back(fun::JSONProperty("omp",JRadixSort::CompiledOMP()));
+  props.push_back(fun::JSONProperty("keys",r.nkeys));
+  props.push_back(fun::JSONProperty("nbits",r.nbits));
+  props.push_back(fun::JSONProperty("sorts",r.nsorts));
+  props.push_back(fun::JSONProperty("time",r.tsort));
+  props.push_back(fun::JSONProperty("keys_per_s",SafeDiv(double(r.nkeys)*r.nsorts,r.tsort)));
+  props.push_back(fun::JSONProperty("gb_per_s",SafeDiv(bytes/1e9,r.tsort)));
+  return(fun::JSONObject(props));
+}
+
+//==============================================================================
+/// Saves the results in the JSON file.
+/// Graba los resultados en el fichero JSON.
+//==============================================================================
+void JSphBenchCpu::SaveJson()const{
+  fun::MkdirPath(fun::GetDirParent(FileJson));
+  ofstream pf;
+  pf.open(FileJson.c_str());
+  if(!pf)Run_ExceptioonFile("File could not be opened.",FileJson);
+  vector<string> cfg;
+  cfg.push_back(fun::JSONProperty("app",AppName));
+  cfg.push_back(fun::JSONProperty("case",JSphCaseGen::GetTypeName(CaseType)));
+  cfg.push_back(fun::JSONProperty("scaling",string(NpWeak? "weak": "strong")));
+  cfg.push_back(fun::JSONProperty("np",(NpWeak? NpWeak: NpCase)));
+  cfg.push_back(fun::JSONProperty("steps",Steps));
+  cfg.push_back(fun::JSONProperty("warmup",WarmupSteps));
+  pf << "{\n";
+  pf << fun::JSONPropertyValue("config",fun::JSONObject(cfg)) << ",\n";
+  pf << " \"runs\" : [\n";
+  for(unsigned c=0;c<unsigned(RunRes.size());c++)pf << "  " << GetJsonRun(RunRes[c]) << (c+1<unsigned(RunRes.size())? ",": "") << "\n";
+  pf << " ],\n";
+  pf << " \"radixsort\" : [\n";
+  for(unsigned c=0;c<unsigned(RadixRes.size());c++)pf << "  " << GetJsonRadix(RadixRes[c]) << (c+1<unsigned(RadixRes.size())? ",": "") << "\n";
+  pf << " ]\n";
+  pf << "}\n";
+  if(pf.fail())Run_ExceptioonFile("File writing failure.",FileJson);
+  pf.close();
+  printf("Results saved in %s\n",FileJson.c_str());
+}
+
+//==============================================================================
+/// Runs all the configurations and saves the results.
+/// Ejecuta todas las configuraciones y graba los resultados.
+//==============================================================================
+void JSphBenchCpu::Run(){
+  const string casebase=string("Bench")+(CaseType==JSphCaseGen::CGEN_DamBreak? "Dam": "Block");
+  for(unsigned ct=0;ct<unsigned(Threads.size());ct++){
+    const int threads=Threads[ct];
+    //-With weak scaling each number of threads uses its own case.
+    //-Con escalado debil cada numero de hilos usa su propio caso.
+    if(NpWeak)SaveCase(NpWeak*unsigned(threads),casebase+fun::PrintStr("_t%d",threads));
+    else if(!ct)SaveCase(NpCase,casebase);
+    if(RunSolver){
+      for(unsigned ck=0;ck<unsigned(Kernels.size());ck++)
+        for(unsigned cv=0;cv<unsigned(Viscos.size());cv++)
+          for(unsigned cd=0;cd<unsigned(Ddts.size());cd++)RunCase(threads,Kernels[ck],Viscos[cv],Ddts[cd]);
+    }
+    if(RunRadix)RunRadixSort(threads);
+  }
+  SaveJson();
+}
+
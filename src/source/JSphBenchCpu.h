@@ -0,0 +1,139 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Benchmark de CPU de los nucleos de divide, ordenacion, interaccion y
+//:#   actualizacion sobre un bloque sintetico de particulas con barrido de
+//:#   hilos y combinaciones de kernel, viscosidad y DDT. Los resultados se
+//:#   graban en formato JSON. (17-10-2026)
+//:# - Casos generados con JSphCaseGen (bloque o rotura de presa) y serie de
+//:#   escalado debil con particulas por hilo constantes. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphBenchCpu.h \brief Declares the class \ref JSphBenchCpu.
+
+#ifndef _JSphBenchCpu_
+#define _JSphBenchCpu_
+
+#include <string>
+#include <vector>
+#include "JObject.h"
+#include "TypesDef.h"
+#include "JSphPerfCpu.h"
+#include "JSphCaseGen.h"
+
+//##############################################################################
+//# JSphBenchCpu
+//##############################################################################
+/// \brief Micro-benchmark of the CPU kernels on a synthetic block of particles.
+///
+/// A case (XML and bi4 files) is generated with JSphCaseGen (block of fluid
+/// over a floor or dam break with obstacle) with the requested number of
+/// particles and neighbours per particle (coefh). With weak scaling a case is
+/// generated for each number of threads with constant particles per thread.
+/// For each combination of number of threads,
+/// kernel, viscosity and DDT, the CPU solver (JSphCpuSingle) is executed for a
+/// few Symplectic steps with performance counters (JSphPerfCpu) and the times
+/// of divide (JCellDivCpuSingle::Divide), sort of particle data (SortArray),
+/// interaction (Interaction_Forces_ct) and update (ComputeSymplecticPre/Corr)
+/// are collected after the warm-up steps. JRadixSort is also measured alone
+/// with random keys. Results (particles*steps/s, pair evaluations/s and GB/s)
+/// are saved in a JSON file.
+///
+/// Benchmark de los nucleos de CPU sobre un bloque sintetico de particulas.
+/// Se genera un caso (ficheros XML y bi4) con JSphCaseGen (bloque de fluido o
+/// rotura de presa) con el numero de particulas y vecinos por particula pedidos.
+/// Con escalado debil se genera un caso para cada numero de hilos con
+/// particulas por hilo constantes.
+/// Para cada combinacion de hilos, kernel, viscosidad y DDT se ejecuta el
+/// solver de CPU unos pocos pasos Symplectic con contadores de rendimiento y
+/// se recogen los tiempos de divide, ordenacion, interaccion y actualizacion
+/// tras los pasos de calentamiento. JRadixSort tambien se mide por separado
+/// con claves aleatorias. Los resultados se graban en un fichero JSON.
+
+class JSphBenchCpu : protected JObject
+{
+protected:
+  ///Result of one execution of the solver. | Resultado de una ejecucion del solver.
+  typedef struct{
+    int threads;
+    std::string kernel;
+    std::string visco;
+    int ddt;
+    std::string casename;
+    unsigned np,npb;
+    double dp,h;
+    JSphPerfCpu::StTotals tot;
+  }StRunResult;
+
+  ///Result of one execution of JRadixSort. | Resultado de una ejecucion de JRadixSort.
+  typedef struct{
+    int threads;
+    unsigned nkeys;
+    unsigned nbits;
+    unsigned nsorts;
+    double tsort;    ///<Time of all sorts [s].
+  }StRadixResult;
+
+  std::string AppName;
+
+  //-Configuration.
+  JSphCaseGen::TpCaseGen CaseType;   ///<Geometry of the case.
+  unsigned NpCase;                   ///<Requested number of particles.
+  unsigned NpWeak;                   ///<Requested number of particles per thread for weak scaling (0: disabled).
+  double CoefH;                      ///<Coefficient to compute h=coefh*sqrt(3*dp^2) (0: default of JSphCaseGen).
+  unsigned Npieces;                  ///<Number of pieces of the bi4 file.
+  unsigned Steps;                    ///<Number of measured steps.
+  unsigned WarmupSteps;              ///<Number of steps before measurement.
+  std::vector<int> Threads;          ///<Numbers of threads to be used.
+  std::vector<std::string> Kernels;  ///<Kernels to be used (wendland, cubic).
+  std::vector<std::string> Viscos;   ///<Viscosity treatments to be used (art, sps).
+  std::vector<int> Ddts;             ///<DDT types to be used (0-3).
+  bool RunSolver;                    ///<Executes the solver.
+  bool RunRadix;                     ///<Executes JRadixSort alone.
+  std::string DirOut;                ///<Output directory.
+  std::string FileJson;              ///<Output JSON file.
+
+  //-Current case.
+  std::string CaseName;              ///<Case name (with directory).
+  unsigned CaseNp,CaseNpb;           ///<Number of particles of case.
+  double CaseDp,CaseH;               ///<Dp and smoothing length of case.
+
+  std::vector<StRunResult> RunRes;
+  std::vector<StRadixResult> RadixRes;
+
+  void PrintUsage()const;
+  void SaveCase(unsigned np,const std::string &name);
+  void RunCase(int threads,const std::string &kernel,const std::string &visco,int ddt);
+  void RunRadixSort(int threads);
+  std::string GetJsonRun(const StRunResult &r)const;
+  std::string GetJsonRadix(const StRadixResult &r)const;
+  void SaveJson()const;
+
+public:
+  JSphBenchCpu(const std::string &appname);
+  ~JSphBenchCpu();
+  void Reset();
+  bool LoadArgv(int argc,char** argv);
+  void Run();
+};
+
+#endif
+
@@ -0,0 +1,435 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphCaseGen.cpp \brief Implements the class \ref JSphCaseGen.
+
+#include "JSphCaseGen.h"
+#include "Functions.h"
+#include "JXml.h"
+#include "JSpaceCtes.h"
+#include "JSpaceEParms.h"
+#include "JSpaceParts.h"
+#include "JPartDataBi4.h"
+#include "JTimer.h"
+#include "OmpDefs.h"
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+//-Geometry of the dam break (SPHERIC benchmark 2) [m].
+//-Geometria de la rotura de presa (benchmark 2 de SPHERIC) [m].
+#define CGEN_TANKSIZE   TDouble3(3.22,1.0,1.0)
+#define CGEN_OBSPOSMIN  TDouble3(0.66,0.30,0)
+#define CGEN_OBSPOSMAX  TDouble3(0.82,0.70,0.16)
+#define CGEN_FLUIDPOSX  1.992
+#define CGEN_FLUIDSIZEZ 0.55
+
+//##############################################################################
+//# JSphCaseGen
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphCaseGen::JSphCaseGen(const std::string &appname):AppName(appname){
+  ClassName="JSphCaseGen";
+  Idp=NULL; Posd=NULL; Vel=NULL; Rhop=NULL;
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphCaseGen::~JSphCaseGen(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphCaseGen::Reset(){
+  FreeMemory();
+  Type=CGEN_Block;
+  NpTarget=0;
+  CoefH=0;
+  Npieces=1;
+  Dp=H=HSwl=0;
+  BoxMin=InnMin=ObsMin=FluMin=TInt3(0);
+  BoxMax=InnMax=ObsMax=FluMax=TInt3(-1);
+  ObsLayers=0;
+  NpTank=NpObs=NpFluid=0;
+  TimeGen=TimeSave=0;
+}
+
+//==============================================================================
+/// Frees memory of particle data.
+/// Libera memoria de datos de particulas.
+//==============================================================================
+void JSphCaseGen::FreeMemory(){
+  delete[] Idp;  Idp=NULL;
+  delete[] Posd; Posd=NULL;
+  delete[] Vel;  Vel=NULL;
+  delete[] Rhop; Rhop=NULL;
+}
+
+//==============================================================================
+/// Returns the name of the type of geometry.
+/// Devuelve el nombre del tipo de geometria.
+//==============================================================================
+std::string JSphCaseGen::GetTypeName(TpCaseGen type){
+  switch(type){
+    case CGEN_Block:     return("block");
+    case CGEN_DamBreak:  return("dam");
+  }
+  return("???");
+}
+
+//==============================================================================
+/// Obtains the type of geometry according to its name. Returns false when the
+/// name is invalid.
+/// Obtiene el tipo de geometria segun su nombre. Devuelve false cuando el
+/// nombre no es valido.
+//==============================================================================
+bool JSphCaseGen::GetTypeByName(const std::string &name,TpCaseGen &type){
+  const string tx=fun::StrLower(name);
+  bool ok=true;
+  if(tx=="block")type=CGEN_Block;
+  else if(tx=="dam" || tx=="dambreak")type=CGEN_DamBreak;
+  else ok=false;
+  return(ok);
+}
+
+//==============================================================================
+/// Returns the number of lattice points in the box [pmin,pmax].
+/// Devuelve el numero de puntos de la red en la caja [pmin,pmax].
+//==============================================================================
+ullong JSphCaseGen::CountBox(const tint3 &pmin,const tint3 &pmax){
+  if(pmax.x<pmin.x || pmax.y<pmin.y || pmax.z<pmin.z)return(0);
+  return(ullong(pmax.x-pmin.x+1)*ullong(pmax.y-pmin.y+1)*ullong(pmax.z-pmin.z+1));
+}
+
+//==============================================================================
+/// Configures the lattice of the block with 2k x k x k fluid particles.
+/// Configura la red del bloque con 2k x k x k particulas de fluido.
+//==============================================================================
+void JSphCaseGen::ConfigBlock(unsigned k){
+  Dp=0.01;
+  H=CoefH*sqrt(3.*Dp*Dp);
+  const int nl=max(1,int(ceil(H*2/Dp-1e-6)));
+  const tint3 n=TInt3(int(k*2),int(k),int(k));
+  BoxMin=TInt3(-nl,-nl,-nl);
+  BoxMax=TInt3(n.x-1+nl,n.y-1+nl,n.z-1);
+  InnMin=TInt3(BoxMin.x,BoxMin.y,0);
+  InnMax=BoxMax;
+  FluMin=TInt3(0);
+  FluMax=TInt3(n.x-1,n.y-1,n.z-1);
+  ObsMin=TInt3(0); ObsMax=TInt3(-1); ObsLayers=0;
+}
+
+//==============================================================================
+/// Configures the lattice of the dam break for dp. The walls and cap of the
+/// tank have three layers outside the tank and the obstacle has three layers
+/// inside its volume (as in Spheric2Dam_*.xml).
+///
+/// Configura la red de la rotura de presa para dp. Las paredes y la tapa del
+/// tanque tienen tres capas por fuera del tanque y el obstaculo tiene tres
+/// capas dentro de su volumen (como en Spheric2Dam_*.xml).
+//==============================================================================
+void JSphCaseGen::ConfigDamBreak(double dp){
+  Dp=dp;
+  H=CoefH*sqrt(3.*Dp*Dp);
+  const tdouble3 tank=CGEN_TANKSIZE;
+  const tint3 n=TInt3(RoundInt(tank.x/dp),RoundInt(tank.y/dp),RoundInt(tank.z/dp));
+  BoxMin=TInt3(-2);
+  BoxMax=TInt3(n.x+2,n.y+2,n.z+2);
+  InnMin=TInt3(1);
+  InnMax=TInt3(n.x-1,n.y-1,n.z-1);
+  const tdouble3 obsmin=CGEN_OBSPOSMIN,obsmax=CGEN_OBSPOSMAX;
+  ObsMin=TInt3(RoundInt(obsmin.x/dp),RoundInt(obsmin.y/dp),1);
+  ObsMax=TInt3(RoundInt(obsmax.x/dp),RoundInt(obsmax.y/dp),RoundInt(obsmax.z/dp));
+  ObsLayers=3;
+  FluMin=TInt3(max(1,int(ceil(CGEN_FLUIDPOSX/dp-1e-6))),1,1);
+  FluMax=TInt3(n.x-1,n.y-1,min(n.z-1,int(floor(CGEN_FLUIDSIZEZ/dp+1e-6))));
+}
+
+//==============================================================================
+/// Computes the number of particles of each part from the lattice limits.
+/// Calcula el numero de particulas de cada parte con los limites de la red.
+//==============================================================================
+void JSphCaseGen::ComputeCounts(){
+  const ullong ntank=CountBox(BoxMin,BoxMax)-CountBox(InnMin,InnMax);
+  const int n=int(ObsLayers);
+  const ullong nobs=CountBox(ObsMin,ObsMax)
+    -CountBox(TInt3(ObsMin.x+n,ObsMin.y+n,ObsMin.z),TInt3(ObsMax.x-n,ObsMax.y-n,ObsMax.z-n));
+  const ullong nfluid=CountBox(FluMin,FluMax);
+  if(ntank+nobs+nfluid>=UINT_MAX)Run_Exceptioon("The number of particles exceeds the maximum allowed.");
+  NpTank=unsigned(ntank);
+  NpObs=unsigned(nobs);
+  NpFluid=unsigned(nfluid);
+}
+
+//==============================================================================
+/// Configures the geometry with the number of particles closest to np.
+/// The default coefh is 1 for the block and 2/sqrt(3) for the dam break (h=2dp
+/// as in Spheric2Dam_*.xml).
+///
+/// Configura la geometria con el numero de particulas mas cercano a np.
+//==============================================================================
+void JSphCaseGen::Config(TpCaseGen type,unsigned np,double coefh,unsigned npieces){
+  Reset();
+  Type=type;
+  NpTarget=np;
+  CoefH=(coefh>0? coefh: (type==CGEN_DamBreak? 2./sqrt(3.): 1.));
+  Npieces=max(1u,npieces);
+  if(Type==CGEN_Block){
+    //-Increases k until np is reached. | Aumenta k hasta alcanzar np.
+    unsigned k=2;
+    ConfigBlock(k); ComputeCounts();
+    while(GetNp()<np){
+      const unsigned np1=GetNp();
+      ConfigBlock(k+1); ComputeCounts();
+      if(GetNp()>=np){
+        if(np-np1<GetNp()-np){ ConfigBlock(k); ComputeCounts(); }
+        break;
+      }
+      k++;
+    }
+  }
+  else if(Type==CGEN_DamBreak){
+    //-Bisection of dp (the number of particles decreases with dp).
+    //-Biseccion de dp (el numero de particulas disminuye con dp).
+    const double dpmax=0.1;
+    ConfigDamBreak(dpmax); ComputeCounts();
+    if(GetNp()>np)Run_Exceptioon(fun::PrintStr("The minimum number of particles of the dam break is %u.",GetNp()));
+    double dplo=dpmax/2;
+    for(;;){
+      ConfigDamBreak(dplo); ComputeCounts();
+      if(GetNp()>=np)break;
+      dplo/=2;
+    }
+    double dphi=dpmax,dpbest=dplo;
+    unsigned errbest=GetNp()-np;
+    for(unsigned c=0;c<60 && errbest;c++){
+      const double dp=(dplo+dphi)/2;
+      ConfigDamBreak(dp); ComputeCounts();
+      const unsigned err=(GetNp()>=np? GetNp()-np: np-GetNp());
+      if(err<errbest){ errbest=err; dpbest=dp; }
+      if(GetNp()>=np)dplo=dp; else dphi=dp;
+    }
+    ConfigDamBreak(dpbest); ComputeCounts();
+    if(ObsMax.z-ObsMin.z+1<int(ObsLayers) || FluMin.x<=ObsMax.x)Run_Exceptioon("The number of particles is too small for the dam break geometry.");
+  }
+  else Run_Exceptioon("Type of case is invalid.");
+  HSwl=Dp*(FluMax.z-InnMin.z+1);
+}
+
+//==============================================================================
+/// Creates the particles in parallel by planes of the lattice (Z axis).
+/// The order is boundary of the tank, boundary of the obstacle and fluid, and
+/// inside each part the particles are sorted by Z, Y and X.
+///
+/// Crea las particulas en paralelo por planos de la red (eje Z).
+/// El orden es contorno del tanque, contorno del obstaculo y fluido, y dentro
+/// de cada parte las particulas se ordenan por Z, Y y X.
+//==============================================================================
+void JSphCaseGen::Generate(){
+  JTimer tm; tm.Start();
+  FreeMemory();
+  const unsigned np=GetNp();
+  try{
+    Idp=new unsigned[np];
+    Posd=new tdouble3[np];
+    Vel=new tfloat3[np];
+    Rhop=new float[np];
+  }
+  catch(const std::bad_alloc&){
+    Run_Exceptioon(fun::PrintStr("Could not allocate the requested memory for %u particles.",np));
+  }
+  const int nz=BoxMax.z-BoxMin.z+1;
+  //-Counts particles of each type in each plane. | Cuenta particulas de cada tipo en cada plano.
+  vector<unsigned> cnt(nz*3,0);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic)
+  #endif
+  for(int cz=0;cz<nz;cz++){
+    const int k=BoxMin.z+cz;
+    unsigned n[3]={0,0,0};
+    for(int j=BoxMin.y;j<=BoxMax.y;j++)for(int i=BoxMin.x;i<=BoxMax.x;i++){
+      const TpPoint t=PointType(i,j,k);
+      if(t!=PT_None)n[t-1]++;
+    }
+    for(unsigned c=0;c<3;c++)cnt[cz*3+c]=n[c];
+  }
+  //-Computes the first particle of each type in each plane. | Calcula la primera particula de cada tipo en cada plano.
+  unsigned ini[3]={0,NpTank,NpTank+NpObs};
+  const unsigned ntype[3]={NpTank,NpObs,NpFluid};
+  for(unsigned c=0;c<3;c++){
+    unsigned p=ini[c];
+    for(int cz=0;cz<nz;cz++){
+      const unsigned n=cnt[cz*3+c];
+      cnt[cz*3+c]=p;
+      p+=n;
+    }
+    if(p-ini[c]!=ntype[c])Run_Exceptioon("The number of generated particles does not match the expected number.");
+  }
+  //-Creates particles. | Crea particulas.
+  const float rhop0=1000.f;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic)
+  #endif
+  for(int cz=0;cz<nz;cz++){
+    const int k=BoxMin.z+cz;
+    unsigned p[3]={cnt[cz*3],cnt[cz*3+1],cnt[cz*3+2]};
+    for(int j=BoxMin.y;j<=BoxMax.y;j++)for(int i=BoxMin.x;i<=BoxMax.x;i++){
+      const TpPoint t=PointType(i,j,k);
+      if(t!=PT_None){
+        const unsigned p1=p[t-1]++;
+        Idp[p1]=p1;
+        Posd[p1]=TDouble3(Dp*i,Dp*j,Dp*k);
+        Vel[p1]=TFloat3(0);
+        Rhop[p1]=rhop0;
+      }
+    }
+  }
+  tm.Stop();
+  TimeGen=tm.GetElapsedTimeD()/1000.;
+}
+
+//==============================================================================
+/// Saves the XML file of the case.
+/// Graba el fichero XML del caso.
+//==============================================================================
+void JSphCaseGen::SaveXml(const std::string &filexml)const{
+  const double rhop0=1000,gamma=7;
+  const double cs0=20.*sqrt(9.81*HSwl);
+  const double b=cs0*cs0*rhop0/gamma;
+  const double mass=rhop0*Dp*Dp*Dp;
+  const bool dam=(Type==CGEN_DamBreak);
+  JXml xml;
+  JSpaceCtes ctes;
+  ctes.SetData2D(false);
+  ctes.SetGravity(TDouble3(0,0,-9.81));
+  ctes.SetCFLnumber(0.2);
+  ctes.SetGamma(gamma);
+  ctes.SetRhop0(rhop0);
+  ctes.SetDp(Dp);
+  ctes.SetH(H);
+  ctes.SetB(b);
+  ctes.SetMassBound(mass);
+  ctes.SetMassFluid(mass);
+  ctes.SaveXmlRun(&xml,"case.execution.constants");
+  JSpaceEParms eparms;
+  eparms.Add("StepAlgorithm","2","Step Algorithm 1:Verlet, 2:Symplectic (default=1)");
+  eparms.Add("Kernel","2","Interaction Kernel 1:Cubic Spline, 2:Wendland (default=2)");
+  eparms.Add("ViscoTreatment","1","Viscosity formulation 1:Artificial, 2:Laminar+SPS (default=1)");
+  eparms.Add("Visco","0.01","Viscosity value");
+  eparms.Add("ViscoBoundFactor","1","Multiply viscosity value with boundary (default=1)");
+  eparms.Add("DensityDT",(dam? "3": "0"),"Density Diffusion Term 0:None, 1:Molteni, 2:Fourtakas, 3:Fourtakas(full) (default=0)");
+  eparms.Add("DensityDTvalue","0.1","DDT value (default=0.1)");
+  eparms.Add("TimeMax",(dam? "2": "1000"),"Time of simulation","seconds");
+  eparms.Add("TimeOut",(dam? "0.01": "1000"),"Time out data","seconds");
+  eparms.Add("PartsOutMax","1","%/100 of fluid particles allowed to be excluded from domain (default=1)","decimal");
+  if(!dam){
+    //-The fluid of the block is not confined. | El fluido del bloque no esta confinado.
+    eparms.SetPosmin("default-50%","default-50%","default");
+    eparms.SetPosmax("default+50%","default+50%","default+100%");
+  }
+  eparms.SaveXml(&xml,"case.execution.parameters");
+  JSpaceParts parts;
+  parts.SetMkFirst(11,1);
+  parts.AddFixed(0,NpTank);
+  if(NpObs)parts.AddFixed(1,NpObs);
+  parts.AddFluid(0,NpFluid);
+  parts.SetPosDomain(LatticePos(BoxMin),LatticePos(BoxMax));
+  parts.SaveXml(&xml,"case.execution.particles");
+  xml.SaveFile(filexml,AppName,true);
+}
+
+//==============================================================================
+/// Saves the bi4 file of the case. With several pieces, each piece has a
+/// contiguous range of particles and pieces are saved in parallel.
+///
+/// Graba el fichero bi4 del caso. Con varias piezas, cada pieza tiene un rango
+/// contiguo de particulas y las piezas se graban en paralelo.
+//==============================================================================
+void JSphCaseGen::SaveBi4(const std::string &dir,const std::string &casename)const{
+  const unsigned np=GetNp();
+  const double rhop0=1000,gamma=7;
+  const double cs0=20.*sqrt(9.81*HSwl);
+  const double b=cs0*cs0*rhop0/gamma;
+  const double mass=rhop0*Dp*Dp*Dp;
+  const tdouble3 posmin=LatticePos(BoxMin);
+  const tdouble3 posmax=LatticePos(BoxMax);
+  const unsigned npie=min(Npieces,max(1u,np));
+  //-Configures pieces. | Configura piezas.
+  vector<JPartDataBi4*> pds(npie,NULL);
+  for(unsigned cp=0;cp<npie;cp++){
+    const unsigned pini=unsigned(ullong(np)*cp/npie);
+    const unsigned pfin=unsigned(ullong(np)*(cp+1)/npie);
+    JPartDataBi4 *pd=pds[cp]=new JPartDataBi4();
+    pd->ConfigBasic(cp,npie,"",AppName,casename,false,0,dir);
+    pd->ConfigParticles(np,GetNpb(),0,0,NpFluid,posmin,posmax);
+    pd->ConfigCtes(Dp,H,b,rhop0,gamma,mass,mass);
+    pd->AddPartInfo(0,0,pfin-pini,0,0,0,posmin,posmax);
+    pd->AddPartData(pfin-pini,Idp+pini,Posd+pini,Vel+pini,Rhop+pini);
+  }
+  //-Saves pieces. | Graba piezas.
+  vector<string> errors(npie);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule(dynamic)
+  #endif
+  for(int cp=0;cp<int(npie);cp++){
+    try{
+      pds[cp]->SaveFileCase(casename);
+    }
+    catch(const std::exception &e){ errors[cp]=e.what(); }
+    catch(...){ errors[cp]="Unknown exception."; }
+  }
+  for(unsigned cp=0;cp<npie;cp++){ delete pds[cp]; pds[cp]=NULL; }
+  for(unsigned cp=0;cp<npie;cp++)if(!errors[cp].empty()){
+    Run_ExceptioonFile(string("Error saving particle data: ")+errors[cp],dir+JPartDataBi4::GetFileNameCase(casename,cp,npie));
+  }
+}
+
+//==============================================================================
+/// Saves the XML and bi4 files of the case (casename includes the directory).
+/// Graba los ficheros XML y bi4 del caso (casename incluye el directorio).
+//==============================================================================
+void JSphCaseGen::SaveCase(const std::string &casename){
+  if(!Posd)Run_Exceptioon("Particles were not generated.");
+  JTimer tm; tm.Start();
+  const string dir=fun::GetDirParent(casename);
+  if(!dir.empty())fun::MkdirPath(dir);
+  SaveXml(casename+".xml");
+  SaveBi4(fun::GetDirWithSlash(dir),fun::GetFile(casename));
+  tm.Stop();
+  TimeSave=tm.GetElapsedTimeD()/1000.;
+}
+
+//==============================================================================
+/// Returns a summary of the generated case.
+/// Devuelve un resumen del caso generado.
+//==============================================================================
+std::string JSphCaseGen::GetSummary()const{
+  return(fun::PrintStr("%s  np:%u (tank:%u  obstacle:%u  fluid:%u)  dp:%g  h:%g"
+    ,GetTypeName(Type).c_str(),GetNp(),NpTank,NpObs,NpFluid,Dp,H));
+}
+
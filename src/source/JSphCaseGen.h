@@ -0,0 +1,159 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Generador de casos de benchmark (bloque de fluido sobre suelo y rotura de
+//:#   presa con obstaculo como Spheric2Dam) con cualquier numero de particulas.
+//:#   Las particulas se crean en paralelo por planos de la red y se graban
+//:#   directamente en ficheros XML y bi4 (con varias piezas grabadas en
+//:#   paralelo) que carga JPartsLoad4. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphCaseGen.h \brief Declares the class \ref JSphCaseGen.
+
+#ifndef _JSphCaseGen_
+#define _JSphCaseGen_
+
+#include <string>
+#include <cmath>
+#include "JObject.h"
+#include "TypesDef.h"
+
+//##############################################################################
+//# JSphCaseGen
+//##############################################################################
+/// \brief Generates benchmark cases with any number of particles without GenCase.
+///
+/// All particles are placed on a cubic lattice with distance dp, so the number
+/// of particles of each part of the geometry is known in advance for any dp.
+/// Two geometries are available:
+/// - CGEN_Block: block of fluid (2k x k x k) over a floor of boundary with
+///   thickness 2h and fixed dp. The size k is chosen for the requested number
+///   of particles.
+/// - CGEN_DamBreak: dam break with obstacle of the SPHERIC benchmark 2 (as the
+///   cases Spheric2Dam_*.xml). Tank of 3.22x1x1 m with walls and cap of three
+///   layers, obstacle of 0.16x0.4x0.16 m and fluid column of 1.228x1x0.55 m. The
+///   dp is chosen for the requested number of particles.
+/// The particles are created in parallel by planes of the lattice (the number
+/// of particles of each plane is counted first) in the order of GenCase: fixed
+/// boundary of the tank (mk 11), fixed boundary of the obstacle (mk 12) and
+/// fluid (mk 1). The case is saved as XML and bi4 files (one or several pieces
+/// saved in parallel) that are loaded by JPartsLoad4.
+///
+/// Genera casos de benchmark con cualquier numero de particulas sin GenCase.
+/// Todas las particulas se colocan en una red cubica de distancia dp, de modo
+/// que el numero de particulas de cada parte de la geometria se conoce de
+/// antemano para cualquier dp. Hay dos geometrias: bloque de fluido sobre un
+/// suelo (dp fijo) y rotura de presa con obstaculo del benchmark 2 de SPHERIC
+/// (dp calculado). Las particulas se crean en paralelo por planos de la red en
+/// el orden de GenCase y el caso se graba en ficheros XML y bi4 (una o varias
+/// piezas grabadas en paralelo) que carga JPartsLoad4.
+
+class JSphCaseGen : protected JObject
+{
+public:
+  ///Types of geometry. | Tipos de geometria.
+  typedef enum{
+    CGEN_Block=1,      ///<Block of fluid over a floor of boundary.
+    CGEN_DamBreak=2    ///<Dam break with obstacle (SPHERIC benchmark 2).
+  }TpCaseGen;
+
+  static std::string GetTypeName(TpCaseGen type);
+
+protected:
+  ///Type of lattice point. | Tipo de punto de la red.
+  typedef enum{ PT_None=0,PT_Tank=1,PT_Obstacle=2,PT_Fluid=3 }TpPoint;
+
+  const std::string AppName;
+
+  //-Configuration.
+  TpCaseGen Type;
+  unsigned NpTarget;   ///<Requested number of particles.
+  double CoefH;        ///<Coefficient to compute h=coefh*sqrt(3*dp^2).
+  unsigned Npieces;    ///<Number of pieces of the bi4 file.
+
+  //-Lattice of the case. | Red del caso.
+  double Dp;           ///<Distance between particles.
+  double H;            ///<Smoothing length.
+  double HSwl;         ///<Maximum height of fluid.
+  tint3 BoxMin,BoxMax; ///<Limits of lattice with particles (included).
+  tint3 InnMin,InnMax; ///<Limits of lattice inside the tank walls or over the floor (included).
+  tint3 ObsMin,ObsMax; ///<Limits of lattice of the obstacle (included).
+  tint3 FluMin,FluMax; ///<Limits of lattice of the fluid (included).
+  unsigned ObsLayers;  ///<Thickness of the obstacle shell in particles.
+
+  //-Number of particles. | Numero de particulas.
+  unsigned NpTank;     ///<Boundary particles of the tank or floor.
+  unsigned NpObs;      ///<Boundary particles of the obstacle.
+  unsigned NpFluid;    ///<Fluid particles.
+
+  //-Particle data. | Datos de particulas.
+  unsigned *Idp;
+  tdouble3 *Posd;
+  tfloat3 *Vel;
+  float *Rhop;
+  double TimeGen;      ///<Time of generation [s].
+  double TimeSave;     ///<Time of saving [s].
+
+  static int RoundInt(double v){ return(int(floor(v+0.5))); }
+  tdouble3 LatticePos(const tint3 &p)const{ return(TDouble3(Dp*p.x,Dp*p.y,Dp*p.z)); }
+  static ullong CountBox(const tint3 &pmin,const tint3 &pmax);
+  void FreeMemory();
+  void ConfigBlock(unsigned k);
+  void ConfigDamBreak(double dp);
+  void ComputeCounts();
+  ///Returns the type of the lattice point (i,j,k). | Devuelve el tipo del punto de la red.
+  TpPoint PointType(int i,int j,int k)const{
+    if(i<BoxMin.x || i>BoxMax.x || j<BoxMin.y || j>BoxMax.y || k<BoxMin.z || k>BoxMax.z)return(PT_None);
+    if(i>=FluMin.x && i<=FluMax.x && j>=FluMin.y && j<=FluMax.y && k>=FluMin.z && k<=FluMax.z)return(PT_Fluid);
+    if(i<InnMin.x || i>InnMax.x || j<InnMin.y || j>InnMax.y || k<InnMin.z || k>InnMax.z)return(PT_Tank);
+    if(i>=ObsMin.x && i<=ObsMax.x && j>=ObsMin.y && j<=ObsMax.y && k>=ObsMin.z && k<=ObsMax.z){
+      const int n=int(ObsLayers);
+      if(i<ObsMin.x+n || i>ObsMax.x-n || j<ObsMin.y+n || j>ObsMax.y-n || k>ObsMax.z-n)return(PT_Obstacle);
+    }
+    return(PT_None);
+  }
+  void SaveXml(const std::string &filexml)const;
+  void SaveBi4(const std::string &dir,const std::string &casename)const;
+
+public:
+  JSphCaseGen(const std::string &appname);
+  ~JSphCaseGen();
+  void Reset();
+
+  static bool GetTypeByName(const std::string &name,TpCaseGen &type);
+
+  void Config(TpCaseGen type,unsigned np,double coefh=0,unsigned npieces=1);
+  void Generate();
+  void SaveCase(const std::string &casename);
+
+  TpCaseGen GetType()const{ return(Type); }
+  double GetDp()const{ return(Dp); }
+  double GetH()const{ return(H); }
+  unsigned GetNp()const{ return(NpTank+NpObs+NpFluid); }
+  unsigned GetNpb()const{ return(NpTank+NpObs); }
+  unsigned GetNpFluid()const{ return(NpFluid); }
+  double GetTimeGen()const{ return(TimeGen); }
+  double GetTimeSave()const{ return(TimeSave); }
+  std::string GetSummary()const;
+};
+
+#endif
+
@@ -0,0 +1,159 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphCheckpoint.cpp \brief Implements the class \ref JSphCheckpoint.
+
+#include "JSphCheckpoint.h"
+#include "JBinaryData.h"
+#include "JLog2.h"
+#include "JException.h"
+#include "Functions.h"
+#include <cstdio>
+
+using namespace std;
+
+const std::string JSphCheckpoint::FileCode="JSphCheckpoint";
+volatile std::sig_atomic_t JSphCheckpoint::SignalRequest=0;
+
+//##############################################################################
+//# JSphCheckpoint
+//##############################################################################
+//==============================================================================
+/// Throws exception related to a file from a static method.
+//==============================================================================
+void JSphCheckpoint::RunExceptioonStatic(const std::string &srcfile,int srcline
+  ,const std::string &method
+  ,const std::string &msg,const std::string &file)
+{
+  throw JException(srcfile,srcline,"JSphCheckpoint",method,msg,file);
+}
+
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphCheckpoint::JSphCheckpoint(JLog2 *log,double interval,const std::string &file)
+  :Log(log),Interval(interval),File(file)
+{
+  ClassName="JSphCheckpoint";
+  Reset();
+ #ifndef WIN32
+  SignalRequest=0;
+  signal(SIGUSR1,SignalHandler);
+ #endif
+  Timer.Start();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphCheckpoint::~JSphCheckpoint(){
+  DestructorActive=true;
+ #ifndef WIN32
+  signal(SIGUSR1,SIG_DFL);
+ #endif
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphCheckpoint::Reset(){
+  Count=0;
+  TimeSave=0;
+}
+
+//==============================================================================
+/// Handler of SIGUSR1, it only marks the request.
+/// Manejador de SIGUSR1, solo marca la peticion.
+//==============================================================================
+void JSphCheckpoint::SignalHandler(int){
+  SignalRequest=1;
+}
+
+//==============================================================================
+/// Shows configuration.
+//==============================================================================
+void JSphCheckpoint::VisuConfig(std::string txhead,std::string txfoot)const{
+  if(!txhead.empty())Log->Print(txhead);
+  Log->Printf("  File.......: %s",File.c_str());
+  if(Interval)Log->Printf("  Interval...: %g s of runtime",Interval);
+ #ifndef WIN32
+  Log->Print("  Signal.....: SIGUSR1");
+ #endif
+  if(!txfoot.empty())Log->Print(txfoot);
+}
+
+//==============================================================================
+/// Returns true when a checkpoint must be saved (interval or signal).
+/// Devuelve true cuando hay que grabar un checkpoint (intervalo o senhal).
+//==============================================================================
+bool JSphCheckpoint::CheckSave(){
+  if(SignalRequest)return(true);
+  if(Interval>0){
+    Timer.Stop();
+    return(Timer.GetElapsedTimeD()>=Interval*1000.);
+  }
+  return(false);
+}
+
+//==============================================================================
+/// Saves checkpoint data in a temporary file that replaces the checkpoint file.
+/// Graba los datos del checkpoint en un fichero temporal que reemplaza al 
+/// fichero de checkpoint.
+//==============================================================================
+void JSphCheckpoint::SaveFile(JBinaryData *bdat,double timestep,unsigned nstep){
+  JTimer tsave; tsave.Start();
+  bdat->SetvUint("FormatVer",FormatVerDef);
+  const string filetmp=File+".tmp";
+  bdat->SaveFile(filetmp,false,true);
+ #ifdef WIN32
+  remove(File.c_str());
+ #endif
+  if(rename(filetmp.c_str(),File.c_str()))Run_ExceptioonFile("Cannot rename the temporary checkpoint file.",filetmp);
+  tsave.Stop();
+  Count++;
+  TimeSave+=tsave.GetElapsedTimeD()/1000.;
+  Log->Printf("  Checkpoint saved at t:%g nstep:%u (%.3f s)%s",timestep,nstep,tsave.GetElapsedTimeD()/1000.,(SignalRequest? " requested by signal": ""));
+  SignalRequest=0;
+  Timer.Start();
+}
+
+//==============================================================================
+/// Loads checkpoint file and checks its format.
+/// Carga fichero de checkpoint y comprueba su formato.
+//==============================================================================
+void JSphCheckpoint::LoadFile(const std::string &file,JBinaryData *bdat){
+  if(!fun::FileExists(file))Run_ExceptioonFileSta("Checkpoint file was not found.",file);
+  bdat->LoadFile(file,FileCode);
+  const unsigned fmtver=bdat->GetvUint("FormatVer",true,0);
+  if(fmtver!=FormatVerDef)Run_ExceptioonFileSta(fun::PrintStr("Format version of checkpoint (%u) is not supported (%u).",fmtver,FormatVerDef),file);
+}
+
+//==============================================================================
+/// Copies data of array after checking its type and number of values.
+/// Copia los datos del array tras comprobar su tipo y numero de valores.
+//==============================================================================
+void JSphCheckpoint::GetArrayData(JBinaryData *bdat,const std::string &name
+  ,JBinaryDataDef::TpData type,unsigned count,void *data)
+{
+  JBinaryDataArray *ar=bdat->GetArray(name);
+  if(!ar)Run_ExceptioonSta(fun::PrintStr("Array \'%s\' of checkpoint is not available.",name.c_str()));
+  if(ar->GetType()!=type || ar->GetCount()!=count)Run_ExceptioonSta(fun::PrintStr("Type or size of array \'%s\' of checkpoint is invalid.",name.c_str()));
+  if(count)ar->GetDataCopy(count,data);
+}
+
@@ -0,0 +1,93 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para grabar y cargar checkpoints con el estado completo de la
+//:#   simulacion. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphCheckpoint.h \brief Declares the class \ref JSphCheckpoint.
+
+#ifndef _JSphCheckpoint_
+#define _JSphCheckpoint_
+
+#include <string>
+#include <csignal>
+#include "JObject.h"
+#include "TypesDef.h"
+#include "JTimer.h"
+#include "JBinaryData.h"
+
+class JLog2;
+
+//##############################################################################
+//# JSphCheckpoint
+//##############################################################################
+/// \brief Saves and loads checkpoint files with the complete state of the simulation.
+///
+/// A checkpoint is requested when the runtime since the last one exceeds the
+/// configured interval or when the process receives SIGUSR1 (not on Windows).
+/// The data is written in a temporary file which replaces the previous
+/// checkpoint once it is complete, so a valid checkpoint always exists.
+///
+/// Graba y carga ficheros de checkpoint con el estado completo de la simulacion.
+/// Se solicita cuando el tiempo de ejecucion desde el ultimo supera el intervalo
+/// configurado o cuando el proceso recibe SIGUSR1 (no en Windows).
+
+class JSphCheckpoint : protected JObject
+{
+protected:
+  JLog2 *Log;
+  const double Interval;   ///<Runtime between checkpoints [s] (0=only on signal). | Tiempo de ejecucion entre checkpoints [s].
+  const std::string File;  ///<Checkpoint file. | Fichero de checkpoint.
+  JTimer Timer;            ///<Measures runtime since last checkpoint. | Mide el tiempo desde el ultimo checkpoint.
+  unsigned Count;          ///<Number of saved checkpoints. | Numero de checkpoints grabados.
+  double TimeSave;         ///<Total time saving checkpoints [s]. | Tiempo total grabando checkpoints [s].
+
+  static volatile std::sig_atomic_t SignalRequest;  ///<A checkpoint was requested by signal.
+  static void SignalHandler(int sig);
+  static void RunExceptioonStatic(const std::string &srcfile,int srcline
+    ,const std::string &method
+    ,const std::string &msg,const std::string &file="");
+
+public:
+  static const std::string FileCode;  ///<Name of root item in the file.
+  static const unsigned FormatVerDef=261017;  ///<Version of format.
+
+  JSphCheckpoint(JLog2 *log,double interval,const std::string &file);
+  ~JSphCheckpoint();
+  void Reset();
+  void VisuConfig(std::string txhead,std::string txfoot)const;
+
+  bool CheckSave();
+  void SaveFile(JBinaryData *bdat,double timestep,unsigned nstep);
+  static void LoadFile(const std::string &file,JBinaryData *bdat);
+  static void GetArrayData(JBinaryData *bdat,const std::string &name
+    ,JBinaryDataDef::TpData type,unsigned count,void *data);
+
+  std::string GetFile()const{ return(File); }
+  unsigned GetCount()const{ return(Count); }
+  double GetTimeSave()const{ return(TimeSave); }
+  static std::string GetFileDef(const std::string &dir){ return(dir+"Checkpoint.cbi4"); }
+};
+
+#endif
+
+
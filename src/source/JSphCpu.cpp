@@ -39,11 +39,16 @@
 #include "JGaugeSystem.h"
 #include "JSphBoundCorr.h"  //<vs_innlet>
 #include "JShifting.h"
+#include "JSphPerfCpu.h"
+#include "JSphSchedCpu.h"
 
 #include <climits>
 #ifndef WIN32
 #include <unistd.h>
 #endif
+#if defined(OMP_USE) && defined(__linux__)
+#include <sched.h>
+#endif
 
 using namespace std;
 
@@ -54,6 +59,9 @@ JSphCpu::JSphCpu(bool withmpi):JSph(true,false,withmpi){
   ClassName="JSphCpu";
   CellDiv=NULL;
   ArraysCpu=new JArraysCpu;
+  Perf=NULL;
+  Sched=NULL;
+  SimdNeigs=NULL;
   InitVars();
   TmcCreation(Timers,false);
 }
@@ -66,6 +74,9 @@ JSphCpu::~JSphCpu(){
   FreeCpuMemoryParticles();
   FreeCpuMemoryFixed();
   delete ArraysCpu;
+  delete Perf; Perf=NULL;
+  delete Sched; Sched=NULL;
+  delete[] SimdNeigs; SimdNeigs=NULL;
   TmcDestruction(Timers);
 }
 
@@ -75,11 +86,22 @@ JSphCpu::~JSphCpu(){
 void JSphCpu::InitVars(){
   RunMode="";
   OmpThreads=1;
+  OmpBind=0;
+  OmpSockets=1;
+  for(int th=0;th<OMP_MAXTHREADS;th++)OmpThSocket[th]=0;
+  CpuSymmetric=false;
+  CpuSimd=CpuSimdCheck=false;
+  CpuPosCell=CpuPosCellCheck=false;
+  NgList=false; NgListSkin=0;
+  CellOrder=CELLORDER_Row;
+  IncDivide=0;
+  CpuSchedCost=false;
 
   Np=Npb=NpbOk=0;
   NpbPer=NpfPer=0;
 
   Idpc=NULL; Codec=NULL; Dcellc=NULL; Posc=NULL; Velrhopc=NULL;
+  CellRowc=NULL; RowCellc=NULL;
   BoundNormalc=NULL; MotionVelc=NULL; //-mDBC //<vs_mddbc>
   VelrhopM1c=NULL;                //-Verlet
   PosPrec=NULL; VelrhopPrec=NULL; //-Symplectic
@@ -87,10 +109,19 @@ void JSphCpu::InitVars(){
   Arc=NULL; Acec=NULL; Deltac=NULL;
   ShiftPosfsc=NULL;               //-Shifting.
   Pressc=NULL;
+  SoaPosxc=SoaPosyc=SoaPoszc=NULL;  //-SIMD interaction.
+  SoaVelxc=SoaVelyc=SoaVelzc=SoaRhopc=NULL;
+  NgListRow=NgListCur=NgListBegin=NgListBeginb=NgListNeigs=NULL; //-Neighbour lists.
+  NgListPos0=NULL;
+  NgListBuilds=NgListUses=0;
+  MdbcGhostPart=NULL; MdbcGhostPos=NULL;        //<vs_mddbc>
+  MdbcGhostCellIni=NULL; MdbcGhostCellFin=NULL; //<vs_mddbc>
   RidpMove=NULL; 
   FtRidp=NULL;
   FtoForces=NULL;
   FtoForcesRes=NULL;
+  FtBlockCount=0;
+  FtObjBlock=NULL; FtBlockObj=NULL; FtoBlockForces=NULL;
   FreeCpuMemoryParticles();
   FreeCpuMemoryFixed();
 }
@@ -105,6 +136,10 @@ void JSphCpu::FreeCpuMemoryFixed(){
   delete[] FtRidp;       FtRidp=NULL;
   delete[] FtoForces;    FtoForces=NULL;
   delete[] FtoForcesRes; FtoForcesRes=NULL;
+  delete[] FtObjBlock;     FtObjBlock=NULL;
+  delete[] FtBlockObj;     FtBlockObj=NULL;
+  delete[] FtoBlockForces; FtoBlockForces=NULL;
+  FtBlockCount=0;
 }
 
 //==============================================================================
@@ -122,6 +157,19 @@ void JSphCpu::AllocCpuMemoryFixed(){
       FtRidp      =new unsigned[CaseNfloat];     MemCpuFixed+=(sizeof(unsigned)*CaseNfloat);
       FtoForces   =new StFtoForces[FtCount];     MemCpuFixed+=(sizeof(StFtoForces)*FtCount);
       FtoForcesRes=new StFtoForcesRes[FtCount];  MemCpuFixed+=(sizeof(StFtoForcesRes)*FtCount);
+      //-Blocks of floating particles, each one belongs to one floating body.
+      FtBlockCount=0;
+      for(unsigned cf=0;cf<FtCount;cf++)FtBlockCount+=(FtObjs[cf].count+FTBLOCKSIZE-1)/FTBLOCKSIZE;
+      FtObjBlock    =new unsigned[FtCount+1];         MemCpuFixed+=(sizeof(unsigned)*(FtCount+1));
+      FtBlockObj    =new unsigned[FtBlockCount];      MemCpuFixed+=(sizeof(unsigned)*FtBlockCount);
+      FtoBlockForces=new StFtoForces[FtBlockCount];   MemCpuFixed+=(sizeof(StFtoForces)*FtBlockCount);
+      unsigned nb=0;
+      for(unsigned cf=0;cf<FtCount;cf++){
+        FtObjBlock[cf]=nb;
+        const unsigned nbcf=(FtObjs[cf].count+FTBLOCKSIZE-1)/FTBLOCKSIZE;
+        for(unsigned b=0;b<nbcf;b++)FtBlockObj[nb++]=cf;
+      }
+      FtObjBlock[FtCount]=nb;
     }
   }
   catch(const std::bad_alloc){
@@ -137,8 +185,110 @@ void JSphCpu::FreeCpuMemoryParticles(){
   CpuParticlesSize=0;
   MemCpuParticles=0;
   ArraysCpu->Reset();
+  FreeNgList();
+  FreeMdbcGhost(); //<vs_mddbc>
+}
+
+//==============================================================================
+/// Deallocate memory of neighbour lists.
+/// Libera memoria de listas de vecinos.
+//==============================================================================
+void JSphCpu::FreeNgList(){
+  delete[] NgListRow;    NgListRow=NULL;
+  delete[] NgListCur;    NgListCur=NULL;
+  delete[] NgListBegin;  NgListBegin=NULL;
+  delete[] NgListBeginb; NgListBeginb=NULL;
+  delete[] NgListPos0;   NgListPos0=NULL;
+  delete[] NgListNeigs;  NgListNeigs=NULL;
+  NgListSizeNp=0;
+  NgListSizeNeigs=0;
+  MemCpuNgList=0;
+  NgListOk=false;
+  NgListNp=NgListNpb=NgListNpbOk=0;
+}
+
+//==============================================================================
+/// Allocates memory of neighbour lists for np rows (current neighbours are kept).
+/// Reserva memoria de listas de vecinos para np filas (se mantienen los vecinos).
+//==============================================================================
+void JSphCpu::AllocNgListNp(unsigned np){
+  delete[] NgListRow;    NgListRow=NULL;
+  delete[] NgListCur;    NgListCur=NULL;
+  delete[] NgListBegin;  NgListBegin=NULL;
+  delete[] NgListBeginb; NgListBeginb=NULL;
+  delete[] NgListPos0;   NgListPos0=NULL;
+  MemCpuNgList=sizeof(unsigned)*NgListSizeNeigs;
+  NgListSizeNp=0;
+  NgListOk=false;
+  try{
+    NgListRow   =new unsigned[np];    MemCpuNgList+=sizeof(unsigned)*np;
+    NgListCur   =new unsigned[np];    MemCpuNgList+=sizeof(unsigned)*np;
+    NgListBegin =new unsigned[np+1];  MemCpuNgList+=sizeof(unsigned)*(np+1);
+    NgListBeginb=new unsigned[np];    MemCpuNgList+=sizeof(unsigned)*np;
+    NgListPos0  =new tdouble3[np];    MemCpuNgList+=sizeof(tdouble3)*np;
+  }
+  catch(const std::bad_alloc&){
+    Run_Exceptioon(fun::PrintStr("Could not allocate the requested memory for neighbour lists of %u particles.",np));
+  }
+  NgListSizeNp=np;
+}
+
+//==============================================================================
+/// Allocates memory of neighbour lists for nneigs neighbours.
+/// Reserva memoria de listas de vecinos para nneigs vecinos.
+//==============================================================================
+void JSphCpu::AllocNgListNeigs(ullong nneigs){
+  delete[] NgListNeigs; NgListNeigs=NULL;
+  MemCpuNgList-=sizeof(unsigned)*NgListSizeNeigs;
+  NgListSizeNeigs=0;
+  NgListOk=false;
+  try{
+    NgListNeigs=new unsigned[nneigs];
+  }
+  catch(const std::bad_alloc&){
+    Run_Exceptioon(fun::PrintStr("Could not allocate the requested memory for %s neighbours.",fun::UlongStr(nneigs).c_str()));
+  }
+  NgListSizeNeigs=nneigs;
+  MemCpuNgList+=sizeof(unsigned)*NgListSizeNeigs;
+}
+
+//<vs_mddbc_ini>
+//==============================================================================
+/// Deallocate memory of ghost nodes of mDBC.
+/// Libera memoria de nodos fantasma de mDBC.
+//==============================================================================
+void JSphCpu::FreeMdbcGhost(){
+  delete[] MdbcGhostPart;    MdbcGhostPart=NULL;
+  delete[] MdbcGhostPos;     MdbcGhostPos=NULL;
+  delete[] MdbcGhostCellIni; MdbcGhostCellIni=NULL;
+  delete[] MdbcGhostCellFin; MdbcGhostCellFin=NULL;
+  MdbcGhostSize=MdbcGhostCount=0;
+  MemCpuMdbcGhost=0;
+  MdbcGhostOk=false;
+  MdbcGhostNpbOk=0;
+  MdbcGhostNcells=MdbcGhostCellMin=TUint3(0);
 }
 
+//==============================================================================
+/// Allocates memory of ghost nodes of mDBC for n boundary particles.
+/// Reserva memoria de nodos fantasma de mDBC para n particulas de contorno.
+//==============================================================================
+void JSphCpu::AllocMdbcGhost(unsigned n){
+  FreeMdbcGhost();
+  try{
+    MdbcGhostPart   =new unsigned[n];
+    MdbcGhostPos    =new tdouble3[n];
+    MdbcGhostCellIni=new tint3[n];
+    MdbcGhostCellFin=new tint3[n];
+  }
+  catch(const std::bad_alloc&){
+    Run_Exceptioon(fun::PrintStr("Could not allocate the requested memory for ghost nodes of %u boundary particles.",n));
+  }
+  MdbcGhostSize=n;
+  MemCpuMdbcGhost=llong(sizeof(unsigned)+sizeof(tdouble3)+sizeof(tint3)*2)*n;
+}
+//<vs_mddbc_end>
+
 //==============================================================================
 /// Allocte memory on CPU for the particles. 
 /// Reserva memoria en Cpu para las particulas. 
@@ -149,6 +299,7 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
   const unsigned np2=(over>0? unsigned(over*np): np);
   CpuParticlesSize=np2+PARTICLES_OVERMEMORY_MIN;
   //-Define number or arrays to use. | Establece numero de arrays a usar.
+  ArraysCpu->ResetTouchStats();
   ArraysCpu->SetArraySize(CpuParticlesSize);
   #ifdef CODE_SIZE4
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,2);  //-code,code2
@@ -177,6 +328,16 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B,1); //-BoundNormal
     if(SlipMode!=SLIP_Vel0)ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B,1); //-MotionVel
   } //<vs_mddbc_end> 
+  if(CpuSimd){
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,7); //-SoaPosx,SoaPosy,SoaPosz,SoaVelx,SoaVely,SoaVelz,SoaRhop
+  }
+  if(CpuPosCell){
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,3); //-SoaPosx,SoaPosy,SoaPosz
+  }
+  if(CpuSimdCheck || CpuPosCellCheck){
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,(DDTArray? 2: 1)); //-ar,delta (check)
+    ArraysCpu->AddArrayCount(JArraysCpu::SIZE_12B,1); //-ace (check)
+  }
   if(InOut){  //<vs_innlet_ini>
     //ArraysCpu->AddArrayCount(JArraysCpu::SIZE_4B,1);  //-InOutPart
     ArraysCpu->AddArrayCount(JArraysCpu::SIZE_1B,1);  //-newizone
@@ -184,6 +345,31 @@ void JSphCpu::AllocCpuMemoryParticles(unsigned np,float over){
   //-Shows the allocated memory.
   MemCpuParticles=ArraysCpu->GetAllocMemoryCpu();
   PrintSizeNp(CpuParticlesSize,MemCpuParticles,0);
+  if(OmpBind)ShowTouchBandwidth();
+}
+
+//==============================================================================
+/// Shows the bytes of particle arrays initialised (first touch) by the threads
+/// of each socket and the measured bandwidth. The time of each socket is the 
+/// maximum time of its threads, which initialise their blocks at the same time,
+/// and it includes the page faults of the first touch.
+///
+/// Muestra los bytes de los arrays de particulas inicializados (first touch) 
+/// por los hilos de cada socket y el ancho de banda medido. El tiempo de cada
+/// socket es el tiempo maximo de sus hilos, que inicializan sus bloques a la vez,
+/// e incluye los fallos de pagina de la primera escritura.
+//==============================================================================
+void JSphCpu::ShowTouchBandwidth()const{
+  Log->Printf("First touch of particle arrays by socket:");
+  for(int s=0;s<OmpSockets;s++){
+    ullong nbytes=0;
+    double t=0;
+    for(int th=0;th<OmpThreads;th++)if(OmpThSocket[th]==s){
+      nbytes+=ArraysCpu->GetTouchBytes(th);
+      t=max(t,ArraysCpu->GetTouchTime(th));
+    }
+    Log->Printf("  Socket %d: %.2f MB in %.3f ms (%.2f GB/s)",s,double(nbytes)/(1024*1024),t*1000,(t>0? double(nbytes)/t/1e9: 0));
+  }
 }
 
 //==============================================================================
@@ -301,6 +487,10 @@ llong JSphCpu::GetAllocMemoryCpu()const{
   s+=MemCpuParticles;
   //-Reserved in AllocCpuMemoryFixed().
   s+=MemCpuFixed;
+  //-Reserved for neighbour lists.
+  s+=MemCpuNgList;
+  //-Reserved for ghost nodes of mDBC.
+  s+=MemCpuMdbcGhost; //<vs_mddbc>
   //-Reserved in other objects.
   if(MLPistons)s+=MLPistons->GetAllocMemoryCpu();  //<vs_mlapiston>
   return(s);
@@ -387,8 +577,138 @@ void JSphCpu::ConfigOmp(const JCfgRun *cfg){
     OmpThreads=1;
     omp_set_num_threads(OmpThreads);
   }
+  //-Binds threads to cores before allocating particle memory (first touch).
+  //-Asigna hilos a cores antes de reservar memoria de particulas (first touch).
+  OmpBind=(Cpu? cfg->OmpBind: 0);
+  if(OmpBind)ConfigOmpBind();
 #else
   OmpThreads=1;
+#endif
+  ConfigOmpSlabs(cfg->OmpSlabs);
+}
+
+//==============================================================================
+/// Creates the distribution of particles of the interaction among threads.
+/// With several slabs, each slab is assigned to the threads of one socket
+/// (when the number of slabs is the number of sockets with bound threads) or
+/// to consecutive threads, and threads of each slab initialise the memory of
+/// their slab (first touch) before particle memory is allocated.
+///
+/// Crea el reparto de particulas de la interaccion entre hilos.
+/// Con varias franjas, cada franja se asigna a los hilos de un socket (cuando
+/// el numero de franjas es el numero de sockets con hilos asignados) o a hilos
+/// consecutivos, y los hilos de cada franja inicializan la memoria de su franja
+/// (first touch) antes de reservar la memoria de particulas.
+//==============================================================================
+void JSphCpu::ConfigOmpSlabs(int ompslabs){
+  delete Sched; Sched=NULL;
+  Sched=new JSphSchedCpu(Log,OmpThreads);
+  const int nslabs=min((ompslabs<0? OmpSockets: ompslabs),OmpThreads);
+  if(nslabs>1){
+    int thslab[OMP_MAXTHREADS];
+    bool bysocket=(OmpBind && nslabs==OmpSockets);
+    if(bysocket){
+      std::vector<int> nth(OmpSockets,0);
+      for(int th=0;th<OmpThreads;th++)nth[OmpThSocket[th]]++;
+      for(int s=0;s<OmpSockets;s++)if(!nth[s])bysocket=false;
+    }
+    for(int th=0;th<OmpThreads;th++)thslab[th]=(bysocket? OmpThSocket[th]: th*nslabs/OmpThreads);
+    Sched->ConfigSlabs(unsigned(nslabs),thslab);
+    int thblock[OMP_MAXTHREADS];
+    Sched->GetTouchOrder(thblock);
+    ArraysCpu->SetTouchOrder(OmpThreads,thblock);
+    Log->Printf("Interaction in %s of particles by %s.",Sched->GetSlabsInfo().c_str(),(bysocket? "socket": "consecutive threads"));
+  }
+  else if(ompslabs>1)Log->PrintWarning("Slabs of particles are not used with only one thread.");
+}
+
+//==============================================================================
+/// Binds each OpenMP thread to one core of the available ones. With OmpBind=1
+/// threads fill the cores in order (close) and with OmpBind=2 consecutive 
+/// threads are distributed over the sockets (spread). Memory of particles is 
+/// initialised later by the same threads (see JArraysCpu), so each socket 
+/// keeps the part of the arrays it computes. The main thread is OpenMP thread 0
+/// so it remains bound to one core and the threads created later inherit this
+/// mask, so the original cores of the process are kept in SvAsyncCores for the
+/// writer thread of SvAsync (see JSphSaveAsync::RunWriter()).
+/// Asigna cada hilo OpenMP a un core de los disponibles. Con OmpBind=1 los 
+/// hilos ocupan los cores en orden (close) y con OmpBind=2 los hilos 
+/// consecutivos se reparten entre sockets (spread). La memoria de particulas
+/// se inicializa despues con los mismos hilos (ver JArraysCpu), de forma que 
+/// cada socket mantiene la parte de los arrays que calcula. El hilo principal
+/// es el hilo 0 de OpenMP asi que queda asignado a un core y los hilos creados
+/// despues heredan esta mascara, por eso los cores originales del proceso se 
+/// guardan en SvAsyncCores para el hilo de escritura de SvAsync (ver 
+/// JSphSaveAsync::RunWriter()).
+//==============================================================================
+void JSphCpu::ConfigOmpBind(){
+#if defined(OMP_USE) && defined(__linux__)
+  //-Obtains available cores and their socket. | Obtiene cores disponibles y su socket.
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if(sched_getaffinity(0,sizeof(mask),&mask))Run_Exceptioon("Available cores could not be obtained.");
+  std::vector<int> cores,sockets;
+  for(int cpu=0;cpu<CPU_SETSIZE;cpu++)if(CPU_ISSET(cpu,&mask)){
+    int socket=0;
+    FILE *pf=fopen(fun::PrintStr("/sys/devices/system/cpu/cpu%d/topology/physical_package_id",cpu).c_str(),"r");
+    if(pf){
+      if(fscanf(pf,"%d",&socket)!=1 || socket<0)socket=0;
+      fclose(pf);
+    }
+    cores.push_back(cpu);
+    sockets.push_back(socket);
+  }
+  const int ncores=int(cores.size());
+  if(!ncores)Run_Exceptioon("There are no available cores.");
+  SvAsyncCores=cores;
+  int nsockets=0;
+  for(int c=0;c<ncores;c++)nsockets=max(nsockets,sockets[c]+1);
+  //-Sorts cores according to binding mode. | Ordena cores segun el modo de asignacion.
+  std::vector<int> order;
+  if(OmpBind==2){//-Spread: round-robin over sockets.
+    std::vector<unsigned> next(nsockets,0);
+    while(int(order.size())<ncores){
+      for(int s=0;s<nsockets;s++){
+        unsigned n=0;
+        for(int c=0;c<ncores;c++)if(sockets[c]==s){
+          if(n==next[s]){ order.push_back(c); break; }
+          n++;
+        }
+        next[s]++;
+      }
+    }
+  }
+  else for(int c=0;c<ncores;c++)order.push_back(c);
+  //-Binds each thread to its core. | Asigna cada hilo a su core.
+  std::vector<int> thsocket(OmpThreads,0);
+  int errors=0;
+  #pragma omp parallel num_threads(OmpThreads) reduction(+:errors)
+  {
+    const int th=omp_get_thread_num();
+    const int c=order[th%ncores];
+    cpu_set_t thmask;
+    CPU_ZERO(&thmask);
+    CPU_SET(cores[c],&thmask);
+    if(sched_setaffinity(0,sizeof(thmask),&thmask))errors++;
+    thsocket[th]=sockets[c];
+  }
+  OmpSockets=nsockets;
+  for(int th=0;th<OmpThreads;th++)OmpThSocket[th]=thsocket[th];
+  if(errors)Log->PrintWarning(fun::PrintStr("%d OpenMP threads could not be bound to cores.",errors));
+  //-Shows threads of each socket. | Muestra hilos de cada socket.
+  Log->Printf("OpenMP threads bound to cores (%s) on %d socket(s):",(OmpBind==2? "spread": "close"),nsockets);
+  for(int s=0;s<nsockets;s++){
+    int nth=0;
+    std::string txth;
+    for(int th=0;th<OmpThreads;th++)if(thsocket[th]==s){
+      txth=txth+(nth? ",": "")+fun::IntStr(th);
+      nth++;
+    }
+    Log->Printf("  Socket %d: %d threads (%.0f%% of threads) [%s]",s,nth,100.*nth/OmpThreads,txth.c_str());
+  }
+#else
+  Log->PrintWarning("Binding of OpenMP threads to cores is only available on Linux.");
+  OmpBind=0;
 #endif
 }
 
@@ -404,9 +724,17 @@ void JSphCpu::ConfigRunMode(const JCfgRun *cfg,std::string preinfo){
   #endif
   Hardware="Cpu";
   if(OmpThreads==1)RunMode="Single core";
-  else RunMode=string("OpenMP(Threads:")+fun::IntStr(OmpThreads)+")";
+  else RunMode=string("OpenMP(Threads:")+fun::IntStr(OmpThreads)+(OmpBind? (OmpBind==2? ",Bind:spread": ",Bind:close"): "")+")";
   if(!preinfo.empty())RunMode=preinfo+" - "+RunMode;
   if(Stable)RunMode=string("Stable - ")+RunMode;
+  if(CpuSimd)RunMode=string(CpuSimdCheck? "SIMD-Check - ": "SIMD - ")+RunMode;
+  if(CpuPosCell)RunMode=string(CpuPosCellCheck? "PosCell-Check - ": "PosCell - ")+RunMode;
+  if(CpuSymmetric)RunMode=string("Symmetric - ")+RunMode;
+  if(CellOrder!=CELLORDER_Row)RunMode=string("CellOrder:")+GetNameCellOrder(CellOrder)+" - "+RunMode;
+  if(NgList)RunMode=string("NgList - ")+RunMode;
+  if(CpuSchedCost)RunMode=string("SchedCost - ")+RunMode;
+  if(Sched->GetNslabs()>1)RunMode=Sched->GetSlabsInfo()+" - "+RunMode;
+  if(IncDivide>0)RunMode=string("IncDivide:")+fun::FloatStr(IncDivide,"%g")+" - "+RunMode;
   RunMode=string("Pos-Double - ")+RunMode;
   Log->Print(" ");
   Log->Print(fun::VarStr("RunMode",RunMode));
@@ -475,6 +803,14 @@ void JSphCpu::PreInteraction_Forces(){
   if(Shifting)ShiftPosfsc=ArraysCpu->ReserveFloat4();
   Pressc=ArraysCpu->ReserveFloat();
   if(TVisco==VISCO_LaminarSPS)SpsGradvelc=ArraysCpu->ReserveSymatrix3f();
+  if(CpuSimd){
+    SoaPosxc=ArraysCpu->ReserveFloat(); SoaPosyc=ArraysCpu->ReserveFloat(); SoaPoszc=ArraysCpu->ReserveFloat();
+    SoaVelxc=ArraysCpu->ReserveFloat(); SoaVelyc=ArraysCpu->ReserveFloat(); SoaVelzc=ArraysCpu->ReserveFloat();
+    SoaRhopc=ArraysCpu->ReserveFloat();
+  }
+  if(CpuPosCell){
+    SoaPosxc=ArraysCpu->ReserveFloat(); SoaPosyc=ArraysCpu->ReserveFloat(); SoaPoszc=ArraysCpu->ReserveFloat();
+  }
 
   //-Initialise arrays.
   PreInteractionVars_Forces(Np,Npb);
@@ -548,6 +884,13 @@ void JSphCpu::PosInteraction_Forces(){
   ArraysCpu->Free(ShiftPosfsc);  ShiftPosfsc=NULL;
   ArraysCpu->Free(Pressc);       Pressc=NULL;
   ArraysCpu->Free(SpsGradvelc);  SpsGradvelc=NULL;
+  ArraysCpu->Free(SoaPosxc);     SoaPosxc=NULL;
+  ArraysCpu->Free(SoaPosyc);     SoaPosyc=NULL;
+  ArraysCpu->Free(SoaPoszc);     SoaPoszc=NULL;
+  ArraysCpu->Free(SoaVelxc);     SoaVelxc=NULL;
+  ArraysCpu->Free(SoaVelyc);     SoaVelyc=NULL;
+  ArraysCpu->Free(SoaVelzc);     SoaVelzc=NULL;
+  ArraysCpu->Free(SoaRhopc);     SoaRhopc=NULL;
 }
 
 //==============================================================================
@@ -744,53 +1087,125 @@ void JSphCpu::GetInteractionCells(const tdouble3 &pos
 } //<vs_innlet_end>
 
 //==============================================================================
-/// Perform interaction between particles. Bound-Fluid/Float
-/// Realiza interaccion entre particulas. Bound-Fluid/Float
+/// Returns true when the particles of the interaction are distributed by Sched
+/// (slabs, chunks of equal estimated work or busy time of threads for Perf)
+/// instead of the guided schedule of OpenMP.
+///
+/// Devuelve true cuando las particulas de la interaccion las reparte Sched
+/// (franjas, fragmentos de igual trabajo estimado o tiempo de calculo de los
+/// hilos para Perf) en lugar del reparto guided de OpenMP.
 //==============================================================================
-template<TpKernel tker,TpFtMode ftmode> void JSphCpu::InteractionForcesBound
-  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial
-  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
-  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
-  ,float &viscdt,float *ar)const
+bool JSphCpu::UseSched()const{
+  return(Sched->GetNslabs()>1 || CpuSchedCost || Perf!=NULL);
+}
+
+//==============================================================================
+/// Prepares the chunks of particles pinit...pinit+n-1 of cells starting at
+/// cellp1 that interact with particles of cells starting at cellp2. With
+/// CpuSchedCost the work of each particle is estimated with the number of
+/// candidate neighbours of its cell.
+///
+/// Prepara los fragmentos de las particulas pinit...pinit+n-1 de las celdas
+/// que empiezan en cellp1 que interaccionan con particulas de las celdas que
+/// empiezan en cellp2. Con CpuSchedCost el trabajo de cada particula se estima
+/// con el numero de vecinos candidatos de su celda.
+//==============================================================================
+void JSphCpu::PrepareSched(unsigned n,unsigned pinit,const tint4 &nc,int hdiv
+  ,unsigned cellp1,unsigned cellp2,const unsigned *beginendcell)const
 {
-  //-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
-  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
-  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
-  //-Starts execution using OpenMP.
-  const int pfin=int(pinit+n);
+  if(!CpuSchedCost){
+    Sched->Prepare(pinit,n,Np);
+    return;
+  }
+  const int nct=nc.w*nc.z;
+  unsigned *cellcost=Sched->GetCellCost(unsigned(nct));
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (guided)
+    #pragma omp parallel for schedule (static) if(nct>OMP_LIMIT_LIGHT)
   #endif
-  for(int p1=int(pinit);p1<pfin;p1++){
+  for(int c=0;c<nct;c++){
+    unsigned ncand=0;
+    if(beginendcell[cellp1+c]<beginendcell[cellp1+c+1]){
+      const int cx=c%nc.x;
+      const int row=int(RowCellc[c/nc.x]);
+      const int cy=row%nc.y;
+      const int cz=row/nc.y;
+      const int cxini=cx-min(cx,hdiv);
+      const int cxfin=cx+min(nc.x-cx-1,hdiv)+1;
+      const int yfin=cy+min(nc.y-cy-1,hdiv)+1;
+      const int zfin=cz+min(nc.z-cz-1,hdiv)+1;
+      for(int z=cz-min(cz,hdiv);z<zfin;z++)for(int y=cy-min(cy,hdiv);y<yfin;y++){
+        const int ymod=int(cellp2)+nc.x*int(CellRowc[nc.y*z+y]);
+        ncand+=beginendcell[cxfin+ymod]-beginendcell[cxini+ymod];
+      }
+    }
+    cellcost[c]=ncand;
+  }
+  Sched->PrepareCost(pinit,n,Np,unsigned(nct),beginendcell+cellp1);
+}
+
+//==============================================================================
+/// Perform interaction between particles of chunk pini...pfin-1. Bound-Fluid/Float
+/// Realiza interaccion entre particulas del fragmento pini...pfin-1. Bound-Fluid/Float
+//==============================================================================
+template<TpKernel tker,TpFtMode ftmode,bool ngl,bool poscell,bool perf> void JSphCpu::InteractionForcesBoundChunk
+  (unsigned pini,unsigned pfin,tint4 nc,int hdiv,unsigned cellinitial
+  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code
+  ,const StNgListc *nglist,float *viscth,float *ar)const
+{
+  const float *posx=SoaPosxc,*posy=SoaPosyc,*posz=SoaPoszc;
+  const double scell=double(Scell);
+  for(int p1=int(pini);p1<int(pfin);p1++){
     float visc=0,arp1=0;
+    ullong npairs=0,npairsok=0; //-Counters of evaluated pairs for Perf. | Contadores de parejas evaluadas para Perf.
 
     //-Load data of particle p1. | Carga datos de particula p1.
     const tdouble3 posp1=pos[p1];
     const bool rsymp1=(Symmetry && posp1.y<=Dosh); //<vs_syymmetry>
     const tfloat3 velp1=TFloat3(velrhop[p1].x,velrhop[p1].y,velrhop[p1].z);
 
-    //-Obtain limits of interaction. | Obtiene limites de interaccion.
-    int cxini,cxfin,yini,yfin,zini,zfin;
-    GetInteractionCells(dcell[p1],hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+    //-Obtain limits of interaction (the neighbour list is a single range). | Obtiene limites de interaccion.
+    int cxini=0,cxfin=0,yini=0,yfin=1,zini=0,zfin=1;
+    if(!ngl)GetInteractionCells(dcell[p1],hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
 
     //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
     for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
+      const float shz=(poscell? float(posp1.z-(DomPosMin.z+scell*(z+cellzero.z))): 0);
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
-        const unsigned pini=beginendcell[cxini+ymod];
-        const unsigned pfin=beginendcell[cxfin+ymod];
+        int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        const unsigned pini=(ngl? nglist->begin [nglist->row[p1]]: beginendcell[cxini+ymod]);
+        const unsigned pfin=(ngl? nglist->beginb[nglist->row[p1]]: beginendcell[cxfin+ymod]);
+        if(perf)npairs+=pfin-pini;
+        //-Cell of p2 along the row and position of p1 relative to its origin (PosCell).
+        const float shy=(poscell? float(posp1.y-(DomPosMin.y+scell*(y+cellzero.y))): 0);
+        int cx2=cxini-1;
+        unsigned pcellfin=pini;
+        float shx=0;
 
         //-Interaction of boundary with type Fluid/Float | Interaccion de Bound con varias Fluid/Float.
         //---------------------------------------------------------------------------------------------
         bool rsym=false; //<vs_syymmetry>
-        for(unsigned p2=pini;p2<pfin;p2++){
-          const float drx=float(posp1.x-pos[p2].x);
-                float dry=float(posp1.y-pos[p2].y);
-          if(rsym)    dry=float(posp1.y+pos[p2].y); //<vs_syymmetry>
-          const float drz=float(posp1.z-pos[p2].z);
+        for(unsigned k=pini;k<pfin;k++){
+          const unsigned p2=(ngl? nglist->cur[nglist->neigs[k]]: k);
+          float drx,dry,drz;
+          if(poscell){
+            while(k>=pcellfin){
+              cx2++;
+              pcellfin=beginendcell[cx2+ymod+1];
+              shx=float(posp1.x-(DomPosMin.x+scell*(cx2+cellzero.x)));
+            }
+            drx=shx-posx[p2]; dry=shy-posy[p2]; drz=shz-posz[p2];
+          }
+          else{
+            drx=float(posp1.x-pos[p2].x);
+            dry=float(posp1.y-pos[p2].y);
+            if(rsym)dry=float(posp1.y+pos[p2].y); //<vs_syymmetry>
+            drz=float(posp1.z-pos[p2].z);
+          }
           const float rr2=drx*drx+dry*dry+drz*drz;
           if(rr2<=Fourh2 && rr2>=ALMOSTZERO){
+            if(perf)npairsok++;
             //-Wendland, Cubic Spline or Gaussian kernel.
             float frx,fry,frz;
             if(tker==KERNEL_Wendland)     GetKernelWendland(rr2,drx,dry,drz,frx,fry,frz);
@@ -821,7 +1236,7 @@ template<TpKernel tker,TpFtMode ftmode> void JSphCpu::InteractionForcesBound
               }
             }
             rsym=(rsymp1 && !rsym && float(posp1.y-dry)<=Dosh); //<vs_syymmetry>
-            if(rsym)p2--;                                       //<vs_syymmetry>
+            if(rsym)k--;                                        //<vs_syymmetry>
           }
           else rsym=false;                                      //<vs_syymmetry>
         }
@@ -833,36 +1248,65 @@ template<TpKernel tker,TpFtMode ftmode> void JSphCpu::InteractionForcesBound
       const int th=omp_get_thread_num();
       if(visc>viscth[th*OMP_STRIDE])viscth[th*OMP_STRIDE]=visc;
     }
+    if(perf)Perf->AddThread(omp_get_thread_num(),0,npairs,npairsok);
+  }
+}
+
+//==============================================================================
+/// Perform interaction between particles. Bound-Fluid/Float
+/// Realiza interaccion entre particulas. Bound-Fluid/Float
+//==============================================================================
+template<TpKernel tker,TpFtMode ftmode,bool ngl,bool poscell,bool perf> void JSphCpu::InteractionForcesBound
+  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial
+  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+  ,const StNgListc *nglist,float &viscdt,float *ar)const
+{
+  //-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
+  if(!UseSched()){
+    //-Starts execution using OpenMP.
+    const int pfin=int(pinit+n);
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule (guided)
+    #endif
+    for(int p1=int(pinit);p1<pfin;p1++)InteractionForcesBoundChunk<tker,ftmode,ngl,poscell,perf> (unsigned(p1),unsigned(p1+1),nc,hdiv,cellinitial,beginendcell,cellzero,dcell,pos,velrhop,code,nglist,viscth,ar);
+  }
+  else{
+    //-Starts execution using OpenMP with chunks of particles from Sched.
+    PrepareSched(n,pinit,nc,hdiv,0,cellinitial,beginendcell);
+    #ifdef OMP_USE
+      #pragma omp parallel if(n>OMP_LIMIT_COMPUTEMEDIUM)
+    #endif
+    for(unsigned cini=0,cfin=0;Sched->Next(omp_get_thread_num(),cini,cfin);)InteractionForcesBoundChunk<tker,ftmode,ngl,poscell,perf> (cini,cfin,nc,hdiv,cellinitial,beginendcell,cellzero,dcell,pos,velrhop,code,nglist,viscth,ar);
+    //-Busy time of threads measured by Sched. | Tiempo de calculo de los hilos medido por Sched.
+    if(perf)for(int th=0;th<OmpThreads;th++)Perf->AddThread(th,Sched->GetThreadBusy(th),0,0);
   }
   //-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
   for(int th=0;th<OmpThreads;th++)if(viscdt<viscth[th*OMP_STRIDE])viscdt=viscth[th*OMP_STRIDE];
 }
 
 //==============================================================================
-/// Perform interaction between particles: Fluid/Float-Fluid/Float or Fluid/Float-Bound
-/// Realiza interaccion entre particulas: Fluid/Float-Fluid/Float or Fluid/Float-Bound
+/// Perform interaction between particles of chunk pini...pfin-1: Fluid/Float-Fluid/Float or Fluid/Float-Bound
+/// Realiza interaccion entre particulas del fragmento pini...pfin-1: Fluid/Float-Fluid/Float or Fluid/Float-Bound
 //==============================================================================
-template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift> 
-  void JSphCpu::InteractionForcesFluid
-  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial,float visco
+template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool ngl,bool poscell,bool perf> 
+  void JSphCpu::InteractionForcesFluidChunk
+  (unsigned pini,unsigned pfin,tint4 nc,int hdiv,unsigned cellinitial,float visco
   ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
   ,const tsymatrix3f* tau,tsymatrix3f* gradvel
-  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
-  ,const float *press 
-  ,float &viscdt,float *ar,tfloat3 *ace,float *delta
+  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code
+  ,const float *press,const StNgListc *nglist
+  ,float *viscth,float *ar,tfloat3 *ace,float *delta
   ,TpShifting shiftmode,tfloat4 *shiftposfs)const
 {
   const bool boundp2=(!cellinitial); //-Interaction with type boundary (Bound). | Interaccion con Bound.
-  //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
-  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
-  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
-  //-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP.
-  const int pfin=int(pinit+n);
-  #ifdef OMP_USE
-    #pragma omp parallel for schedule (guided)
-  #endif
-  for(int p1=int(pinit);p1<pfin;p1++){
+  const float *posx=SoaPosxc,*posy=SoaPosyc,*posz=SoaPoszc;
+  const double scell=double(Scell);
+  for(int p1=int(pini);p1<int(pfin);p1++){
     float visc=0,arp1=0,deltap1=0;
+    ullong npairs=0,npairsok=0; //-Counters of evaluated pairs for Perf. | Contadores de parejas evaluadas para Perf.
     tfloat3 acep1=TFloat3(0);
     tsymatrix3f gradvelp1={0,0,0,0,0,0};
 
@@ -886,28 +1330,56 @@ template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool sh
     const tsymatrix3f taup1=(tvisco==VISCO_Artificial? gradvelp1: tau[p1]);
     const bool rsymp1=(Symmetry && posp1.y<=Dosh); //<vs_syymmetry>
 
-    //-Obtain interaction limits.
-    int cxini,cxfin,yini,yfin,zini,zfin;
-    GetInteractionCells(dcell[p1],hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+    //-Obtain interaction limits (the neighbour list is a single range).
+    int cxini=0,cxfin=0,yini=0,yfin=1,zini=0,zfin=1;
+    if(!ngl)GetInteractionCells(dcell[p1],hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
 
     //-Search for neighbours in adjacent cells.
     for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
+      const float shz=(poscell? float(posp1.z-(DomPosMin.z+scell*(z+cellzero.z))): 0);
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
-        const unsigned pini=beginendcell[cxini+ymod];
-        const unsigned pfin=beginendcell[cxfin+ymod];
+        int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
+        unsigned pini,pfin;
+        if(ngl){
+          const unsigned r=nglist->row[p1];
+          pini=(boundp2? nglist->beginb[r]: nglist->begin[r]);
+          pfin=(boundp2? nglist->begin[r+1]: nglist->beginb[r]);
+        }
+        else{
+          pini=beginendcell[cxini+ymod];
+          pfin=beginendcell[cxfin+ymod];
+        }
+        if(perf)npairs+=pfin-pini;
+        //-Cell of p2 along the row and position of p1 relative to its origin (PosCell).
+        const float shy=(poscell? float(posp1.y-(DomPosMin.y+scell*(y+cellzero.y))): 0);
+        int cx2=cxini-1;
+        unsigned pcellfin=pini;
+        float shx=0;
 
         //-Interaction of Fluid with type Fluid or Bound. | Interaccion de Fluid con varias Fluid o Bound.
         //------------------------------------------------------------------------------------------------
         bool rsym=false; //<vs_syymmetry>
-        for(unsigned p2=pini;p2<pfin;p2++){
-          const float drx=float(posp1.x-pos[p2].x);
-                float dry=float(posp1.y-pos[p2].y);
-          if(rsym)    dry=float(posp1.y+pos[p2].y); //<vs_syymmetry>
-          const float drz=float(posp1.z-pos[p2].z);
+        for(unsigned k=pini;k<pfin;k++){
+          const unsigned p2=(ngl? nglist->cur[nglist->neigs[k]]: k);
+          float drx,dry,drz;
+          if(poscell){
+            while(k>=pcellfin){
+              cx2++;
+              pcellfin=beginendcell[cx2+ymod+1];
+              shx=float(posp1.x-(DomPosMin.x+scell*(cx2+cellzero.x)));
+            }
+            drx=shx-posx[p2]; dry=shy-posy[p2]; drz=shz-posz[p2];
+          }
+          else{
+            drx=float(posp1.x-pos[p2].x);
+            dry=float(posp1.y-pos[p2].y);
+            if(rsym)dry=float(posp1.y+pos[p2].y); //<vs_syymmetry>
+            drz=float(posp1.z-pos[p2].z);
+          }
           const float rr2=drx*drx+dry*dry+drz*drz;
           if(rr2<=Fourh2 && rr2>=ALMOSTZERO){
+            if(perf)npairsok++;
             //-Wendland, Cubic Spline or Gaussian kernel.
             float frx,fry,frz;
             if(tker==KERNEL_Wendland)     GetKernelWendland(rr2,drx,dry,drz,frx,fry,frz);
@@ -1015,7 +1487,7 @@ template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool sh
               }
             }
             rsym=(rsymp1 && !rsym && float(posp1.y-dry)<=Dosh); //<vs_syymmetry>
-            if(rsym)p2--;                                       //<vs_syymmetry>
+            if(rsym)k--;                                        //<vs_syymmetry>
           }
           else rsym=false;                                      //<vs_syymmetry>
         }
@@ -1041,11 +1513,761 @@ template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool sh
       }
       if(shift)shiftposfs[p1]=shiftposfsp1;
     }
+    if(perf)Perf->AddThread(omp_get_thread_num(),0,npairs,npairsok);
+  }
+}
+
+//==============================================================================
+/// Perform interaction between particles: Fluid/Float-Fluid/Float or Fluid/Float-Bound
+/// Realiza interaccion entre particulas: Fluid/Float-Fluid/Float or Fluid/Float-Bound
+//==============================================================================
+template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool ngl,bool poscell,bool perf> 
+  void JSphCpu::InteractionForcesFluid
+  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial,float visco
+  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+  ,const tsymatrix3f* tau,tsymatrix3f* gradvel
+  ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
+  ,const float *press,const StNgListc *nglist
+  ,float &viscdt,float *ar,tfloat3 *ace,float *delta
+  ,TpShifting shiftmode,tfloat4 *shiftposfs)const
+{
+  //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
+  if(!UseSched()){
+    //-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP.
+    const int pfin=int(pinit+n);
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule (guided)
+    #endif
+    for(int p1=int(pinit);p1<pfin;p1++)InteractionForcesFluidChunk<tker,ftmode,tvisco,tdensity,shift,ngl,poscell,perf> (unsigned(p1),unsigned(p1+1),nc,hdiv,cellinitial,visco,beginendcell,cellzero,dcell,tau,gradvel,pos,velrhop,code,press,nglist,viscth,ar,ace,delta,shiftmode,shiftposfs);
+  }
+  else{
+    //-Initialise execution with OpenMP with chunks of particles from Sched. | Inicia ejecucion con OpenMP con fragmentos de particulas de Sched.
+    PrepareSched(n,pinit,nc,hdiv,unsigned(nc.w*nc.z+1),cellinitial,beginendcell);
+    #ifdef OMP_USE
+      #pragma omp parallel if(n>OMP_LIMIT_COMPUTEMEDIUM)
+    #endif
+    for(unsigned cini=0,cfin=0;Sched->Next(omp_get_thread_num(),cini,cfin);)InteractionForcesFluidChunk<tker,ftmode,tvisco,tdensity,shift,ngl,poscell,perf> (cini,cfin,nc,hdiv,cellinitial,visco,beginendcell,cellzero,dcell,tau,gradvel,pos,velrhop,code,press,nglist,viscth,ar,ace,delta,shiftmode,shiftposfs);
+    //-Busy time of threads measured by Sched. | Tiempo de calculo de los hilos medido por Sched.
+    if(perf)for(int th=0;th<OmpThreads;th++)Perf->AddThread(th,Sched->GetThreadBusy(th),0,0);
+  }
+  //-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+  for(int th=0;th<OmpThreads;th++)if(viscdt<viscth[th*OMP_STRIDE])viscdt=viscth[th*OMP_STRIDE];
+}
+
+//==============================================================================
+/// Perform interaction Fluid-Fluid visiting each pair only once (Newton's third law).
+/// Each particle interacts with the following particles of its own cell and with
+/// the forward half of the cell stencil, and the opposite contribution is applied
+/// to the neighbour. Cells are processed by colours so that two cells of the same
+/// colour never write the same particles and no atomic operations are needed.
+/// Only valid without floating bodies and without symmetry.
+///
+/// Realiza interaccion Fluid-Fluid visitando cada pareja una sola vez (tercera
+/// ley de Newton). Las celdas se procesan por colores para que dos celdas del 
+/// mismo color nunca escriban las mismas particulas.
+//==============================================================================
+template<TpKernel tker,TpVisco tvisco,TpDensity tdensity,bool shift,bool perf> 
+  void JSphCpu::InteractionForcesFluidSym
+  (tint4 nc,int hdiv,unsigned cellfluid,float visco
+  ,const unsigned *beginendcell
+  ,const tsymatrix3f* tau,tsymatrix3f* gradvel
+  ,const tdouble3 *pos,const tfloat4 *velrhop
+  ,const float *press
+  ,float &viscdt,float *ar,tfloat3 *ace,float *delta
+  ,tfloat4 *shiftposfs)const
+{
+  const float cbar=(float)Cs0;
+  //-Number of colours per axis. The write range of one cell is [cx-hdiv,cx+hdiv],[cy-hdiv,cy+hdiv],[cz,cz+hdiv].
+  const int colx=(nc.x>1? hdiv*2+1: 1);
+  const int coly=(nc.y>1? hdiv*2+1: 1);
+  const int colz=(nc.z>1? hdiv+1: 1);
+  //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
+  //-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP.
+  #ifdef OMP_USE
+    #pragma omp parallel
+  #endif
+  {
+    const int th=omp_get_thread_num();
+    double tbusy=0;
+    ullong npairs=0,npairsok=0;
+    for(int ccz=0;ccz<colz;ccz++)for(int ccy=0;ccy<coly;ccy++)for(int ccx=0;ccx<colx;ccx++){
+      const int ncx=(nc.x-ccx+colx-1)/colx;
+      const int ncy=(nc.y-ccy+coly-1)/coly;
+      const int ncz=(nc.z-ccz+colz-1)/colz;
+      const int ncol=ncx*ncy*ncz;
+      const double tini=(perf? omp_get_wtime(): 0);
+      #ifdef OMP_USE
+        #pragma omp for schedule (guided) nowait
+      #endif
+      for(int cc=0;cc<ncol;cc++){
+        const int cx=ccx+(cc%ncx)*colx;
+        const int cy=ccy+((cc/ncx)%ncy)*coly;
+        const int cz=ccz+(cc/(ncx*ncy))*colz;
+        const int cell=cx+nc.x*int(CellRowc[cy+nc.y*cz])+int(cellfluid);
+        const unsigned pcini=beginendcell[cell];
+        const unsigned pcfin=beginendcell[cell+1];
+        if(pcini<pcfin){
+          //-Ranges of the forward half-stencil (first one is the own cell and following ones in x).
+          unsigned rowini[16],rowfin[16];
+          unsigned nrow=0;
+          const int cxini=cx-min(cx,hdiv);
+          const int cxfin=cx+min(nc.x-cx-1,hdiv)+1;
+          const int yfin=cy+min(nc.y-cy-1,hdiv)+1;
+          const int zfin=cz+min(nc.z-cz-1,hdiv)+1;
+          rowini[nrow]=0; rowfin[nrow]=beginendcell[cell-cx+cxfin]; nrow++;
+          for(int y=cy+1;y<yfin;y++){
+            const int ymod=nc.x*int(CellRowc[y+nc.y*cz])+cellfluid;
+            rowini[nrow]=beginendcell[cxini+ymod]; rowfin[nrow]=beginendcell[cxfin+ymod]; nrow++;
+          }
+          const int yini=cy-min(cy,hdiv);
+          for(int z=cz+1;z<zfin;z++)for(int y=yini;y<yfin;y++){
+            const int ymod=nc.x*int(CellRowc[y+nc.y*z])+cellfluid;
+            rowini[nrow]=beginendcell[cxini+ymod]; rowfin[nrow]=beginendcell[cxfin+ymod]; nrow++;
+          }
+
+          for(unsigned p1=pcini;p1<pcfin;p1++){
+            float visc=0,arp1=0,deltap1=0;
+            tfloat3 acep1=TFloat3(0);
+            tsymatrix3f gradvelp1={0,0,0,0,0,0};
+            tfloat4 shiftposfsp1;
+            if(shift)shiftposfsp1=shiftposfs[p1];
+
+            //-Obtain data of particle p1.
+            const tdouble3 posp1=pos[p1];
+            const tfloat3 velp1=TFloat3(velrhop[p1].x,velrhop[p1].y,velrhop[p1].z);
+            const float rhopp1=velrhop[p1].w;
+            const float pressp1=press[p1];
+            const tsymatrix3f taup1=(tvisco==VISCO_Artificial? gradvelp1: tau[p1]);
+
+            rowini[0]=p1+1;
+            for(unsigned r=0;r<nrow;r++){
+              const unsigned pini=rowini[r];
+              const unsigned pfin=rowfin[r];
+              if(perf)npairs+=pfin-pini;
+              for(unsigned p2=pini;p2<pfin;p2++){
+                const float drx=float(posp1.x-pos[p2].x);
+                const float dry=float(posp1.y-pos[p2].y);
+                const float drz=float(posp1.z-pos[p2].z);
+                const float rr2=drx*drx+dry*dry+drz*drz;
+                if(rr2<=Fourh2 && rr2>=ALMOSTZERO){
+                  if(perf)npairsok++;
+                  //-Wendland, Cubic Spline or Gaussian kernel.
+                  float frx,fry,frz;
+                  if(tker==KERNEL_Wendland)     GetKernelWendland(rr2,drx,dry,drz,frx,fry,frz);
+                  else if(tker==KERNEL_Cubic)   GetKernelCubic   (rr2,drx,dry,drz,frx,fry,frz);
+                  else if(tker==KERNEL_Gaussian)GetKernelGaussian(rr2,drx,dry,drz,frx,fry,frz);
+                  const tfloat4 velrhop2=velrhop[p2];
+                  const float pressp2=press[p2];
+                  const float dot3=(drx*frx+dry*fry+drz*frz);
+
+                  //===== Acceleration (p2 receives the opposite value) ===== 
+                  tfloat3 acep12;
+                  {
+                    const float prs=(pressp1+pressp2)/(rhopp1*velrhop2.w) + (tker==KERNEL_Cubic? GetKernelCubicTensil(rr2,rhopp1,pressp1,velrhop2.w,pressp2): 0);
+                    const float p_vpm=-prs*MassFluid;
+                    acep12=TFloat3(p_vpm*frx,p_vpm*fry,p_vpm*frz);
+                  }
+
+                  //-Density derivative (same value for p1 and p2).
+                  const float dvx=velp1.x-velrhop2.x, dvy=velp1.y-velrhop2.y, dvz=velp1.z-velrhop2.z;
+                  const float arp12=MassFluid*(dvx*frx+dvy*fry+dvz*frz);
+                  arp1+=arp12;
+                  ar[p2]+=arp12;
+
+                  //-Density Diffusion Term (Molteni and Colagrossi 2009).
+                  if(tdensity==DDT_DDT){
+                    const float visc_densi1=DDT2h*cbar*(rhopp1/velrhop2.w-1.f)/(rr2+Eta2);
+                    const float visc_densi2=DDT2h*cbar*(velrhop2.w/rhopp1-1.f)/(rr2+Eta2);
+                    deltap1+=visc_densi1*dot3*MassFluid;
+                    const float deltap2=visc_densi2*dot3*MassFluid;
+                    if(delta)delta[p2]+=deltap2;
+                    else ar[p2]+=deltap2;
+                  }
+                  //-Density Diffusion Term (Fourtakas et al 2019).  //<vs_dtt2_ini>
+                  if(tdensity==DDT_DDT2 || tdensity==DDT_DDT2Full){
+                    const float drhop1=RhopZero*pow(1.f+DDTgz*drz,1.f/Gamma)-RhopZero;
+                    const float drhop2=RhopZero*pow(1.f-DDTgz*drz,1.f/Gamma)-RhopZero;
+                    const float visc_densi1=DDT2h*cbar*((velrhop2.w-rhopp1)-drhop1)/(rr2+Eta2);
+                    const float visc_densi2=DDT2h*cbar*((rhopp1-velrhop2.w)-drhop2)/(rr2+Eta2);
+                    deltap1-=visc_densi1*dot3*MassFluid/velrhop2.w;
+                    const float deltap2=-visc_densi2*dot3*MassFluid/rhopp1;
+                    if(delta)delta[p2]+=deltap2;
+                    else ar[p2]+=deltap2;
+                  }  //<vs_dtt2_end>
+
+                  //-Shifting correction.
+                  if(shift){
+                    if(shiftposfsp1.x!=FLT_MAX){
+                      const float massrhop=MassFluid/velrhop2.w;
+                      shiftposfsp1.x+=massrhop*frx;
+                      shiftposfsp1.y+=massrhop*fry;
+                      shiftposfsp1.z+=massrhop*frz;
+                      shiftposfsp1.w-=massrhop*dot3;
+                    }
+                    if(shiftposfs[p2].x!=FLT_MAX){
+                      const float massrhop=MassFluid/rhopp1;
+                      shiftposfs[p2].x-=massrhop*frx;
+                      shiftposfs[p2].y-=massrhop*fry;
+                      shiftposfs[p2].z-=massrhop*frz;
+                      shiftposfs[p2].w-=massrhop*dot3;
+                    }
+                  }
+
+                  //===== Viscosity ===== 
+                  const float dot=drx*dvx + dry*dvy + drz*dvz;
+                  const float dot_rr2=dot/(rr2+Eta2);
+                  visc=max(dot_rr2,visc);
+                  if(tvisco==VISCO_Artificial){//-Artificial viscosity.
+                    if(dot<0){
+                      const float amubar=H*dot_rr2;  //amubar=CTE.h*dot/(rr2+CTE.eta2);
+                      const float robar=(rhopp1+velrhop2.w)*0.5f;
+                      const float pi_visc=(-visco*cbar*amubar/robar)*MassFluid;
+                      acep12.x-=pi_visc*frx; acep12.y-=pi_visc*fry; acep12.z-=pi_visc*frz;
+                    }
+                  }
+                  else if(tvisco==VISCO_LaminarSPS){//-Laminar+SPS viscosity. 
+                    {//-Laminar contribution.
+                      const float robar2=(rhopp1+velrhop2.w);
+                      const float temp=4.f*visco/((rr2+Eta2)*robar2);
+                      const float vtemp=MassFluid*temp*dot3;  
+                      acep12.x+=vtemp*dvx; acep12.y+=vtemp*dvy; acep12.z+=vtemp*dvz;
+                    }
+                    //-SPS turbulence model.
+                    const tsymatrix3f taup2=tau[p2];
+                    const float tau_xx=taup1.xx+taup2.xx,tau_xy=taup1.xy+taup2.xy,tau_xz=taup1.xz+taup2.xz;
+                    const float tau_yy=taup1.yy+taup2.yy,tau_yz=taup1.yz+taup2.yz,tau_zz=taup1.zz+taup2.zz;
+                    acep12.x+=MassFluid*(tau_xx*frx + tau_xy*fry + tau_xz*frz);
+                    acep12.y+=MassFluid*(tau_xy*frx + tau_yy*fry + tau_yz*frz);
+                    acep12.z+=MassFluid*(tau_xz*frx + tau_yz*fry + tau_zz*frz);
+                    //-Velocity gradients (the product dv*fr is the same for p1 and p2).
+                    const float volp2=-MassFluid/velrhop2.w;
+                    const float volp1=-MassFluid/rhopp1;
+                    tsymatrix3f gv;
+                    gv.xx=dvx*frx; gv.xy=dvx*fry+dvy*frx; gv.xz=dvx*frz+dvz*frx;
+                    gv.yy=dvy*fry; gv.yz=dvy*frz+dvz*fry; gv.zz=dvz*frz;
+                    gradvelp1.xx+=gv.xx*volp2; gradvelp1.xy+=gv.xy*volp2; gradvelp1.xz+=gv.xz*volp2;
+                    gradvelp1.yy+=gv.yy*volp2; gradvelp1.yz+=gv.yz*volp2; gradvelp1.zz+=gv.zz*volp2;
+                    tsymatrix3f *gvp2=gradvel+p2;
+                    gvp2->xx+=gv.xx*volp1; gvp2->xy+=gv.xy*volp1; gvp2->xz+=gv.xz*volp1;
+                    gvp2->yy+=gv.yy*volp1; gvp2->yz+=gv.yz*volp1; gvp2->zz+=gv.zz*volp1;
+                  }
+                  acep1=acep1+acep12;
+                  ace[p2]=ace[p2]-acep12;
+                }
+              }
+            }
+            //-Sum results together. | Almacena resultados.
+            if(tdensity!=DDT_None){
+              if(delta)delta[p1]=(delta[p1]==FLT_MAX? FLT_MAX: delta[p1]+deltap1);
+              else arp1+=deltap1;
+            }
+            ar[p1]+=arp1;
+            ace[p1]=ace[p1]+acep1;
+            if(visc>viscth[th*OMP_STRIDE])viscth[th*OMP_STRIDE]=visc;
+            if(tvisco==VISCO_LaminarSPS){
+              gradvel[p1].xx+=gradvelp1.xx;
+              gradvel[p1].xy+=gradvelp1.xy;
+              gradvel[p1].xz+=gradvelp1.xz;
+              gradvel[p1].yy+=gradvelp1.yy;
+              gradvel[p1].yz+=gradvelp1.yz;
+              gradvel[p1].zz+=gradvelp1.zz;
+            }
+            if(shift)shiftposfs[p1]=shiftposfsp1;
+          }
+        }
+      }
+      //-Waits for the other threads after measuring the busy time of this colour.
+      if(perf)tbusy+=omp_get_wtime()-tini;
+      #ifdef OMP_USE
+        #pragma omp barrier
+      #endif
+    }
+    if(perf)Perf->AddThread(th,tbusy,npairs,npairsok);
+  }
+  //-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+  for(int th=0;th<OmpThreads;th++)if(viscdt<viscth[th*OMP_STRIDE])viscdt=viscth[th*OMP_STRIDE];
+}
+
+//==============================================================================
+/// Copies particle data to SoA arrays for SIMD interaction. Positions are stored
+/// relative to the origin of the cell where the particle was sorted, so the 
+/// distance between particles in float keeps the accuracy of the double path.
+/// With velrhop=NULL only positions are copied (scalar interaction with PosCell).
+///
+/// Copia datos de particulas en arrays SoA para interaccion SIMD. Las posiciones
+/// se guardan relativas al origen de la celda donde se ordeno la particula.
+//==============================================================================
+void JSphCpu::PreInteractionSimd(tint4 nc,tint3 cellzero,const unsigned *beginendcell
+  ,const tdouble3 *pos,const tfloat4 *velrhop)const
+{
+  const int nct=nc.w*nc.z;
+  const int cellfluid=nct+1;
+  const double scell=double(Scell);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int c=0;c<nct*2;c++){
+    const int cell=(c<nct? c: c-nct);
+    const int box=(c<nct? cell: cell+cellfluid);
+    const unsigned pini=beginendcell[box];
+    const unsigned pfin=beginendcell[box+1];
+    if(pini<pfin){
+      const int cx=cell%nc.x;
+      const int row=int(RowCellc[cell/nc.x]);
+      const int cy=row%nc.y;
+      const int cz=row/nc.y;
+      const double ox=DomPosMin.x+scell*(cx+cellzero.x);
+      const double oy=DomPosMin.y+scell*(cy+cellzero.y);
+      const double oz=DomPosMin.z+scell*(cz+cellzero.z);
+      for(unsigned p=pini;p<pfin;p++){
+        const tdouble3 ps=pos[p];
+        SoaPosxc[p]=float(ps.x-ox);
+        SoaPosyc[p]=float(ps.y-oy);
+        SoaPoszc[p]=float(ps.z-oz);
+        if(velrhop){
+          const tfloat4 v=velrhop[p];
+          SoaVelxc[p]=v.x; SoaVelyc[p]=v.y; SoaVelzc[p]=v.z; SoaRhopc[p]=v.w;
+        }
+      }
+    }
+  }
+}
+
+//==============================================================================
+/// Collects neighbours of a particle for SIMD interaction. Distances to all the
+/// candidates of each cell are computed with SoA arrays and only the particles 
+/// inside the kernel support are kept (nb.idx[] and nb.dr[]=drx,dry,drz,rr2).
+/// Returns number of neighbours and number of evaluated candidates in ncand.
+///
+/// Obtiene los vecinos de una particula para interaccion SIMD. Devuelve el
+/// numero de vecinos.
+//==============================================================================
+unsigned JSphCpu::GetNeighboursSimd(const tdouble3 &posp1,unsigned rcell
+  ,int hdiv,const tint4 &nc,const tint3 &cellzero,unsigned cellinitial
+  ,const unsigned *beginendcell,StSimdNeigsc &nb,unsigned &ncand)const
+{
+  int cxini,cxfin,yini,yfin,zini,zfin;
+  GetInteractionCells(rcell,hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+  //-Resizes buffers according to number of candidates.
+  ncand=0;
+  for(int z=zini;z<zfin;z++){
+    const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
+    for(int y=yini;y<yfin;y++){
+      const int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]);
+      ncand+=beginendcell[cxfin+ymod]-beginendcell[cxini+ymod];
+    }
+  }
+  if(!ncand)return(0);
+  if(nb.idx.size()<ncand){
+    const unsigned size=ncand+ncand/2+64;
+    nb.idx.resize(size);
+    nb.dr.resize(size*5);
+  }
+  const unsigned size=unsigned(nb.idx.size());
+  unsigned *idx=&nb.idx[0];
+  float *ndrx=&nb.dr[0],*ndry=ndrx+size,*ndrz=ndry+size,*nrr2=ndrz+size;
+  //-Search for neighbours in adjacent cells.
+  const double scell=double(Scell);
+  const float fourh2=Fourh2;
+  unsigned nn=0;
+  for(int z=zini;z<zfin;z++){
+    const int zmod=nc.y*z;
+    const float shz=float(posp1.z-(DomPosMin.z+scell*(z+cellzero.z)));
+    for(int y=yini;y<yfin;y++){
+      const int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]);
+      const float shy=float(posp1.y-(DomPosMin.y+scell*(y+cellzero.y)));
+      for(int x=cxini;x<cxfin;x++){
+        const unsigned pini=beginendcell[x+ymod];
+        const unsigned pfin=beginendcell[x+ymod+1];
+        const float shx=float(posp1.x-(DomPosMin.x+scell*(x+cellzero.x)));
+        //-Without branches, all candidates are stored and only neighbours advance nn
+        // (this compaction is not vectorised).
+        for(unsigned p2=pini;p2<pfin;p2++){
+          const float drx=shx-SoaPosxc[p2];
+          const float dry=shy-SoaPosyc[p2];
+          const float drz=shz-SoaPoszc[p2];
+          const float rr2=drx*drx+dry*dry+drz*drz;
+          idx[nn]=p2; ndrx[nn]=drx; ndry[nn]=dry; ndrz[nn]=drz; nrr2[nn]=rr2;
+          nn+=(rr2<=fourh2 && rr2>=ALMOSTZERO? 1: 0);
+        }
+      }
+    }
+  }
+  return(nn);
+}
+
+//==============================================================================
+/// Perform interaction between particles using SoA arrays and vectorised 
+/// evaluation of neighbours: Fluid-Fluid or Fluid-Bound.
+/// Only valid without floating bodies, symmetry, shifting and with artificial 
+/// viscosity.
+///
+/// Realiza interaccion entre particulas usando arrays SoA y evaluacion 
+/// vectorizada de vecinos: Fluid-Fluid o Fluid-Bound.
+//==============================================================================
+template<TpKernel tker,TpDensity tdensity> void JSphCpu::InteractionForcesFluidSimd
+  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial,float visco
+  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+  ,const tdouble3 *pos,const float *press
+  ,float &viscdt,float *ar,tfloat3 *ace,float *delta)const
+{
+  const bool boundp2=(!cellinitial); //-Interaction with type boundary (Bound). | Interaccion con Bound.
+  const float massp2=(boundp2? MassBound: MassFluid);
+  const float cbar=(float)Cs0;
+  const bool ddt2=((tdensity==DDT_DDT2 || tdensity==DDT_DDT2Full) && !boundp2); //-DDT2 is discarded with boundary (see below).
+  const float *velx=SoaVelxc,*vely=SoaVelyc,*velz=SoaVelzc,*rhop=SoaRhopc;
+  //-Initialize viscth to calculate viscdt maximo con OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
+  //-Initialise execution with OpenMP. | Inicia ejecucion con OpenMP.
+  const int pfin=int(pinit+n);
+  #ifdef OMP_USE
+    #pragma omp parallel
+  #endif
+  {
+    StSimdNeigsc &nb=SimdNeigs[omp_get_thread_num()];
+    const double tini=(Perf? omp_get_wtime(): 0);
+    ullong npairs=0,npairsok=0;
+    #ifdef OMP_USE
+      #pragma omp for schedule (guided) nowait
+    #endif
+    for(int p1=int(pinit);p1<pfin;p1++){
+      unsigned ncand;
+      const unsigned nn=GetNeighboursSimd(pos[p1],dcell[p1],hdiv,nc,cellzero,cellinitial,beginendcell,nb,ncand);
+      if(Perf){ npairs+=ncand; npairsok+=nn; }
+      if(nn){
+        const unsigned size=unsigned(nb.idx.size());
+        const unsigned *idx=&nb.idx[0];
+        float *ndrx=&nb.dr[0],*ndry=ndrx+size,*ndrz=ndry+size,*nrr2=ndrz+size,*ndrh=nrr2+size;
+        //-Density difference minus hydrostatic density difference of DDT2 is computed
+        // out of the SIMD loop since -ffast-math reassociates the difference of these
+        // close values in the SIMD loop (Ar changes up to 0.4%). The hydrostatic term
+        // is computed in float as in the scalar interaction and both differences are
+        // taken in double (rhopp1) before rounding to float.
+        if(ddt2){
+          const double rhopp1=rhop[p1];
+          for(unsigned c=0;c<nn;c++)ndrh[c]=float((rhop[idx[c]]-rhopp1)-(RhopZero*pow(1.f+DDTgz*ndrz[c],1.f/Gamma)-RhopZero));
+        }
+        //-Obtain data of particle p1.
+        const float velp1x=velx[p1],velp1y=vely[p1],velp1z=velz[p1];
+        const float rhopp1=rhop[p1];
+        const float pressp1=press[p1];
+        float visc=0,arp1=0,deltap1=0;
+        float acep1x=0,acep1y=0,acep1z=0;
+        //-Interaction of Fluid with type Fluid or Bound. | Interaccion de Fluid con varias Fluid o Bound.
+        #ifdef OMP_USE
+          #pragma omp simd reduction(+:arp1,deltap1,acep1x,acep1y,acep1z) reduction(max:visc)
+        #endif
+        for(unsigned c=0;c<nn;c++){
+          const unsigned p2=idx[c];
+          const float drx=ndrx[c],dry=ndry[c],drz=ndrz[c],rr2=nrr2[c];
+          //-Wendland, Cubic Spline or Gaussian kernel.
+          float frx,fry,frz;
+          if(tker==KERNEL_Wendland)     GetKernelWendland(rr2,drx,dry,drz,frx,fry,frz);
+          else if(tker==KERNEL_Cubic)   GetKernelCubic   (rr2,drx,dry,drz,frx,fry,frz);
+          else if(tker==KERNEL_Gaussian)GetKernelGaussian(rr2,drx,dry,drz,frx,fry,frz);
+          const float rhopp2=rhop[p2];
+          const float pressp2=press[p2];
+          //===== Acceleration ===== 
+          const float prs=(pressp1+pressp2)/(rhopp1*rhopp2) + (tker==KERNEL_Cubic? GetKernelCubicTensil(rr2,rhopp1,pressp1,rhopp2,pressp2): 0);
+          const float p_vpm=-prs*massp2;
+          //-Density derivative.
+          const float dvx=velp1x-velx[p2], dvy=velp1y-vely[p2], dvz=velp1z-velz[p2];
+          arp1+=massp2*(dvx*frx+dvy*fry+dvz*frz);
+          //-Density Diffusion Term (Molteni and Colagrossi 2009).
+          if(tdensity==DDT_DDT){
+            const float visc_densi=DDT2h*cbar*(rhopp1/rhopp2-1.f)/(rr2+Eta2);
+            deltap1+=visc_densi*(drx*frx+dry*fry+drz*frz)*massp2;
+          }
+          //-Density Diffusion Term (Fourtakas et al 2019).  //<vs_dtt2_ini>
+          if(ddt2){
+            const float visc_densi=DDT2h*cbar*ndrh[c]/(rr2+Eta2);
+            deltap1-=visc_densi*(drx*frx+dry*fry+drz*frz)*massp2/rhopp2;
+          }  //<vs_dtt2_end>
+          //===== Viscosity (artificial) ===== 
+          const float dot=drx*dvx + dry*dvy + drz*dvz;
+          const float dot_rr2=dot/(rr2+Eta2);
+          visc=max(dot_rr2,visc);
+          const float robar=(rhopp1+rhopp2)*0.5f;
+          const float pi_visc=(dot<0? (-visco*cbar*H*dot_rr2/robar)*massp2: 0.f);
+          acep1x+=(p_vpm-pi_visc)*frx; acep1y+=(p_vpm-pi_visc)*fry; acep1z+=(p_vpm-pi_visc)*frz;
+        }
+        //-DDT is not applied with boundary particles in the same way than scalar path.
+        if(boundp2 && ((tdensity==DDT_DDT && TBoundary==BC_DBC) || tdensity==DDT_DDT2))deltap1=FLT_MAX;
+        if(boundp2 && tdensity==DDT_DDT2Full)deltap1=0;
+        //-Sum results together. | Almacena resultados.
+        if(arp1||acep1x||acep1y||acep1z||visc){
+          if(tdensity!=DDT_None){
+            if(delta)delta[p1]=(delta[p1]==FLT_MAX || deltap1==FLT_MAX? FLT_MAX: delta[p1]+deltap1);
+            else if(deltap1!=FLT_MAX)arp1+=deltap1;
+          }
+          ar[p1]+=arp1;
+          ace[p1]=ace[p1]+TFloat3(acep1x,acep1y,acep1z);
+          const int th=omp_get_thread_num();
+          if(visc>viscth[th*OMP_STRIDE])viscth[th*OMP_STRIDE]=visc;
+        }
+      }
+    }
+    if(Perf)Perf->AddThread(omp_get_thread_num(),omp_get_wtime()-tini,npairs,npairsok);
   }
   //-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
   for(int th=0;th<OmpThreads;th++)if(viscdt<viscth[th*OMP_STRIDE])viscdt=viscth[th*OMP_STRIDE];
 }
 
+//==============================================================================
+/// Perform interaction between particles using SoA arrays and vectorised 
+/// evaluation of neighbours: Bound-Fluid.
+///
+/// Realiza interaccion entre particulas usando arrays SoA y evaluacion 
+/// vectorizada de vecinos: Bound-Fluid.
+//==============================================================================
+template<TpKernel tker> void JSphCpu::InteractionForcesBoundSimd
+  (unsigned n,unsigned pinit,tint4 nc,int hdiv,unsigned cellinitial
+  ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+  ,const tdouble3 *pos,float &viscdt,float *ar)const
+{
+  const float massp2=MassFluid;
+  const float *velx=SoaVelxc,*vely=SoaVelyc,*velz=SoaVelzc;
+  //-Initialize viscth to calculate max viscdt with OpenMP. | Inicializa viscth para calcular visdt maximo con OpenMP.
+  float viscth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)viscth[th*OMP_STRIDE]=0;
+  //-Starts execution using OpenMP.
+  const int pfin=int(pinit+n);
+  #ifdef OMP_USE
+    #pragma omp parallel
+  #endif
+  {
+    StSimdNeigsc &nb=SimdNeigs[omp_get_thread_num()];
+    const double tini=(Perf? omp_get_wtime(): 0);
+    ullong npairs=0,npairsok=0;
+    #ifdef OMP_USE
+      #pragma omp for schedule (guided) nowait
+    #endif
+    for(int p1=int(pinit);p1<pfin;p1++){
+      unsigned ncand;
+      const unsigned nn=GetNeighboursSimd(pos[p1],dcell[p1],hdiv,nc,cellzero,cellinitial,beginendcell,nb,ncand);
+      if(Perf){ npairs+=ncand; npairsok+=nn; }
+      if(nn){
+        const unsigned size=unsigned(nb.idx.size());
+        const unsigned *idx=&nb.idx[0];
+        const float *ndrx=&nb.dr[0],*ndry=ndrx+size,*ndrz=ndry+size,*nrr2=ndrz+size;
+        const float velp1x=velx[p1],velp1y=vely[p1],velp1z=velz[p1];
+        float visc=0,arp1=0;
+        //-Interaction of boundary with type Fluid/Float | Interaccion de Bound con varias Fluid/Float.
+        #ifdef OMP_USE
+          #pragma omp simd reduction(+:arp1) reduction(max:visc)
+        #endif
+        for(unsigned c=0;c<nn;c++){
+          const unsigned p2=idx[c];
+          const float drx=ndrx[c],dry=ndry[c],drz=ndrz[c],rr2=nrr2[c];
+          //-Wendland, Cubic Spline or Gaussian kernel.
+          float frx,fry,frz;
+          if(tker==KERNEL_Wendland)     GetKernelWendland(rr2,drx,dry,drz,frx,fry,frz);
+          else if(tker==KERNEL_Cubic)   GetKernelCubic   (rr2,drx,dry,drz,frx,fry,frz);
+          else if(tker==KERNEL_Gaussian)GetKernelGaussian(rr2,drx,dry,drz,frx,fry,frz);
+          //-Density derivative.
+          const float dvx=velp1x-velx[p2], dvy=velp1y-vely[p2], dvz=velp1z-velz[p2];
+          arp1+=massp2*(dvx*frx+dvy*fry+dvz*frz);
+          //-Viscosity.
+          const float dot=drx*dvx + dry*dvy + drz*dvz;
+          visc=max(dot/(rr2+Eta2),visc);
+        }
+        //-Sum results together. | Almacena resultados.
+        if(arp1||visc){
+          ar[p1]+=arp1;
+          const int th=omp_get_thread_num();
+          if(visc>viscth[th*OMP_STRIDE])viscth[th*OMP_STRIDE]=visc;
+        }
+      }
+    }
+    if(Perf)Perf->AddThread(omp_get_thread_num(),omp_get_wtime()-tini,npairs,npairsok);
+  }
+  //-Keep max value in viscdt. | Guarda en viscdt el valor maximo.
+  for(int th=0;th<OmpThreads;th++)if(viscdt<viscth[th*OMP_STRIDE])viscdt=viscth[th*OMP_STRIDE];
+}
+
+//==============================================================================
+/// Returns the number of neighbours of particle p1 within rcut2 (squared distance)
+/// in the cells starting at cellinitial and stores them in neigs[] (when it is 
+/// not NULL). The order of the neighbours is the order of the cell search.
+///
+/// Devuelve el numero de vecinos de la particula p1 a distancia menor que rcut2
+/// (al cuadrado) en las celdas a partir de cellinitial y los guarda en neigs[] 
+/// (cuando no es NULL). El orden de los vecinos es el de la busqueda por celdas.
+//==============================================================================
+unsigned JSphCpu::NgListSearch(unsigned p1,int hdivnl,const tint4 &nc,const tint3 &cellzero
+  ,unsigned cellinitial,const unsigned *beginendcell,const unsigned *dcell,const tdouble3 *pos
+  ,float rcut2,unsigned *neigs)const
+{
+  const tdouble3 posp1=pos[p1];
+  int cxini,cxfin,yini,yfin,zini,zfin;
+  GetInteractionCells(dcell[p1],hdivnl,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+  unsigned n=0;
+  for(int z=zini;z<zfin;z++){
+    const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
+    for(int y=yini;y<yfin;y++){
+      const int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]);
+      const unsigned pini=beginendcell[cxini+ymod];
+      const unsigned pfin=beginendcell[cxfin+ymod];
+      for(unsigned p2=pini;p2<pfin;p2++)if(p2!=p1){
+        const float drx=float(posp1.x-pos[p2].x);
+        const float dry=float(posp1.y-pos[p2].y);
+        const float drz=float(posp1.z-pos[p2].z);
+        if(drx*drx+dry*dry+drz*drz<=rcut2){
+          if(neigs)neigs[n]=p2;
+          n++;
+        }
+      }
+    }
+  }
+  return(n);
+}
+
+//==============================================================================
+/// Builds the neighbour lists of all particles with distance 2h*(1+NgListSkin).
+/// Boundary particles near fluid only store fluid neighbours and fluid particles
+/// store fluid neighbours followed by boundary neighbours. The rows of the lists
+/// are the current positions of the particles.
+///
+/// Crea las listas de vecinos de todas las particulas con distancia 2h*(1+NgListSkin).
+/// Las particulas de contorno cerca del fluido solo guardan vecinos fluid y las
+/// particulas fluid guardan vecinos fluid seguidos de vecinos de contorno. Las
+/// filas de las listas son las posiciones actuales de las particulas.
+//==============================================================================
+void JSphCpu::NgListBuild(const stinterparmsc &t){
+  const tint4 nc=TInt4(int(t.ncells.x),int(t.ncells.y),int(t.ncells.z),int(t.ncells.x*t.ncells.y));
+  const tint3 cellzero=TInt3(t.cellmin.x,t.cellmin.y,t.cellmin.z);
+  const unsigned cellfluid=nc.w*nc.z+1;
+  const float rcut=Dosh*(1.f+NgListSkin);
+  const float rcut2=rcut*rcut;
+  const int hdivnl=max(int(ceil(rcut/Scell)),1);
+  const int np=int(t.np),npb=int(t.npb),npbok=int(t.npbok);
+  //-Allocates memory for rows. | Reserva memoria para filas.
+  if(t.np>NgListSizeNp)AllocNgListNp(t.np+unsigned(t.np*0.1f));
+  NgListOk=false;
+  //-Counts neighbours of each row. | Cuenta vecinos de cada fila.
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int p=0;p<np;p++){
+    unsigned nf=0,nb=0;
+    if(p<npbok)nf=NgListSearch(p,hdivnl,nc,cellzero,cellfluid,t.begincell,t.dcell,t.pos,rcut2,NULL);
+    else if(p>=npb){
+      nf=NgListSearch(p,hdivnl,nc,cellzero,cellfluid,t.begincell,t.dcell,t.pos,rcut2,NULL);
+      nb=NgListSearch(p,hdivnl,nc,cellzero,0,t.begincell,t.dcell,t.pos,rcut2,NULL);
+    }
+    NgListBegin[p]=nf;
+    NgListBeginb[p]=nb;
+    NgListRow[p]=NgListCur[p]=unsigned(p);
+    NgListPos0[p]=t.pos[p];
+  }
+  //-Computes first neighbour of each row. | Calcula primer vecino de cada fila.
+  ullong nneigs=0;
+  for(int p=0;p<np;p++){
+    const unsigned nf=NgListBegin[p],nb=NgListBeginb[p];
+    NgListBegin[p]=unsigned(nneigs);
+    NgListBeginb[p]=unsigned(nneigs+nf);
+    nneigs+=nf+nb;
+  }
+  if(nneigs!=unsigned(nneigs))Run_Exceptioon("The number of neighbours is too big for neighbour lists.");
+  NgListBegin[np]=unsigned(nneigs);
+  //-Allocates memory for neighbours. | Reserva memoria para vecinos.
+  if(nneigs>NgListSizeNeigs)AllocNgListNeigs(nneigs+nneigs/10);
+  //-Stores neighbours of each row. | Guarda vecinos de cada fila.
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided)
+  #endif
+  for(int p=0;p<np;p++){
+    if(p<npbok)NgListSearch(p,hdivnl,nc,cellzero,cellfluid,t.begincell,t.dcell,t.pos,rcut2,NgListNeigs+NgListBegin[p]);
+    else if(p>=npb){
+      NgListSearch(p,hdivnl,nc,cellzero,cellfluid,t.begincell,t.dcell,t.pos,rcut2,NgListNeigs+NgListBegin[p]);
+      NgListSearch(p,hdivnl,nc,cellzero,0,t.begincell,t.dcell,t.pos,rcut2,NgListNeigs+NgListBeginb[p]);
+    }
+  }
+  NgListNp=t.np; NgListNpb=t.npb; NgListNpbOk=t.npbok;
+  NgListOk=true;
+  NgListBuilds++;
+}
+
+//==============================================================================
+/// Returns the maximum squared displacement of particles since the neighbour 
+/// lists were built.
+/// Devuelve el desplazamiento maximo al cuadrado de las particulas desde que se
+/// crearon las listas de vecinos.
+//==============================================================================
+float JSphCpu::NgListMaxDisp2(unsigned np,const tdouble3 *pos)const{
+  float dispth[OMP_MAXTHREADS*OMP_STRIDE];
+  for(int th=0;th<OmpThreads;th++)dispth[th*OMP_STRIDE]=0;
+  const int n=int(np);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=0;p<n;p++){
+    const tdouble3 ps=pos[p],ps0=NgListPos0[NgListRow[p]];
+    const float dx=float(ps.x-ps0.x),dy=float(ps.y-ps0.y),dz=float(ps.z-ps0.z);
+    const float disp2=dx*dx+dy*dy+dz*dz;
+    const int th=omp_get_thread_num();
+    if(disp2>dispth[th*OMP_STRIDE])dispth[th*OMP_STRIDE]=disp2;
+  }
+  float disp2=0;
+  for(int th=0;th<OmpThreads;th++)if(disp2<dispth[th*OMP_STRIDE])disp2=dispth[th*OMP_STRIDE];
+  return(disp2);
+}
+
+//==============================================================================
+/// Checks the neighbour lists before the interaction and builds them again when
+/// the rows changed (number of particles or boundary particles near fluid without
+/// list) or when the maximum displacement exceeds half the skin distance.
+/// Changes of the cells of the divide do not invalidate the lists.
+///
+/// Comprueba las listas de vecinos antes de la interaccion y las crea de nuevo
+/// cuando cambian las filas (numero de particulas o particulas de contorno cerca
+/// del fluido sin lista) o cuando el desplazamiento maximo supera la mitad de la
+/// distancia de piel. Los cambios de celdas del divide no invalidan las listas.
+//==============================================================================
+void JSphCpu::NgListCheck(const stinterparmsc &t){
+  bool rebuild=(!NgListOk || t.np!=NgListNp || t.npb!=NgListNpb || t.npbok!=NgListNpbOk);
+  //-Boundary particles near fluid must have rows with list. | Las particulas de contorno cerca del fluido deben tener filas con lista.
+  for(unsigned p=0;p<t.npbok && !rebuild;p++)rebuild=(NgListRow[p]>=NgListNpbOk);
+  if(!rebuild){
+    const float displimit=Dosh*NgListSkin*0.5f;
+    rebuild=(NgListMaxDisp2(t.np,t.pos)>displimit*displimit);
+  }
+  if(rebuild)NgListBuild(t);
+  NgListUses++;
+}
+
+//==============================================================================
+/// Updates the rows of the neighbour lists after the particles were reordered
+/// with sortpart[] (only positions pini...pfin-1 were reordered). The lists are 
+/// invalidated when the number of particles changes.
+///
+/// Actualiza las filas de las listas de vecinos despues de reordenar las 
+/// particulas con sortpart[] (solo se reordenaron las posiciones pini...pfin-1).
+/// Las listas se invalidan cuando cambia el numero de particulas.
+//==============================================================================
+void JSphCpu::NgListSort(unsigned np,unsigned pini,unsigned pfin,const unsigned *sortpart){
+  if(!NgListOk)return;
+  if(np!=NgListNp){ NgListOk=false; return; }
+  const int ini=int(pini),fin=int(min(pfin,np));
+  if(ini>=fin)return;
+  unsigned *row=ArraysCpu->ReserveUint();
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(fin-ini>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int p=ini;p<fin;p++){
+    const unsigned r=NgListRow[sortpart[p]];
+    row[p]=r;
+    NgListCur[r]=unsigned(p);
+  }
+  memcpy(NgListRow+ini,row+ini,sizeof(unsigned)*(fin-ini));
+  ArraysCpu->Free(row);
+}
+
 //==============================================================================
 /// Perform DEM interaction between particles Floating-Bound & Floating-Floating //(DEM)
 /// Realiza interaccion DEM entre particulas Floating-Bound & Floating-Floating //(DEM)
@@ -1088,9 +2310,9 @@ void JSphCpu::InteractionForcesDEM
       //-Search for neighbours in adjacent cells (first bound and then fluid+floating).
       for(unsigned cellinitial=0;cellinitial<=cellfluid;cellinitial+=cellfluid){
         for(int z=zini;z<zfin;z++){
-          const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
+          const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
           for(int y=yini;y<yfin;y++){
-            int ymod=zmod+nc.x*y;
+            int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid or boundary cells. | Le suma donde empiezan las celdas de fluido o bound.
             const unsigned pini=beginendcell[cxini+ymod];
             const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -1190,9 +2412,11 @@ void JSphCpu::ComputeSpsTau(unsigned n,unsigned pini,const tfloat4 *velrhop,cons
 
 //==============================================================================
 /// Interaction of Fluid-Fluid/Bound & Bound-Fluid (forces and DEM).
+/// With perf the pairs of the scalar interaction are counted for Perf (-svperf).
 /// Interaccion Fluid-Fluid/Bound & Bound-Fluid (forces and DEM).
+/// Con perf se cuentan las parejas de la interaccion escalar para Perf.
 //==============================================================================
-template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift>
+template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool perf>
   void JSphCpu::Interaction_ForcesCpuT(const stinterparmsc &t,StInterResultc &res)const
 {
   const tint4 nc=TInt4(int(t.ncells.x),int(t.ncells.y),int(t.ncells.z),int(t.ncells.x*t.ncells.y));
@@ -1200,11 +2424,25 @@ template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool sh
   const unsigned cellfluid=nc.w*nc.z+1;
   const int hdiv=(CellMode==CELLMODE_H? 2: 1);
   float viscdt=res.viscdt;
+  const bool simd=(CpuSimd && ftmode==FTMODE_None && tvisco==VISCO_Artificial && !shift);
+  const StNgListc ngldata={NgListRow,NgListCur,NgListBegin,NgListBeginb,NgListNeigs};
+  const bool ngl=(NgList && NgListOk);
+  //-Positions relative to the origin of cells (PosCell) are not valid with neighbour lists.
+  const bool poscell=(CpuPosCell && !ngl);
+  if(simd)PreInteractionSimd(nc,cellzero,t.begincell,t.pos,t.velrhop);
+  else if(poscell)PreInteractionSimd(nc,cellzero,t.begincell,t.pos,NULL);
   if(t.npf){
     //-Interaction Fluid-Fluid.
-    InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift> (t.npf,t.npb,nc,hdiv,cellfluid,Visco                 ,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    if(ftmode==FTMODE_None && CpuSymmetric)InteractionForcesFluidSym<tker,tvisco,tdensity,shift,perf> (nc,hdiv,cellfluid,Visco,t.begincell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.press,viscdt,t.ar,t.ace,t.delta,t.shiftposfs);
+    else if(simd)InteractionForcesFluidSimd<tker,tdensity> (t.npf,t.npb,nc,hdiv,cellfluid,Visco,t.begincell,cellzero,t.dcell,t.pos,t.press,viscdt,t.ar,t.ace,t.delta);
+    else if(ngl)    InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,true ,false,perf> (t.npf,t.npb,nc,hdiv,cellfluid,Visco,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    else if(poscell)InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,false,true ,perf> (t.npf,t.npb,nc,hdiv,cellfluid,Visco,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    else            InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,false,false,perf> (t.npf,t.npb,nc,hdiv,cellfluid,Visco,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
     //-Interaction Fluid-Bound.
-    InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift> (t.npf,t.npb,nc,hdiv,0        ,Visco*ViscoBoundFactor,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    if(simd)InteractionForcesFluidSimd<tker,tdensity> (t.npf,t.npb,nc,hdiv,0,Visco*ViscoBoundFactor,t.begincell,cellzero,t.dcell,t.pos,t.press,viscdt,t.ar,t.ace,t.delta);
+    else if(ngl)    InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,true ,false,perf> (t.npf,t.npb,nc,hdiv,0,Visco*ViscoBoundFactor,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    else if(poscell)InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,false,true ,perf> (t.npf,t.npb,nc,hdiv,0,Visco*ViscoBoundFactor,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
+    else            InteractionForcesFluid<tker,ftmode,tvisco,tdensity,shift,false,false,perf> (t.npf,t.npb,nc,hdiv,0,Visco*ViscoBoundFactor,t.begincell,cellzero,t.dcell,t.spstau,t.spsgradvel,t.pos,t.velrhop,t.code,t.idp,t.press,&ngldata,viscdt,t.ar,t.ace,t.delta,t.shiftmode,t.shiftposfs);
 
     //-Interaction of DEM Floating-Bound & Floating-Floating. //(DEM)
     if(UseDEM)InteractionForcesDEM(CaseNfloat,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,FtRidp,DemData,t.pos,t.velrhop,t.code,t.idp,viscdt,t.ace);
@@ -1214,14 +2452,23 @@ template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool sh
   }
   if(t.npbok){
     //-Interaction Bound-Fluid.
-    InteractionForcesBound<tker,ftmode> (t.npbok,0,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,t.pos,t.velrhop,t.code,t.idp,viscdt,t.ar);
+    if(simd)InteractionForcesBoundSimd<tker> (t.npbok,0,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,t.pos,viscdt,t.ar);
+    else if(ngl)    InteractionForcesBound<tker,ftmode,true ,false,perf> (t.npbok,0,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,t.pos,t.velrhop,t.code,t.idp,&ngldata,viscdt,t.ar);
+    else if(poscell)InteractionForcesBound<tker,ftmode,false,true ,perf> (t.npbok,0,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,t.pos,t.velrhop,t.code,t.idp,&ngldata,viscdt,t.ar);
+    else            InteractionForcesBound<tker,ftmode,false,false,perf> (t.npbok,0,nc,hdiv,cellfluid,t.begincell,cellzero,t.dcell,t.pos,t.velrhop,t.code,t.idp,&ngldata,viscdt,t.ar);
   }
   res.viscdt=viscdt;
 }
 //==============================================================================
 template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity> void JSphCpu::Interaction_Forces_ct5(const stinterparmsc &t,StInterResultc &res)const{
-  if(Shifting)Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,true >(t,res);
-  else        Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,false>(t,res);
+  if(Perf){
+    if(Shifting)Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,true ,true >(t,res);
+    else        Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,false,true >(t,res);
+  }
+  else{
+    if(Shifting)Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,true ,false>(t,res);
+    else        Interaction_ForcesCpuT<tker,ftmode,tvisco,tdensity,false,false>(t,res);
+  }
 }
 //==============================================================================
 template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco> void JSphCpu::Interaction_Forces_ct4(const stinterparmsc &t,StInterResultc &res)const{
@@ -1249,28 +2496,68 @@ void JSphCpu::Interaction_Forces_ct(const stinterparmsc &t,StInterResultc &res)c
 }
 
 //<vs_mddbc_ini>
+//==============================================================================
+/// Computes ghost nodes of boundary particles with normal and the cells of 
+/// their neighbour search. They are kept until boundary particles are reordered.
+/// Calcula nodos fantasma de particulas de contorno con normal y las celdas de 
+/// su busqueda de vecinos. Se mantienen hasta que se reordena el contorno.
+//==============================================================================
+void JSphCpu::MdbcGhostUpdate(tuint3 ncells,tuint3 cellmin
+  ,const tdouble3 *pos,const tfloat3 *boundnormal)
+{
+  const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
+  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
+  const int hdiv=(CellMode==CELLMODE_H? 2: 1);
+  const unsigned n=NpbOk;
+  if(n>MdbcGhostSize)AllocMdbcGhost(n+unsigned(n*0.1f));
+  //-Compacts boundary particles with normal. | Compacta particulas de contorno con normal.
+  unsigned ng=0;
+  for(unsigned p1=0;p1<n;p1++)if(boundnormal[p1]!=TFloat3(0))MdbcGhostPart[ng++]=p1;
+  //-Calculates ghost node positions and limits of interaction.
+  const int nn=int(ng);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(nn>OMP_LIMIT_COMPUTELIGHT)
+  #endif
+  for(int cp=0;cp<nn;cp++){
+    const unsigned p1=MdbcGhostPart[cp];
+    tdouble3 gposp1=pos[p1]+ToTDouble3(boundnormal[p1]);
+    gposp1=(PeriActive!=0? UpdatePeriodicPos(gposp1): gposp1); //-Corrected interface Position.
+    int cxini,cxfin,yini,yfin,zini,zfin;
+    GetInteractionCells(gposp1,hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+    MdbcGhostPos[cp]=gposp1;
+    MdbcGhostCellIni[cp]=TInt3(cxini,yini,zini);
+    MdbcGhostCellFin[cp]=TInt3(cxfin,yfin,zfin);
+  }
+  MdbcGhostCount=ng;
+  MdbcGhostNpbOk=n;
+  MdbcGhostNcells=ncells;
+  MdbcGhostCellMin=cellmin;
+  MdbcGhostOk=true;
+}
+
 //==============================================================================
 /// Perform interaction between ghost nodes of boundaries and fluid.
 //==============================================================================
 template<bool sim2d,TpSlipMode tslip> void JSphCpu::InteractionBoundCorrection
   (unsigned n,float determlimit,float mdbcthreshold
-  ,tint4 nc,int hdiv,unsigned cellinitial,const unsigned *beginendcell,tint3 cellzero
+  ,tint4 nc,unsigned cellinitial,const unsigned *beginendcell
+  ,const unsigned *ghostpart,const tdouble3 *ghostpos,const tint3 *ghostcini,const tint3 *ghostcfin
   ,const tdouble3 *pos,const typecode *code,const unsigned *idp
   ,const tfloat3 *boundnormal,const tfloat3 *motionvel,tfloat4 *velrhop)
 {
   if(tslip==SLIP_FreeSlip)Run_Exceptioon("SlipMode=\'Free slip\' is not yet implemented...");
   const int nn=int(n);
-  #ifdef _WITHOMP
+  #ifdef OMP_USE
     #pragma omp parallel for schedule (guided)
   #endif
-  for(int p1=0;p1<nn;p1++)if(boundnormal[p1]!=TFloat3(0)){
+  for(int cp=0;cp<nn;cp++){
+    const unsigned p1=ghostpart[cp];
     float rhopfinal=FLT_MAX;
     tfloat3 velrhopfinal=TFloat3(0);
     float sumwab=0;
 
-    //-Calculates ghost node position.
-    tdouble3 gposp1=pos[p1]+ToTDouble3(boundnormal[p1]);
-    gposp1=(PeriActive!=0? UpdatePeriodicPos(gposp1): gposp1); //-Corrected interface Position.
+    //-Ghost node position. | Posicion del nodo fantasma.
+    const tdouble3 gposp1=ghostpos[cp];
     //-Initializes variables for calculation.
     float rhopp1=0;
     tfloat3 gradrhopp1=TFloat3(0);
@@ -1279,14 +2566,15 @@ template<bool sim2d,TpSlipMode tslip> void JSphCpu::InteractionBoundCorrection
     tmatrix4d a_corr3=TMatrix4d(0);   //-Only for 3D.
 
     //-Obtain limits of interaction.
-    int cxini,cxfin,yini,yfin,zini,zfin;
-    GetInteractionCells(gposp1,hdiv,nc,cellzero,cxini,cxfin,yini,yfin,zini,zfin);
+    const int cxini=ghostcini[cp].x,cxfin=ghostcfin[cp].x;
+    const int yini=ghostcini[cp].y,yfin=ghostcfin[cp].y;
+    const int zini=ghostcini[cp].z,zfin=ghostcfin[cp].z;
       
     //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
     for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
+        int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
         const unsigned pini=beginendcell[cxini+ymod];
         const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -1442,19 +2730,26 @@ void JSphCpu::Interaction_BoundCorrection(TpSlipMode slipmode
 {
   const float determlimit=1e-3f;
   const tint4 nc=TInt4(int(ncells.x),int(ncells.y),int(ncells.z),int(ncells.x*ncells.y));
-  const tint3 cellzero=TInt3(cellmin.x,cellmin.y,cellmin.z);
   const unsigned cellfluid=nc.w*nc.z+1;
-  const int hdiv=(CellMode==CELLMODE_H? 2: 1);
+  //-Updates ghost nodes when boundary particles or cells were changed.
+  //-Actualiza nodos fantasma cuando cambiaron las particulas de contorno o las celdas.
+  if(!MdbcGhostOk || MdbcGhostNpbOk!=NpbOk || ncells!=MdbcGhostNcells || cellmin!=MdbcGhostCellMin){
+    MdbcGhostUpdate(ncells,cellmin,pos,boundnormal);
+  }
+  const unsigned *gp=MdbcGhostPart;
+  const tdouble3 *gpos=MdbcGhostPos;
+  const tint3 *gci=MdbcGhostCellIni;
+  const tint3 *gcf=MdbcGhostCellFin;
   //-Interaction GhostBoundaryNodes-Fluid.
-  unsigned n=NpbOk;
+  unsigned n=MdbcGhostCount;
   if(Simulate2D){ const bool sim2d=true;
-    if(slipmode==SLIP_Vel0    )InteractionBoundCorrection<sim2d,SLIP_Vel0    >(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
-    if(slipmode==SLIP_NoSlip  )InteractionBoundCorrection<sim2d,SLIP_NoSlip  >(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
-    if(slipmode==SLIP_FreeSlip)InteractionBoundCorrection<sim2d,SLIP_FreeSlip>(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_Vel0    )InteractionBoundCorrection<sim2d,SLIP_Vel0    >(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_NoSlip  )InteractionBoundCorrection<sim2d,SLIP_NoSlip  >(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_FreeSlip)InteractionBoundCorrection<sim2d,SLIP_FreeSlip>(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
   }else{          const bool sim2d=false;
-    if(slipmode==SLIP_Vel0    )InteractionBoundCorrection<sim2d,SLIP_Vel0    >(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
-    if(slipmode==SLIP_NoSlip  )InteractionBoundCorrection<sim2d,SLIP_NoSlip  >(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
-    if(slipmode==SLIP_FreeSlip)InteractionBoundCorrection<sim2d,SLIP_FreeSlip>(n,determlimit,MdbcThreshold,nc,hdiv,cellfluid,begincell,cellzero,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_Vel0    )InteractionBoundCorrection<sim2d,SLIP_Vel0    >(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_NoSlip  )InteractionBoundCorrection<sim2d,SLIP_NoSlip  >(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
+    if(slipmode==SLIP_FreeSlip)InteractionBoundCorrection<sim2d,SLIP_FreeSlip>(n,determlimit,MdbcThreshold,nc,cellfluid,begincell,gp,gpos,gci,gcf,pos,code,idp,boundnormal,motionvel,velrhop);
   }
 }
 //<vs_mddbc_end>
@@ -1619,6 +2914,11 @@ void JSphCpu::ComputeVerlet(double dt){
   }
   //-New values are calculated en VelrhopM1c. | Los nuevos valores se calculan en VelrhopM1c.
   swap(Velrhopc,VelrhopM1c);     //-Swap Velrhopc & VelrhopM1c. | Intercambia Velrhopc y VelrhopM1c.
+  if(Perf){//-Bytes read and written by the update of particle state.
+    const ullong bbound=sizeof(tfloat4)*3+sizeof(float);
+    const ullong bfluid=sizeof(tfloat4)*3+sizeof(float)+sizeof(tfloat3)+sizeof(typecode)+sizeof(tdouble3)*2+sizeof(unsigned)+(shift? sizeof(tfloat4): 0);
+    Perf->AddBytesStep(bbound*Npb+bfluid*(Np-Npb));
+  }
   TmcStop(Timers,TMC_SuComputeStep);
 }
 
@@ -1693,6 +2993,11 @@ void JSphCpu::ComputeSymplecticPre(double dt){
 
   //-Copy previous position of boundary. | Copia posicion anterior del contorno.
   memcpy(Posc,PosPrec,sizeof(tdouble3)*Npb);
+  if(Perf){//-Bytes read and written by the update of particle state.
+    const ullong bbound=sizeof(tfloat4)*2+sizeof(float)+sizeof(tdouble3)*2;
+    const ullong bfluid=sizeof(tfloat4)*2+sizeof(float)+sizeof(tfloat3)+sizeof(typecode)+sizeof(tdouble3)*2+sizeof(unsigned);
+    Perf->AddBytesStep(bbound*Npb+bfluid*(Np-Npb));
+  }
 
   TmcStop(Timers,TMC_SuComputeStep);
 }
@@ -1762,6 +3067,11 @@ void JSphCpu::ComputeSymplecticCorr(double dt){
     }
   }
 
+  if(Perf){//-Bytes read and written by the update of particle state.
+    const ullong bbound=sizeof(tfloat4)*3+sizeof(float);
+    const ullong bfluid=sizeof(tfloat4)*3+sizeof(float)+sizeof(tfloat3)+sizeof(typecode)+sizeof(tdouble3)*2+sizeof(unsigned)+(shift? sizeof(tfloat4): 0);
+    Perf->AddBytesStep(bbound*Npb+bfluid*(Np-Npb));
+  }
   //-Free memory assigned to variables Pre and ComputeSymplecticPre(). | Libera memoria asignada a variables Pre en ComputeSymplecticPre().
   ArraysCpu->Free(PosPrec);      PosPrec=NULL;
   ArraysCpu->Free(VelrhopPrec);  VelrhopPrec=NULL;
@@ -2080,7 +3390,14 @@ void JSphCpu::ShowTimers(bool onlyfile){
   JLog2::TpMode_Out mode=(onlyfile? JLog2::Out_File: JLog2::Out_ScrFile);
   Log->Print("[CPU Timers]",mode);
   if(!SvTimers)Log->Print("none",mode);
-  else for(unsigned c=0;c<TimerGetCount();c++)if(TimerIsActive(c))Log->Print(TimerToText(c),mode);
+  else{
+    for(unsigned c=0;c<TimerGetCount();c++)if(TimerIsActive(c))Log->Print(TimerToText(c),mode);
+    //-Mean idle time of threads at the end of the interaction loops. | Tiempo medio de espera de los hilos al final de los bucles de interaccion.
+    if(Sched->GetNloops()){
+      const double tloop=Sched->GetLoopTime(),tidle=Sched->GetLoopIdle();
+      Log->Print(JSph::TimerToText("CF-ForcesIdle",float(tidle*1000))+fun::PrintStr(" (%.1f%% of %u loops of %.3f sec.)",(tloop? 100.*tidle/tloop: 0),Sched->GetNloops(),tloop),mode);
+    }
+  }
 }
 
 //==============================================================================
@@ -2092,6 +3409,10 @@ void JSphCpu::GetTimersInfo(std::string &hinfo,std::string &dinfo)const{
     hinfo=hinfo+";"+TimerGetName(c);
     dinfo=dinfo+";"+fun::FloatStr(TimerGetValue(c)/1000.f);
   }
+  if(SvTimers && Sched->GetNloops()){
+    hinfo=hinfo+";CF-ForcesIdle";
+    dinfo=dinfo+";"+fun::FloatStr(float(Sched->GetLoopIdle()));
+  }
 }
 
 
@@ -25,6 +25,7 @@
 #include "JSphTimersCpu.h"
 #include "JSph.h"
 #include <string>
+#include <vector>
 
 
 ///Structure with the parameters for particle interaction on CPU.
@@ -75,10 +76,27 @@ typedef struct{
   float viscdt;
 }StInterResultc;
 
+///Structure with the Verlet neighbour lists for particle interaction on CPU.
+typedef struct{
+  const unsigned *row;     ///<Row of the lists for each particle [np].
+  const unsigned *cur;     ///<Current position of the particle of each row [np].
+  const unsigned *begin;   ///<First fluid neighbour of each row [np+1].
+  const unsigned *beginb;  ///<First bound neighbour of each row (end of fluid neighbours) [np].
+  const unsigned *neigs;   ///<Rows of the neighbours [begin[np]].
+}StNgListc;
+
+///Structure with the buffers of neighbours of one thread for SIMD interaction on CPU.
+typedef struct{
+  std::vector<unsigned> idx;  ///<Neighbours of the particle.
+  std::vector<float> dr;      ///<Rows drx, dry, drz, rr2 and density term of DDT2 of the neighbours.
+}StSimdNeigsc;
+
 
 class JPartsOut;
 class JArraysCpu;
 class JCellDivCpu;
+class JSphPerfCpu;
+class JSphSchedCpu;
 
 //##############################################################################
 //# JSphCpu
@@ -92,7 +110,20 @@ private:
 
 protected:
   int OmpThreads;        ///<Max number of OpenMP threads in execution on CPU host (minimum 1). | Numero maximo de hilos OpenMP en ejecucion por host en CPU (minimo 1).
+  int OmpBind;           ///<Binding of OpenMP threads to cores 0:None, 1:Close, 2:Spread over sockets. | Asignacion de hilos OpenMP a cores.
+  int OmpSockets;        ///<Number of sockets of the cores of OpenMP threads (1 without OmpBind). | Numero de sockets de los cores de los hilos OpenMP.
+  int OmpThSocket[OMP_MAXTHREADS]; ///<Socket of each OpenMP thread (0 without OmpBind). | Socket de cada hilo OpenMP.
   std::string RunMode;   ///<Overall mode of execution (symmetry, openmp, load balancing). |  Almacena modo de ejecucion (simetria,openmp,balanceo,...).
+  bool CpuSymmetric;     ///<Fluid-Fluid interaction computes each pair once and applies the opposite contribution to the neighbour (Newton's third law).
+  bool CpuSimd;          ///<Interaction uses SoA arrays and vectorised evaluation of neighbours.
+  bool CpuSimdCheck;     ///<Interaction with CpuSimd is checked against the scalar path in each step.
+  bool CpuPosCell;       ///<Scalar interaction uses float positions relative to the origin of cells (SoaPos arrays).
+  bool CpuPosCellCheck;  ///<Interaction with CpuPosCell is checked against the path with double positions in each step.
+  bool NgList;           ///<Interaction uses Verlet neighbour lists with skin distance.
+  float NgListSkin;      ///<Skin distance of the neighbour lists as a fraction of 2h.
+  TpCellOrder CellOrder; ///<Order in memory of the rows of cells (Row, Morton or Hilbert).
+  float IncDivide;       ///<Maximum fraction of fluid particles that change cell for an incremental divide (0:disabled).
+  bool CpuSchedCost;     ///<Chunks of particles of the interaction with equal work estimated from the occupancy of cells.
 
   //-Number of particles in domain | Numero de particulas del dominio.
   unsigned Np;        ///<Total number of particles (including periodic duplicates). | Numero total de particulas (incluidas las duplicadas periodicas).
@@ -120,6 +151,8 @@ protected:
   unsigned *Idpc;    ///<Identifier of particle | Identificador de particula.
   typecode *Codec;   ///<Indicator of group of particles & other special markers. | Indica el grupo de las particulas y otras marcas especiales.
   unsigned *Dcellc;  ///<Cells inside DomCells coded with DomCellCode. | Celda dentro de DomCells codificada con DomCellCode.
+  const unsigned *CellRowc; ///<Position in memory of each row of cells (cy+cz*Ncy) [Ncy*Ncz] (from CellDiv). | Posicion en memoria de cada fila de celdas.
+  const unsigned *RowCellc; ///<Row (cy+cz*Ncy) in each position of memory [Ncy*Ncz] (from CellDiv). | Fila en cada posicion de memoria.
   tdouble3 *Posc;
   tfloat4 *Velrhopc;
 
@@ -137,6 +170,12 @@ protected:
   unsigned *FtRidp;             ///<Identifier to access to the particles of the floating object [CaseNfloat].
   StFtoForces *FtoForces;       ///<Stores forces of floatings [FtCount].
   StFtoForcesRes *FtoForcesRes; ///<Stores data to update floatings [FtCount].
+  //-Blocks of floating particles for parallel sums and updates (each block belongs to one floating body).
+  static const unsigned FTBLOCKSIZE=4096; ///<Maximum number of particles of each block. | Numero maximo de particulas de cada bloque.
+  unsigned FtBlockCount;        ///<Number of blocks of floating particles.
+  unsigned *FtObjBlock;         ///<First block of each floating body [FtCount+1].
+  unsigned *FtBlockObj;         ///<Floating body of each block [FtBlockCount].
+  StFtoForces *FtoBlockForces;  ///<Partial sums of forces of each block [FtBlockCount].
 
   //-Variables for computation of forces | Vars. para computo de fuerzas.
   tfloat3 *Acec;         ///<Sum of interaction forces | Acumula fuerzas de interaccion
@@ -156,7 +195,48 @@ protected:
   tsymatrix3f *SpsTauc;       ///<SPS sub-particle stress tensor.
   tsymatrix3f *SpsGradvelc;   ///<Velocity gradients.
 
+  //-Variables for SIMD interaction (SoA copy of particle data). | Vars. para interaccion SIMD (copia SoA de datos de particulas).
+  float *SoaPosxc,*SoaPosyc,*SoaPoszc;  ///<Position relative to the origin of the cell where particle is sorted (also with CpuPosCell).
+  float *SoaVelxc,*SoaVelyc,*SoaVelzc;  ///<Velocity of particles.
+  float *SoaRhopc;                      ///<Density of particles.
+  StSimdNeigsc *SimdNeigs;              ///<Buffers of neighbours of each thread, reused in each step [OmpThreads].
+
+  //-Variables for Verlet neighbour lists (rows are the particles when the lists were built).
+  //-Vars. para listas de vecinos de Verlet (las filas son las particulas al crear las listas).
+  bool NgListOk;           ///<The neighbour lists are valid for the current particles.
+  unsigned NgListNp;       ///<Number of particles (rows) of the neighbour lists.
+  unsigned NgListNpb;      ///<Number of boundary particles when the lists were built.
+  unsigned NgListNpbOk;    ///<Number of boundary particles near fluid when the lists were built.
+  unsigned NgListSizeNp;   ///<Number of rows with allocated memory.
+  ullong NgListSizeNeigs;  ///<Number of neighbours with allocated memory.
+  unsigned *NgListRow;     ///<Row of the lists for each particle [NgListSizeNp].
+  unsigned *NgListCur;     ///<Current position of the particle of each row [NgListSizeNp].
+  unsigned *NgListBegin;   ///<First fluid neighbour of each row [NgListSizeNp+1].
+  unsigned *NgListBeginb;  ///<First bound neighbour of each row [NgListSizeNp].
+  tdouble3 *NgListPos0;    ///<Position of each row when the lists were built [NgListSizeNp].
+  unsigned *NgListNeigs;   ///<Rows of the neighbours [NgListSizeNeigs].
+  llong MemCpuNgList;      ///<Memory reserved for neighbour lists.
+  unsigned NgListBuilds;   ///<Number of times the lists were built.
+  unsigned NgListUses;     ///<Number of interactions using the lists.
+
+  //-Variables for ghost nodes of mDBC (kept while boundary particles are not reordered). //<vs_mddbc_ini>
+  //-Vars. para nodos fantasma de mDBC (se mantienen mientras no se reordena el contorno).
+  bool MdbcGhostOk;          ///<The ghost nodes are valid for the current boundary particles.
+  unsigned MdbcGhostNpbOk;   ///<Number of boundary particles near fluid when ghost nodes were computed.
+  tuint3 MdbcGhostNcells;    ///<Number of cells of the divide when ghost nodes were computed.
+  tuint3 MdbcGhostCellMin;   ///<Lower cell of the divide when ghost nodes were computed.
+  unsigned MdbcGhostCount;   ///<Number of ghost nodes (boundary particles with normal).
+  unsigned MdbcGhostSize;    ///<Number of ghost nodes with allocated memory.
+  unsigned *MdbcGhostPart;   ///<Boundary particle of each ghost node [MdbcGhostSize].
+  tdouble3 *MdbcGhostPos;    ///<Position of each ghost node [MdbcGhostSize].
+  tint3 *MdbcGhostCellIni;   ///<First cell (x,y,z) of neighbour search of each ghost node [MdbcGhostSize].
+  tint3 *MdbcGhostCellFin;   ///<Last cell+1 (x,y,z) of neighbour search of each ghost node [MdbcGhostSize].
+  llong MemCpuMdbcGhost;     ///<Memory reserved for ghost nodes of mDBC.
+  //<vs_mddbc_end>
+
   TimersCpu Timers;
+  JSphPerfCpu *Perf;  ///<Performance counters of each step (only with SvPerf). | Contadores de rendimiento de cada paso.
+  JSphSchedCpu *Sched; ///<Distribution of particles of the interaction among threads. | Reparto de particulas de la interaccion entre hilos.
 
 
   void InitVars();
@@ -165,10 +245,18 @@ protected:
   void AllocCpuMemoryFixed();
   void FreeCpuMemoryParticles();
   void AllocCpuMemoryParticles(unsigned np,float over);
+  void ShowTouchBandwidth()const;
 
   void ResizeCpuMemoryParticles(unsigned np);
   void ReserveBasicArraysCpu();
 
+  void FreeNgList();
+  void AllocNgListNp(unsigned np);
+  void AllocNgListNeigs(ullong nneigs);
+
+  void FreeMdbcGhost();             //<vs_mddbc>
+  void AllocMdbcGhost(unsigned n);  //<vs_mddbc>
+
   bool CheckCpuParticlesSize(unsigned requirednp){ return(requirednp+PARTICLES_OVERMEMORY_MIN<=CpuParticlesSize); }
 
   template<class T> T* TSaveArrayCpu(unsigned np,const T *datasrc)const;
@@ -198,6 +286,8 @@ protected:
   unsigned GetParticlesData(unsigned n,unsigned pini,bool onlynormal
     ,unsigned *idp,tdouble3 *pos,tfloat3 *vel,float *rhop,typecode *code);
   void ConfigOmp(const JCfgRun *cfg);
+  void ConfigOmpBind();
+  void ConfigOmpSlabs(int ompslabs);
 
   void ConfigRunMode(const JCfgRun *cfg,std::string preinfo="");
   void ConfigCellDiv(JCellDivCpu* celldiv){ CellDiv=celldiv; }
@@ -228,28 +318,79 @@ protected:
     ,int hdiv,const tint4 &nc,const tint3 &cellzero                       //<vs_innlet>
     ,int &cxini,int &cxfin,int &yini,int &yfin,int &zini,int &zfin)const; //<vs_innlet>
 
-  template<TpKernel tker,TpFtMode ftmode> void InteractionForcesBound
+  bool UseSched()const;
+  void PrepareSched(unsigned n,unsigned pinit,const tint4 &nc,int hdiv
+    ,unsigned cellp1,unsigned cellp2,const unsigned *beginendcell)const;
+
+  template<TpKernel tker,TpFtMode ftmode,bool ngl,bool poscell,bool perf> void InteractionForcesBoundChunk
+    (unsigned pini,unsigned pfin,tint4 nc,int hdiv,unsigned cellinitial
+    ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+    ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code
+    ,const StNgListc *nglist,float *viscth,float *ar)const;
+  template<TpKernel tker,TpFtMode ftmode,bool ngl,bool poscell,bool perf> void InteractionForcesBound
     (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellinitial
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
     ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *id
-    ,float &viscdt,float *ar)const;
+    ,const StNgListc *nglist,float &viscdt,float *ar)const;
 
-  template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift> void InteractionForcesFluid
+  template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool ngl,bool poscell,bool perf> void InteractionForcesFluidChunk
+    (unsigned pini,unsigned pfin,tint4 nc,int hdiv,unsigned cellinitial,float visco
+    ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+    ,const tsymatrix3f* tau,tsymatrix3f* gradvel
+    ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code
+    ,const float *press,const StNgListc *nglist
+    ,float *viscth,float *ar,tfloat3 *ace,float *delta
+    ,TpShifting shiftmode,tfloat4 *shiftposfs)const;
+  template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool ngl,bool poscell,bool perf> void InteractionForcesFluid
     (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellfluid,float visco
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
     ,const tsymatrix3f* tau,tsymatrix3f* gradvel
     ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
-    ,const float *press
+    ,const float *press,const StNgListc *nglist
     ,float &viscdt,float *ar,tfloat3 *ace,float *delta
     ,TpShifting shiftmode,tfloat4 *shiftposfs)const;
 
+  template<TpKernel tker,TpVisco tvisco,TpDensity tdensity,bool shift,bool perf> void InteractionForcesFluidSym
+    (tint4 nc,int hdiv,unsigned cellfluid,float visco
+    ,const unsigned *beginendcell
+    ,const tsymatrix3f* tau,tsymatrix3f* gradvel
+    ,const tdouble3 *pos,const tfloat4 *velrhop
+    ,const float *press
+    ,float &viscdt,float *ar,tfloat3 *ace,float *delta
+    ,tfloat4 *shiftposfs)const;
+
+  void PreInteractionSimd(tint4 nc,tint3 cellzero,const unsigned *beginendcell
+    ,const tdouble3 *pos,const tfloat4 *velrhop)const;
+
+  unsigned GetNeighboursSimd(const tdouble3 &posp1,unsigned rcell
+    ,int hdiv,const tint4 &nc,const tint3 &cellzero,unsigned cellinitial
+    ,const unsigned *beginendcell,StSimdNeigsc &nb,unsigned &ncand)const;
+
+  template<TpKernel tker,TpDensity tdensity> void InteractionForcesFluidSimd
+    (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellinitial,float visco
+    ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+    ,const tdouble3 *pos,const float *press
+    ,float &viscdt,float *ar,tfloat3 *ace,float *delta)const;
+
+  template<TpKernel tker> void InteractionForcesBoundSimd
+    (unsigned n,unsigned pini,tint4 nc,int hdiv,unsigned cellinitial
+    ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
+    ,const tdouble3 *pos,float &viscdt,float *ar)const;
+
+  unsigned NgListSearch(unsigned p1,int hdivnl,const tint4 &nc,const tint3 &cellzero,unsigned cellinitial
+    ,const unsigned *beginendcell,const unsigned *dcell,const tdouble3 *pos,float rcut2,unsigned *neigs)const;
+  void NgListBuild(const stinterparmsc &t);
+  float NgListMaxDisp2(unsigned np,const tdouble3 *pos)const;
+  void NgListCheck(const stinterparmsc &t);
+  void NgListSort(unsigned np,unsigned pini,unsigned pfin,const unsigned *sortpart);
+
   void InteractionForcesDEM(unsigned nfloat,tint4 nc,int hdiv,unsigned cellfluid
     ,const unsigned *beginendcell,tint3 cellzero,const unsigned *dcell
     ,const unsigned *ftridp,const StDemData* demobjs
     ,const tdouble3 *pos,const tfloat4 *velrhop,const typecode *code,const unsigned *idp
     ,float &viscdt,tfloat3 *ace)const;
 
-  template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift> 
+  template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity,bool shift,bool perf> 
     void Interaction_ForcesCpuT(const stinterparmsc &t,StInterResultc &res)const;
   template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco,TpDensity tdensity> void Interaction_Forces_ct5(const stinterparmsc &t,StInterResultc &res)const;
   template<TpKernel tker,TpFtMode ftmode,TpVisco tvisco> void Interaction_Forces_ct4(const stinterparmsc &t,StInterResultc &res)const;
@@ -258,9 +399,11 @@ protected:
   void Interaction_Forces_ct(const stinterparmsc &t,StInterResultc &res)const;
 
 //<vs_mddbc_ini>
+  void MdbcGhostUpdate(tuint3 ncells,tuint3 cellmin,const tdouble3 *pos,const tfloat3 *boundnormal);
   template<bool sim2d,TpSlipMode tslip> void InteractionBoundCorrection
     (unsigned n,float determlimit,float mdbcthreshold
-    ,tint4 nc,int hdiv,unsigned cellinitial,const unsigned *beginendcell,tint3 cellzero
+    ,tint4 nc,unsigned cellinitial,const unsigned *beginendcell
+    ,const unsigned *ghostpart,const tdouble3 *ghostpos,const tint3 *ghostcini,const tint3 *ghostcfin
     ,const tdouble3 *pos,const typecode *code,const unsigned *idp
     ,const tfloat3 *boundnormal,const tfloat3 *motionvel,tfloat4 *velrhop);
   void Interaction_BoundCorrection(TpSlipMode slipmode
@@ -41,6 +41,9 @@
 #include "JLinearValue.h"
 #include "JDataArrays.h"
 #include "JShifting.h"
+#include "JSphPerfCpu.h"
+#include "JSphSchedCpu.h"
+#include "JSphCheckpoint.h"
 #include <climits>
 
 using namespace std;
@@ -50,6 +53,7 @@ using namespace std;
 JSphCpuSingle::JSphCpuSingle():JSphCpu(false){
   ClassName="JSphCpuSingle";
   CellDivSingle=NULL;
+  InterCheckAce=InterCheckAr=InterCheckVisc=0;
 }
 
 //==============================================================================
@@ -93,6 +97,36 @@ void JSphCpuSingle::LoadConfig(JCfgRun *cfg){
   //-Load basic general configuraction. | Carga configuracion basica general.
   JSph::LoadConfig(cfg);
   //-Checks compatibility of selected options.
+  CpuSymmetric=cfg->CpuSymmetric;
+  if(CpuSymmetric && (WithFloating || Symmetry)){
+    Log->PrintWarning("The symmetric pair-force mode (-cpusymmetric) is not compatible with floating bodies or symmetry, so it is disabled.");
+    CpuSymmetric=false;
+  }
+  CpuSimd=(cfg->CpuSimd!=0);
+  CpuSimdCheck=(cfg->CpuSimd==2);
+  if(CpuSimd && (WithFloating || Symmetry || Shifting || TVisco!=VISCO_Artificial)){
+    Log->PrintWarning("The SIMD interaction (-cpusimd) is only available with artificial viscosity and without floating bodies, symmetry or shifting, so it is disabled.");
+    CpuSimd=CpuSimdCheck=false;
+  }
+  if(CpuSimd){
+    delete[] SimdNeigs;
+    SimdNeigs=new StSimdNeigsc[OmpThreads];
+  }
+  NgListSkin=cfg->CpuNgList;
+  NgList=(NgListSkin>0);
+  if(NgList && (PeriActive || InOut || CpuSymmetric || CpuSimd)){
+    Log->PrintWarning("The neighbour lists (-cpunglist) are not compatible with periodic conditions, inlet/outlet, -cpusymmetric or -cpusimd, so they are disabled.");
+    NgList=false;
+  }
+  CpuPosCell=(cfg->CpuPosCell!=0);
+  CpuPosCellCheck=(cfg->CpuPosCell==2);
+  if(CpuPosCell && (Symmetry || CpuSimd || CpuSymmetric || NgList)){
+    Log->PrintWarning("The interaction with positions relative to cells (-cpuposcell) is not compatible with symmetry, -cpusimd, -cpusymmetric or -cpunglist, so it is disabled.");
+    CpuPosCell=CpuPosCellCheck=false;
+  }
+  CellOrder=cfg->CellOrder;
+  IncDivide=cfg->IncDivide;
+  CpuSchedCost=cfg->CpuSchedCost;
   Log->Print("**Special case configuration is loaded");
 }
 
@@ -110,9 +144,7 @@ void JSphCpuSingle::ConfigDomain(){
 
   //-Copies particle data.
   ReserveBasicArraysCpu();
-  memcpy(Posc,PartsLoaded->GetPos(),sizeof(tdouble3)*Np);
-  memcpy(Idpc,PartsLoaded->GetIdp(),sizeof(unsigned)*Np);
-  memcpy(Velrhopc,PartsLoaded->GetVelRhop(),sizeof(tfloat4)*Np);
+  PartsLoaded->GetParticles(Np,Idpc,Posc,Velrhopc);
 
   //-Computes radius of floating bodies.
   if(CaseNfloat && PeriActive!=0 && !PartBegin)CalcFloatingRadius(Np,Posc,Idpc);
@@ -153,6 +185,8 @@ void JSphCpuSingle::ConfigDomain(){
   //-Crea objeto para divide en CPU y selecciona un cellmode valido.
   CellDivSingle=new JCellDivCpuSingle(Stable,FtCount!=0,PeriActive,CellMode
     ,Scell,Map_PosMin,Map_PosMax,Map_Cells,CaseNbound,CaseNfixed,CaseNpb,Log,DirOut);
+  CellDivSingle->SetCellOrder(CellOrder);
+  CellDivSingle->SetIncDivide(IncDivide);
   CellDivSingle->DefineDomain(DomCellCode,DomCelIni,DomCelFin,DomPosMin,DomPosMax);
   ConfigCellDiv((JCellDivCpu*)CellDivSingle);
 
@@ -180,39 +214,36 @@ void JSphCpuSingle::ResizeParticlesSize(unsigned newsize,float oversize,bool upd
 }
 
 //==============================================================================
-/// Create list of new periodic particles to duplicate.
-/// With stable activated reordered list of periodic particles.
+/// Counts the new periodic particles created from each block of particles.
+/// The n particles from pini are split in nblk blocks of consecutive particles
+/// and the count of each block is stored in blkcount[]. Returns the total.
 ///
-/// Crea lista de nuevas particulas periodicas a duplicar.
-/// Con stable activado reordena lista de periodicas.
+/// Cuenta las nuevas particulas periodicas creadas a partir de cada bloque de
+/// particulas consecutivas. Devuelve el total.
 //==============================================================================
-unsigned JSphCpuSingle::PeriodicMakeList(unsigned n,unsigned pini,bool stable,unsigned nmax,tdouble3 perinc,const tdouble3 *pos,const typecode *code,unsigned *listp)const{
-  unsigned count=0;
-  if(n){
-    //-Initialize size of list lsph to zero. | Inicializa tamanho de lista lspg a cero.
-    listp[nmax]=0;
-    for(unsigned p=0;p<n;p++){
-      const unsigned p2=p+pini;
+unsigned JSphCpuSingle::PeriodicCountList(unsigned n,unsigned pini,unsigned nblk
+  ,tdouble3 perinc,const tdouble3 *pos,const typecode *code,unsigned *blkcount)const
+{
+  const int nb=int(nblk);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (static) if(nb>1)
+  #endif
+  for(int b=0;b<nb;b++){
+    const unsigned pfin=pini+unsigned(ullong(n)*unsigned(b+1)/nblk);
+    unsigned count=0;
+    for(unsigned p=pini+unsigned(ullong(n)*unsigned(b)/nblk);p<pfin;p++){
       //-Keep normal or periodic particles. | Se queda con particulas normales o periodicas.
-      if(CODE_GetSpecialValue(code[p2])<=CODE_PERIODIC){
-        //-Get particle position. | Obtiene posicion de particula.
-        const tdouble3 ps=pos[p2];
-        tdouble3 ps2=ps+perinc;
-        if(Map_PosMin<=ps2 && ps2<Map_PosMax){
-          unsigned cp=listp[nmax]; listp[nmax]++; if(cp<nmax)listp[cp]=p2;
-        }
-        ps2=ps-perinc;
-        if(Map_PosMin<=ps2 && ps2<Map_PosMax){
-          unsigned cp=listp[nmax]; listp[nmax]++; if(cp<nmax)listp[cp]=(p2|0x80000000);
-        }
+      if(CODE_GetSpecialValue(code[p])<=CODE_PERIODIC){
+        const tdouble3 ps=pos[p];
+        const tdouble3 ps1=ps+perinc,ps2=ps-perinc;
+        if(Map_PosMin<=ps1 && ps1<Map_PosMax)count++;
+        if(Map_PosMin<=ps2 && ps2<Map_PosMax)count++;
       }
     }
-    count=listp[nmax];
-    //-Reorder list if it is valid and stability is activated. | Reordena lista si es valida y stable esta activado.
-    if(stable && count && count<=nmax){
-      //-Don't make mistake because at the moment the list is not created using OpenMP. | No hace falta porque de momento no se crea la lista usando OpenMP.
-    }
+    blkcount[b]=count;
   }
+  unsigned count=0;
+  for(unsigned b=0;b<nblk;b++)count+=blkcount[b];
   return(count);
 }
 
@@ -252,94 +283,59 @@ void JSphCpuSingle::PeriodicDuplicatePos(unsigned pnew,unsigned pcopy,bool inver
 }
 
 //==============================================================================
-/// Create periodic particles starting from a list of the particles to duplicate.
-/// Assume that all the particles are valid.
-/// This kernel works for single-cpu & multi-cpu because it uses domposmin.
-///
-/// Crea particulas periodicas a partir de una lista con las particulas a duplicar.
-/// Se presupone que todas las particulas son validas.
-/// Este kernel vale para single-cpu y multi-cpu porque usa domposmin. 
-//==============================================================================
-void JSphCpuSingle::PeriodicDuplicateVerlet(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-  ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tfloat4 *velrhopm1)const
-{
-  const int n=int(np);
-  #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
-  #endif
-  for(int p=0;p<n;p++){
-    const unsigned pnew=unsigned(p)+pini;
-    const unsigned rp=listp[p];
-    const unsigned pcopy=(rp&0x7FFFFFFF);
-    //-Adjust position and cell of new particle. | Ajusta posicion y celda de nueva particula.
-    PeriodicDuplicatePos(pnew,pcopy,(rp>=0x80000000),perinc.x,perinc.y,perinc.z,cellmax,pos,dcell);
-    //-Copy the rest of the values. | Copia el resto de datos.
-    idp[pnew]=idp[pcopy];
-    code[pnew]=CODE_SetPeriodic(code[pcopy]);
-    velrhop[pnew]=velrhop[pcopy];
-    velrhopm1[pnew]=velrhopm1[pcopy];
-    if(spstau)spstau[pnew]=spstau[pcopy];
-  }
-}
-
-//==============================================================================
-/// Create periodic particles starting from a list of the particles to duplicate.
-/// Assume that all the particles are valid.
-/// This kernel works for single-cpu & multi-cpu because it uses domposmin.
-///
-/// Crea particulas periodicas a partir de una lista con las particulas a duplicar.
-/// Se presupone que todas las particulas son validas.
-/// Este kernel vale para single-cpu y multi-cpu porque usa domposmin. 
-//==============================================================================
-void JSphCpuSingle::PeriodicDuplicateSymplectic(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-  ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tdouble3 *pospre,tfloat4 *velrhoppre)const
-{
-  const int n=int(np);
-  #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
-  #endif
-  for(int p=0;p<n;p++){
-    const unsigned pnew=unsigned(p)+pini;
-    const unsigned rp=listp[p];
-    const unsigned pcopy=(rp&0x7FFFFFFF);
-    //-Adjust position and cell of new particle. | Ajusta posicion y celda de nueva particula.
-    PeriodicDuplicatePos(pnew,pcopy,(rp>=0x80000000),perinc.x,perinc.y,perinc.z,cellmax,pos,dcell);
-    //-Copy the rest of the values. | Copia el resto de datos.
-    idp[pnew]=idp[pcopy];
-    code[pnew]=CODE_SetPeriodic(code[pcopy]);
-    velrhop[pnew]=velrhop[pcopy];
-    if(pospre)pospre[pnew]=pospre[pcopy];
-    if(velrhoppre)velrhoppre[pnew]=velrhoppre[pcopy];
-    if(spstau)spstau[pnew]=spstau[pcopy];
-  }
-}
-
-//<vs_mddbc_ini>
-//==============================================================================
-/// Create periodic particles starting from a list of the particles to duplicate.
-/// Assume that all the particles are valid.
+/// Creates the new periodic particles from pnew0 in the same order used by a
+/// serial search. Each block of PeriodicCountList() writes its particles after 
+/// those of the previous blocks, so no intermediate list is needed. Arrays 
+/// velrhopm1, pospre, velrhoppre, spstau, normals and motionvel can be NULL.
 /// This kernel works for single-cpu & multi-cpu because it uses domposmin.
 ///
-/// Crea particulas periodicas a partir de una lista con las particulas a duplicar.
-/// Se presupone que todas las particulas son validas.
+/// Crea las nuevas particulas periodicas a partir de pnew0 en el mismo orden 
+/// que una busqueda secuencial. Cada bloque de PeriodicCountList() graba sus 
+/// particulas tras las de los bloques anteriores, sin usar una lista intermedia.
 /// Este kernel vale para single-cpu y multi-cpu porque usa domposmin. 
 //==============================================================================
-void JSphCpuSingle::PeriodicDuplicateNormals(unsigned np,unsigned pini,tuint3 cellmax
-  ,tdouble3 perinc,const unsigned *listp,tfloat3 *normals,tfloat3 *motionvel)const
+void JSphCpuSingle::PeriodicDuplicate(unsigned n,unsigned pini,unsigned nblk
+  ,const unsigned *blkcount,unsigned pnew0,tuint3 cellmax,tdouble3 perinc
+  ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop
+  ,tsymatrix3f *spstau,tfloat4 *velrhopm1,tdouble3 *pospre,tfloat4 *velrhoppre
+  ,tfloat3 *normals,tfloat3 *motionvel)const
 {
-  const int n=int(np);
+  //-First new particle of each block. | Primera particula nueva de cada bloque.
+  unsigned blkini[OMP_MAXTHREADS];
+  for(unsigned b=0,pnew=pnew0;b<nblk;b++){ blkini[b]=pnew; pnew+=blkcount[b]; }
+  const int nb=int(nblk);
   #ifdef OMP_USE
-    #pragma omp parallel for schedule (static) if(n>OMP_LIMIT_COMPUTELIGHT)
+    #pragma omp parallel for schedule (static) if(nb>1)
   #endif
-  for(int p=0;p<n;p++){
-    const unsigned pnew=unsigned(p)+pini;
-    const unsigned rp=listp[p];
-    const unsigned pcopy=(rp&0x7FFFFFFF);
-    normals[pnew]=normals[pcopy];
-    if(motionvel)motionvel[pnew]=motionvel[pcopy];
+  for(int b=0;b<nb;b++)if(blkcount[b]){
+    const unsigned pfin=pini+unsigned(ullong(n)*unsigned(b+1)/nblk);
+    unsigned pnew=blkini[b];
+    for(unsigned p=pini+unsigned(ullong(n)*unsigned(b)/nblk);p<pfin;p++){
+      //-Keep normal or periodic particles. | Se queda con particulas normales o periodicas.
+      if(CODE_GetSpecialValue(code[p])<=CODE_PERIODIC){
+        const tdouble3 ps=pos[p];
+        for(unsigned cinv=0;cinv<2;cinv++){
+          const tdouble3 ps2=(cinv? ps-perinc: ps+perinc);
+          if(Map_PosMin<=ps2 && ps2<Map_PosMax){
+            //-Adjust position and cell of new particle. | Ajusta posicion y celda de nueva particula.
+            PeriodicDuplicatePos(pnew,p,(cinv!=0),perinc.x,perinc.y,perinc.z,cellmax,pos,dcell);
+            //-Copy the rest of the values. | Copia el resto de datos.
+            idp[pnew]=idp[p];
+            code[pnew]=CODE_SetPeriodic(code[p]);
+            velrhop[pnew]=velrhop[p];
+            if(velrhopm1)velrhopm1[pnew]=velrhopm1[p];
+            if(pospre)pospre[pnew]=pospre[p];
+            if(velrhoppre)velrhoppre[pnew]=velrhoppre[p];
+            if(spstau)spstau[pnew]=spstau[p];
+            if(normals)normals[pnew]=normals[p];        //<vs_mddbc>
+            if(motionvel)motionvel[pnew]=motionvel[p];  //<vs_mddbc>
+            pnew++;
+          }
+        }
+      }
+    }
   }
 }
-//<vs_mddbc_end>
 
 //==============================================================================
 /// Create duplicate particles for periodic conditions.
@@ -360,14 +356,20 @@ void JSphCpuSingle::RunPeriodic(){
   NpfPerM1=NpfPer;
   NpbPerM1=NpbPer;
   //-Mark present periodic particles to ignore. | Marca periodicas actuales para ignorar.
-  for(unsigned p=0;p<Np;p++){
-    const typecode rcode=Codec[p];
-    if(CODE_IsPeriodic(rcode))Codec[p]=CODE_SetOutIgnore(rcode);
+  {
+    const int np=int(Np);
+    #ifdef OMP_USE
+      #pragma omp parallel for schedule (static) if(np>OMP_LIMIT_COMPUTELIGHT)
+    #endif
+    for(int p=0;p<np;p++){
+      const typecode rcode=Codec[p];
+      if(CODE_IsPeriodic(rcode))Codec[p]=CODE_SetOutIgnore(rcode);
+    }
   }
+  if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec) && (!PosPrec || !VelrhopPrec))Run_Exceptioon("Symplectic data is invalid.");
   //-Create new periodic particles. | Crea las nuevas periodicas.
   const unsigned npb0=Npb;
   const unsigned npf0=Np-Npb;
-  const unsigned np0=Np;
   NpbPer=NpfPer=0;
   BoundChanged=true;
   for(unsigned ctype=0;ctype<2;ctype++){//-0:bound, 1:fluid+floating.
@@ -383,37 +385,26 @@ void JSphCpuSingle::RunPeriodic(){
         const unsigned nper=(ctype? NpfPer: NpbPer); //-Number of new periodic particles of type to be processed. | Numero de periodicas nuevas del tipo a procesar.
         const unsigned pini2=(cblock? pini: Np-nper);
         const unsigned num2= (cblock? num:  nper);
-        //-Repeat the search if the resulting memory available is insufficient and it had to be increased.
-        //-Repite la busqueda si la memoria disponible resulto insuficiente y hubo que aumentarla.
-        bool run=true;
-        while(run && num2){
-          //-Reserve memory to create list of periodic particles. | Reserva memoria para crear lista de particulas periodicas.
-          unsigned* listp=ArraysCpu->ReserveUint();
-          unsigned nmax=CpuParticlesSize-1; //-Maximmum number of particles that fit in the list. | Numero maximo de particulas que caben en la lista.
-          //-Generate list of new periodic particles. | Genera lista de nuevas periodicas.
-          if(Np>=0x80000000)Run_Exceptioon("The number of particles is too big.");//-Because the last bit is used to mark the direction in which a new periodic particle is created. | Porque el ultimo bit se usa para marcar el sentido en que se crea la nueva periodica.
-          unsigned count=PeriodicMakeList(num2,pini2,Stable,nmax,perinc,Posc,Codec,listp);
-          //-Redimension memory for particles if there is insufficient space and repeat the search process.
-          //-Redimensiona memoria para particulas si no hay espacio suficiente y repite el proceso de busqueda.
-          if(count>nmax || !CheckCpuParticlesSize(count+Np)){
-            ArraysCpu->Free(listp); listp=NULL;
-            TmcStop(Timers,TMC_SuPeriodic);
-            ResizeParticlesSize(Np+count,PERIODIC_OVERMEMORYNP,false);
-            TmcStart(Timers,TMC_SuPeriodic);
-          }
-          else{
-            run=false;
-            //-Create new duplicate periodic particles in the list
-            //-Crea nuevas particulas periodicas duplicando las particulas de la lista.
-            if(TStep==STEP_Verlet)PeriodicDuplicateVerlet(count,Np,DomCells,perinc,listp,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc,VelrhopM1c);
-            if(TStep==STEP_Symplectic){
-              if((PosPrec || VelrhopPrec) && (!PosPrec || !VelrhopPrec))Run_Exceptioon("Symplectic data is invalid.") ;
-              PeriodicDuplicateSymplectic(count,Np,DomCells,perinc,listp,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc,PosPrec,VelrhopPrec);
+        if(num2){
+          //-Counts new periodic particles of each block (one block per thread).
+          //-Cuenta nuevas periodicas de cada bloque (un bloque por hilo).
+          unsigned blkcount[OMP_MAXTHREADS];
+          const unsigned nblk=(num2>OMP_LIMIT_COMPUTELIGHT? unsigned(OmpThreads): 1);
+          const unsigned count=PeriodicCountList(num2,pini2,nblk,perinc,Posc,Codec,blkcount);
+          if(count){
+            //-Redimension memory for particles with the exact number of new particles.
+            //-Redimensiona memoria para particulas con el numero exacto de nuevas particulas.
+            if(!CheckCpuParticlesSize(Np+count)){
+              TmcStop(Timers,TMC_SuPeriodic);
+              ResizeParticlesSize(Np+count,PERIODIC_OVERMEMORYNP,false);
+              TmcStart(Timers,TMC_SuPeriodic);
             }
-            if(UseNormals)PeriodicDuplicateNormals(count,Np,DomCells,perinc,listp,BoundNormalc,MotionVelc); //<vs_mddbc>
-
-            //-Free the list and update the number of particles. | Libera lista y actualiza numero de particulas.
-            ArraysCpu->Free(listp); listp=NULL;
+            //-Create new duplicate periodic particles after the current ones.
+            //-Crea nuevas particulas periodicas a continuacion de las actuales.
+            PeriodicDuplicate(num2,pini2,nblk,blkcount,Np,DomCells,perinc,Idpc,Codec,Dcellc,Posc,Velrhopc,SpsTauc
+              ,(TStep==STEP_Verlet? VelrhopM1c: NULL),(TStep==STEP_Symplectic? PosPrec: NULL),(TStep==STEP_Symplectic? VelrhopPrec: NULL)
+              ,(UseNormals? BoundNormalc: NULL),(UseNormals? MotionVelc: NULL));
+            //-Update the number of particles. | Actualiza numero de particulas.
             Np+=count;
             //-Update number of new periodic particles. | Actualiza numero de periodicas nuevas.
             if(!ctype)NpbPer+=count;
@@ -437,33 +428,101 @@ void JSphCpuSingle::RunCellDivide(bool updateperiodic){
 
   //-Initiates Divide.
   CellDivSingle->Divide(Npb,Np-Npb-NpbPer-NpfPer,NpbPer,NpfPer,BoundChanged,Dcellc,Codec,Idpc,Posc,Timers);
+  CellRowc=CellDivSingle->GetCellRow();
+  RowCellc=CellDivSingle->GetRowCell();
 
   //-Sorts particle data. | Ordena datos de particulas.
   TmcStart(Timers,TMC_NlSortData);
-  CellDivSingle->SortArray(Idpc);
-  CellDivSingle->SortArray(Codec);
-  CellDivSingle->SortArray(Dcellc);
-  CellDivSingle->SortArray(Posc);
-  CellDivSingle->SortArray(Velrhopc);
-  if(TStep==STEP_Verlet){
-    CellDivSingle->SortArray(VelrhopM1c);
-  }
-  else if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec)){//-In reality, this is only necessary in divide for corrector, not in predictor??? | En realidad solo es necesario en el divide del corrector, no en el predictor???
-    if(!PosPrec || !VelrhopPrec)Run_Exceptioon("Symplectic data is invalid.") ;
-    CellDivSingle->SortArray(PosPrec);
-    CellDivSingle->SortArray(VelrhopPrec);
+  //-Only particles reordered by the divide (all, only fluid or the range of the
+  // incremental divide) are sorted in a single pass per group of arrays.
+  //-Solo se ordenan las particulas reordenadas por el divide (todas, solo 
+  // fluido o el rango del divide incremental) en una pasada por grupo de arrays.
+  const bool divinc=CellDivSingle->GetDivideInc();
+  const unsigned npsort=(divinc? CellDivSingle->GetSortFin()-CellDivSingle->GetSortIni(): Np-CellDivSingle->GetSortPartIni());
+  const bool sortswap=CellDivSingle->GetSortSwap(); //-Sorted data is in the second arrays. | Los datos ordenados estan en los segundos arrays.
+  unsigned sortbytes=sizeof(unsigned)*2+sizeof(typecode)+sizeof(tdouble3)+sizeof(tfloat4); //-Bytes of sorted data per particle.
+  if(npsort){
+    {
+      unsigned* idpc=ArraysCpu->ReserveUint();
+      typecode* codec=ArraysCpu->ReserveTypeCode();
+      unsigned* dcellc=ArraysCpu->ReserveUint();
+      tdouble3* posc=ArraysCpu->ReserveDouble3();
+      tfloat4*  velrhopc=ArraysCpu->ReserveFloat4();
+      CellDivSingle->SortBasicArrays(Idpc,Codec,Dcellc,Posc,Velrhopc,idpc,codec,dcellc,posc,velrhopc);
+      if(sortswap){
+        swap(Idpc,idpc);
+        swap(Codec,codec);
+        swap(Dcellc,dcellc);
+        swap(Posc,posc);
+        swap(Velrhopc,velrhopc);
+      }
+      ArraysCpu->Free(idpc);
+      ArraysCpu->Free(codec);
+      ArraysCpu->Free(dcellc);
+      ArraysCpu->Free(posc);
+      ArraysCpu->Free(velrhopc);
+    }
+    if(TStep==STEP_Verlet){
+      tfloat4* velrhopc=ArraysCpu->ReserveFloat4();
+      CellDivSingle->SortDataArrays(VelrhopM1c,velrhopc);
+      if(sortswap)swap(VelrhopM1c,velrhopc);
+      ArraysCpu->Free(velrhopc);
+      sortbytes+=sizeof(tfloat4);
+    }
+    else if(TStep==STEP_Symplectic && (PosPrec || VelrhopPrec)){//-In reality, this is only necessary in divide for corrector, not in predictor??? | En realidad solo es necesario en el divide del corrector, no en el predictor???
+      if(!PosPrec || !VelrhopPrec)Run_Exceptioon("Symplectic data is invalid.") ;
+      tdouble3* posc=ArraysCpu->ReserveDouble3();
+      tfloat4*  velrhopc=ArraysCpu->ReserveFloat4();
+      CellDivSingle->SortDataArrays(PosPrec,VelrhopPrec,posc,velrhopc);
+      if(sortswap){
+        swap(PosPrec,posc);
+        swap(VelrhopPrec,velrhopc);
+      }
+      ArraysCpu->Free(posc);
+      ArraysCpu->Free(velrhopc);
+      sortbytes+=sizeof(tdouble3)+sizeof(tfloat4);
+    }
+    if(TVisco==VISCO_LaminarSPS){
+      tsymatrix3f *spstauc=ArraysCpu->ReserveSymatrix3f();
+      CellDivSingle->SortDataArrays(SpsTauc,spstauc);
+      if(sortswap)swap(SpsTauc,spstauc);
+      ArraysCpu->Free(spstauc);
+      sortbytes+=sizeof(tsymatrix3f);
+    }
+    if(UseNormals){ //<vs_mddbc_ini>
+      tfloat3* boundnormalc=ArraysCpu->ReserveFloat3();
+      CellDivSingle->SortDataArrays(BoundNormalc,boundnormalc);
+      if(sortswap)swap(BoundNormalc,boundnormalc);
+      ArraysCpu->Free(boundnormalc);
+      sortbytes+=sizeof(tfloat3);
+      if(MotionVelc){
+        tfloat3* motionvelc=ArraysCpu->ReserveFloat3();
+        CellDivSingle->SortDataArrays(MotionVelc,motionvelc);
+        if(sortswap)swap(MotionVelc,motionvelc);
+        ArraysCpu->Free(motionvelc);
+        sortbytes+=sizeof(tfloat3);
+      }
+    } //<vs_mddbc_end>
   }
-  if(TVisco==VISCO_LaminarSPS)CellDivSingle->SortArray(SpsTauc);
-  if(UseNormals){ //<vs_mddbc_ini>
-    CellDivSingle->SortArray(BoundNormalc);
-    if(MotionVelc)CellDivSingle->SortArray(MotionVelc);
-  } //<vs_mddbc_end>
+
+  //-Sorted data is read and written once, then the smallest part is copied.
+  //-Los datos ordenados se leen y escriben una vez, despues se copia la parte menor.
+  if(Perf)Perf->AddBytesSort(ullong(npsort+(sortswap? Np-npsort: npsort))*(sortbytes*2));
 
   //-Collect divide data. | Recupera datos del divide.
   Np=CellDivSingle->GetNpFinal();
   Npb=CellDivSingle->GetNpbFinal();
   NpbOk=Npb-CellDivSingle->GetNpbIgnore();
 
+  //-Updates rows of neighbour lists with the new order of particles.
+  if(NgList){
+    if(divinc)NgListSort(Np,CellDivSingle->GetSortIni(),CellDivSingle->GetSortFin(),CellDivSingle->GetSortPart());
+    else NgListSort(Np,CellDivSingle->GetSortPartIni(),Np,CellDivSingle->GetSortPart());
+  }
+
+  //-Ghost nodes of mDBC are computed again when boundary particles were reordered. //<vs_mddbc>
+  if(UseNormals && !CellDivSingle->GetSortPartIni())MdbcGhostOk=false;              //<vs_mddbc>
+
   //-Manages excluded particles fixed, moving and floating before aborting the execution.
   if(CellDivSingle->GetNpbOut())AbortBoundOut();
 
@@ -539,7 +598,6 @@ void JSphCpuSingle::Interaction_Forces(TpInterStep interstep){
   if(TBoundary==BC_MDBC && (MdbcCorrector || interstep!=INTERSTEP_SymCorrector))BoundCorrection(); //-Boundary correction for mDBC.  //<vs_mddbc>
   InterStep=interstep;
   PreInteraction_Forces();
-  TmcStart(Timers,TMC_CfForces);
 
   //-Interaction of Fluid-Fluid/Bound & Bound-Fluid (forces and DEM). | Interaccion Fluid-Fluid/Bound & Bound-Fluid (forces and DEM).
   const stinterparmsc parms=StInterparmsc(Np,Npb,NpbOk,CellDivSingle->GetNcells()
@@ -548,9 +606,32 @@ void JSphCpuSingle::Interaction_Forces(TpInterStep interstep){
     ,ShiftingMode,ShiftPosfsc
     ,SpsTauc,SpsGradvelc
   );
+  //-Checks neighbour lists and builds them again when necessary.
+  if(NgList){
+    TmcStart(Timers,TMC_NlNgList);
+    NgListCheck(parms);
+    TmcStop(Timers,TMC_NlNgList);
+  }
+  TmcStart(Timers,TMC_CfForces);
   StInterResultc res;
   res.viscdt=0;
-  JSphCpu::Interaction_Forces_ct(parms,res);
+  if(CpuSimdCheck || CpuPosCellCheck){
+    //-Keeps initial values to repeat the interaction with the scalar path.
+    float   *arini=ArraysCpu->ReserveFloat();
+    tfloat3 *aceini=ArraysCpu->ReserveFloat3();
+    float   *deltaini=(Deltac? ArraysCpu->ReserveFloat(): NULL);
+    memcpy(arini,Arc,sizeof(float)*Np);
+    memcpy(aceini,Acec,sizeof(tfloat3)*Np);
+    if(deltaini)memcpy(deltaini,Deltac,sizeof(float)*Np);
+    JSphCpu::Interaction_Forces_ct(parms,res);
+    InteractionCheck(parms,res,arini,aceini,deltaini);
+    ArraysCpu->Free(arini);
+    ArraysCpu->Free(aceini);
+    ArraysCpu->Free(deltaini);
+  }
+  else JSphCpu::Interaction_Forces_ct(parms,res);
+  //-Moves limits of slabs of particles according to the measured time. | Mueve limites de franjas de particulas segun el tiempo medido.
+  Sched->Rebalance();
 
   //-For 2-D simulations zero the 2nd component. | Para simulaciones 2D anula siempre la 2nd componente.
   if(Simulate2D){
@@ -578,6 +659,55 @@ void JSphCpuSingle::Interaction_Forces(TpInterStep interstep){
   TmcStop(Timers,TMC_CfForces);
 }
 
+//==============================================================================
+/// Repeats the interaction with the scalar path and double positions starting 
+/// from initial values (arini[], aceini[] and deltaini[] are overwritten) and 
+/// updates the maximum relative difference with the results of the SIMD or 
+/// PosCell interaction. The difference of ar is relative to RhopZero*Cs0/H 
+/// (or max |ar| when it is higher) since max |ar| is almost zero when the 
+/// fluid is at rest.
+///
+/// Repite la interaccion con el codigo escalar y posiciones double y actualiza
+/// la diferencia relativa maxima con los resultados de la interaccion SIMD o 
+/// PosCell. La diferencia de ar es relativa a RhopZero*Cs0/H (o max |ar| si es
+/// mayor) ya que max |ar| es casi cero con el fluido en reposo.
+//==============================================================================
+void JSphCpuSingle::InteractionCheck(const stinterparmsc &parms,const StInterResultc &res
+  ,const float *arini,const tfloat3 *aceini,const float *deltaini)
+{
+  stinterparmsc parms2=parms;
+  parms2.ar=(float*)arini;
+  parms2.ace=(tfloat3*)aceini;
+  parms2.delta=(float*)deltaini;
+  StInterResultc res2;
+  res2.viscdt=0;
+  const bool simd=CpuSimd,poscell=CpuPosCell;
+  CpuSimd=CpuPosCell=false;
+  JSphCpu::Interaction_Forces_ct(parms2,res2);
+  CpuSimd=simd; CpuPosCell=poscell;
+  //-Compares results of fluid particles (ace) and all particles (ar).
+  const int n=int(Np);
+  double acemax=0,armax=0,dacemax=0,darmax=0;
+  for(int p=0;p<n;p++){
+    float ar1=Arc[p],ar2=arini[p];
+    if(Deltac && p>=int(Npb)){
+      if(Deltac[p]!=FLT_MAX)ar1+=Deltac[p];
+      if(deltaini[p]!=FLT_MAX)ar2+=deltaini[p];
+    }
+    armax=max(armax,double(fabs(ar2)));
+    darmax=max(darmax,double(fabs(ar1-ar2)));
+    if(p>=int(Npb)){
+      const tfloat3 a2=aceini[p],da=Acec[p]-a2;
+      acemax=max(acemax,sqrt(double(a2.x*a2.x+a2.y*a2.y+a2.z*a2.z)));
+      dacemax=max(dacemax,sqrt(double(da.x*da.x+da.y*da.y+da.z*da.z)));
+    }
+  }
+  if(acemax)InterCheckAce=max(InterCheckAce,float(dacemax/acemax));
+  armax=max(armax,double(RhopZero)*Cs0/H);
+  InterCheckAr=max(InterCheckAr,float(darmax/armax));
+  if(res2.viscdt)InterCheckVisc=max(InterCheckVisc,float(fabs(res.viscdt-res2.viscdt)/res2.viscdt));
+}
+
 //<vs_mddbc_ini>
 //==============================================================================
 /// Calculates extrapolated data on boundary particles from fluid domain for mDBC.
@@ -738,13 +868,24 @@ tfloat3 JSphCpuSingle::FtPeriodicDist(const tdouble3 &pos,const tdouble3 &center
 }
 
 //==============================================================================
-/// Calculate summation: face, fomegaace.
-/// Calcula suma de face y fomegaace a partir de particulas floating.
+/// Returns range of floating particles (index of FtRidp) of block b.
+/// Devuelve rango de particulas floating (indice de FtRidp) del bloque b.
+//==============================================================================
+void JSphCpuSingle::FtGetBlockRange(unsigned b,unsigned &fpini,unsigned &fpfin)const{
+  const unsigned cf=FtBlockObj[b];
+  const unsigned fpini0=FtObjs[cf].begin-CaseNpb;
+  fpini=fpini0+FTBLOCKSIZE*(b-FtObjBlock[cf]);
+  fpfin=min(fpini+FTBLOCKSIZE,fpini0+FtObjs[cf].count);
+}
+
+//==============================================================================
+/// Calculate summation: face, fomegaace of floating particles fpini...fpfin-1
+/// of floating body cf.
+/// Calcula suma de face y fomegaace a partir de las particulas floating 
+/// fpini...fpfin-1 del floating cf.
 //==============================================================================
-void JSphCpuSingle::FtCalcForcesSum(unsigned cf,tfloat3 &face,tfloat3 &fomegaace)const{
+void JSphCpuSingle::FtCalcForcesSum(unsigned cf,unsigned fpini,unsigned fpfin,tfloat3 &face,tfloat3 &fomegaace)const{
   const StFloatingData &fobj=FtObjs[cf];
-  const unsigned fpini=fobj.begin-CaseNpb;
-  const unsigned fpfin=fpini+fobj.count;
   const float fradius=fobj.radius;
   const tdouble3 fcenter=fobj.center;
   const float fmassp=fobj.massp;
@@ -766,9 +907,28 @@ void JSphCpuSingle::FtCalcForcesSum(unsigned cf,tfloat3 &face,tfloat3 &fomegaace
 
 //==============================================================================
 /// Calculate forces around floating object particles.
+/// Partial sums of blocks of floating particles are computed in parallel and 
+/// then added in order of blocks, so the result does not depend on the number 
+/// of threads and large floating bodies are computed by several threads.
+///
 /// Calcula fuerzas sobre floatings.
+/// Las sumas parciales de los bloques de particulas floating se calculan en
+/// paralelo y despues se suman en el orden de los bloques, asi el resultado no
+/// depende del numero de hilos y los floatings grandes se calculan con varios
+/// hilos.
 //==============================================================================
 void JSphCpuSingle::FtCalcForces(StFtoForces *ftoforces)const{
+  //-Partial sums of face and fomegaace of each block. | Sumas parciales de face y fomegaace de cada bloque.
+  const int nblocks=int(FtBlockCount);
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided) if(CaseNfloat>OMP_LIMIT_COMPUTEMEDIUM)
+  #endif
+  for(int b=0;b<nblocks;b++){
+    unsigned fpini,fpfin;
+    FtGetBlockRange(unsigned(b),fpini,fpfin);
+    FtCalcForcesSum(FtBlockObj[b],fpini,fpfin,FtoBlockForces[b].face,FtoBlockForces[b].fomegaace);
+  }
+  //-Computes accelerations of each floating body. | Calcula aceleraciones de cada floating.
   const int ftcount=int(FtCount);
   #ifdef OMP_USE
     #pragma omp parallel for schedule (guided)
@@ -786,9 +946,12 @@ void JSphCpuSingle::FtCalcForces(StFtoForces *ftoforces)const{
     //-Calculates the inverse of the intertia matrix to compute the I^-1 * L= W
     const tmatrix3f invinert=fmath::InverseMatrix3x3(inert);
 
-    //-Computes traslational and rotational velocities.
-    tfloat3 face,fomegaace;
-    FtCalcForcesSum(cf,face,fomegaace);
+    //-Computes traslational and rotational velocities adding partial sums in order of blocks.
+    tfloat3 face=TFloat3(0),fomegaace=TFloat3(0);
+    for(unsigned b=FtObjBlock[cf];b<FtObjBlock[cf+1];b++){
+      face=face+FtoBlockForces[b].face;
+      fomegaace=fomegaace+FtoBlockForces[b].fomegaace;
+    }
 
     //-Calculate omega starting from fomegaace & invinert. | Calcula omega a partir de fomegaace y invinert.
     {
@@ -931,21 +1094,21 @@ void JSphCpuSingle::RunFloating(double dt,bool predictor){
       TmcStart(Timers,TMC_SuFloating);
     }//<vs_chroono_end> 
 
-    //-Apply movement around floating objects. | Aplica movimiento sobre floatings.
-    const int ftcount=int(FtCount);
+    //-Apply movement around floating objects by blocks of particles. | Aplica movimiento sobre floatings por bloques de particulas.
+    const int nblocks=int(FtBlockCount);
     #ifdef OMP_USE
-      #pragma omp parallel for schedule (guided)
+      #pragma omp parallel for schedule (guided) if(CaseNfloat>OMP_LIMIT_COMPUTEMEDIUM)
     #endif
-    for(int cf=0;cf<ftcount;cf++){
+    for(int b=0;b<nblocks;b++){
       //-Get Floating object values.
-      const StFloatingData fobj=FtObjs[cf];
+      const unsigned cf=FtBlockObj[b];
       const tfloat3 fomega=FtoForcesRes[cf].fomegares;
       const tfloat3 fvel=FtoForcesRes[cf].fvelres;
       const tdouble3 fcenter=FtoForcesRes[cf].fcenterres;
       //-Updates floating particles.
-      const float fradius=fobj.radius;
-      const unsigned fpini=fobj.begin-CaseNpb;
-      const unsigned fpfin=fpini+fobj.count;
+      const float fradius=FtObjs[cf].radius;
+      unsigned fpini,fpfin;
+      FtGetBlockRange(unsigned(b),fpini,fpfin);
       for(unsigned fp=fpini;fp<fpfin;fp++){
         const int p=FtRidp[fp];
         if(p!=UINT_MAX){
@@ -962,14 +1125,16 @@ void JSphCpuSingle::RunFloating(double dt,bool predictor){
           velrhop->z=fvel.z+(fomega.x*dist.y-fomega.y*dist.x);
         }
       }
+    }
 
-      //-Stores floating data.
-      if(!predictor){
-        FtObjs[cf].center=(PeriActive? UpdatePeriodicPos(fcenter): fcenter);
-        FtObjs[cf].angles=ToTFloat3(ToTDouble3(FtObjs[cf].angles)+ToTDouble3(fomega)*dt);
-        FtObjs[cf].fvel=fvel;
-        FtObjs[cf].fomega=fomega;
-      }
+    //-Stores floating data.
+    if(!predictor)for(unsigned cf=0;cf<FtCount;cf++){
+      const tfloat3 fomega=FtoForcesRes[cf].fomegares;
+      const tdouble3 fcenter=FtoForcesRes[cf].fcenterres;
+      FtObjs[cf].center=(PeriActive? UpdatePeriodicPos(fcenter): fcenter);
+      FtObjs[cf].angles=ToTFloat3(ToTDouble3(FtObjs[cf].angles)+ToTDouble3(fomega)*dt);
+      FtObjs[cf].fvel=FtoForcesRes[cf].fvelres;
+      FtObjs[cf].fomega=fomega;
     }
 
     //-Update data of points in FtForces and calculates motion data of affected floatings.  //<vs_moordyyn_ini>
@@ -989,7 +1154,7 @@ void JSphCpuSingle::RunFloating(double dt,bool predictor){
 void JSphCpuSingle::RunGaugeSystem(double timestep){
   const bool svpart=(TimeStep>=TimePartNext);
   GaugeSystem->CalculeCpu(timestep,svpart,CellDivSingle->GetNcells()
-    ,CellDivSingle->GetCellDomainMin(),CellDivSingle->GetBeginCell()
+    ,CellDivSingle->GetCellDomainMin(),CellDivSingle->GetBeginCell(),CellDivSingle->GetCellRow()
     ,NpbOk,Npb,Np,Posc,Codec,Idpc,Velrhopc);
 }
 
@@ -1014,20 +1179,28 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   ConfigDomain();
   ConfigRunMode(cfg);
   VisuParticleSummary();
+  if(cfg->SvPerf){
+    Perf=new JSphPerfCpu(Log,OmpThreads);
+    Perf->SetSkipSteps(cfg->SvPerfSkip);
+    if(!SvTimers)Log->PrintWarning("Timers are disabled (-svtimers:0), so times in RunPerf.csv are zero.");
+  }
 
   //-Initialisation of execution variables. | Inicializacion de variables de ejecucion.
   //------------------------------------------------------------------------------------
   InitRunCpu();
-  RunGaugeSystem(TimeStep);
+  const bool resume=!CheckpointFile.empty();
+  if(resume)CheckpointLoad();
+  else RunGaugeSystem(TimeStep);
   if(InOut)InOutInit(TimeStepIni);  //<vs_innlet>
   FreePartsInit();
   UpdateMaxValues();
   PrintAllocMemory(GetAllocMemoryCpu());
-  SaveData(); 
+  if(!resume)SaveData(); 
   TmcResetValues(Timers);
   TmcStop(Timers,TMC_Init);
   if(Log->WarningCount())Log->PrintWarningList("\n[WARNINGS]","");
-  PartNstep=-1; Part++;
+  if(Perf)Perf->Start(Timers);
+  if(!resume){ PartNstep=-1; Part++; }
 
   //-Main Loop.
   //------------
@@ -1038,6 +1211,7 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
   Log->Print(string("\n[Initialising simulation (")+RunCode+")  "+fun::GetDateTime()+"]");
   PrintHeadPart();
   while(TimeStep<TimeMax){
+    ArraysCpu->MarkStep();
     InterStep=(TStep==STEP_Symplectic? INTERSTEP_SymPredictor: INTERSTEP_Verlet);
     if(ViscoTime)Visco=ViscoTime->GetVisco(float(TimeStep));
     double stepdt=ComputeStep();
@@ -1062,7 +1236,10 @@ void JSphCpuSingle::Run(std::string appname,JCfgRun *cfg,JLog2 *log){
       TimerPart.Start();
     }
     UpdateMaxValues();
+    if(Perf)Perf->AddStep(Nstep,TimeStep,stepdt,Np,Npb,Timers);
     Nstep++;
+    ArraysCpu->CheckStep(); //-Arrays reserved during the step must be freed. | Los arrays reservados en el paso deben liberarse.
+    if(CheckpointRequested())CheckpointSave();
     if(Part<=PartIni+1 && tc.CheckTime())Log->Print(string("  ")+tc.GetInfoFinish((TimeStep-TimeStepIni)/(TimeMax-TimeStepIni)));
     if(NstepsBreak && Nstep>=NstepsBreak)break; //-For debugging.
   }
@@ -1117,6 +1294,7 @@ void JSphCpuSingle::SaveData(){
   JDataArrays arrays;
   AddBasicArrays(arrays,npsave,pos,idp,vel,rhop);
   JSph::SaveData(npsave,arrays,1,vdom,&infoplus);
+  if(Perf)Perf->SaveData();
   //-Free auxiliary memory for particle data. | Libera memoria auxiliar para datos de particulas.
   ArraysCpu->Free(idp);
   ArraysCpu->Free(pos);
@@ -1126,14 +1304,123 @@ void JSphCpuSingle::SaveData(){
   TmcStop(Timers,TMC_SuSavePart);
 }
 
+//==============================================================================
+/// Executes divide of all particles after saving or loading a checkpoint, so 
+/// the original and the resumed executions continue from the same state.
+/// Ejecuta divide de todas las particulas tras grabar o cargar un checkpoint,
+/// de forma que la ejecucion original y la reanudada siguen desde el mismo estado.
+//==============================================================================
+void JSphCpuSingle::CheckpointDivide(){
+  BoundChanged=true;
+  RunCellDivide(true);
+  if(NgList)NgListOk=false;
+}
+
+//==============================================================================
+/// Saves checkpoint with the complete state of the simulation. Particle data is
+/// saved in the current order of cells, including periodic particles.
+/// Graba checkpoint con el estado completo de la simulacion. Los datos de 
+/// particulas se graban en el orden actual de celdas, incluidas las periodicas.
+//==============================================================================
+void JSphCpuSingle::CheckpointSave(){
+  TmcStart(Timers,TMC_SuSavePart);
+  //-General state of the simulation.
+  JBinaryData bdat(JSphCheckpoint::FileCode);
+  CheckpointSaveState(&bdat);
+  //-Number of particles.
+  bdat.SetvUint("Np",Np);
+  bdat.SetvUint("Npb",Npb);
+  bdat.SetvUint("NpbOk",NpbOk);
+  bdat.SetvUint("NpbPer",NpbPer);
+  bdat.SetvUint("NpfPer",NpfPer);
+  bdat.SetvUint("NpbPerM1",NpbPerM1);
+  bdat.SetvUint("NpfPerM1",NpfPerM1);
+  //-Particle data (tfloat4 and tsymatrix3f are stored as float values).
+  const JBinaryDataDef::TpData tcode=(sizeof(typecode)==2? JBinaryDataDef::DatUshort: JBinaryDataDef::DatUint);
+  bdat.CreateArray("Idp"    ,JBinaryDataDef::DatUint   ,Np  ,Idpc    ,true);
+  bdat.CreateArray("Code"   ,tcode                     ,Np  ,Codec   ,true);
+  bdat.CreateArray("Dcell"  ,JBinaryDataDef::DatUint   ,Np  ,Dcellc  ,true);
+  bdat.CreateArray("Pos"    ,JBinaryDataDef::DatDouble3,Np  ,Posc    ,true);
+  bdat.CreateArray("Velrhop",JBinaryDataDef::DatFloat  ,Np*4,Velrhopc,true);
+  if(TStep==STEP_Verlet)bdat.CreateArray("VelrhopM1",JBinaryDataDef::DatFloat,Np*4,VelrhopM1c,true);
+  if(TVisco==VISCO_LaminarSPS)bdat.CreateArray("SpsTau",JBinaryDataDef::DatFloat,Np*6,SpsTauc,true);
+  if(UseNormals){ //<vs_mddbc_ini>
+    bdat.CreateArray("BoundNormal",JBinaryDataDef::DatFloat3,Np,BoundNormalc,true);
+    if(MotionVelc)bdat.CreateArray("MotionVel",JBinaryDataDef::DatFloat3,Np,MotionVelc,true);
+  } //<vs_mddbc_end>
+  CheckpointSaveFile(&bdat);
+  TmcStop(Timers,TMC_SuSavePart);
+  CheckpointDivide();
+}
+
+//==============================================================================
+/// Loads checkpoint to resume the simulation with the complete state.
+/// Carga checkpoint para reanudar la simulacion con el estado completo.
+//==============================================================================
+void JSphCpuSingle::CheckpointLoad(){
+  JBinaryData bdat(JSphCheckpoint::FileCode);
+  JSphCheckpoint::LoadFile(CheckpointFile,&bdat);
+  //-General state of the simulation.
+  CheckpointLoadState(&bdat);
+  //-Number of particles.
+  const unsigned np=bdat.GetvUint("Np");
+  if(np>CpuParticlesSize)ResizeParticlesSize(np,0,false);
+  Np=np;
+  Npb=bdat.GetvUint("Npb");
+  NpbOk=bdat.GetvUint("NpbOk");
+  NpbPer=bdat.GetvUint("NpbPer");
+  NpfPer=bdat.GetvUint("NpfPer");
+  NpbPerM1=bdat.GetvUint("NpbPerM1");
+  NpfPerM1=bdat.GetvUint("NpfPerM1");
+  //-Particle data.
+  const JBinaryDataDef::TpData tcode=(sizeof(typecode)==2? JBinaryDataDef::DatUshort: JBinaryDataDef::DatUint);
+  JSphCheckpoint::GetArrayData(&bdat,"Idp"    ,JBinaryDataDef::DatUint   ,Np  ,Idpc);
+  JSphCheckpoint::GetArrayData(&bdat,"Code"   ,tcode                     ,Np  ,Codec);
+  JSphCheckpoint::GetArrayData(&bdat,"Dcell"  ,JBinaryDataDef::DatUint   ,Np  ,Dcellc);
+  JSphCheckpoint::GetArrayData(&bdat,"Pos"    ,JBinaryDataDef::DatDouble3,Np  ,Posc);
+  JSphCheckpoint::GetArrayData(&bdat,"Velrhop",JBinaryDataDef::DatFloat  ,Np*4,Velrhopc);
+  if(TStep==STEP_Verlet)JSphCheckpoint::GetArrayData(&bdat,"VelrhopM1",JBinaryDataDef::DatFloat,Np*4,VelrhopM1c);
+  if(TVisco==VISCO_LaminarSPS)JSphCheckpoint::GetArrayData(&bdat,"SpsTau",JBinaryDataDef::DatFloat,Np*6,SpsTauc);
+  if(UseNormals){ //<vs_mddbc_ini>
+    JSphCheckpoint::GetArrayData(&bdat,"BoundNormal",JBinaryDataDef::DatFloat3,Np,BoundNormalc);
+    if(MotionVelc)JSphCheckpoint::GetArrayData(&bdat,"MotionVel",JBinaryDataDef::DatFloat3,Np,MotionVelc);
+  } //<vs_mddbc_end>
+  Log->Printf("Checkpoint loaded from \"%s\" (t:%g nstep:%d).",CheckpointFile.c_str(),TimeStep,Nstep);
+  CheckpointDivide();
+}
+
 //==============================================================================
 /// Displays and stores final summary of the execution.
 /// Muestra y graba resumen final de ejecucion.
 //==============================================================================
 void JSphCpuSingle::FinishRun(bool stop){
+  FlushSaveAsync();
   float tsim=TimerSim.GetElapsedTimeF()/1000.f,ttot=TimerTot.GetElapsedTimeF()/1000.f;
   JSph::ShowResume(stop,tsim,ttot,true,"");
   Log->Print(" ");
+  if(CpuSimdCheck || CpuPosCellCheck){
+    Log->Printf("Check of %s interaction against scalar path with double positions (maximum relative difference):",(CpuSimdCheck? "SIMD": "PosCell"));
+    Log->Printf("  Ace: %g   Ar: %g   ViscDt: %g",InterCheckAce,InterCheckAr,InterCheckVisc);
+    if(InterCheckAce>INTERCHECK_TOL || InterCheckAr>INTERCHECK_TOL || InterCheckVisc>INTERCHECK_TOL)
+      Log->PrintfWarning("The %s interaction differs from scalar path more than the tolerance (%g).",(CpuSimdCheck? "SIMD": "PosCell"),INTERCHECK_TOL);
+    Log->Print(" ");
+  }
+  if(IncDivide>0){
+    const unsigned ndiv=CellDivSingle->GetNdiv(),ndivinc=CellDivSingle->GetNdivInc();
+    Log->Printf("Incremental divide (max fraction=%g): %u of %u divides (%u without changes, %u full divides).",IncDivide,ndivinc,ndiv,CellDivSingle->GetNdivIncSame(),CellDivSingle->GetNdivFull());
+    if(ndivinc)Log->Printf("  Fluid particles that changed cell per incremental divide: %.1f",double(CellDivSingle->GetIncMoved())/ndivinc);
+    Log->Print(" ");
+  }
+  if(Sched->GetNslabs()>1){
+    Sched->ShowSummary();
+    Log->Print(" ");
+  }
+  if(NgList){
+    Log->Printf("Neighbour lists (skin=%g): built %u times for %u interactions (%.2f MB).",NgListSkin,NgListBuilds,NgListUses,double(MemCpuNgList)/(1024*1024));
+    Log->Print(" ");
+  }
+  Log->Printf("Arrays of particles (maximum in use/allocated): %s",ArraysCpu->GetUsageInfo().c_str());
+  Log->Print(" ");
   string hinfo=";RunMode",dinfo=string(";")+RunMode;
   if(SvTimers){
     ShowTimers();
@@ -1141,6 +1428,7 @@ void JSphCpuSingle::FinishRun(bool stop){
     Log->Print(" ");
   }
   if(SvRes)SaveRes(tsim,ttot,hinfo,dinfo);
+  if(Perf)Perf->SaveData();
   Log->PrintFilesList();
   Log->PrintWarningList();
 }
@@ -37,20 +37,24 @@ class JSphCpuSingle : public JSphCpu
 protected:
   JCellDivCpuSingle* CellDivSingle;
 
+  float InterCheckAce;   ///<Maximum relative difference of ace with the scalar interaction with double positions (with -cpusimd:2 or -cpuposcell:2).
+  float InterCheckAr;    ///<Maximum relative difference of ar with the scalar interaction with double positions (with -cpusimd:2 or -cpuposcell:2).
+  float InterCheckVisc;  ///<Maximum relative difference of viscdt with the scalar interaction with double positions (with -cpusimd:2 or -cpuposcell:2).
+
   llong GetAllocMemoryCpu()const;
   void UpdateMaxValues();
   void LoadConfig(JCfgRun *cfg);
   void ConfigDomain();
 
   void ResizeParticlesSize(unsigned newsize,float oversize,bool updatedivide);
-  unsigned PeriodicMakeList(unsigned np,unsigned pini,bool stable,unsigned nmax,tdouble3 perinc,const tdouble3 *pos,const typecode *code,unsigned *listp)const;
+  unsigned PeriodicCountList(unsigned n,unsigned pini,unsigned nblk
+    ,tdouble3 perinc,const tdouble3 *pos,const typecode *code,unsigned *blkcount)const;
   void PeriodicDuplicatePos(unsigned pnew,unsigned pcopy,bool inverse,double dx,double dy,double dz,tuint3 cellmax,tdouble3 *pos,unsigned *dcell)const;
-  void PeriodicDuplicateVerlet(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-    ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tfloat4 *velrhopm1)const;
-  void PeriodicDuplicateSymplectic(unsigned np,unsigned pini,tuint3 cellmax,tdouble3 perinc,const unsigned *listp
-    ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop,tsymatrix3f *spstau,tdouble3 *pospre,tfloat4 *velrhoppre)const;
-  void PeriodicDuplicateNormals(unsigned np,unsigned pini,tuint3 cellmax              //<vs_mddbc>
-    ,tdouble3 perinc,const unsigned *listp,tfloat3 *motionvel,tfloat3 *normals)const; //<vs_mddbc>
+  void PeriodicDuplicate(unsigned n,unsigned pini,unsigned nblk
+    ,const unsigned *blkcount,unsigned pnew0,tuint3 cellmax,tdouble3 perinc
+    ,unsigned *idp,typecode *code,unsigned *dcell,tdouble3 *pos,tfloat4 *velrhop
+    ,tsymatrix3f *spstau,tfloat4 *velrhopm1,tdouble3 *pospre,tfloat4 *velrhoppre
+    ,tfloat3 *normals,tfloat3 *motionvel)const;
   void RunPeriodic();
 
   void RunCellDivide(bool updateperiodic);
@@ -61,6 +65,8 @@ protected:
     ,int &cxini,int &cxfin,int &yini,int &yfin,int &zini,int &zfin)const;
 
   void Interaction_Forces(TpInterStep tinterstep);
+  void InteractionCheck(const stinterparmsc &parms,const StInterResultc &res
+    ,const float *arini,const tfloat3 *aceini,const float *deltaini);
   void BoundCorrection(); //<vs_mddbc>
 
   double ComputeAceMax(unsigned np,const tfloat3* ace,const typecode *code)const;
@@ -72,7 +78,8 @@ protected:
   double ComputeStep_Sym();
 
   inline tfloat3 FtPeriodicDist(const tdouble3 &pos,const tdouble3 &center,float radius)const;
-  void FtCalcForcesSum(unsigned cf,tfloat3 &face,tfloat3 &fomegaace)const;
+  void FtGetBlockRange(unsigned b,unsigned &fpini,unsigned &fpfin)const;
+  void FtCalcForcesSum(unsigned cf,unsigned fpini,unsigned fpfin,tfloat3 &face,tfloat3 &fomegaace)const;
   void FtCalcForces(StFtoForces *ftoforces)const;
   void FtCalcForcesRes(double dt,const StFtoForces *ftoforces,StFtoForcesRes *ftoforcesres)const;
   void FtApplyImposedVel(StFtoForcesRes *ftoforcesres)const; //<vs_fttvel>
@@ -81,12 +88,16 @@ protected:
   void RunGaugeSystem(double timestep);
   
   void SaveData();
+  void CheckpointDivide();
+  void CheckpointSave();
+  void CheckpointLoad();
   void FinishRun(bool stop);
 
 public:
   JSphCpuSingle();
   ~JSphCpuSingle();
   void Run(std::string appname,JCfgRun *cfg,JLog2 *log);
+  const JSphPerfCpu* GetPerf()const{ return(Perf); }
 
 //<vs_innlet_ini>
 //-Code for InOut in JSphCpuSingle_InOut.cpp
@@ -62,12 +62,13 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Double
 
   //-Inicia ejecucion con OpenMP.
   const int n=int(inoutcount);
-  #ifdef _WITHOMP
-    #pragma omp parallel for schedule (guided)
+  bool invalid=false;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided) reduction(|:invalid)
   #endif
   for(int p=0;p<n;p++){
     const unsigned p1=(unsigned)inoutpart[p];
-    if(!CODE_IsFluidInout(code[p1]))Run_Exceptioon("InOut particle is invalid.");
+    if(!CODE_IsFluidInout(code[p1])){ invalid=true; continue; } //-Exceptions can not leave the OpenMP loop.
     const unsigned izone=CODE_GetIzoneFluidInout(code[p1]);
     const byte cfg=cfgzone[izone];
     const bool computerhop=(JSphInOutZone::GetConfigRhopMode(cfg)==JSphInOutZone::MRHOP_Extrapolated);
@@ -95,9 +96,9 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Double
       
       //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
       for(int z=zini;z<zfin;z++){
-        const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
         for(int y=yini;y<yfin;y++){
-          int ymod=zmod+nc.x*y;
+          int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
           const unsigned pini=beginendcell[cxini+ymod];
           const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -245,6 +246,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Double
       velrhop[p1]=velrhopfinal;
     }
   }
+  if(invalid)Run_Exceptioon("InOut particle is invalid.");
 }
 
 //==============================================================================
@@ -261,12 +263,13 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Single
 {
   //-Inicia ejecucion con OpenMP.
   const int n=int(inoutcount);
-  #ifdef _WITHOMP
-    #pragma omp parallel for schedule (guided)
+  bool invalid=false;
+  #ifdef OMP_USE
+    #pragma omp parallel for schedule (guided) reduction(|:invalid)
   #endif
   for(int p=0;p<n;p++){
     const unsigned p1=(unsigned)inoutpart[p];
-    if(!CODE_IsFluidInout(code[p1]))Run_Exceptioon("InOut particle is invalid.");
+    if(!CODE_IsFluidInout(code[p1])){ invalid=true; continue; } //-Exceptions can not leave the OpenMP loop.
     const unsigned izone=CODE_GetIzoneFluidInout(code[p1]);
     const byte cfg=cfgzone[izone];
     const bool computerhop=(JSphInOutZone::GetConfigRhopMode(cfg)==JSphInOutZone::MRHOP_Extrapolated);
@@ -292,9 +295,9 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Single
       
       //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
       for(int z=zini;z<zfin;z++){
-        const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
         for(int y=yini;y<yfin;y++){
-          int ymod=zmod+nc.x*y;
+          int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
           const unsigned pini=beginendcell[cxini+ymod];
           const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -441,6 +444,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionInOutExtrap_Single
       velrhop[p1]=velrhopfinal;
     }
   }
+  if(invalid)Run_Exceptioon("InOut particle is invalid.");
 }
 
 //==============================================================================
@@ -504,9 +508,9 @@ float JSphCpu::Interaction_InOutZsurf(unsigned nptz,const tfloat3 *ptzpos,float
       
     //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
     for(int z=zini;z<zfin;z++){
-      const int zmod=(nc.w)*z+cellfluid; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+      const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
       for(int y=yini;y<yfin;y++){
-        int ymod=zmod+nc.x*y;
+        int ymod=cellfluid+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
         const unsigned pini=beginendcell[cxini+ymod];
         const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -541,7 +545,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Double
   ,tfloat4 *velrhop)
 {
   const int n=int(npb);
-  #ifdef _WITHOMP
+  #ifdef OMP_USE
     #pragma omp parallel for schedule (guided)
   #endif
   for(int p1=0;p1<n;p1++)if(CODE_GetTypeAndValue(code[p1])==boundcode){
@@ -564,9 +568,9 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Double
       
       //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
       for(int z=zini;z<zfin;z++){
-        const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
         for(int y=yini;y<yfin;y++){
-          int ymod=zmod+nc.x*y;
+          int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
           const unsigned pini=beginendcell[cxini+ymod];
           const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -665,7 +669,7 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Single
   ,tfloat4 *velrhop)
 {
   const int n=int(npb);
-  #ifdef _WITHOMP
+  #ifdef OMP_USE
     #pragma omp parallel for schedule (guided)
   #endif
   for(int p1=0;p1<n;p1++)if(CODE_GetTypeAndValue(code[p1])==boundcode){
@@ -688,9 +692,9 @@ template<bool sim2d,TpKernel tker> void JSphCpu::InteractionBoundCorr_Single
       
       //-Search for neighbours in adjacent cells. | Busqueda de vecinos en celdas adyacentes.
       for(int z=zini;z<zfin;z++){
-        const int zmod=(nc.w)*z+cellinitial; //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
+        const int zmod=nc.y*z; //-First row of sheet z. | Primera fila de la capa z.
         for(int y=yini;y<yfin;y++){
-          int ymod=zmod+nc.x*y;
+          int ymod=cellinitial+nc.x*int(CellRowc[zmod+y]); //-Sum from start of fluid cells. | Le suma donde empiezan las celdas de fluido.
           const unsigned pini=beginendcell[cxini+ymod];
           const unsigned pfin=beginendcell[cxfin+ymod];
 
@@ -144,9 +144,7 @@ void JSphGpuSingle::ConfigDomain(){
   AllocCpuMemoryParticles(Np);
 
   //-Copies particle data.
-  memcpy(AuxPos,PartsLoaded->GetPos(),sizeof(tdouble3)*Np);
-  memcpy(Idp,PartsLoaded->GetIdp(),sizeof(unsigned)*Np);
-  memcpy(Velrhop,PartsLoaded->GetVelRhop(),sizeof(tfloat4)*Np);
+  PartsLoaded->GetParticles(Np,Idp,AuxPos,Velrhop);
 
   //-Computes radius of floating bodies.
   if(CaseNfloat && PeriActive!=0 && !PartBegin)CalcFloatingRadius(Np,AuxPos,Idp);
@@ -852,6 +850,7 @@ void JSphGpuSingle::SaveData(){
 /// Muestra y graba resumen final de ejecucion.
 //==============================================================================
 void JSphGpuSingle::FinishRun(bool stop){
+  FlushSaveAsync();
   float tsim=TimerSim.GetElapsedTimeF()/1000.f,ttot=TimerTot.GetElapsedTimeF()/1000.f;
   JSph::ShowResume(stop,tsim,ttot,true,"");
   Log->Print(" ");
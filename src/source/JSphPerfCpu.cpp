@@ -0,0 +1,201 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphPerfCpu.cpp \brief Implements the class \ref JSphPerfCpu.
+
+#include "JSphPerfCpu.h"
+#include "JLog2.h"
+#include "JAppInfo.h"
+#include "Functions.h"
+#include "JSaveCsv2.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+//##############################################################################
+//# JSphPerfCpu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphPerfCpu::JSphPerfCpu(JLog2* log,int ompthreads):Log(log),OmpThreads(ompthreads){
+  ClassName="JSphPerfCpu";
+  Reset();
+  //-Timer groups according to the prefix of the name (VA-Init is ignored).
+  for(unsigned ct=0;ct<TMC_COUNT;ct++){
+    unsigned cg=UINT_MAX;
+    if(ct!=TMC_Init){
+      const string name=TmcGetName(CsTypeTimerCPU(ct));
+      const string group=name.substr(0,name.find('-'));
+      for(unsigned c=0;c<unsigned(Groups.size()) && cg==UINT_MAX;c++)if(Groups[c]==group)cg=c;
+      if(cg==UINT_MAX){ cg=unsigned(Groups.size()); Groups.push_back(group); }
+    }
+    TimerGroup.push_back(cg);
+  }
+  Records.resize(SizeRecords);
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphPerfCpu::~JSphPerfCpu(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables.
+//==============================================================================
+void JSphPerfCpu::Reset(){
+  FileName="";
+  Count=0;
+  CountTotal=0;
+  SkipSteps=0;
+  memset(&Totals,0,sizeof(StTotals));
+  memset(TimersLast,0,sizeof(double)*TMC_COUNT);
+  ResetStep();
+}
+
+//==============================================================================
+/// Initialisation of counters of current step.
+//==============================================================================
+void JSphPerfCpu::ResetStep(){
+  memset(Th,0,sizeof(StThreadCounters)*OMP_MAXTHREADS);
+  BytesSort=BytesStep=0;
+}
+
+//==============================================================================
+/// Starts collection of counters from the current values of timers.
+/// Inicia la recogida de contadores a partir de los valores actuales de timers.
+//==============================================================================
+void JSphPerfCpu::Start(const StSphTimerCpu *timers){
+  for(unsigned ct=0;ct<TMC_COUNT;ct++)TimersLast[ct]=timers[ct].time;
+  ResetStep();
+  TimerStep.Start();
+}
+
+//==============================================================================
+/// Stores counters of the step and starts the next one.
+/// Guarda contadores del paso e inicia el siguiente.
+//==============================================================================
+void JSphPerfCpu::AddStep(unsigned nstep,double timestep,double dt,unsigned np
+  ,unsigned npb,const StSphTimerCpu *timers)
+{
+  TimerStep.Stop();
+  StStepRecord &r=Records[Count];
+  r.nstep=nstep;
+  r.timestep=timestep;
+  r.dt=dt;
+  r.np=np;
+  r.npb=npb;
+  r.tstep=TimerStep.GetElapsedTimeD()/1000.;
+  for(unsigned ct=0;ct<TMC_COUNT;ct++){
+    r.timers[ct]=(timers[ct].time-TimersLast[ct])/1000.;
+    TimersLast[ct]=timers[ct].time;
+  }
+  //-Busy time of threads and pairs.
+  r.thmin=r.thmax=Th[0].tbusy;
+  r.pairseval=r.pairsok=0;
+  double thsum=0;
+  for(int th=0;th<OmpThreads;th++){
+    const StThreadCounters &t=Th[th];
+    r.thmin=min(r.thmin,t.tbusy);
+    r.thmax=max(r.thmax,t.tbusy);
+    thsum+=t.tbusy;
+    r.pairseval+=t.pairseval;
+    r.pairsok+=t.pairsok;
+  }
+  r.thmean=thsum/OmpThreads;
+  r.bytessort=BytesSort;
+  r.bytesstep=BytesStep;
+  //-Accumulates totals after the warm-up steps.
+  //-Acumula totales tras los pasos de calentamiento.
+  if(CountTotal>=SkipSteps){
+    Totals.nsteps++;
+    Totals.npsteps+=r.np;
+    Totals.tstep+=r.tstep;
+    for(unsigned ct=0;ct<TMC_COUNT;ct++)Totals.timers[ct]+=r.timers[ct];
+    Totals.thmax+=r.thmax;
+    Totals.thmean+=r.thmean;
+    Totals.pairseval+=r.pairseval;
+    Totals.pairsok+=r.pairsok;
+    Totals.bytessort+=r.bytessort;
+    Totals.bytesstep+=r.bytesstep;
+  }
+  Count++;
+  CountTotal++;
+  if(Count>=SizeRecords)SaveFileRecords();
+  ResetStep();
+  TimerStep.Start();
+}
+
+//==============================================================================
+/// Saves buffered records in CSV file.
+/// Graba registros del buffer en fichero CSV.
+//==============================================================================
+void JSphPerfCpu::SaveFileRecords(){
+  const bool firstsv=FileName.empty();
+  if(firstsv){
+    FileName=AppInfo.GetDirOut()+"RunPerf.csv";
+    Log->AddFileInfo(FileName,"Saves performance counters of each step (timers, thread imbalance, pairs and bytes moved).");
+  }
+  jcsv::JSaveCsv2 scsv(FileName,!firstsv,AppInfo.GetCsvSepComa());
+  const unsigned ngroups=unsigned(Groups.size());
+  //-Saves head.
+  if(firstsv){
+    scsv.SetHead();
+    scsv << "Step;Time [s];Dt [s];Np;Npb;TStep [s];TOther [s]";
+    for(unsigned cg=0;cg<ngroups;cg++){
+      scsv << Groups[cg]+" [s]";
+      for(unsigned ct=0;ct<TMC_COUNT;ct++)if(TimerGroup[ct]==cg)scsv << string(TmcGetName(CsTypeTimerCPU(ct)))+" [s]";
+    }
+    scsv << "ThreadMin [s];ThreadMax [s];ThreadMean [s];Imbalance";
+    scsv << "PairsEval;PairsOk;PairsRatio;BytesSort;BytesStep" << jcsv::Endl();
+  }
+  //-Saves data.
+  scsv.SetData();
+  scsv << jcsv::Fmt(jcsv::TpDouble1,"%.6E") << jcsv::Fmt(jcsv::TpFloat1,"%.4f");
+  for(unsigned c=0;c<Count;c++){
+    const StStepRecord &r=Records[c];
+    double ttimers=0;
+    for(unsigned ct=0;ct<TMC_COUNT;ct++)if(TimerGroup[ct]!=UINT_MAX)ttimers+=r.timers[ct];
+    scsv << r.nstep << r.timestep << r.dt << r.np << r.npb << r.tstep << max(r.tstep-ttimers,0.);
+    for(unsigned cg=0;cg<ngroups;cg++){
+      double tgroup=0;
+      for(unsigned ct=0;ct<TMC_COUNT;ct++)if(TimerGroup[ct]==cg)tgroup+=r.timers[ct];
+      scsv << tgroup;
+      for(unsigned ct=0;ct<TMC_COUNT;ct++)if(TimerGroup[ct]==cg)scsv << r.timers[ct];
+    }
+    scsv << r.thmin << r.thmax << r.thmean << float(r.thmean>0? r.thmax/r.thmean: 0);
+    scsv << r.pairseval << r.pairsok << float(r.pairseval? double(r.pairsok)/double(r.pairseval): 0);
+    scsv << r.bytessort << r.bytesstep << jcsv::Endl();
+  }
+  scsv.SaveData();
+  Count=0;
+}
+
+//==============================================================================
+/// Saves buffered records in CSV file.
+/// Graba registros del buffer en fichero CSV.
+//==============================================================================
+void JSphPerfCpu::SaveData(){
+  if(Count)SaveFileRecords();
+}
+
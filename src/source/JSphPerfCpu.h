@@ -0,0 +1,141 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para grabar contadores de rendimiento de cada paso en CPU. (17-10-2026)
+//:# - Totales de los pasos medidos tras los pasos de calentamiento para el
+//:#   programa de benchmark. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphPerfCpu.h \brief Declares the class \ref JSphPerfCpu.
+
+#ifndef _JSphPerfCpu_
+#define _JSphPerfCpu_
+
+#include <string>
+#include <vector>
+#include "JObject.h"
+#include "TypesDef.h"
+#include "OmpDefs.h"
+#include "JSphTimersCpu.h"
+
+class JLog2;
+
+//##############################################################################
+//# JSphPerfCpu
+//##############################################################################
+/// \brief Collects performance counters of each step on CPU and saves them in RunPerf.csv.
+///
+/// Each record contains the time of every CPU timer during the step (grouped by
+/// the prefix of the timer name: NL, CF, SU), the busy time of each OpenMP thread
+/// in the particle interaction, the number of evaluated and accepted pairs and
+/// the bytes moved by the reordering of particle data and by the update of the
+/// particle state.
+
+class JSphPerfCpu : protected JObject
+{
+public:
+
+  /// Counters of one OpenMP thread (padded to a cache line). | Contadores de un hilo de OpenMP.
+  typedef struct{
+    double tbusy;     ///<Time of the thread in particle interaction [s]. | Tiempo del hilo en la interaccion [s].
+    ullong pairseval; ///<Number of evaluated pairs. | Numero de parejas evaluadas.
+    ullong pairsok;   ///<Number of pairs inside the kernel support. | Numero de parejas dentro del soporte del kernel.
+    byte pad[40];
+  }StThreadCounters;
+
+  /// Record of one step. | Registro de un paso.
+  typedef struct{
+    unsigned nstep;
+    double timestep;
+    double dt;
+    unsigned np;
+    unsigned npb;
+    double tstep;               ///<Wall time of the step [s].
+    double timers[TMC_COUNT];   ///<Time of each timer during the step [s].
+    double thmin,thmax,thmean;  ///<Busy time of threads in interaction [s].
+    ullong pairseval;
+    ullong pairsok;
+    ullong bytessort;           ///<Bytes moved by the reordering of particle data.
+    ullong bytesstep;           ///<Bytes moved by the update of particle state.
+  }StStepRecord;
+
+  /// Totals of the steps after the first SkipSteps. | Totales de los pasos tras los primeros SkipSteps.
+  typedef struct{
+    unsigned nsteps;            ///<Number of accumulated steps.
+    ullong npsteps;             ///<Sum of the particles of each step (particles*steps).
+    double tstep;               ///<Wall time of the steps [s].
+    double timers[TMC_COUNT];   ///<Time of each timer [s].
+    double thmax,thmean;        ///<Busy time of the slowest and the mean thread in interaction [s].
+    ullong pairseval;
+    ullong pairsok;
+    ullong bytessort;
+    ullong bytesstep;
+  }StTotals;
+
+private:
+  JLog2* Log;
+  const int OmpThreads;
+  std::string FileName;
+
+  std::vector<std::string> Groups;  ///<Names of timer groups (prefix of timer names).
+  std::vector<unsigned> TimerGroup; ///<Group of each timer (UINT_MAX for ignored timers) [TMC_COUNT].
+
+  StThreadCounters Th[OMP_MAXTHREADS]; ///<Counters of each thread during current step.
+  ullong BytesSort;                    ///<Bytes moved by reordering during current step.
+  ullong BytesStep;                    ///<Bytes moved by update of particle state during current step.
+  double TimersLast[TMC_COUNT];        ///<Accumulated values of timers at the end of last step [ms].
+  JTimer TimerStep;                    ///<Measures wall time of each step.
+
+  static const unsigned SizeRecords=200;  ///<Maximum number of records to be buffered. | Numero maximo de registros en buffer.
+  std::vector<StStepRecord> Records;      ///<Buffered records [SizeRecords].
+  unsigned Count;                         ///<Number of buffered records.
+  ullong CountTotal;                      ///<Total number of saved records.
+
+  unsigned SkipSteps;                     ///<Number of first steps not included in Totals (warm-up). | Numero de primeros pasos no incluidos en Totals.
+  StTotals Totals;                        ///<Totals of the steps after SkipSteps. | Totales de los pasos tras SkipSteps.
+
+  void ResetStep();
+  void SaveFileRecords();
+
+public:
+  JSphPerfCpu(JLog2* log,int ompthreads);
+  ~JSphPerfCpu();
+  void Reset();
+  void Start(const StSphTimerCpu *timers);
+
+  /// Adds counters of thread th in particle interaction. | Suma contadores del hilo th en la interaccion.
+  void AddThread(int th,double tbusy,ullong pairseval,ullong pairsok){
+    StThreadCounters &t=Th[th]; t.tbusy+=tbusy; t.pairseval+=pairseval; t.pairsok+=pairsok;
+  }
+  void AddBytesSort(ullong n){ BytesSort+=n; }
+  void AddBytesStep(ullong n){ BytesStep+=n; }
+
+  void AddStep(unsigned nstep,double timestep,double dt,unsigned np,unsigned npb,const StSphTimerCpu *timers);
+  void SaveData();
+  ullong GetCountTotal()const{ return(CountTotal); }
+
+  void SetSkipSteps(unsigned n){ SkipSteps=n; }
+  const StTotals& GetTotals()const{ return(Totals); }
+};
+
+#endif
+
+
@@ -0,0 +1,300 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSaveAsync.cpp \brief Implements the classes \ref JSphPartJob and \ref JSphSaveAsync.
+
+#include "JSphSaveAsync.h"
+#include "Functions.h"
+#include "JTimer.h"
+#include <cstring>
+#ifdef __linux__
+  #include <sched.h>
+#endif
+
+using namespace std;
+
+//##############################################################################
+//# JSphPartJob
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphPartJob::JSphPartJob(){
+  ClassName="JSphPartJob";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphPartJob::~JSphPartJob(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables (the buffer memory is kept).
+/// Inicializacion de variables (se mantiene la memoria del buffer).
+//==============================================================================
+void JSphPartJob::Reset(){
+  BufferUsed=0;
+  Part=0; TimeStep=0; Nstep=0; TotalNp=0;
+  Npok=Nout=0;
+  TimePart=0;
+  DomainMin=DomainMax=TDouble3(0);
+  VDom.clear();
+  SymplecticDtPre=DemDtForce=0;
+  WithInfo=false;
+  memset(&InfoPlus,0,sizeof(JSph::StInfoPartPlus));
+  DtMean=DtMin=DtMax=0;
+  WithDtError=false; DtError=0;
+  Arrays.Reset();
+  OutCount=0;
+  OutIdp=NULL; OutPos=NULL; OutVel=NULL; OutRhop=NULL; OutMotive=NULL;
+  FtCenter.clear(); FtFvel.clear(); FtFomega.clear();
+}
+
+//==============================================================================
+/// Returns pointer to size bytes of the buffer (aligned to 64 bytes).
+/// Devuelve puntero a size bytes del buffer (alineados a 64 bytes).
+//==============================================================================
+void* JSphPartJob::AllocBuffer(size_t size){
+  const size_t size64=(size+63)/64*64;
+  if(BufferUsed+size64>Buffer.size())Run_Exceptioon("Buffer size is not enough.");
+  void *ptr=&Buffer[BufferUsed];
+  BufferUsed+=size64;
+  return(ptr);
+}
+
+//==============================================================================
+/// Stores particle arrays and excluded particles. With copy=true the data is
+/// copied in the buffer of the job, otherwise only the pointers are stored.
+///
+/// Guarda arrays de particulas y particulas excluidas. Con copy=true los datos
+/// se copian en el buffer del trabajo, sino solo se guardan los punteros.
+//==============================================================================
+void JSphPartJob::SetData(const JDataArrays &arrays,unsigned outcount
+  ,const unsigned *outidp,const tdouble3 *outpos,const tfloat3 *outvel
+  ,const float *outrhop,const byte *outmotive,bool copy)
+{
+  Arrays.Reset();
+  OutCount=outcount;
+  if(!copy){
+    Arrays.CopyFrom(arrays);
+    OutIdp=outidp; OutPos=outpos; OutVel=outvel; OutRhop=outrhop; OutMotive=outmotive;
+  }
+  else{
+    //-Computes size and resizes buffer when it is necessary.
+    const unsigned na=arrays.Count();
+    size_t size=0;
+    for(unsigned ca=0;ca<na;ca++){
+      const JDataArrays::StDataArray &arr=arrays.GetArrayCte(ca);
+      size+=(size_t(arr.count)*SizeOfType(arr.type)+63)/64*64;
+    }
+    const size_t sizeout=(sizeof(unsigned)+sizeof(tdouble3)+sizeof(tfloat3)+sizeof(float)+sizeof(byte))*size_t(outcount);
+    size+=sizeout+64*5;
+    if(Buffer.size()<size){
+      Buffer.clear(); Buffer.shrink_to_fit();
+      try{
+        Buffer.resize(size+size/8);
+      }
+      catch(const std::bad_alloc&){
+        Run_Exceptioon(fun::PrintStr("Could not allocate the requested memory (%s).",fun::LongStr(llong(size)).c_str()));
+      }
+    }
+    BufferUsed=0;
+    //-Copies particle arrays.
+    for(unsigned ca=0;ca<na;ca++){
+      const JDataArrays::StDataArray &arr=arrays.GetArrayCte(ca);
+      const size_t sizearr=size_t(arr.count)*SizeOfType(arr.type);
+      void *ptr=AllocBuffer(sizearr);
+      memcpy(ptr,arr.ptr,sizearr);
+      Arrays.AddArray(arr.fullname,arr.type,arr.count,ptr,false);
+    }
+    //-Copies excluded particles.
+    if(outcount){
+      unsigned *idp =(unsigned*)AllocBuffer(sizeof(unsigned)*outcount);  memcpy(idp ,outidp ,sizeof(unsigned)*outcount);
+      tdouble3 *pos =(tdouble3*)AllocBuffer(sizeof(tdouble3)*outcount);  memcpy(pos ,outpos ,sizeof(tdouble3)*outcount);
+      tfloat3  *vel =(tfloat3 *)AllocBuffer(sizeof(tfloat3) *outcount);  memcpy(vel ,outvel ,sizeof(tfloat3) *outcount);
+      float    *rhop=(float   *)AllocBuffer(sizeof(float)   *outcount);  memcpy(rhop,outrhop,sizeof(float)   *outcount);
+      byte     *mot =(byte    *)AllocBuffer(sizeof(byte)    *outcount);  memcpy(mot ,outmotive,sizeof(byte)  *outcount);
+      OutIdp=idp; OutPos=pos; OutVel=vel; OutRhop=rhop; OutMotive=mot;
+    }
+  }
+}
+
+
+//##############################################################################
+//# JSphSaveAsync
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphSaveAsync::JSphSaveAsync(JSph *sph,unsigned jobs):Sph(sph),JobsCount(jobs){
+  ClassName="JSphSaveAsync";
+  if(!JobsCount)Run_Exceptioon("Number of jobs is invalid.");
+  Busy=Stop=false;
+  SavedCount=WaitCount=0;
+  WaitTime=0;
+  for(unsigned c=0;c<JobsCount;c++){
+    Jobs.push_back(new JSphPartJob());
+    FreeJobs.push_back(Jobs[c]);
+  }
+  Writer=std::thread(&JSphSaveAsync::RunWriter,this);
+}
+
+//==============================================================================
+/// Destructor. Waits for pending jobs and finishes the writer thread.
+/// Destructor. Espera los trabajos pendientes y termina el hilo de escritura.
+//==============================================================================
+JSphSaveAsync::~JSphSaveAsync(){
+  DestructorActive=true;
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    Stop=true;
+  }
+  CvWork.notify_all();
+  if(Writer.joinable())Writer.join();
+  for(unsigned c=0;c<unsigned(Jobs.size());c++)delete Jobs[c];
+  Jobs.clear();
+}
+
+//==============================================================================
+/// Main function of the writer thread. It inherits the affinity of the main 
+/// thread, which is bound to one core with -ompbind, so it uses the original
+/// cores of the process (SvAsyncCores) to not compete with OpenMP thread 0.
+/// Funcion principal del hilo de escritura. Hereda la afinidad del hilo 
+/// principal, que esta asignado a un core con -ompbind, asi que usa los cores
+/// originales del proceso (SvAsyncCores) para no competir con el hilo 0 de 
+/// OpenMP.
+//==============================================================================
+void JSphSaveAsync::RunWriter(){
+ #ifdef __linux__
+  const std::vector<int> &cores=Sph->SvAsyncCores;
+  if(!cores.empty()){
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for(unsigned c=0;c<unsigned(cores.size());c++)CPU_SET(cores[c],&mask);
+    sched_setaffinity(0,sizeof(mask),&mask);
+  }
+ #endif
+  std::unique_lock<std::mutex> lock(Mtx);
+  while(true){
+    CvWork.wait(lock,[this]{ return(Stop || !Pending.empty()); });
+    if(Pending.empty())break; //-Stop with no pending jobs.
+    JSphPartJob *job=Pending.front();
+    Pending.pop_front();
+    Busy=true;
+    lock.unlock();
+    string err;
+    if(Error.empty()){//-After an error the following jobs are discarded.
+      try{
+        Sph->SavePartJob(*job);
+      }
+      catch(const std::exception &e){
+        err=e.what();
+        if(err.empty())err="Unknown error.";
+      }
+      catch(...){
+        err="Unknown error.";
+      }
+    }
+    lock.lock();
+    if(!err.empty() && Error.empty())Error=err;
+    job->Reset();
+    FreeJobs.push_back(job);
+    Busy=false;
+    SavedCount++;
+    CvDone.notify_all();
+  }
+}
+
+//==============================================================================
+/// Throws exception when the writer thread failed. Error is read with the 
+/// mutex since the writer thread sets it.
+/// Genera excepcion cuando el hilo de escritura fallo. Error se lee con el 
+/// mutex porque el hilo de escritura lo asigna.
+//==============================================================================
+void JSphSaveAsync::CheckError(){
+  string err;
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    err=Error;
+  }
+  if(!err.empty())Run_Exceptioon(string("Error saving PART data in background: ")+err);
+}
+
+//==============================================================================
+/// Returns a free job. Waits when all jobs are pending (back-pressure).
+/// Devuelve un trabajo libre. Espera si todos estan pendientes.
+//==============================================================================
+JSphPartJob* JSphSaveAsync::GetFreeJob(){
+  JSphPartJob *job=NULL;
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    if(FreeJobs.empty()){
+      JTimer tw; tw.Start();
+      CvDone.wait(lock,[this]{ return(!FreeJobs.empty()); });
+      tw.Stop();
+      WaitCount++;
+      WaitTime+=tw.GetElapsedTimeD()/1000.;
+    }
+    //-The job is not taken from FreeJobs after an error, so it is not lost.
+    if(Error.empty()){
+      job=FreeJobs.back();
+      FreeJobs.pop_back();
+    }
+  }
+  if(!job)CheckError();
+  return(job);
+}
+
+//==============================================================================
+/// Submits job to be saved by the writer thread.
+/// Envia trabajo para ser grabado por el hilo de escritura.
+//==============================================================================
+void JSphSaveAsync::Submit(JSphPartJob *job){
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    Pending.push_back(job);
+  }
+  CvWork.notify_one();
+}
+
+//==============================================================================
+/// Waits until all submitted jobs are saved.
+/// Espera hasta que todos los trabajos enviados esten grabados.
+//==============================================================================
+void JSphSaveAsync::Flush(){
+  {
+    std::unique_lock<std::mutex> lock(Mtx);
+    CvDone.wait(lock,[this]{ return(Pending.empty() && !Busy); });
+  }
+  CheckError();
+}
+
+//==============================================================================
+/// Returns memory allocated by the buffers of jobs.
+/// Devuelve la memoria reservada por los buffers de los trabajos.
+//==============================================================================
+llong JSphSaveAsync::GetAllocMemory()const{
+  llong s=0;
+  for(unsigned c=0;c<unsigned(Jobs.size());c++)s+=Jobs[c]->GetAllocMemory();
+  return(s);
+}
+
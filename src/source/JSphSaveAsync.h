@@ -0,0 +1,154 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Grabacion de ficheros PART en segundo plano con buffers reutilizables. (17-10-2026)
+//:# - El hilo de escritura usa los cores originales del proceso con -ompbind. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphSaveAsync.h \brief Declares the classes \ref JSphPartJob and \ref JSphSaveAsync.
+
+#ifndef _JSphSaveAsync_
+#define _JSphSaveAsync_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "JObject.h"
+#include "TypesDef.h"
+#include "JDataArrays.h"
+#include "JSph.h"
+
+//##############################################################################
+//# JSphPartJob
+//##############################################################################
+/// \brief Snapshot of the data of one PART to be saved.
+///
+/// When the data is copied, particle arrays and excluded particles are stored
+/// in a buffer owned by the job which is reused by following PARTs.
+
+class JSphPartJob : protected JObject
+{
+protected:
+  std::vector<byte> Buffer;  ///<Memory for copied arrays (only grows). | Memoria para arrays copiados.
+  size_t BufferUsed;
+
+  void* AllocBuffer(size_t size);
+
+public:
+  //-Values of the PART. | Valores del PART.
+  unsigned Part;
+  double TimeStep;
+  unsigned Nstep;
+  ullong TotalNp;
+  unsigned Npok;
+  unsigned Nout;
+  double TimePart;           ///<Runtime since last PART [s].
+  tdouble3 DomainMin,DomainMax;
+  std::vector<tdouble3> VDom;
+  double SymplecticDtPre;
+  double DemDtForce;
+  //-Additional information (SvData&SDAT_Info).
+  bool WithInfo;
+  JSph::StInfoPartPlus InfoPlus;
+  double DtMean,DtMin,DtMax;
+  bool WithDtError;
+  double DtError;
+  //-Particle arrays.
+  JDataArrays Arrays;
+  //-Excluded particles.
+  unsigned OutCount;
+  const unsigned *OutIdp;
+  const tdouble3 *OutPos;
+  const tfloat3  *OutVel;
+  const float    *OutRhop;
+  const byte     *OutMotive;
+  //-Floating bodies.
+  std::vector<tdouble3> FtCenter;
+  std::vector<tfloat3>  FtFvel;
+  std::vector<tfloat3>  FtFomega;
+
+  JSphPartJob();
+  ~JSphPartJob();
+  void Reset();
+  void SetData(const JDataArrays &arrays,unsigned outcount,const unsigned *outidp
+    ,const tdouble3 *outpos,const tfloat3 *outvel,const float *outrhop,const byte *outmotive
+    ,bool copy);
+  llong GetAllocMemory()const{ return(llong(Buffer.capacity())); }
+};
+
+//##############################################################################
+//# JSphSaveAsync
+//##############################################################################
+/// \brief Saves PART data in a background thread.
+///
+/// The main thread takes a free job, copies the particle data in it and submits
+/// it, then the writer thread saves the files with JSph::SavePartJob(). The number
+/// of jobs is fixed, so memory is bounded and the main thread waits when all the
+/// jobs are pending (back-pressure).
+///
+/// Graba los datos de PART en un hilo en segundo plano. El numero de trabajos es
+/// fijo, por lo que la memoria esta acotada y el hilo principal espera cuando
+/// todos los trabajos estan pendientes.
+
+class JSphSaveAsync : protected JObject
+{
+protected:
+  JSph *Sph;
+  const unsigned JobsCount;            ///<Number of jobs (buffered PARTs).
+  std::vector<JSphPartJob*> Jobs;      ///<All jobs [JobsCount].
+  std::vector<JSphPartJob*> FreeJobs;  ///<Jobs available for the main thread.
+  std::deque<JSphPartJob*> Pending;    ///<Jobs submitted to the writer thread.
+  bool Busy;                           ///<The writer thread is saving a job.
+  bool Stop;                           ///<Writer thread must finish.
+  std::string Error;                   ///<Error of writer thread (protected by Mtx).
+
+  std::thread Writer;
+  std::mutex Mtx;
+  std::condition_variable CvWork;      ///<Signals new jobs or stop to the writer.
+  std::condition_variable CvDone;      ///<Signals finished jobs to the main thread.
+
+  unsigned SavedCount;                 ///<Number of saved PARTs.
+  unsigned WaitCount;                  ///<Number of times the main thread waited for a free job.
+  double WaitTime;                     ///<Time waited by the main thread [s].
+
+  void RunWriter();
+  void CheckError();
+
+public:
+  JSphSaveAsync(JSph *sph,unsigned jobs);
+  ~JSphSaveAsync();
+  JSphPartJob* GetFreeJob();
+  void Submit(JSphPartJob *job);
+  void Flush();
+
+  unsigned GetJobsCount()const{ return(JobsCount); }
+  unsigned GetSavedCount()const{ return(SavedCount); }
+  unsigned GetWaitCount()const{ return(WaitCount); }
+  double GetWaitTime()const{ return(WaitTime); }
+  llong GetAllocMemory()const;
+};
+
+#endif
+
+
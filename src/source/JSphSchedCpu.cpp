@@ -0,0 +1,384 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file JSphSchedCpu.cpp \brief Implements the class \ref JSphSchedCpu.
+
+#include "JSphSchedCpu.h"
+#include "JLog2.h"
+#include "Functions.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+//##############################################################################
+//# JSphSchedCpu
+//##############################################################################
+//==============================================================================
+/// Constructor.
+//==============================================================================
+JSphSchedCpu::JSphSchedCpu(JLog2* log,int ompthreads):Log(log),OmpThreads(ompthreads){
+  ClassName="JSphSchedCpu";
+  Reset();
+}
+
+//==============================================================================
+/// Destructor.
+//==============================================================================
+JSphSchedCpu::~JSphSchedCpu(){
+  DestructorActive=true;
+  Reset();
+}
+
+//==============================================================================
+/// Initialisation of variables (one slab for all threads).
+/// Inicializacion de variables (una franja para todos los hilos).
+//==============================================================================
+void JSphSchedCpu::Reset(){
+  Nslabs=1;
+  for(int th=0;th<OMP_MAXTHREADS;th++){
+    ThSlab[th]=0;
+    Th[th].slab=-1; Th[th].tini=Th[th].tbusy=0;
+  }
+  memset(SlabThreads,0,sizeof(unsigned)*OMP_MAXTHREADS);
+  SlabThreads[0]=unsigned(OmpThreads);
+  memset(SlabFrac,0,sizeof(double)*(OMP_MAXTHREADS+1));
+  SlabFrac[1]=1;
+  ChunkIni.clear();
+  LoopOpen=false;
+  LoopThreads=OmpThreads;
+  UseCost=false;
+  CellCost.clear();
+  SegPart.clear(); SegAcc.clear(); SegCost.clear();
+  memset(SlabNext,0,sizeof(unsigned)*OMP_MAXTHREADS);
+  memset(SlabEnd,0,sizeof(unsigned)*OMP_MAXTHREADS);
+  memset(SlabTime,0,sizeof(double)*OMP_MAXTHREADS);
+  memset(SlabTimeTot,0,sizeof(double)*OMP_MAXTHREADS);
+  ChunksTot=ChunksStolen=0;
+  Nrebalance=0;
+  Nloops=0;
+  LoopTime=LoopIdle=0;
+}
+
+//==============================================================================
+/// Configures slabs of particles with the slab of each thread. Initial limits
+/// are proportional to the number of threads of each slab.
+/// Configura franjas de particulas con la franja de cada hilo. Los limites
+/// iniciales son proporcionales al numero de hilos de cada franja.
+//==============================================================================
+void JSphSchedCpu::ConfigSlabs(unsigned nslabs,const int *thslab){
+  Reset();
+  if(nslabs<1 || nslabs>unsigned(OmpThreads))Run_Exceptioon("Number of slabs is invalid.");
+  Nslabs=nslabs;
+  memset(SlabThreads,0,sizeof(unsigned)*OMP_MAXTHREADS);
+  for(int th=0;th<OmpThreads;th++){
+    if(thslab[th]<0 || unsigned(thslab[th])>=Nslabs)Run_Exceptioon("Slab of thread is invalid.");
+    ThSlab[th]=thslab[th];
+    SlabThreads[ThSlab[th]]++;
+  }
+  unsigned nth=0;
+  for(unsigned s=0;s<Nslabs;s++){
+    if(!SlabThreads[s])Run_Exceptioon(fun::PrintStr("Slab %u has no threads.",s));
+    SlabFrac[s]=double(nth)/OmpThreads;
+    nth+=SlabThreads[s];
+  }
+  SlabFrac[Nslabs]=1;
+}
+
+//==============================================================================
+/// Returns the block of particle memory initialised by each thread (first
+/// touch), so threads of each slab initialise the memory of their slab.
+/// Devuelve el bloque de memoria de particulas que inicializa cada hilo (first
+/// touch), asi los hilos de cada franja inicializan la memoria de su franja.
+//==============================================================================
+void JSphSchedCpu::GetTouchOrder(int *thblock)const{
+  int b=0;
+  for(unsigned s=0;s<Nslabs;s++)for(int th=0;th<OmpThreads;th++)if(ThSlab[th]==int(s))thblock[th]=b++;
+}
+
+//==============================================================================
+/// Adds segment of particles from p with constant work per particle.
+/// Anhade segmento de particulas desde p con trabajo constante por particula.
+//==============================================================================
+void JSphSchedCpu::AddSegment(unsigned p,double cost){
+  const unsigned nseg=unsigned(SegPart.size());
+  SegAcc.push_back(nseg? SegAcc[nseg-1]+SegCost[nseg-1]*(p-SegPart[nseg-1]): 0);
+  SegPart.push_back(p);
+  SegCost.push_back(cost);
+}
+
+//==============================================================================
+/// Returns estimated work of particles before p.
+/// Devuelve el trabajo estimado de las particulas anteriores a p.
+//==============================================================================
+double JSphSchedCpu::CostAt(unsigned p)const{
+  const unsigned s=unsigned(upper_bound(SegPart.begin(),SegPart.end(),p)-SegPart.begin())-1;
+  return(SegAcc[s]+SegCost[s]*(p-SegPart[s]));
+}
+
+//==============================================================================
+/// Returns first particle where the accumulated estimated work reaches cost.
+/// Devuelve la primera particula donde el trabajo estimado acumulado alcanza cost.
+//==============================================================================
+unsigned JSphSchedCpu::PartAt(double cost)const{
+  const unsigned nseg=unsigned(SegAcc.size())-1;
+  const unsigned s=unsigned(upper_bound(SegAcc.begin(),SegAcc.end(),cost)-SegAcc.begin())-1;
+  if(s>=nseg)return(SegPart[nseg]);
+  const unsigned p=SegPart[s]+unsigned(ceil((cost-SegAcc[s])/SegCost[s]));
+  return(min(p,SegPart[s+1]));
+}
+
+//==============================================================================
+/// Adds chunks of decreasing size for particles pini...pfin-1 computed by nth
+/// threads. Each chunk has the particles or the estimated work (UseCost) of
+/// the pending ones divided by nth and at least MINCHUNK particles.
+///
+/// Anhade fragmentos de tamanho decreciente para las particulas pini...pfin-1
+/// calculadas por nth hilos. Cada fragmento tiene las particulas o el trabajo
+/// estimado (UseCost) de las pendientes divididos por nth y al menos MINCHUNK
+/// particulas.
+//==============================================================================
+void JSphSchedCpu::AddChunks(unsigned pini,unsigned pfin,unsigned nth){
+  const double costfin=(UseCost? CostAt(pfin): 0);
+  unsigned p=pini;
+  while(p<pfin){
+    const unsigned rest=pfin-p;
+    unsigned size=max((rest+nth-1)/nth,MINCHUNK);
+    if(UseCost){
+      const double cost=CostAt(p);
+      size=max(PartAt(cost+(costfin-cost)/nth)-p,MINCHUNK);
+    }
+    ChunkIni.push_back(p);
+    p+=min(rest,size);
+  }
+}
+
+//==============================================================================
+/// Returns buffer for the candidate neighbours of each cell for PrepareCost().
+/// Devuelve buffer para los vecinos candidatos de cada celda para PrepareCost().
+//==============================================================================
+unsigned* JSphSchedCpu::GetCellCost(unsigned ncells){
+  if(CellCost.size()<ncells)CellCost.resize(ncells);
+  return(ncells? &CellCost[0]: NULL);
+}
+
+//==============================================================================
+/// Prepares chunks of particles pini...pini+n-1 for the next parallel loop.
+/// Limits of slabs are applied to particles [0,np).
+/// Must be called outside the parallel region.
+///
+/// Prepara los fragmentos de las particulas pini...pini+n-1 para el siguiente
+/// bucle paralelo. Los limites de franjas se aplican a las particulas [0,np).
+/// Debe llamarse fuera de la region paralela.
+//==============================================================================
+void JSphSchedCpu::Prepare(unsigned pini,unsigned n,unsigned np){
+  UseCost=false;
+  PrepareChunks(pini,n,np);
+}
+
+//==============================================================================
+/// Prepares chunks with equal estimated work of particles pini...pini+n-1 for
+/// the next parallel loop. The particles of cell c are cellpini[c]...
+/// cellpini[c+1]-1 and their candidate neighbours were stored in GetCellCost().
+/// Must be called outside the parallel region.
+///
+/// Prepara fragmentos con igual trabajo estimado de las particulas pini...
+/// pini+n-1 para el siguiente bucle paralelo. Las particulas de la celda c son
+/// cellpini[c]...cellpini[c+1]-1 y sus vecinos candidatos se grabaron en
+/// GetCellCost(). Debe llamarse fuera de la region paralela.
+//==============================================================================
+void JSphSchedCpu::PrepareCost(unsigned pini,unsigned n,unsigned np,unsigned ncells,const unsigned *cellpini){
+  if(CellCost.size()<ncells)Run_Exceptioon("Candidate neighbours of cells are missing.");
+  const unsigned pfin=pini+n;
+  SegPart.clear(); SegAcc.clear(); SegCost.clear();
+  unsigned p=pini;
+  for(unsigned c=0;c<ncells;c++){
+    const unsigned a=max(cellpini[c],p),b=min(cellpini[c+1],pfin);
+    if(a<b){
+      if(p<a)AddSegment(p,COSTPART);
+      AddSegment(a,double(COSTPART+CellCost[c]));
+      p=b;
+    }
+  }
+  if(p<pfin)AddSegment(p,COSTPART);
+  AddSegment(pfin,0);
+  UseCost=true;
+  PrepareChunks(pini,n,np);
+}
+
+//==============================================================================
+/// Splits particles pini...pini+n-1 in slabs and chunks.
+/// Divide las particulas pini...pini+n-1 en franjas y fragmentos.
+//==============================================================================
+void JSphSchedCpu::PrepareChunks(unsigned pini,unsigned n,unsigned np){
+  CloseLoop();
+  ChunkIni.clear();
+  const unsigned pfin=pini+n;
+  for(unsigned s=0;s<Nslabs;s++){
+    const unsigned sini=(s? max(pini,unsigned(SlabFrac[s]*np)): pini);
+    const unsigned sfin=(s+1<Nslabs? min(pfin,unsigned(SlabFrac[s+1]*np)): pfin);
+    SlabNext[s]=unsigned(ChunkIni.size());
+    if(sini<sfin)AddChunks(sini,sfin,SlabThreads[s]);
+    SlabEnd[s]=unsigned(ChunkIni.size());
+  }
+  ChunkIni.push_back(pfin);
+  for(int th=0;th<OmpThreads;th++){ Th[th].slab=-1; Th[th].tbusy=0; }
+  LoopThreads=(n>OMP_LIMIT_COMPUTEMEDIUM? OmpThreads: 1);
+  LoopOpen=true;
+}
+
+//==============================================================================
+/// Accumulates the busy time of the slowest thread and the mean idle time of
+/// threads at the end of the last loop.
+/// Acumula el tiempo de calculo del hilo mas lento y el tiempo medio de espera
+/// de los hilos al final del ultimo bucle.
+//==============================================================================
+void JSphSchedCpu::CloseLoop(){
+  if(LoopOpen){
+    double tmax=0,tmean=0;
+    for(int th=0;th<LoopThreads;th++){
+      tmax=max(tmax,Th[th].tbusy);
+      tmean+=Th[th].tbusy/LoopThreads;
+    }
+    Nloops++;
+    LoopTime+=tmax;
+    LoopIdle+=tmax-tmean;
+    LoopOpen=false;
+  }
+}
+
+//==============================================================================
+/// Returns the next chunk of particles for thread th. It is the next chunk of
+/// its slab or, when its slab is finished, the last chunk of the slab with more
+/// pending chunks. Returns false when there are no pending chunks.
+/// Must be called by all threads inside the parallel region.
+///
+/// Devuelve el siguiente fragmento de particulas para el hilo th. Es el
+/// siguiente fragmento de su franja o, cuando su franja esta terminada, el
+/// ultimo fragmento de la franja con mas fragmentos pendientes. Devuelve false
+/// cuando no hay fragmentos pendientes.
+/// Debe llamarse por todos los hilos dentro de la region paralela.
+//==============================================================================
+bool JSphSchedCpu::Next(int th,unsigned &pini,unsigned &pfin){
+  bool ok=false;
+  const double t=omp_get_wtime();
+  #ifdef OMP_USE
+    #pragma omp critical (JSphSchedCpu_Next)
+  #endif
+  {
+    //-Busy time of the previous chunk. | Tiempo de calculo del fragmento anterior.
+    StThreadState &ts=Th[th];
+    if(ts.slab>=0){
+      ts.tbusy+=t-ts.tini;
+      SlabTime[ts.slab]+=t-ts.tini;
+      ts.slab=-1;
+    }
+    //-Selects next chunk. | Selecciona siguiente fragmento.
+    unsigned s=unsigned(ThSlab[th]);
+    unsigned c=UINT_MAX;
+    if(SlabNext[s]<SlabEnd[s])c=SlabNext[s]++;
+    else{
+      unsigned nmax=0;
+      for(unsigned cs=0;cs<Nslabs;cs++)if(SlabEnd[cs]-SlabNext[cs]>nmax){ nmax=SlabEnd[cs]-SlabNext[cs]; s=cs; }
+      if(nmax){ c=--SlabEnd[s]; ChunksStolen++; }
+    }
+    if(c!=UINT_MAX){
+      pini=ChunkIni[c]; pfin=ChunkIni[c+1];
+      ts.slab=int(s); ts.tini=t;
+      ChunksTot++;
+      ok=true;
+    }
+  }
+  return(ok);
+}
+
+//==============================================================================
+/// Moves limits of slabs so that the busy time measured since the last call is
+/// proportional to the number of threads of each slab. The time per particle
+/// is assumed constant inside each slab and the change is damped by half.
+/// Also closes the measurement of the last loop.
+///
+/// Mueve los limites de las franjas para que el tiempo de calculo medido desde
+/// la ultima llamada sea proporcional al numero de hilos de cada franja. Se
+/// supone tiempo por particula constante dentro de cada franja y el cambio se
+/// amortigua a la mitad. Tambien cierra la medida del ultimo bucle.
+//==============================================================================
+void JSphSchedCpu::Rebalance(){
+  CloseLoop();
+  if(Nslabs<2)return;
+  double ttot=0;
+  for(unsigned s=0;s<Nslabs;s++)ttot+=SlabTime[s];
+  if(ttot>0){
+    double newfrac[OMP_MAXTHREADS+1];
+    unsigned s=0,nth=0;
+    double tacc=0;
+    for(unsigned k=1;k<Nslabs;k++){
+      nth+=SlabThreads[k-1];
+      const double target=ttot*nth/OmpThreads;
+      while(s+1<Nslabs && tacc+SlabTime[s]<target){ tacc+=SlabTime[s]; s++; }
+      const double f=(SlabTime[s]>0? min(1.,max(0.,(target-tacc)/SlabTime[s])): 0.5);
+      newfrac[k]=SlabFrac[s]+(SlabFrac[s+1]-SlabFrac[s])*f;
+    }
+    //-Damped update keeping a minimum width of slabs. | Actualizacion amortiguada manteniendo un ancho minimo de franjas.
+    const double minw=0.01/Nslabs;
+    bool changed=false;
+    for(unsigned k=1;k<Nslabs;k++){
+      double v=(SlabFrac[k]+newfrac[k])*0.5;
+      v=max(v,SlabFrac[k-1]+minw);
+      v=min(v,1.-minw*(Nslabs-k));
+      if(fabs(v-SlabFrac[k])>1e-5){ SlabFrac[k]=v; changed=true; }
+    }
+    if(changed)Nrebalance++;
+  }
+  for(unsigned s=0;s<Nslabs;s++){ SlabTimeTot[s]+=SlabTime[s]; SlabTime[s]=0; }
+}
+
+//==============================================================================
+/// Returns short description of slabs for RunMode.
+/// Devuelve descripcion corta de las franjas para RunMode.
+//==============================================================================
+std::string JSphSchedCpu::GetSlabsInfo()const{
+  string tx;
+  for(unsigned s=0;s<Nslabs;s++)tx=tx+(s? "+": "")+fun::UintStr(SlabThreads[s]);
+  return(fun::PrintStr("Slabs:%u(%s)",Nslabs,tx.c_str()));
+}
+
+//==============================================================================
+/// Shows final limits and busy time of slabs.
+/// Muestra limites finales y tiempo de calculo de las franjas.
+//==============================================================================
+void JSphSchedCpu::ShowSummary()const{
+  if(Nslabs<2)return;
+  string txlim,txtime;
+  double tmean=0,tmax=0;
+  for(unsigned s=0;s<Nslabs;s++){
+    const double tth=SlabTimeTot[s]/SlabThreads[s];
+    txlim=txlim+(s? " ": "")+fun::DoubleStr(SlabFrac[s],"%.4f");
+    txtime=txtime+(s? " ": "")+fun::DoubleStr(SlabTimeTot[s],"%.3f");
+    tmean+=tth/Nslabs;
+    tmax=max(tmax,tth);
+  }
+  txlim=txlim+" "+fun::DoubleStr(SlabFrac[Nslabs],"%.4f");
+  Log->Printf("Slabs of particles for interaction (%s):",GetSlabsInfo().c_str());
+  Log->Printf("  Limits (fraction of particles): %s",txlim.c_str());
+  Log->Printf("  Busy time per slab [s]: %s (imbalance per thread: %.1f%%)",txtime.c_str(),(tmean>0? (tmax/tmean-1)*100: 0));
+  Log->Printf("  Chunks computed by threads of other slabs: %.2f%% (rebalances: %u)",(ChunksTot? 100.*ChunksStolen/ChunksTot: 0),Nrebalance);
+}
+
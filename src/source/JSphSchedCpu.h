@@ -0,0 +1,166 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//:#############################################################################
+//:# Cambios:
+//:# =========
+//:# - Clase para repartir los rangos de particulas de la interaccion entre los
+//:#   hilos OpenMP, con franjas (slabs) de particulas por socket que se
+//:#   reequilibran segun el tiempo medido. (17-10-2026)
+//:# - Fragmentos de igual coste estimado con la ocupacion de las celdas y 
+//:#   medida del tiempo de espera de los hilos en cada bucle. (17-10-2026)
+//:# - Los bucles pequenhos se ejecutan con un hilo y se devuelve el tiempo de
+//:#   calculo de cada hilo para JSphPerfCpu. (17-10-2026)
+//:#############################################################################
+
+/// \file JSphSchedCpu.h \brief Declares the class \ref JSphSchedCpu.
+
+#ifndef _JSphSchedCpu_
+#define _JSphSchedCpu_
+
+#include <string>
+#include <vector>
+#include "JObject.h"
+#include "TypesDef.h"
+#include "OmpDefs.h"
+
+class JLog2;
+
+//##############################################################################
+//# JSphSchedCpu
+//##############################################################################
+/// \brief Distributes the particles of the interaction on CPU among the OpenMP threads.
+///
+/// The particle range of each interaction loop is split in chunks of decreasing
+/// size (as the guided schedule of OpenMP) and each thread requests the next
+/// chunk with Next(). With several slabs, the particles [0,np) are split in
+/// contiguous slabs (particles are sorted by cells, so each slab is a slab of
+/// the domain along the outer axis of the order of cells) and each slab is
+/// assigned to the threads of one socket, which first touched approximately the
+/// same part of the particle arrays (see JArraysCpuSize::FirstTouch()). Threads of one slab only compute chunks of other slabs
+/// when their slab is finished. The busy time of each slab is measured and the
+/// limits of the slabs are moved after each interaction to equal the time of
+/// the slabs.
+/// With PrepareCost() the chunks have equal estimated work instead of equal
+/// number of particles. The work of each particle is estimated with the number
+/// of candidate neighbours of its cell (from the occupancy of BeginCell).
+/// The idle time of threads at the end of each loop is measured for all modes.
+/// JSphCpu only uses this class with slabs, PrepareCost() or performance
+/// counters, otherwise the interaction keeps the guided schedule of OpenMP.
+/// Loops of up to OMP_LIMIT_COMPUTEMEDIUM particles are run by one thread (the
+/// parallel regions of the interaction use the same limit).
+///
+/// Distribuye las particulas de la interaccion en CPU entre los hilos OpenMP.
+/// El rango de particulas de cada bucle se divide en fragmentos de tamanho
+/// decreciente (como el reparto guided de OpenMP) y cada hilo pide el siguiente
+/// fragmento con Next(). Con varias franjas, las particulas [0,np) se dividen
+/// en franjas contiguas (las particulas estan ordenadas por celdas, asi que
+/// cada franja es una franja del dominio segun el eje exterior del orden de
+/// celdas) y cada franja se asigna a los hilos de un socket, que inicializaron
+/// aproximadamente la misma parte de los arrays de particulas. Los hilos de una franja solo
+/// calculan fragmentos de otras franjas cuando terminan la suya. Se mide el
+/// tiempo de calculo de cada franja y tras cada interaccion se mueven los
+/// limites de las franjas para igualar el tiempo de las franjas.
+/// Con PrepareCost() los fragmentos tienen igual trabajo estimado en lugar de
+/// igual numero de particulas. El trabajo de cada particula se estima con el
+/// numero de vecinos candidatos de su celda (con la ocupacion de BeginCell).
+/// Se mide el tiempo de espera de los hilos al final de cada bucle.
+/// JSphCpu solo usa esta clase con franjas, PrepareCost() o contadores de
+/// rendimiento, en otro caso la interaccion mantiene el reparto guided de OpenMP.
+/// Los bucles de hasta OMP_LIMIT_COMPUTEMEDIUM particulas los ejecuta un hilo.
+
+class JSphSchedCpu : protected JObject
+{
+protected:
+  /// State of each thread (padded to a cache line). | Estado de cada hilo.
+  typedef struct{
+    int slab;      ///<Slab of the current chunk (-1: none). | Franja del fragmento actual (-1: ninguno).
+    double tini;   ///<Start time of the current chunk. | Instante de inicio del fragmento actual.
+    double tbusy;  ///<Busy time in the current loop [s]. | Tiempo de calculo en el bucle actual [s].
+    byte pad[40];
+  }StThreadState;
+
+  JLog2* Log;
+  const int OmpThreads;
+  static const unsigned MINCHUNK=16;  ///<Minimum number of particles of a chunk. | Numero minimo de particulas de un fragmento.
+  static const unsigned COSTPART=8;   ///<Estimated work of each particle besides its candidate neighbours. | Trabajo estimado de cada particula ademas de sus vecinos candidatos.
+
+  unsigned Nslabs;                       ///<Number of slabs of particles (1: one slab for all threads). | Numero de franjas de particulas.
+  int ThSlab[OMP_MAXTHREADS];            ///<Slab of each thread. | Franja de cada hilo.
+  unsigned SlabThreads[OMP_MAXTHREADS];  ///<Number of threads of each slab. | Numero de hilos de cada franja.
+  double SlabFrac[OMP_MAXTHREADS+1];     ///<Limits of slabs as fraction of particles [Nslabs+1]. | Limites de franjas como fraccion de particulas.
+
+  //-Chunks of the current loop. | Fragmentos del bucle actual.
+  std::vector<unsigned> ChunkIni;        ///<First particle of each chunk and end of the last one [nchunks+1]. | Primera particula de cada fragmento y final del ultimo.
+  unsigned SlabNext[OMP_MAXTHREADS];     ///<Next chunk of each slab. | Siguiente fragmento de cada franja.
+  unsigned SlabEnd[OMP_MAXTHREADS];      ///<End of pending chunks of each slab. | Final de los fragmentos pendientes de cada franja.
+  StThreadState Th[OMP_MAXTHREADS];      ///<State of each thread. | Estado de cada hilo.
+  bool LoopOpen;                         ///<Busy time of threads in the current loop is pending. | Tiempo de los hilos en el bucle actual esta pendiente.
+  int LoopThreads;                       ///<Threads of the current loop (1 up to OMP_LIMIT_COMPUTEMEDIUM particles). | Hilos del bucle actual (1 hasta OMP_LIMIT_COMPUTEMEDIUM particulas).
+
+  //-Estimated work of particles for PrepareCost(). | Trabajo estimado de particulas para PrepareCost().
+  bool UseCost;                          ///<Chunks of the current loop use the estimated work. | Los fragmentos del bucle actual usan el trabajo estimado.
+  std::vector<unsigned> CellCost;        ///<Candidate neighbours of each cell [ncells]. | Vecinos candidatos de cada celda.
+  std::vector<unsigned> SegPart;         ///<First particle of each segment of constant work per particle [nseg+1]. | Primera particula de cada segmento de trabajo constante.
+  std::vector<double> SegAcc;            ///<Accumulated work at the start of each segment [nseg+1]. | Trabajo acumulado al inicio de cada segmento.
+  std::vector<double> SegCost;           ///<Work per particle of each segment [nseg+1]. | Trabajo por particula de cada segmento.
+
+  //-Statistics. | Estadisticas.
+  double SlabTime[OMP_MAXTHREADS];       ///<Busy time of each slab since the last rebalance [s]. | Tiempo de calculo de cada franja desde el ultimo reequilibrado [s].
+  double SlabTimeTot[OMP_MAXTHREADS];    ///<Total busy time of each slab [s]. | Tiempo total de calculo de cada franja [s].
+  ullong ChunksTot;                      ///<Total number of computed chunks. | Numero total de fragmentos calculados.
+  ullong ChunksStolen;                   ///<Chunks computed by threads of other slab. | Fragmentos calculados por hilos de otra franja.
+  unsigned Nrebalance;                   ///<Number of rebalances that changed the limits. | Numero de reequilibrados que cambiaron los limites.
+  unsigned Nloops;                       ///<Number of measured loops. | Numero de bucles medidos.
+  double LoopTime;                       ///<Total time of loops (busy time of the slowest thread) [s]. | Tiempo total de los bucles [s].
+  double LoopIdle;                       ///<Total mean idle time of threads at the end of loops [s]. | Tiempo medio total de espera de los hilos al final de los bucles [s].
+
+  void AddSegment(unsigned p,double cost);
+  double CostAt(unsigned p)const;
+  unsigned PartAt(double cost)const;
+  void AddChunks(unsigned pini,unsigned pfin,unsigned nth);
+  void PrepareChunks(unsigned pini,unsigned n,unsigned np);
+  void CloseLoop();
+
+public:
+  JSphSchedCpu(JLog2* log,int ompthreads);
+  ~JSphSchedCpu();
+  void Reset();
+  void ConfigSlabs(unsigned nslabs,const int *thslab);
+
+  unsigned GetNslabs()const{ return(Nslabs); }
+  void GetTouchOrder(int *thblock)const;
+
+  unsigned* GetCellCost(unsigned ncells);
+  void Prepare(unsigned pini,unsigned n,unsigned np);
+  void PrepareCost(unsigned pini,unsigned n,unsigned np,unsigned ncells,const unsigned *cellpini);
+  bool Next(int th,unsigned &pini,unsigned &pfin);
+  /// Returns the busy time of thread th in the last loop [s]. | Devuelve el tiempo de calculo del hilo th en el ultimo bucle [s].
+  double GetThreadBusy(int th)const{ return(Th[th].tbusy); }
+  void Rebalance();
+
+  std::string GetSlabsInfo()const;
+  unsigned GetNloops()const{ return(Nloops); }
+  double GetLoopTime()const{ return(LoopTime); }
+  double GetLoopIdle()const{ return(LoopIdle); }
+  void ShowSummary()const;
+};
+
+#endif
+
+
@@ -56,9 +56,10 @@ typedef enum{
   ,TMC_SuChrono=14      //<vs_innlet>
   ,TMC_SuBoundCorr=15   //<vs_innlet>
   ,TMC_SuInOut=16       //<vs_innlet>
+  ,TMC_NlNgList=17
 }CsTypeTimerCPU;
-//#define TMC_COUNT 14   //<vs_no_innlet>
-#define TMC_COUNT 17     //<vs_innlet>
+//#define TMC_COUNT 15   //<vs_no_innlet>
+#define TMC_COUNT 18     //<vs_innlet>
 
 typedef StSphTimerCpu TimersCpu[TMC_COUNT];
 
@@ -84,6 +85,7 @@ inline const char* TmcGetName(CsTypeTimerCPU ct){
     case TMC_SuChrono:          return("SU-Chrono");     //<vs_chroono>
     case TMC_SuBoundCorr:       return("SU-BoundCorr");  //<vs_innlet>
     case TMC_SuInOut:           return("SU-InOut");      //<vs_innlet>
+    case TMC_NlNgList:          return("NL-NgList");
   }
   return("???");
 }
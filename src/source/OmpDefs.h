@@ -34,6 +34,7 @@
 #else
   #define omp_get_thread_num() 0
   #define omp_get_max_threads() 1
+  #define omp_get_wtime() 0.
 #endif
 
 #define OMP_MAXTHREADS 64  
@@ -0,0 +1,67 @@
+//HEAD_DSPH
+/*
+ <DUALSPHYSICS>  Copyright (c) 2020 by Dr Jose M. Dominguez et al. (see http://dual.sphysics.org/index.php/developers/).
+
+ EPHYSLAB Environmental Physics Laboratory, Universidade de Vigo, Ourense, Spain.
+ School of Mechanical, Aerospace and Civil Engineering, University of Manchester, Manchester, U.K.
+
+ This file is part of DualSPHysics.
+
+ DualSPHysics is free software: you can redistribute it and/or modify it under the terms of the GNU Lesser General Public License
+ as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+ DualSPHysics is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License along with DualSPHysics. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file mainbench.cpp \brief Main file of the CPU micro-benchmark (see \ref JSphBenchCpu).
+
+#include <string>
+#include <cstdio>
+#include "JAppInfo.h"
+#include "JException.h"
+#include "JSphBenchCpu.h"
+#include "Functions.h"
+
+#ifdef _MSC_VER
+  #pragma warning(disable : 4996) //Cancels sprintf() deprecated.
+#endif
+
+using namespace std;
+
+
+JAppInfo AppInfo("DualSPHysics5Bench","v5.0.112e","17-10-2026");
+
+//==============================================================================
+//==============================================================================
+int main(int argc, char** argv){
+  int errcode=1;
+  AppInfo.ConfigRunPaths(argv[0]);
+  const std::string appname=AppInfo.GetFullName();
+  printf("\n%s\n\n",appname.c_str());
+  try{
+    JSphBenchCpu bench(appname);
+    if(bench.LoadArgv(argc,argv))bench.Run();
+    errcode=0;
+  }
+  catch(const char *cad){
+    printf("\n*** Exception(chr): %s\n",cad);
+  }
+  catch(const string &e){
+    printf("\n*** Exception(str): %s\n",e.c_str());
+  }
+  catch (const JException &){
+    //-The message was already printed by JException. | El mensaje ya fue mostrado por JException.
+  }
+  catch (const exception &e){
+    printf("\n*** Exception(exc): %s\n",e.what());
+  }
+  catch(...){
+    printf("\n*** Attention: Unknown exception...\n");
+  }
+  printf("\nFinished execution (code=%d).\n",errcode);
+  return(errcode);
+}
+
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+#-Compares the order of cells in memory on CPU (-cellorder:row/morton/hilbert).
+#-Time of CF-Forces is saved in Run.out (-svtimers) and cache misses are
+#-measured with perf when it is available.
+
+flog=z_TestCellOrder.csv
+
+vexe=_linux64
+casedir=_DataCases_Ds5Test
+ds="../bin/linux/DualSPHysics${vexe}"
+
+opt="-symplectic -ddt:3 -cellmode:2h -sv:none -svtimers:1 -tmax:0.02"
+
+perfev="cache-references,cache-misses,LLC-loads,LLC-load-misses,L1-dcache-load-misses"
+perfok=0
+if [ -x "$(command -v perf)" ]; then
+  perf stat -e ${perfev} true > /dev/null 2>&1 && perfok=1
+fi
+if [ $perfok = 0 ]; then
+  echo "perf is not available, cache misses are not measured."
+fi
+
+export LD_LIBRARY_PATH=${LD_LIBRARY_PATH}:$(pwd)/../bin/linux
+
+for fcase in Spheric2Dam_100K Spheric2Dam_200K Spheric2Dam_400K Spheric2Dam_01M; do
+  #-Generates case once.
+  if [ ! -e ${casedir}/z${fcase}.bi4 ]; then
+    ../bin/linux/GenCase${vexe} ${casedir}/${fcase} ${casedir}/z${fcase}
+  fi
+  for order in row morton hilbert; do
+    dirout=TestCellOrder${vexe}_c_${fcase}_${order}
+    rm -f -r ${dirout}
+    mkdir ${dirout}
+    cmd="${ds} -name ${casedir}/z${fcase} -dirout ${dirout} -runname ${dirout} -cpu -svres -cellorder:${order} ${opt}"
+    if [ $perfok = 1 ]; then
+      perf stat -x, -o ${dirout}/PerfStat.csv -e ${perfev} ${cmd}
+    else
+      ${cmd}
+    fi
+    #-Stores execution summary and CF-Forces time.
+    tforces=$(grep "CF-Forces" ${dirout}/Run.out | head -n 1 | awk '{print $2}')
+    if [ ! -e ${flog} ]; then
+      echo "Case;Order;CF-Forces(s);$(head -n 1 ${dirout}/Run.csv)" > ${flog}
+    fi
+    echo "${fcase};${order};${tforces};$(tail -n 1 ${dirout}/Run.csv)" >> ${flog}
+    if [ $perfok = 1 ]; then
+      echo "--- ${fcase} ${order} ---" >> ${flog%.csv}_perf.txt
+      cat ${dirout}/PerfStat.csv >> ${flog%.csv}_perf.txt
+    fi
+  done
+done
+
+echo "--- DONE! ---"
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+export bench="../bin/linux/DualSPHysicsBench_linux64"
+
+export dirout=_BenchCpu
+
+# Dam break cases (as Spheric2Dam) generated without GenCase.
+# Strong scaling: the same case of 1M particles with 1, 2, 4... threads.
+${bench} -case:dam -np:1000000 -ddts:3 -steps:20 -dirout:${dirout}/strong
+
+# Weak scaling: 250K particles per thread (a case is generated for each number of threads).
+${bench} -case:dam -weak:250000 -ddts:3 -steps:20 -dirout:${dirout}/weak
+
+# Only generation of cases (e.g. 13M particles in 4 pieces of bi4).
+${bench} -case:dam -np:13000000 -pieces:4 -solver:0 -radix:0 -dirout:${dirout}/case13M
+
+echo --- DONE! ---